@@ -35,6 +35,8 @@
 
 #include "CustomProperties.h"
 #include "macros.h"
+#include <capture_attributes.hpp>
+#include <thumbnail.hpp> // media_core
 
 /////////////////////////////////////////////////////////////////////////////////
 //
@@ -63,6 +65,56 @@ STDMETHODIMP CSocMft0::GetState(UINT32 *pState)
     return hr;
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+//
+// The input queue. Each value has its own method, so the clients don't share a selection
+//
+STDMETHODIMP CSocMft0::SetQueueDepth(UINT32 depth)
+{
+    if (depth == 0 || depth > SOCMFT0_MAX_QUEUE_DEPTH)
+    {
+        return E_INVALIDARG;
+    }
+    CAutoLock lock(&m_critSec);
+    // The samples over the new depth are not dropped. ProcessInput waits for them
+    m_uiQueueDepth = depth;
+    return S_OK;
+}
+
+STDMETHODIMP CSocMft0::GetQueueDepth(UINT32 *pDepth)
+{
+    if (!pDepth)
+    {
+        return E_POINTER;
+    }
+    CAutoLock lock(&m_critSec);
+    *pDepth = m_uiQueueDepth;
+    return S_OK;
+}
+
+STDMETHODIMP CSocMft0::GetQueueCount(UINT32 *pCount)
+{
+    if (!pCount)
+    {
+        return E_POINTER;
+    }
+    CAutoLock lock(&m_critSec);
+    *pCount = static_cast<UINT32>(m_sampleQueue.size());
+    return S_OK;
+}
+
+STDMETHODIMP CSocMft0::GetLatency(UINT32 *pAverage, UINT32 *pMax)
+{
+    if (!pAverage || !pMax)
+    {
+        return E_POINTER;
+    }
+    CAutoLock lock(&m_critSec);
+    *pAverage = static_cast<UINT32>(m_hnsLatencyAverage / 10);
+    *pMax = static_cast<UINT32>(m_hnsLatencyMax / 10);
+    return S_OK;
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 //
 // This initializes the CSocMFT0 for Com
@@ -841,9 +893,9 @@ STDMETHODIMP CSocMft0::GetInputStatus(
         return E_POINTER;
     }
 
-    // If we already have an input sample, we don't accept
-    // another one until the client calls ProcessOutput or Flush.
-    if (m_spSample == NULL)
+    // If the queue is full, we don't accept another sample
+    // until the client calls ProcessOutput or Flush.
+    if (!IsQueueFull())
     {
         *pdwFlags = MFT_INPUT_STATUS_ACCEPT_DATA;
     }
@@ -873,7 +925,7 @@ STDMETHODIMP CSocMft0::GetOutputStatus(
 
     // We can produce an output sample if (and only if)
     // we have an input sample.
-    if (m_spSample != NULL)
+    if (HasPendingOutput())
     {
         *pdwFlags = MFT_OUTPUT_STATUS_SAMPLE_READY;
     }
@@ -945,7 +997,7 @@ STDMETHODIMP CSocMft0::ProcessMessage(
 /////////////////////////////////////////////////////////////////////
 //
 // ProcessInput
-// Process an input sample. The sample is cached and real work is done
+// Process an input sample. The sample is queued and real work is done
 // in ProcessOutput
 //
 STDMETHODIMP CSocMft0::ProcessInput(
@@ -973,9 +1025,9 @@ STDMETHODIMP CSocMft0::ProcessInput(
         return MF_E_NOTACCEPTING;   // Client must set input and output types.
     }
 
-    if (m_spSample != NULL)
+    if (IsQueueFull())
     {
-        return MF_E_NOTACCEPTING;   // We already have an input sample.
+        return MF_E_NOTACCEPTING;   // We already have m_uiQueueDepth input samples.
     }
 
     // Validate the number of buffers. There should only be a single buffer to hold the video frame.
@@ -996,8 +1048,9 @@ STDMETHODIMP CSocMft0::ProcessInput(
         return MF_E_SAMPLE_HAS_TOO_MANY_BUFFERS;
     }
 
-    // Cache the sample. We do the actual work in ProcessOutput.
-    m_spSample = pSample;
+    // Queue the sample. We do the actual work in ProcessOutput.
+    QueuedSample queued = { pSample, MFGetSystemTime() };
+    m_sampleQueue.push_back(std::move(queued));
 
     return S_OK;
 }
@@ -1042,30 +1095,49 @@ STDMETHODIMP CSocMft0::ProcessOutput(
 
     // If we don't have an input sample, we need some input before
     // we can generate any output.
-    if (m_spSample == nullptr)
+    if (!HasPendingOutput())
     {
         return MF_E_TRANSFORM_NEED_MORE_INPUT;
     }
+
+    // The front stays in the queue if CreateOutputSample fails
+    ComPtr<IMFSample> spSample = m_sampleQueue.front().spSample;
+    const LONGLONG hnsQueued = m_sampleQueue.front().hnsQueued;
 #if (NTDDI_VERSION >= NTDDI_WINBLUE)
-    hr = ProcessMetadata();
+    // The metadata is processed here under m_critSec, one sample at a time.
+    // So SOCMFT0_DEFAULT_QUEUE_DEPTH is 1. A deeper queue only absorbs the jitter
+    hr = ProcessMetadata(spSample.Get());
     if (FAILED(hr))
     {
         //Log the failure
         hr = S_OK;
     }
 #endif // (NTDDI_VERSION >= NTDDI_WINBLUE)
-    hr = CreateOutputSample(&pOutputSamples[0].pSample);
+    hr = CreateOutputSample(spSample.Get(), &pOutputSamples[0].pSample);
     if (FAILED(hr))
     {
         return hr;
     }
-    pOutputSamples[0].dwStatus = 0;
-    *pdwStatus = 0;
+#if (NTDDI_VERSION >= NTDDI_WINBLUE)
+    // The photo confirmation. Only for the photo pins, so the capture pin doesn't pay for it
+    if (m_stStreamType == PINNAME_IMAGE || m_stStreamType == PINNAME_VIDEO_STILL)
+    {
+        if (FAILED(AttachThumbnail(pOutputSamples[0].pSample)))
+        {
+            //Log the failure. The photo is delivered without the thumbnail
+        }
+    }
+#endif // (NTDDI_VERSION >= NTDDI_WINBLUE)
 
     // if createOutputSample actually make a copy of the sample,
     // (for example, JPEG encoding case), we need to copy the
-    // attribute from m_spSample to spOutputIMFSample
-    m_spSample.Reset();
+    // attribute from the input sample to spOutputIMFSample
+    m_sampleQueue.pop_front();
+    UpdateLatency(MFGetSystemTime() - hnsQueued);
+
+    // Tell the client to call ProcessOutput again without more input
+    pOutputSamples[0].dwStatus = HasPendingOutput() ? MFT_OUTPUT_DATA_BUFFER_INCOMPLETE : 0;
+    *pdwStatus = 0;
     return hr;
 }
 
@@ -1077,6 +1149,7 @@ STDMETHODIMP CSocMft0::ProcessOutput(
 HRESULT
 CSocMft0::
 CreateOutputSample(
+    _In_ IMFSample *pInputSample,
     _Outptr_result_maybenull_
     IMFSample **ppSample
 )
@@ -1084,24 +1157,54 @@ CreateOutputSample(
     HRESULT hr = S_OK;
 
     //Do nothing for now
-    if (!ppSample)
+    if (!pInputSample || !ppSample)
     {
         return E_POINTER;
     }
 
-    m_spSample.CopyTo(ppSample);
+    *ppSample = pInputSample;
+    (*ppSample)->AddRef();
 
     return hr;
 }
+
+/////////////////////////////////////////////////////////////////////
+//
+// Update the latency of the queue for GetLatency.
+// The average is moving with 1/8 weight of the new sample
+//
+void CSocMft0::UpdateLatency(
+    _In_ LONGLONG hnsLatency
+)
+{
+    if (hnsLatency < 0)
+    {
+        hnsLatency = 0;
+    }
+    if (m_hnsLatencyAverage == 0)
+    {
+        m_hnsLatencyAverage = hnsLatency;
+    }
+    else
+    {
+        m_hnsLatencyAverage += (hnsLatency - m_hnsLatencyAverage) / 8;
+    }
+    if (hnsLatency > m_hnsLatencyMax)
+    {
+        m_hnsLatencyMax = hnsLatency;
+    }
+}
 /////////////////////////////////////////////////////////////////////
 //
 // Flush the MFT.
 //
 STDMETHODIMP CSocMft0::OnFlush()
 {
-    // For this MFT, flushing just means releasing the input sample.
+    // For this MFT, flushing just means releasing the input samples.
     CAutoLock lock(&m_critSec);
-    m_spSample.Reset();
+    m_sampleQueue.clear();
+    m_hnsLatencyAverage = 0;
+    m_hnsLatencyMax = 0;
     return S_OK;
 }
 
@@ -1410,10 +1513,12 @@ HRESULT CSocMft0::GetPreviewMediaType(
 //
 // Handle the Metadata with the buffer
 //
-HRESULT CSocMft0::ProcessMetadata()
+HRESULT CSocMft0::ProcessMetadata(
+    _In_ IMFSample *pSample
+)
 {
     ComPtr<IMFAttributes>  spMetadata;
-    HRESULT hr = m_spSample->GetUnknown(MFSampleExtension_CaptureMetadata, IID_PPV_ARGS(spMetadata.ReleaseAndGetAddressOf()));
+    HRESULT hr = pSample->GetUnknown(MFSampleExtension_CaptureMetadata, IID_PPV_ARGS(spMetadata.ReleaseAndGetAddressOf()));
     if (FAILED(hr))
     {
         return hr;
@@ -1441,579 +1546,142 @@ HRESULT CSocMft0::ProcessMetadata()
         return hr;
     }
 
-    LONG lBufferLeft = static_cast<LONG>(dwLength);
-    if (lBufferLeft < sizeof(KSCAMERA_METADATA_ITEMHEADER))
-    {
-        return E_UNEXPECTED;
-    }
-
-    PKSCAMERA_METADATA_ITEMHEADER pItem = (PKSCAMERA_METADATA_ITEMHEADER)pData;
-
-    while (lBufferLeft > 0)
-    {
-        switch (pItem->MetadataId)
-        {
-        case MetadataId_Custom_PreviewAggregation:
-            hr = ParseMetadata_PreviewAggregation(pItem, spMetadata.Get());
-            if (FAILED(hr))
-            {
-                return hr;
-            }
-            break;
-        case MetadataId_Custom_ImageAggregation:
-            hr = ParseMetadata_ImageAggregation(pItem, spMetadata.Get());
-            if (FAILED(hr))
-            {
-                return hr;
-            }
-            break;
-        case MetadataId_Custom_Histogram:
-            hr = ParseMetadata_Histogram(pItem, spMetadata.Get());
-            if (FAILED(hr))
-            {
-                return hr;
-            }
-            break;
-        case MetadataId_Custom_FaceDetection:
-            hr = ParseMetadata_FaceDetection(pItem, spMetadata.Get());
-            if (FAILED(hr))
-            {
-                return hr;
-            }
-        }
-
-        if (!pItem->Size)
-        {
-            // 0 size item will cause the loop to break and
-            // we will report buffer malformated
-            break;
-        }
-        lBufferLeft -= (LONG)pItem->Size;
-        if (lBufferLeft < sizeof(KSCAMERA_METADATA_ITEMHEADER))
-        {
-            break;
-        }
-        pItem = reinterpret_cast<PKSCAMERA_METADATA_ITEMHEADER>
-            (reinterpret_cast<PBYTE>(pItem) + pItem->Size);
-    }
-
-    if (lBufferLeft != 0)
-    {
-        //Check and log for malformated data
-        return E_UNEXPECTED;
-    }
-
-    return S_OK;
+    // The raw stream is kept as it is. The items are translated into the MF_CAPTURE_METADATA_* attributes
+    // E_UNEXPECTED for the malformed data
+    return translate_capture_metadata(metadata_view_t{pData, dwLength}, spMetadata.Get());
 }
 
-HRESULT CSocMft0::ParseMetadata_PreviewAggregation(
-    _In_ PKSCAMERA_METADATA_ITEMHEADER pItem,
-    _In_ IMFAttributes *pMetaDataAttributes
+/////////////////////////////////////////////////////////////////////
+//
+// Attach the photo confirmation to the sample of the photo pin.
+// The frame is decimated by m_uThumbnailScaleFactor into m_stThumbnailFormat
+// with make_thumbnail, and set as MFSampleExtension_PhotoThumbnail
+//
+HRESULT CSocMft0::AttachThumbnail(
+    _In_ IMFSample *pSample
 )
 {
-    HRESULT hr = S_OK;
-    if (pItem->Size < sizeof(CAMERA_METADATA_PREVIEWAGGREGATION))
-    {
-        return E_UNEXPECTED;
-    }
-
-    PCAMERA_METADATA_PREVIEWAGGREGATION pFixedStruct =
-        (PCAMERA_METADATA_PREVIEWAGGREGATION)pItem;
-
-    if (pFixedStruct->Data.FocusState.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_FOCUSSTATE,
-            pFixedStruct->Data.FocusState.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-    }
-
-    if (pFixedStruct->Data.ExposureTime.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT64(
-            MF_CAPTURE_METADATA_EXPOSURE_TIME,
-            pFixedStruct->Data.ExposureTime.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-    }
-
-    if (pFixedStruct->Data.ISOSpeed.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_ISO_SPEED,
-            pFixedStruct->Data.ISOSpeed.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-    }
-
-    if (pFixedStruct->Data.LensPosition.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_LENS_POSITION,
-            pFixedStruct->Data.LensPosition.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-    }
-
-    if (pFixedStruct->Data.FlashOn.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_FLASH,
-            pFixedStruct->Data.FlashOn.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-    }
-
-    if (pFixedStruct->Data.WhiteBalanceMode.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_WHITEBALANCE,
-            pFixedStruct->Data.WhiteBalanceMode.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-    }
-
-    if (pFixedStruct->Data.EVCompensation.Set)
-    {
-        CapturedMetadataExposureCompensation EVCompensation;
-
-        EVCompensation.Flags = pFixedStruct->Data.EVCompensation.Flags;
-        EVCompensation.Value = pFixedStruct->Data.EVCompensation.Value;
-
-        hr = pMetaDataAttributes->SetBlob(
-            MF_CAPTURE_METADATA_EXPOSURE_COMPENSATION,
-            (const UINT8 *)&EVCompensation,
-            sizeof(EVCompensation));
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-    }
-
-    if (pFixedStruct->Data.SensorFrameRate.Set)
+    if (!pSample)
     {
-        hr = pMetaDataAttributes->SetUINT64(
-            MF_CAPTURE_METADATA_SENSORFRAMERATE,
-            pFixedStruct->Data.SensorFrameRate.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        return E_POINTER;
     }
-
-    if (pFixedStruct->Data.IsoAnalogGain.Set ||
-        pFixedStruct->Data.IsoDigitalGain.Set)
+    if (!m_spInputType)
     {
-        CapturedMetadataISOGains IsoGains;
-
-        if (pFixedStruct->Data.IsoAnalogGain.Set)
-        {
-            IsoGains.AnalogGain =
-                FLOAT(pFixedStruct->Data.IsoAnalogGain.Numerator) /
-                FLOAT(pFixedStruct->Data.IsoAnalogGain.Denominator);
-        }
-        if (pFixedStruct->Data.IsoDigitalGain.Set)
-        {
-            IsoGains.DigitalGain =
-                FLOAT(pFixedStruct->Data.IsoDigitalGain.Numerator) /
-                FLOAT(pFixedStruct->Data.IsoDigitalGain.Denominator);
-        }
-
-        hr = pMetaDataAttributes->SetBlob(
-            MF_CAPTURE_METADATA_ISO_GAINS,
-            (const UINT8 *)&IsoGains,
-            sizeof(IsoGains));
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        return MF_E_TRANSFORM_TYPE_NOT_SET;
     }
-
-    if (pFixedStruct->Data.WhiteBalanceGain_R.Set ||
-        pFixedStruct->Data.WhiteBalanceGain_G.Set ||
-        pFixedStruct->Data.WhiteBalanceGain_B.Set)
+    if (!IsEqualGUID(m_stThumbnailFormat, MFVideoFormat_ARGB32) &&
+        !IsEqualGUID(m_stThumbnailFormat, MFVideoFormat_RGB32))
     {
-        CapturedMetadataWhiteBalanceGains WhiteBalanceGains;
-
-        if (pFixedStruct->Data.WhiteBalanceGain_R.Set)
-        {
-            WhiteBalanceGains.R =
-                FLOAT(pFixedStruct->Data.WhiteBalanceGain_R.Numerator) /
-                FLOAT(pFixedStruct->Data.WhiteBalanceGain_R.Denominator);
-        }
-        if (pFixedStruct->Data.WhiteBalanceGain_G.Set)
-        {
-            WhiteBalanceGains.G =
-                FLOAT(pFixedStruct->Data.WhiteBalanceGain_G.Numerator) /
-                FLOAT(pFixedStruct->Data.WhiteBalanceGain_G.Denominator);
-        }
-        if (pFixedStruct->Data.WhiteBalanceGain_B.Set)
-        {
-            WhiteBalanceGains.B =
-                FLOAT(pFixedStruct->Data.WhiteBalanceGain_B.Numerator) /
-                FLOAT(pFixedStruct->Data.WhiteBalanceGain_B.Denominator);
-        }
-
-        hr = pMetaDataAttributes->SetBlob(
-            MF_CAPTURE_METADATA_WHITEBALANCE_GAINS,
-            (const UINT8 *)&WhiteBalanceGains,
-            sizeof(WhiteBalanceGains));
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        return MF_E_INVALIDMEDIATYPE;   // make_thumbnail writes BGRA only
     }
 
-    return S_OK;
-}
-
-HRESULT CSocMft0::ParseMetadata_ImageAggregation(
-    _In_ PKSCAMERA_METADATA_ITEMHEADER pItem,
-    _In_ IMFAttributes *pMetaDataAttributes
-)
-{
-    HRESULT hr = S_OK;
-    if (pItem->Size < sizeof(CAMERA_METADATA_IMAGEAGGREGATION))
+    GUID guidSubType = GUID_NULL;
+    HRESULT hr = m_spInputType->GetGUID(MF_MT_SUBTYPE, &guidSubType);
+    if (FAILED(hr))
     {
-        return E_UNEXPECTED;
+        return hr;
     }
-
-    PCAMERA_METADATA_IMAGEAGGREGATION pFixedStruct =
-        (PCAMERA_METADATA_IMAGEAGGREGATION)pItem;
-
-    if (pFixedStruct->Data.FrameId.Set)
+    const pixel_format_t format = get_pixel_format(static_cast<uint32_t>(guidSubType.Data1));
+    if (!is_thumbnail_source(format) || !is_thumbnail_factor(m_uThumbnailScaleFactor))
     {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_REQUESTED_FRAME_SETTING_ID,
-            pFixedStruct->Data.FrameId.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        return MF_E_INVALIDMEDIATYPE;
     }
-
-    if (pFixedStruct->Data.ExposureTime.Set)
+    UINT32 uiWidth = 0, uiHeight = 0;
+    hr = MFGetAttributeSize(m_spInputType.Get(), MF_MT_FRAME_SIZE, &uiWidth, &uiHeight);
+    if (FAILED(hr))
     {
-        hr = pMetaDataAttributes->SetUINT64(
-            MF_CAPTURE_METADATA_EXPOSURE_TIME,
-            pFixedStruct->Data.ExposureTime.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        return hr;
     }
-
-    if (pFixedStruct->Data.ISOSpeed.Set)
+    const UINT32 uiThumbnailWidth = uiWidth / m_uThumbnailScaleFactor;
+    const UINT32 uiThumbnailHeight = uiHeight / m_uThumbnailScaleFactor;
+    if (uiThumbnailWidth == 0 || uiThumbnailHeight == 0)
     {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_ISO_SPEED,
-            pFixedStruct->Data.ISOSpeed.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        return MF_E_INVALIDMEDIATYPE;
     }
 
-    if (pFixedStruct->Data.LensPosition.Set)
+    yuv_color_t color{};
+    if (MFGetAttributeUINT32(m_spInputType.Get(), MF_MT_YUV_MATRIX, MFVideoTransferMatrix_BT601) == MFVideoTransferMatrix_BT709)
     {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_LENS_POSITION,
-            pFixedStruct->Data.LensPosition.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        color.matrix = yuv_matrix_t::bt709;
     }
-
-    if (pFixedStruct->Data.SceneMode.Set)
+    if (MFGetAttributeUINT32(m_spInputType.Get(), MF_MT_VIDEO_NOMINAL_RANGE, MFNominalRange_16_235) == MFNominalRange_0_255)
     {
-        hr = pMetaDataAttributes->SetUINT64(
-            MF_CAPTURE_METADATA_SCENE_MODE,
-            pFixedStruct->Data.SceneMode.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        color.range = yuv_range_t::full;
     }
 
-    if (pFixedStruct->Data.FlashOn.Set)
+    ComPtr<IMFMediaBuffer> spThumbnail;
+    hr = MFCreate2DMediaBuffer(uiThumbnailWidth, uiThumbnailHeight, m_stThumbnailFormat.Data1, FALSE, spThumbnail.ReleaseAndGetAddressOf());
+    if (FAILED(hr))
     {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_FLASH,
-            pFixedStruct->Data.FlashOn.Value);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        return hr;
     }
-
-    if (pFixedStruct->Data.FlashPower.Set)
     {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_FLASH_POWER,
-            pFixedStruct->Data.FlashPower.Value);
+        ComPtr<IMFMediaBuffer> spBuffer;
+        hr = pSample->GetBufferByIndex(0, spBuffer.ReleaseAndGetAddressOf());
         if (FAILED(hr))
         {
             return hr;
         }
-    }
-
-    if (pFixedStruct->Data.WhiteBalanceMode.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_WHITEBALANCE,
-            pFixedStruct->Data.WhiteBalanceMode.Value);
+        Buffer2DLock srcLock(spBuffer.Get());
+        BYTE *pSrc = NULL;
+        LONG lSrcPitch = 0;
+        hr = srcLock.LockBuffer(&pSrc, &lSrcPitch, static_cast<LONG>(get_row_bytes(get_pixel_traits(format), uiWidth)));
         if (FAILED(hr))
         {
             return hr;
         }
-    }
-
-    if (pFixedStruct->Data.ZoomFactor.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_ZOOMFACTOR,
-            pFixedStruct->Data.ZoomFactor.Value);
+        Buffer2DLock dstLock(spThumbnail.Get());
+        BYTE *pDst = NULL;
+        LONG lDstPitch = 0;
+        hr = dstLock.LockBuffer(&pDst, &lDstPitch, static_cast<LONG>(uiThumbnailWidth * 4));
         if (FAILED(hr))
         {
             return hr;
         }
-    }
-
-    if (pFixedStruct->Data.EVCompensation.Set)
-    {
-        CapturedMetadataExposureCompensation EVCompensation;
-
-        EVCompensation.Flags = pFixedStruct->Data.EVCompensation.Flags;
-        EVCompensation.Value = pFixedStruct->Data.EVCompensation.Value;
-
-        hr = pMetaDataAttributes->SetBlob(
-            MF_CAPTURE_METADATA_EXPOSURE_COMPENSATION,
-            (const UINT8 *)&EVCompensation,
-            sizeof(EVCompensation));
-        if (FAILED(hr))
+        if (lSrcPitch < 0 || lDstPitch < 0)
         {
-            return hr;
+            return MF_E_INVALIDMEDIATYPE;   // bottom-up rows
         }
-    }
-
-    if (pFixedStruct->Data.FocusState.Set)
-    {
-        hr = pMetaDataAttributes->SetUINT32(
-            MF_CAPTURE_METADATA_FOCUSSTATE,
-            pFixedStruct->Data.FocusState.Value);
-        if (FAILED(hr))
+        const frame_view_t src = make_frame_view(format, uiWidth, uiHeight, pSrc, static_cast<size_t>(lSrcPitch));
+        const frame_view_t dst = make_frame_view(pixel_format_t::rgb32, uiThumbnailWidth, uiThumbnailHeight, pDst, static_cast<size_t>(lDstPitch));
+        if (!make_thumbnail(src, dst, m_uThumbnailScaleFactor, color))
         {
-            return hr;
+            return E_FAIL;
         }
     }
-    return S_OK;
-}
-#endif // (NTDDI_VERSION >= NTDDI_WINBLUE)
-struct HistogramData
-{
-    HistogramDataHeader     Header;
-    ULONG                   Color[256];
-
-    HistogramData()
-    {
-        Header.Size = sizeof(*this);
-        Header.ChannelMask = 0;
-        Header.Linear = 1;
-        RtlZeroMemory(Color, sizeof(Color));
-    }
-};
-
-//  This is the blob we pass back every time.
-template <ULONG I>
-struct Histogram
-{
-    HistogramBlobHeader     Blob;
-    //  RGB or YUV Histograms.
-    HistogramHeader         Header;
-    HistogramData           Data[I];
-
-    Histogram(
-        _In_    ULONG   Width = 0,
-        _In_    ULONG   Height = 0
-    )
-    {
-        Blob.Histograms = 1;
-        Blob.Size = sizeof(*this);
-
-        Header.Size = sizeof(Header) + sizeof(Data);
-        Header.Bins = 256;
-        Header.Grid.Height = Height;
-        Header.Grid.Width = Width;
-        Header.Grid.Region.top = 0;
-        Header.Grid.Region.left = 0;
-        Header.Grid.Region.bottom = Height - 1;
-        Header.Grid.Region.right = Width - 1;
-    }
-};
-
-#if (NTDDI_VERSION >= NTDDI_WINBLUE)
-#define MF_HISTOGRAM_RGB    (MF_HISTOGRAM_CHANNEL_R | MF_HISTOGRAM_CHANNEL_G  | MF_HISTOGRAM_CHANNEL_B )
-#define MF_HISTOGRAM_YCrCb  (MF_HISTOGRAM_CHANNEL_Y | MF_HISTOGRAM_CHANNEL_Cr | MF_HISTOGRAM_CHANNEL_Cb)
-
-HRESULT CSocMft0::ParseMetadata_Histogram(
-    _In_ PKSCAMERA_METADATA_ITEMHEADER pItem,
-    _In_ IMFAttributes *pMetaDataAttributes
-)
-{
-    if (pItem->Size < sizeof(CAMERA_METADATA_HISTOGRAM))
-    {
-        return E_UNEXPECTED;
-    }
-
-    PCAMERA_METADATA_HISTOGRAM pHistogram = (PCAMERA_METADATA_HISTOGRAM)pItem;
-
-    if ((pHistogram->Data.ChannelMask & MF_HISTOGRAM_RGB) == MF_HISTOGRAM_RGB)
-    {
-        Histogram<4>    Blob(pHistogram->Data.Width, pHistogram->Data.Height);
-
-        Blob.Header.FourCC = pHistogram->Data.FourCC;
-        Blob.Header.ChannelMasks = pHistogram->Data.ChannelMask;
-
-        //  For a RGB Histogram, we fake the Y channel by copying the G channel.
-        Blob.Data[0].Header.ChannelMask = MF_HISTOGRAM_CHANNEL_Y;
-        RtlCopyMemory(Blob.Data[0].Color, pHistogram->Data.P1Data, sizeof(Blob.Data[0].Color));
-
-        //  Now just copy the RGB channels normally.
-        Blob.Data[1].Header.ChannelMask = MF_HISTOGRAM_CHANNEL_R;
-        RtlCopyMemory(Blob.Data[1].Color, pHistogram->Data.P0Data, sizeof(Blob.Data[1].Color));
-        Blob.Data[2].Header.ChannelMask = MF_HISTOGRAM_CHANNEL_G;
-        RtlCopyMemory(Blob.Data[2].Color, pHistogram->Data.P1Data, sizeof(Blob.Data[2].Color));
-        Blob.Data[3].Header.ChannelMask = MF_HISTOGRAM_CHANNEL_B;
-        RtlCopyMemory(Blob.Data[3].Color, pHistogram->Data.P2Data, sizeof(Blob.Data[3].Color));
-
-        return pMetaDataAttributes->SetBlob(
-            MF_CAPTURE_METADATA_HISTOGRAM,
-            (PBYTE)&Blob,
-            sizeof(Blob)
-        );
-    }
-    else if ((pHistogram->Data.ChannelMask & MF_HISTOGRAM_YCrCb) == MF_HISTOGRAM_YCrCb)
-    {
-        Histogram<3>    Blob(pHistogram->Data.Width, pHistogram->Data.Height);
-
-        Blob.Header.FourCC = pHistogram->Data.FourCC;
-        Blob.Header.ChannelMasks = pHistogram->Data.ChannelMask;
-
-        Blob.Data[0].Header.ChannelMask = MF_HISTOGRAM_CHANNEL_Y;
-        RtlCopyMemory(Blob.Data[0].Color, pHistogram->Data.P0Data, sizeof(Blob.Data[0].Color));
-        Blob.Data[1].Header.ChannelMask = MF_HISTOGRAM_CHANNEL_Cr;
-        RtlCopyMemory(Blob.Data[1].Color, pHistogram->Data.P1Data, sizeof(Blob.Data[1].Color));
-        Blob.Data[2].Header.ChannelMask = MF_HISTOGRAM_CHANNEL_Cb;
-        RtlCopyMemory(Blob.Data[2].Color, pHistogram->Data.P2Data, sizeof(Blob.Data[2].Color));
-
-        //TODO:
-        return pMetaDataAttributes->SetBlob(
-            MF_CAPTURE_METADATA_HISTOGRAM,
-            (PBYTE)&Blob,
-            sizeof(Blob)
-        );
-    }
-    return E_UNEXPECTED;
-}
-
-HRESULT CSocMft0::ParseMetadata_FaceDetection(
-    _In_ PKSCAMERA_METADATA_ITEMHEADER pItem,
-    _In_ IMFAttributes *pMetaDataAttributes
-)
-{
-    HRESULT hr = S_OK;
-
-    if (pItem->Size < sizeof(CAMERA_METADATA_FACEHEADER))
+    hr = spThumbnail->SetCurrentLength(uiThumbnailWidth * uiThumbnailHeight * 4);
+    if (FAILED(hr))
     {
-        return E_UNEXPECTED;
+        return hr;
     }
 
-    PCAMERA_METADATA_FACEHEADER pFaceHeader = (PCAMERA_METADATA_FACEHEADER)pItem;
-
-    if (pItem->Size < (sizeof(CAMERA_METADATA_FACEHEADER) + (sizeof(METADATA_FACEDATA) * pFaceHeader->Count)))
-    {
-        return E_UNEXPECTED;
-    }
-    PMETADATA_FACEDATA  pFaceData = (PMETADATA_FACEDATA)(pFaceHeader + 1);
-    UINT32 cbRectSize = sizeof(FaceRectInfoBlobHeader) + (sizeof(FaceRectInfo) * (pFaceHeader->Count));
-    BYTE *pRectBuf = new (std::nothrow) BYTE[cbRectSize];
-    if (pRectBuf == NULL)
+    ComPtr<IMFMediaType> spThumbnailType;
+    hr = MFCreateMediaType(spThumbnailType.ReleaseAndGetAddressOf());
+    if (FAILED(hr))
     {
-        return E_OUTOFMEMORY;
+        return hr;
     }
-
-    UINT32 cbCharSize = sizeof(FaceCharacterizationBlobHeader) + (sizeof(FaceCharacterization) * (pFaceHeader->Count));
-    BYTE *pCharBuf = new (std::nothrow) BYTE[cbCharSize];
-    if (pCharBuf == NULL)
+    hr = spThumbnailType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+    if (SUCCEEDED(hr))
     {
-        delete[] pRectBuf;
-        return E_OUTOFMEMORY;
+        hr = spThumbnailType->SetGUID(MF_MT_SUBTYPE, m_stThumbnailFormat);
     }
-
-    FaceRectInfoBlobHeader *pFaceRectHeader = (FaceRectInfoBlobHeader *)pRectBuf;
-    pFaceRectHeader->Size = cbRectSize;
-    pFaceRectHeader->Count = pFaceHeader->Count;
-
-    FaceCharacterizationBlobHeader *pFaceCharHeader = (FaceCharacterizationBlobHeader *)pCharBuf;
-    pFaceCharHeader->Size = cbCharSize;
-    pFaceCharHeader->Count = pFaceHeader->Count;
-
-    FaceRectInfo           *FaceRegions = (FaceRectInfo *)(pFaceRectHeader + 1);
-    FaceCharacterization   *FaceChars = (FaceCharacterization *)(pFaceCharHeader + 1);
-
-    for (UINT i = 0; i < pFaceHeader->Count; i++)
+    if (SUCCEEDED(hr))
     {
-        FaceRegions[i].Region = pFaceData[i].Region;
-        FaceRegions[i].confidenceLevel = pFaceData[i].confidenceLevel;
-
-        FaceChars[i].BlinkScoreLeft = pFaceData[i].BlinkScoreLeft;
-        FaceChars[i].BlinkScoreRight = pFaceData[i].BlinkScoreRight;
-        FaceChars[i].FacialExpression = (pFaceData[i].FacialExpression == EXPRESSION_SMILE) ? MF_METADATAFACIALEXPRESSION_SMILE : 0;
-        FaceChars[i].FacialExpressionScore = pFaceData[i].FacialExpressionScore;
+        hr = MFSetAttributeSize(spThumbnailType.Get(), MF_MT_FRAME_SIZE, uiThumbnailWidth, uiThumbnailHeight);
     }
-
-    hr = pMetaDataAttributes->SetBlob(MF_CAPTURE_METADATA_FACEROIS, pRectBuf, cbRectSize);
-    if (FAILED(hr))
+    if (SUCCEEDED(hr))
     {
-        goto done;
+        hr = spThumbnailType->SetUINT32(MF_MT_DEFAULT_STRIDE, uiThumbnailWidth * 4);
     }
-
-    MetadataTimeStamps timestamp;
-    timestamp.Flags = MF_METADATATIMESTAMPS_DEVICE;
-    timestamp.Device = pFaceHeader->Timestamp;
-
-    hr = pMetaDataAttributes->SetBlob(MF_CAPTURE_METADATA_FACEROITIMESTAMPS, (const UINT8 *)&timestamp, sizeof(MetadataTimeStamps));
-    if (FAILED(hr))
+    if (SUCCEEDED(hr))
     {
-        goto done;
+        hr = pSample->SetUnknown(MFSampleExtension_PhotoThumbnailMediaType, spThumbnailType.Get());
     }
-
-#if (NTDDI_VERSION >= NTDDI_WINTHRESHOLD)
-    //  Include characterization data if any of the associated bits were set.
-    if (pFaceHeader->Flags & KSCAMERA_EXTENDEDPROP_FACEDETECTION_ADVANCED_MASK)
+    if (SUCCEEDED(hr))
     {
-        hr = pMetaDataAttributes->SetBlob(MF_CAPTURE_METADATA_FACEROICHARACTERIZATIONS, pCharBuf, cbCharSize);
+        hr = pSample->SetUnknown(MFSampleExtension_PhotoThumbnail, spThumbnail.Get());
     }
-#endif // (NTDDI_VERSION >= NTDDI_WINTHRESHOLD)
-
-done:
-    delete[] pRectBuf;
-    delete[] pCharBuf;
-
     return hr;
 }
 #endif // (NTDDI_VERSION >= NTDDI_WINBLUE)
@@ -38,6 +38,7 @@ using namespace Microsoft::WRL;
 class CSocMft0:
     public Microsoft::WRL::RuntimeClass<Microsoft::WRL::RuntimeClassFlags<Microsoft::WRL::WinRtClassicComMix>,
     ISocMft0,
+    ISocMft1,
     IMFTransform,
     IInspectable>
 {
@@ -51,6 +52,9 @@ public:
         m_bEnableVideoStabilization(FALSE),
         m_uiSourceStreamId(0),
         m_uiInternalState(0),
+        m_uiQueueDepth(SOCMFT0_DEFAULT_QUEUE_DEPTH),
+        m_hnsLatencyAverage(0),
+        m_hnsLatencyMax(0),
         m_uThumbnailScaleFactor(4)
     {
         InitializeCriticalSection(&m_critSec);
@@ -67,6 +71,12 @@ public:
     STDMETHOD(SetState)(UINT32 state);
     STDMETHOD(GetState)(UINT32 *pState);
 
+    /*ISocMft1*/
+    STDMETHOD(SetQueueDepth)(UINT32 depth);
+    STDMETHOD(GetQueueDepth)(UINT32 *pDepth);
+    STDMETHOD(GetQueueCount)(UINT32 *pCount);
+    STDMETHOD(GetLatency)(UINT32 *pAverage, UINT32 *pMax);
+
     /*IInspectable*/
     STDMETHOD(GetIids)(
         _Out_ ULONG *iidCount,
@@ -236,37 +246,35 @@ protected:
     // HasPendingOutput: Returns TRUE if the MFT is holding an input sample.
     BOOL HasPendingOutput() const
     {
-        return m_spSample != NULL;
+        return !m_sampleQueue.empty();
+    }
+
+    // IsQueueFull: Returns TRUE if ProcessInput must reject the sample.
+    // The depth can be lowered below the count. Then the queue drains first
+    BOOL IsQueueFull() const
+    {
+        return m_sampleQueue.size() >= m_uiQueueDepth;
     }
 
     HRESULT CreateOutputSample(
+        _In_ IMFSample *pInputSample,
         _Outptr_result_maybenull_ IMFSample **ppSample
     );
 
+    void UpdateLatency(
+        _In_ LONGLONG hnsLatency
+    );
+
     HRESULT GetPreviewMediaType(
         _Outptr_result_maybenull_ IMFMediaType **ppType
     );
 #if (NTDDI_VERSION >= NTDDI_WINBLUE)
-    HRESULT ProcessMetadata();
-
-    HRESULT ParseMetadata_PreviewAggregation(
-        _In_ PKSCAMERA_METADATA_ITEMHEADER pItem,
-        _In_ IMFAttributes *pMetaDataAttributes
+    HRESULT ProcessMetadata(
+        _In_ IMFSample *pSample
     );
 
-    HRESULT ParseMetadata_ImageAggregation(
-        _In_ PKSCAMERA_METADATA_ITEMHEADER pItem,
-        _In_ IMFAttributes *pMetaDataAttributes
-    );
-
-    HRESULT ParseMetadata_Histogram(
-        _In_ PKSCAMERA_METADATA_ITEMHEADER pItem,
-        _In_ IMFAttributes *pMetaDataAttributes
-    );
-
-    HRESULT ParseMetadata_FaceDetection(
-        _In_ PKSCAMERA_METADATA_ITEMHEADER pItem,
-        _In_ IMFAttributes *pMetaDataAttributes
+    HRESULT AttachThumbnail(
+        _In_ IMFSample *pSample
     );
 #endif // (NTDDI_VERSION >= NTDDI_WINBLUE)
     HRESULT FillBufferLengthFromMediaType(
@@ -287,7 +295,14 @@ protected:
 
     CRITICAL_SECTION            m_critSec;
 
-    ComPtr<IMFSample>          m_spSample;                 // Input sample.
+    // Input sample and the time of ProcessInput
+    struct QueuedSample
+    {
+        ComPtr<IMFSample>       spSample;
+        LONGLONG                hnsQueued;
+    };
+
+    std::deque<QueuedSample>   m_sampleQueue;              // Input samples. Bounded by m_uiQueueDepth
     ComPtr<IMFMediaType>       m_spInputType;              // Input media type.
     ComPtr<IMFMediaType>       m_spOutputType;             // Output media type.
 
@@ -300,6 +315,9 @@ protected:
     BOOL                        m_bEnableVideoStabilization;
     UINT                        m_uiSourceStreamId;
     UINT                        m_uiInternalState;
+    UINT32                      m_uiQueueDepth;             // 1 ~ SOCMFT0_MAX_QUEUE_DEPTH
+    LONGLONG                    m_hnsLatencyAverage;        // 100 ns. Moving average of ProcessInput to ProcessOutput
+    LONGLONG                    m_hnsLatencyMax;
     BYTE                        m_uThumbnailScaleFactor;
     GUID                        m_stThumbnailFormat;
 
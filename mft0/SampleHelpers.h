@@ -90,3 +90,59 @@ private:
   ComPtr<IMFMediaBuffer> m_spBuffer;
   bool m_bLocked;
 };
+
+/***************************************************************************\
+*****************************************************************************
+*
+* class Buffer2DLock
+*
+* Locks the buffer with IMF2DBuffer if possible, so the pitch of the device is
+* kept without the contiguous copy. Unlocks it when the object goes out of scope
+*
+*****************************************************************************
+\***************************************************************************/
+
+class Buffer2DLock {
+public:
+  Buffer2DLock(_In_ IMFMediaBuffer *pBuffer) : m_bLocked(false) {
+    m_spBuffer = pBuffer;
+  }
+
+  // *plPitch is the row bytes of the contiguous buffer if there is no IMF2DBuffer
+  HRESULT LockBuffer(_Outptr_ BYTE **ppbScanline0, _Out_ LONG *plPitch,
+                     LONG lContiguousPitch) {
+    if (!m_spBuffer) {
+      return E_INVALIDARG;
+    }
+
+    HRESULT hr = m_spBuffer.As(&m_sp2DBuffer);
+    if (SUCCEEDED(hr)) {
+      hr = m_sp2DBuffer->Lock2D(ppbScanline0, plPitch);
+    } else {
+      m_sp2DBuffer.Reset();
+      hr = m_spBuffer->Lock(ppbScanline0, NULL, NULL);
+      *plPitch = lContiguousPitch;
+    }
+    if (FAILED(hr)) {
+      return hr;
+    }
+    m_bLocked = true;
+    return S_OK;
+  }
+
+  ~Buffer2DLock() {
+    if (m_bLocked) {
+      // Unlock fails only if we did not lock it first
+      if (m_sp2DBuffer) {
+        (void)m_sp2DBuffer->Unlock2D();
+      } else {
+        (void)m_spBuffer->Unlock();
+      }
+    }
+  }
+
+private:
+  ComPtr<IMFMediaBuffer> m_spBuffer;
+  ComPtr<IMF2DBuffer> m_sp2DBuffer;
+  bool m_bLocked;
+};
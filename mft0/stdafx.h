@@ -34,6 +34,7 @@
 #include <mfapi.h>
 #include <mferror.h>
 #include <mfidl.h>
+#include <deque>
 #include <vector>
 
 #include <wil/resource.h>
@@ -0,0 +1,206 @@
+/**
+ * @file    async_reader.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Awaitable hand-off from the callback based sources
+ */
+#pragma once
+#include <coroutine.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+/**
+ * @brief Single consumer queue for the coroutine. `co_await pop()` suspends until `push` or `close`
+ * @note  The waiting coroutine is resumed in the thread which invoked `push`/`close`
+ */
+template <typename T>
+class async_channel_t final {
+    std::mutex mtx{};
+    std::deque<T> items{};
+    coroutine_handle<void> waiter{};
+    bool closed = false;
+
+  public:
+    class awaiter_t final {
+        async_channel_t& channel;
+
+      public:
+        explicit awaiter_t(async_channel_t& channel) noexcept : channel{channel} {
+        }
+        bool await_ready() noexcept {
+            std::lock_guard lck{channel.mtx};
+            return channel.closed || channel.items.empty() == false;
+        }
+        /// @return false if an item arrived after `await_ready`
+        bool await_suspend(coroutine_handle<void> handle) noexcept {
+            std::lock_guard lck{channel.mtx};
+            if (channel.closed || channel.items.empty() == false)
+                return false;
+            channel.waiter = handle;
+            return true;
+        }
+        /// @return `std::nullopt` if the channel is closed and empty
+        std::optional<T> await_resume() noexcept(false) {
+            std::lock_guard lck{channel.mtx};
+            if (channel.items.empty())
+                return std::nullopt;
+            std::optional<T> item{std::move(channel.items.front())};
+            channel.items.pop_front();
+            return item;
+        }
+    };
+
+  public:
+    async_channel_t() noexcept = default;
+    async_channel_t(const async_channel_t&) = delete;
+    async_channel_t(async_channel_t&&) = delete;
+    async_channel_t& operator=(const async_channel_t&) = delete;
+    async_channel_t& operator=(async_channel_t&&) = delete;
+
+    /// @return false if the channel is closed
+    bool push(T&& item) noexcept(false) {
+        coroutine_handle<void> handle{};
+        {
+            std::lock_guard lck{mtx};
+            if (closed)
+                return false;
+            items.emplace_back(std::move(item));
+            std::swap(handle, waiter);
+        }
+        if (handle)
+            handle.resume();
+        return true;
+    }
+
+    void close() noexcept {
+        coroutine_handle<void> handle{};
+        {
+            std::lock_guard lck{mtx};
+            closed = true;
+            std::swap(handle, waiter);
+        }
+        if (handle)
+            handle.resume();
+    }
+
+    awaiter_t pop() noexcept {
+        return awaiter_t{*this};
+    }
+};
+
+/**
+ * @brief Keeps `depth` read requests in flight for the callback based source(e.g. `IMFSourceReaderCallback`)
+ *
+ * @details `start` issues `depth` requests. Each item taken by `co_await next()` issues 1 more request,
+ *          so the device always has a pending request while the consumer works on the current item.
+ * @code
+ * async_reader_t<frame_t> reader{3};
+ * reader.start([&]() { return device.request(); }); // the device calls `reader.complete(frame)` later
+ * while (auto frame = co_await reader.next())
+ *     consume(*frame);
+ * @endcode
+ */
+template <typename T>
+class async_reader_t final {
+    async_channel_t<T> channel{};
+    std::mutex mtx{};
+    std::function<bool()> request{}; // empty after `close`
+    const size_t depth;
+    std::atomic_size_t in_flight{0};
+
+  public:
+    class awaiter_t final {
+        async_reader_t& reader;
+        typename async_channel_t<T>::awaiter_t awaiter;
+
+      public:
+        explicit awaiter_t(async_reader_t& reader) noexcept : reader{reader}, awaiter{reader.channel.pop()} {
+        }
+        bool await_ready() noexcept {
+            return awaiter.await_ready();
+        }
+        bool await_suspend(coroutine_handle<void> handle) noexcept {
+            return awaiter.await_suspend(handle);
+        }
+        /// @return `std::nullopt` for the end of the stream
+        std::optional<T> await_resume() noexcept(false) {
+            std::optional<T> item = awaiter.await_resume();
+            if (item.has_value())
+                reader.request_one(); // replace the consumed one
+            return item;
+        }
+    };
+
+  public:
+    /// @param depth number of the requests in flight. 0 is treated as 1
+    explicit async_reader_t(size_t depth = 3) noexcept : depth{depth ? depth : 1} {
+    }
+    async_reader_t(const async_reader_t&) = delete;
+    async_reader_t(async_reader_t&&) = delete;
+    async_reader_t& operator=(const async_reader_t&) = delete;
+    async_reader_t& operator=(async_reader_t&&) = delete;
+
+    /**
+     * @param fn issues 1 asynchronous read. false if it failed. it must not throw
+     * @note  `fn` is released with `close`
+     */
+    void start(std::function<bool()> fn) noexcept(false) {
+        {
+            std::lock_guard lck{mtx};
+            request = std::move(fn);
+        }
+        for (size_t i = 0; i < depth; ++i)
+            request_one();
+    }
+
+    /// @brief 1 request is completed with the `item`. for the callback
+    void complete(T&& item) noexcept(false) {
+        --in_flight;
+        channel.push(std::move(item));
+    }
+    /// @brief 1 request is completed without item(e.g. stream tick). for the callback
+    void skip() noexcept {
+        --in_flight;
+        request_one();
+    }
+    /// @brief end of the stream or error. `co_await next()` returns `std::nullopt` after the remaining items
+    void close() noexcept {
+        {
+            std::lock_guard lck{mtx};
+            request = nullptr;
+        }
+        channel.close();
+    }
+
+    awaiter_t next() noexcept {
+        return awaiter_t{*this};
+    }
+
+    size_t get_depth() const noexcept {
+        return depth;
+    }
+    /// @brief requests which are not completed yet
+    size_t get_in_flight() const noexcept {
+        return in_flight;
+    }
+
+  private:
+    void request_one() noexcept {
+        std::function<bool()> fn{};
+        {
+            std::lock_guard lck{mtx};
+            fn = request;
+        }
+        if (fn == nullptr)
+            return;
+        ++in_flight; // the completion can be faster than the return
+        if (fn() == false) {
+            --in_flight;
+            close();
+        }
+    }
+};
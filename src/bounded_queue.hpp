@@ -0,0 +1,223 @@
+/**
+ * @file    bounded_queue.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Blocking FIFO with capacity to connect the pipeline stages
+ */
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/// @brief What `bounded_queue_t::push` does when the queue is full
+enum class overflow_policy_t : uint32_t {
+    block = 0,          ///< wait for the consumer. no loss, but the latency is unbounded
+    drop_oldest,        ///< discard the front item. for the live preview/capture
+    drop_newest,        ///< discard the incoming item
+    drop_non_reference, ///< discard the oldest droppable item(e.g. non-reference frame). block if there is none
+};
+
+/// @brief Counters to measure what was lost in the live pipeline
+struct queue_stats_t final {
+    uint64_t pushed = 0;  ///< accepted items
+    uint64_t popped = 0;
+    uint64_t dropped = 0; ///< items discarded by the `overflow_policy_t`
+    uint64_t blocked = 0; ///< `push` which had to wait for the consumer
+    size_t high_water = 0;
+};
+
+/**
+ * @brief Multi-producer/multi-consumer FIFO with `overflow_policy_t` for the full queue
+ *
+ * @details `close` is the end of the stream. After that, `push` fails and `pop` returns the remaining items
+ */
+template <typename T>
+class bounded_queue_t final {
+  public:
+    /// @note invoked outside of the lock, in the thread of `push`
+    using drop_hook_t = std::function<void(const T& item, overflow_policy_t policy)>;
+    /// @return true if the item can be dropped with `overflow_policy_t::drop_non_reference`
+    /// @note invoked once for each item, outside of the lock, in the thread of `push`
+    using droppable_t = std::function<bool(const T& item)>;
+
+  private:
+    /// @brief the item and the result of `droppable_t` at `push`
+    struct entry_t final {
+        T item;
+        bool droppable;
+    };
+
+    mutable std::mutex mtx{};
+    std::condition_variable readable{};
+    std::condition_variable writable{};
+    std::deque<entry_t> items{};
+    size_t capacity;
+    overflow_policy_t policy;
+    bool closed = false;
+    queue_stats_t counters{};
+    drop_hook_t on_drop{};
+    std::shared_ptr<const droppable_t> droppable{}; // shared with `push` which runs it outside of the lock
+
+  public:
+    /// @param capacity 0 is treated as 1
+    explicit bounded_queue_t(size_t capacity, overflow_policy_t policy = overflow_policy_t::block) noexcept
+        : capacity{capacity ? capacity : 1}, policy{policy} {
+    }
+    bounded_queue_t(const bounded_queue_t&) = delete;
+    bounded_queue_t(bounded_queue_t&&) = delete;
+    bounded_queue_t& operator=(const bounded_queue_t&) = delete;
+    bounded_queue_t& operator=(bounded_queue_t&&) = delete;
+
+    void set_policy(overflow_policy_t value) noexcept {
+        std::lock_guard lck{mtx};
+        policy = value;
+    }
+    void set_drop_hook(drop_hook_t fn) noexcept {
+        std::lock_guard lck{mtx};
+        on_drop = std::move(fn);
+    }
+    /// @note without this, `overflow_policy_t::drop_non_reference` works like `block`
+    /// @throw std::bad_alloc
+    void set_droppable(droppable_t fn) noexcept(false) {
+        auto holder = fn ? std::make_shared<const droppable_t>(std::move(fn)) : nullptr;
+        std::lock_guard lck{mtx};
+        droppable.swap(holder);
+    }
+
+    /**
+     * @note with the drop policies, `push` doesn't block. The dropped item is given to the drop hook
+     * @return false if the queue is closed. the `item` is not moved in the case
+     */
+    bool push(T&& item) noexcept(false) {
+        const bool can_drop = is_droppable(item);
+        std::unique_lock lck{mtx};
+        if (closed)
+            return false;
+        if (items.size() >= capacity) {
+            switch (policy) {
+            case overflow_policy_t::drop_oldest: {
+                T dropped = std::move(items.front().item);
+                items.pop_front();
+                items.push_back(entry_t{std::move(item), can_drop});
+                return notify_dropped(lck, dropped, true);
+            }
+            case overflow_policy_t::drop_newest: {
+                T dropped = std::move(item);
+                return notify_dropped(lck, dropped, false);
+            }
+            case overflow_policy_t::drop_non_reference:
+                for (auto it = items.begin(); it != items.end(); ++it) {
+                    if (it->droppable == false)
+                        continue;
+                    T dropped = std::move(it->item);
+                    items.erase(it);
+                    items.push_back(entry_t{std::move(item), can_drop});
+                    return notify_dropped(lck, dropped, true);
+                }
+                if (can_drop) {
+                    T dropped = std::move(item);
+                    return notify_dropped(lck, dropped, false);
+                }
+                [[fallthrough]]; // all items are reference. wait for the consumer
+            case overflow_policy_t::block:
+            default:
+                ++counters.blocked;
+                writable.wait(lck, [this]() { return closed || items.size() < capacity; });
+                if (closed)
+                    return false;
+                break;
+            }
+        }
+        items.push_back(entry_t{std::move(item), can_drop});
+        ++counters.pushed;
+        if (counters.high_water < items.size())
+            counters.high_water = items.size();
+        lck.unlock();
+        readable.notify_one();
+        return true;
+    }
+
+    /// @return false if the queue is closed and empty
+    bool pop(T& item) noexcept(false) {
+        std::unique_lock lck{mtx};
+        readable.wait(lck, [this]() { return closed || items.empty() == false; });
+        if (items.empty())
+            return false;
+        item = std::move(items.front().item);
+        items.pop_front();
+        ++counters.popped;
+        lck.unlock();
+        writable.notify_one();
+        return true;
+    }
+
+    /// @brief wake up all waiting threads. `push` will fail
+    void close() noexcept {
+        {
+            std::lock_guard lck{mtx};
+            closed = true;
+        }
+        readable.notify_all();
+        writable.notify_all();
+    }
+
+    /// @brief close and discard the remaining items
+    void cancel() noexcept {
+        std::deque<entry_t> discarded{};
+        {
+            std::lock_guard lck{mtx};
+            closed = true;
+            discarded.swap(items);
+        }
+        readable.notify_all();
+        writable.notify_all();
+    }
+
+    bool is_closed() const noexcept {
+        std::lock_guard lck{mtx};
+        return closed;
+    }
+    size_t size() const noexcept {
+        std::lock_guard lck{mtx};
+        return items.size();
+    }
+    size_t max_size() const noexcept {
+        return capacity;
+    }
+    queue_stats_t stats() const noexcept {
+        std::lock_guard lck{mtx};
+        return counters;
+    }
+
+  private:
+    /// @note the lock is released while the `droppable_t` runs. The copy of the holder keeps it alive
+    bool is_droppable(const T& item) noexcept(false) {
+        std::shared_ptr<const droppable_t> fn{};
+        {
+            std::lock_guard lck{mtx};
+            fn = droppable;
+        }
+        return fn && (*fn)(item);
+    }
+
+    /**
+     * @param accepted the incoming item is in the queue instead of the `dropped`
+     * @return true. either way, the producer can continue
+     */
+    bool notify_dropped(std::unique_lock<std::mutex>& lck, const T& dropped, bool accepted) noexcept(false) {
+        ++counters.dropped;
+        if (accepted)
+            ++counters.pushed;
+        drop_hook_t hook = on_drop;
+        const overflow_policy_t reason = policy;
+        lck.unlock();
+        if (accepted)
+            readable.notify_one();
+        if (hook)
+            hook(dropped, reason);
+        return true;
+    }
+};
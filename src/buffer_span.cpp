@@ -0,0 +1,47 @@
+#include "buffer_span.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+void span_list_t::push_back(const void* data, size_t size) noexcept(false) {
+    if (data == nullptr || size == 0)
+        return;
+    spans.push_back(byte_span_t{static_cast<const uint8_t*>(data), size});
+    total += size;
+}
+
+void span_list_t::clear() noexcept {
+    spans.clear();
+    total = 0;
+}
+
+size_t span_list_t::locate(size_t offset, size_t& local) const noexcept {
+    for (size_t i = 0; i < spans.size(); ++i) {
+        if (offset < spans[i].size) {
+            local = offset;
+            return i;
+        }
+        offset -= spans[i].size;
+    }
+    local = 0;
+    return spans.size();
+}
+
+size_t span_list_t::read(size_t offset, uint8_t* dst, size_t length) const noexcept {
+    size_t local = 0;
+    size_t copied = 0;
+    for (size_t i = locate(offset, local); i < spans.size() && copied < length; ++i, local = 0) {
+        const size_t amount = min(spans[i].size - local, length - copied);
+        memcpy(dst + copied, spans[i].data + local, amount);
+        copied += amount;
+    }
+    return copied;
+}
+
+uint8_t span_list_t::at(size_t offset) const noexcept {
+    size_t local = 0;
+    const size_t i = locate(offset, local);
+    return spans[i].data[local];
+}
@@ -0,0 +1,67 @@
+/**
+ * @file    buffer_span.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Scatter-gather access to the memory pieces of a sample
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Non-owning read-only range of bytes
+struct byte_span_t final {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+/**
+ * @brief Ordered list of `byte_span_t`. Works like one logical buffer without flattening the pieces
+ *
+ * @details The consumers(writer, hasher, parser ...) can visit each piece where it is.
+ *          `read` gathers a range which may cross the boundary of the pieces.
+ */
+class span_list_t final {
+    std::vector<byte_span_t> spans{};
+    size_t total = 0;
+
+  public:
+    using const_iterator = std::vector<byte_span_t>::const_iterator;
+
+    /// @note empty span is ignored
+    void push_back(const void* data, size_t size) noexcept(false);
+    void clear() noexcept;
+
+    /// @brief number of the pieces
+    size_t count() const noexcept {
+        return spans.size();
+    }
+    /// @brief sum of all pieces' size
+    size_t total_size() const noexcept {
+        return total;
+    }
+    const byte_span_t& operator[](size_t index) const noexcept {
+        return spans[index];
+    }
+    const_iterator begin() const noexcept {
+        return spans.begin();
+    }
+    const_iterator end() const noexcept {
+        return spans.end();
+    }
+
+    /**
+     * @brief gather `length` bytes from the logical `offset`
+     * @return bytes copied into the `dst`. less than `length` if the list is shorter
+     */
+    size_t read(size_t offset, uint8_t* dst, size_t length) const noexcept;
+
+    /**
+     * @brief find the piece which contains the logical `offset`
+     * @param local offset in the piece
+     * @return `count()` if the `offset` is out of range
+     */
+    size_t locate(size_t offset, size_t& local) const noexcept;
+
+    /// @return byte at the logical `offset`. The `offset` must be less than `total_size()`
+    uint8_t at(size_t offset) const noexcept;
+};
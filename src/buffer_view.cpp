@@ -0,0 +1,68 @@
+#include "buffer_view.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+using namespace std;
+
+/// @throw std::bad_alloc
+static shared_ptr<frame_block_t> allocate_block(size_t length, frame_pool_t* pool) noexcept(false) {
+    constexpr size_t alignment = 64;
+    if (pool) {
+        if (auto block = pool->acquire(length, alignment))
+            return block;
+        throw bad_alloc{};
+    }
+    auto holder = make_unique<frame_block_t>();
+    holder->data = aligned_allocate(length ? length : 1, alignment);
+    if (holder->data == nullptr)
+        throw bad_alloc{};
+    holder->size = length;
+    holder->alignment = alignment;
+    return shared_ptr<frame_block_t>{holder.release(), [](frame_block_t* block) {
+                                         aligned_deallocate(block->data);
+                                         delete block;
+                                     }};
+}
+
+buffer_view_t::buffer_view_t(shared_ptr<frame_block_t> block) noexcept
+    : block{move(block)}, offset{0}, length{this->block ? this->block->size : 0} {
+}
+
+buffer_view_t::buffer_view_t(shared_ptr<frame_block_t> _block, size_t _offset, size_t _length) noexcept(false)
+    : block{move(_block)}, offset{_offset}, length{_length} {
+    const size_t capacity = block ? block->size : 0;
+    if (offset > capacity || length > capacity - offset)
+        throw out_of_range{"buffer_view_t: range is out of the block"};
+}
+
+buffer_view_t buffer_view_t::slice(size_t _offset, size_t _length) const noexcept(false) {
+    if (_offset > length || _length > length - _offset)
+        throw out_of_range{"buffer_view_t: slice is out of the view"};
+    return buffer_view_t{block, offset + _offset, _length};
+}
+
+uint8_t* buffer_view_t::mutable_data(frame_pool_t* pool) noexcept(false) {
+    if (block == nullptr)
+        return nullptr;
+    // the only owner. nobody can observe the write.
+    // `use_count` is a relaxed load. The fence orders this write after the other owners' last release
+    if (block.use_count() == 1) {
+        atomic_thread_fence(memory_order_acquire);
+        return static_cast<uint8_t*>(block->data) + offset;
+    }
+    auto copied = allocate_block(length, pool);
+    memcpy(copied->data, data(), length);
+    block = move(copied);
+    offset = 0;
+    return static_cast<uint8_t*>(block->data);
+}
+
+buffer_view_t make_buffer_view(const void* src, size_t length, frame_pool_t* pool) noexcept(false) {
+    auto block = allocate_block(length, pool);
+    if (length)
+        memcpy(block->data, src, length);
+    return buffer_view_t{move(block), 0, length};
+}
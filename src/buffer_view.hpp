@@ -0,0 +1,71 @@
+/**
+ * @file    buffer_view.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Reference counted, read-only view of a memory block
+ */
+#pragma once
+#include <frame_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Read-only range of a shared `frame_block_t`. Copy of the view doesn't copy the memory
+ *
+ * @details Multiple consumers(preview, recording, ...) can hold the same frame without `memcpy`.
+ *          `mutable_data` performs the copy-on-write only when the block is shared with other owners.
+ */
+class buffer_view_t final {
+    std::shared_ptr<frame_block_t> block{};
+    size_t offset = 0;
+    size_t length = 0;
+
+  public:
+    buffer_view_t() noexcept = default;
+    /// @brief view of the whole block
+    explicit buffer_view_t(std::shared_ptr<frame_block_t> block) noexcept;
+    /// @throw std::out_of_range if the range is not in the block
+    buffer_view_t(std::shared_ptr<frame_block_t> block, size_t offset, size_t length) noexcept(false);
+
+    const uint8_t* data() const noexcept {
+        return block ? static_cast<const uint8_t*>(block->data) + offset : nullptr;
+    }
+    size_t size() const noexcept {
+        return length;
+    }
+    bool empty() const noexcept {
+        return length == 0;
+    }
+    const std::shared_ptr<frame_block_t>& get_block() const noexcept {
+        return block;
+    }
+    /// @brief true if another view(or owner) references the same block
+    bool is_shared() const noexcept {
+        return block.use_count() > 1;
+    }
+
+    /**
+     * @brief sub-range which shares the block
+     * @param offset relative to this view
+     * @throw std::out_of_range
+     */
+    buffer_view_t slice(size_t offset, size_t length) const noexcept(false);
+
+    /**
+     * @brief Writable pointer for the view. Copy-on-write
+     *
+     * @details If the block is shared, the range is copied to a new block(from the `pool` if not `nullptr`)
+     *          and this view moves to the new one. The other views are not affected.
+     *          The other views may be released in the other threads. Their writes happen before the unique use.
+     * @note    The block must not be shared with `std::weak_ptr`. `lock` can make a new owner after the check
+     * @throw std::bad_alloc
+     */
+    uint8_t* mutable_data(frame_pool_t* pool = nullptr) noexcept(false);
+};
+
+/**
+ * @brief Copy the memory into a new block. The only copy until someone mutates the views
+ * @throw std::bad_alloc
+ */
+buffer_view_t make_buffer_view(const void* src, size_t length, frame_pool_t* pool = nullptr) noexcept(false);
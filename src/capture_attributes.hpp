@@ -0,0 +1,263 @@
+/**
+ * @file    capture_attributes.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Translation of the capture metadata items into the `MF_CAPTURE_METADATA_*` attributes
+ * @note    Header-only, so MFT0 translates the items on the capture path without the `media` library
+ * @see     https://docs.microsoft.com/en-us/windows-hardware/drivers/stream/capture-stats-metadata-attributes
+ */
+#pragma once
+// clang-format off
+#include <mfapi.h>
+#include <mfidl.h>
+#include <ks.h>
+#include <ksmedia.h> // for KSCAMERA_EXTENDEDPROP_FACEDETECTION_*
+// clang-format on
+
+#include <capture_metadata.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+/// @brief UINT32 `orientation_t` in `MFSampleExtension_CaptureMetadata`. Written by `translate_capture_metadata`
+constexpr GUID MF_CAPTURE_METADATA_ORIENTATION{
+    0x8f3d6c21, 0x5b47, 0x4e0a, {0x9c, 0x1e, 0x3a, 0x7b, 0x2d, 0x64, 0xf1, 0x95}};
+
+inline HRESULT set_metadata_if(IMFAttributes* metadata, const GUID& key, const metadata_u32_t& value) noexcept {
+    return value.set ? metadata->SetUINT32(key, value.value) : S_OK;
+}
+inline HRESULT set_metadata_if(IMFAttributes* metadata, const GUID& key, const metadata_i64_t& value) noexcept {
+    return value.set ? metadata->SetUINT64(key, static_cast<UINT64>(value.value)) : S_OK;
+}
+inline HRESULT set_metadata_if(IMFAttributes* metadata, const GUID& key, const metadata_u64_t& value) noexcept {
+    return value.set ? metadata->SetUINT64(key, value.value) : S_OK;
+}
+inline HRESULT set_metadata_if(IMFAttributes* metadata, const metadata_evcomp_t& value) noexcept {
+    if (value.set == 0)
+        return S_OK;
+    CapturedMetadataExposureCompensation compensation{};
+    compensation.Flags = value.flags;
+    compensation.Value = value.value;
+    return metadata->SetBlob(MF_CAPTURE_METADATA_EXPOSURE_COMPENSATION, reinterpret_cast<const UINT8*>(&compensation),
+                             sizeof(compensation));
+}
+
+inline HRESULT translate_capture_metadata(const preview_aggregation_t& data, IMFAttributes* metadata) noexcept {
+    for (const auto& [key, value] : {std::make_pair(&MF_CAPTURE_METADATA_FOCUSSTATE, data.focus_state),
+                                     std::make_pair(&MF_CAPTURE_METADATA_ISO_SPEED, data.iso_speed),
+                                     std::make_pair(&MF_CAPTURE_METADATA_LENS_POSITION, data.lens_position),
+                                     std::make_pair(&MF_CAPTURE_METADATA_FLASH, data.flash_on),
+                                     std::make_pair(&MF_CAPTURE_METADATA_WHITEBALANCE, data.white_balance_mode)})
+        if (auto hr = set_metadata_if(metadata, *key, value); FAILED(hr))
+            return hr;
+    if (auto hr = set_metadata_if(metadata, MF_CAPTURE_METADATA_EXPOSURE_TIME, data.exposure_time); FAILED(hr))
+        return hr;
+    if (auto hr = set_metadata_if(metadata, MF_CAPTURE_METADATA_SENSORFRAMERATE, data.sensor_frame_rate); FAILED(hr))
+        return hr;
+    if (auto hr = set_metadata_if(metadata, data.ev_compensation); FAILED(hr))
+        return hr;
+    if (data.iso_analog_gain.set || data.iso_digital_gain.set) {
+        CapturedMetadataISOGains gains{};
+        gains.AnalogGain = to_float(data.iso_analog_gain);
+        gains.DigitalGain = to_float(data.iso_digital_gain);
+        if (auto hr = metadata->SetBlob(MF_CAPTURE_METADATA_ISO_GAINS, reinterpret_cast<const UINT8*>(&gains),
+                                        sizeof(gains));
+            FAILED(hr))
+            return hr;
+    }
+    if (data.white_balance_gain_r.set || data.white_balance_gain_g.set || data.white_balance_gain_b.set) {
+        CapturedMetadataWhiteBalanceGains gains{};
+        gains.R = to_float(data.white_balance_gain_r);
+        gains.G = to_float(data.white_balance_gain_g);
+        gains.B = to_float(data.white_balance_gain_b);
+        return metadata->SetBlob(MF_CAPTURE_METADATA_WHITEBALANCE_GAINS, reinterpret_cast<const UINT8*>(&gains),
+                                 sizeof(gains));
+    }
+    return S_OK;
+}
+
+inline HRESULT translate_capture_metadata(const image_aggregation_t& data, IMFAttributes* metadata) noexcept {
+    for (const auto& [key, value] : {std::make_pair(&MF_CAPTURE_METADATA_REQUESTED_FRAME_SETTING_ID, data.frame_id),
+                                     std::make_pair(&MF_CAPTURE_METADATA_ISO_SPEED, data.iso_speed),
+                                     std::make_pair(&MF_CAPTURE_METADATA_LENS_POSITION, data.lens_position),
+                                     std::make_pair(&MF_CAPTURE_METADATA_FLASH, data.flash_on),
+                                     std::make_pair(&MF_CAPTURE_METADATA_FLASH_POWER, data.flash_power),
+                                     std::make_pair(&MF_CAPTURE_METADATA_WHITEBALANCE, data.white_balance_mode),
+                                     std::make_pair(&MF_CAPTURE_METADATA_ZOOMFACTOR, data.zoom_factor),
+                                     std::make_pair(&MF_CAPTURE_METADATA_FOCUSSTATE, data.focus_state)})
+        if (auto hr = set_metadata_if(metadata, *key, value); FAILED(hr))
+            return hr;
+    if (auto hr = set_metadata_if(metadata, MF_CAPTURE_METADATA_EXPOSURE_TIME, data.exposure_time); FAILED(hr))
+        return hr;
+    if (auto hr = set_metadata_if(metadata, MF_CAPTURE_METADATA_SCENE_MODE, data.scene_mode); FAILED(hr))
+        return hr;
+    if (auto hr = set_metadata_if(metadata, data.ev_compensation); FAILED(hr))
+        return hr;
+    // the frame is not rotated here. see `orient`
+    if (data.orientation.set && data.orientation.value >= 1 && data.orientation.value <= 8)
+        return metadata->SetUINT32(MF_CAPTURE_METADATA_ORIENTATION, data.orientation.value);
+    return S_OK;
+}
+
+/// @brief `MF_CAPTURE_METADATA_HISTOGRAM` blob with `N` channels
+template <uint32_t N>
+struct histogram_blob_t final {
+    struct channel_t final {
+        HistogramDataHeader header;
+        ULONG color[256];
+    };
+    HistogramBlobHeader blob;
+    HistogramHeader header;
+    channel_t channels[N];
+};
+
+template <uint32_t N>
+HRESULT set_histogram_blob(IMFAttributes* metadata, const histogram_t& data, const uint32_t (&masks)[N],
+                           const uint32_t* const (&bins)[N]) noexcept {
+    histogram_blob_t<N> blob{};
+    blob.blob.Size = sizeof(blob);
+    blob.blob.Histograms = 1;
+    blob.header.Size = sizeof(blob.header) + sizeof(blob.channels);
+    blob.header.Bins = 256;
+    blob.header.FourCC = data.fourcc;
+    blob.header.ChannelMasks = data.channel_mask;
+    blob.header.Grid.Width = data.width;
+    blob.header.Grid.Height = data.height;
+    blob.header.Grid.Region = RECT{0, 0, static_cast<LONG>(data.width) - 1, static_cast<LONG>(data.height) - 1};
+    for (uint32_t i = 0; i < N; ++i) {
+        blob.channels[i].header.Size = sizeof(blob.channels[i]);
+        blob.channels[i].header.ChannelMask = masks[i];
+        blob.channels[i].header.Linear = 1;
+        std::memcpy(blob.channels[i].color, bins[i], sizeof(blob.channels[i].color));
+    }
+    return metadata->SetBlob(MF_CAPTURE_METADATA_HISTOGRAM, reinterpret_cast<const UINT8*>(&blob), sizeof(blob));
+}
+
+/**
+ * @brief Write the `data` as `MF_CAPTURE_METADATA_HISTOGRAM`. The blob is `histogram_blob_t`
+ * @details The Y/Cr/Cb histogram has 3 channels. The R/G/B histogram has 4 channels, Y/R/G/B,
+ *          because the consumers expect the Y channel. RGB fakes it with the G
+ * @param metadata `MFSampleExtension_CaptureMetadata` of the sample
+ * @return `S_FALSE` if the `channel_mask` is neither Y/Cr/Cb nor R/G/B
+ */
+inline HRESULT set_capture_histogram(IMFAttributes* metadata, const histogram_t& data) noexcept {
+    if (metadata == nullptr)
+        return E_POINTER;
+    constexpr uint32_t rgb = histogram_channel_r | histogram_channel_g | histogram_channel_b;
+    constexpr uint32_t ycrcb = histogram_channel_y | histogram_channel_cr | histogram_channel_cb;
+    if ((data.channel_mask & rgb) == rgb)
+        return set_histogram_blob<4>(
+            metadata, data, {histogram_channel_y, histogram_channel_r, histogram_channel_g, histogram_channel_b},
+            {data.p1, data.p0, data.p1, data.p2});
+    if ((data.channel_mask & ycrcb) == ycrcb)
+        return set_histogram_blob<3>(metadata, data, {histogram_channel_y, histogram_channel_cr, histogram_channel_cb},
+                                     {data.p0, data.p1, data.p2});
+    return S_FALSE;
+}
+
+inline HRESULT translate_capture_metadata(const metadata_faces_t& faces, IMFAttributes* metadata) noexcept {
+    const uint32_t count = faces.size();
+    std::vector<BYTE> rects{}, characterizations{};
+    try {
+        rects.resize(sizeof(FaceRectInfoBlobHeader) + sizeof(FaceRectInfo) * count);
+        characterizations.resize(sizeof(FaceCharacterizationBlobHeader) + sizeof(FaceCharacterization) * count);
+    } catch (const std::bad_alloc&) {
+        return E_OUTOFMEMORY;
+    }
+    auto* rect_header = reinterpret_cast<FaceRectInfoBlobHeader*>(rects.data());
+    rect_header->Size = static_cast<ULONG>(rects.size());
+    rect_header->Count = count;
+    auto* char_header = reinterpret_cast<FaceCharacterizationBlobHeader*>(characterizations.data());
+    char_header->Size = static_cast<ULONG>(characterizations.size());
+    char_header->Count = count;
+    auto* regions = reinterpret_cast<FaceRectInfo*>(rect_header + 1);
+    auto* chars = reinterpret_cast<FaceCharacterization*>(char_header + 1);
+    for (uint32_t i = 0; i < count; ++i) {
+        const metadata_face_t face = faces[i];
+        regions[i].Region = RECT{face.left, face.top, face.right, face.bottom};
+        regions[i].confidenceLevel = face.confidence;
+        chars[i].BlinkScoreLeft = face.blink_score_left;
+        chars[i].BlinkScoreRight = face.blink_score_right;
+        chars[i].FacialExpression = face.expression == 1 ? MF_METADATAFACIALEXPRESSION_SMILE : 0;
+        chars[i].FacialExpressionScore = face.expression_score;
+    }
+    if (auto hr = metadata->SetBlob(MF_CAPTURE_METADATA_FACEROIS, rects.data(), static_cast<UINT32>(rects.size()));
+        FAILED(hr))
+        return hr;
+    MetadataTimeStamps timestamp{};
+    timestamp.Flags = MF_METADATATIMESTAMPS_DEVICE;
+    timestamp.Device = static_cast<LONGLONG>(faces.header.timestamp);
+    if (auto hr = metadata->SetBlob(MF_CAPTURE_METADATA_FACEROITIMESTAMPS, reinterpret_cast<const UINT8*>(&timestamp),
+                                    sizeof(timestamp));
+        FAILED(hr))
+        return hr;
+    if ((faces.header.flags & KSCAMERA_EXTENDEDPROP_FACEDETECTION_ADVANCED_MASK) == 0)
+        return S_OK;
+    return metadata->SetBlob(MF_CAPTURE_METADATA_FACEROICHARACTERIZATIONS, characterizations.data(),
+                             static_cast<UINT32>(characterizations.size()));
+}
+
+/// @return `S_FALSE` if the `item` is unknown or too small for its payload
+inline HRESULT translate_capture_metadata(const metadata_item_t& item, IMFAttributes* metadata) noexcept {
+    if (metadata == nullptr)
+        return E_POINTER;
+    switch (item.id) {
+    case metadata_id_t::preview_aggregation:
+        if (preview_aggregation_t data{}; decode_metadata(item, data))
+            return translate_capture_metadata(data, metadata);
+        break;
+    case metadata_id_t::image_aggregation:
+        if (image_aggregation_t data{}; decode_metadata(item, data))
+            return translate_capture_metadata(data, metadata);
+        break;
+    case metadata_id_t::histogram:
+        if (histogram_t data{}; decode_metadata(item, data))
+            return set_capture_histogram(metadata, data);
+        break;
+    case metadata_id_t::face_detection:
+        if (metadata_faces_t data{}; decode_metadata(item, data))
+            return translate_capture_metadata(data, metadata);
+        break;
+    default:
+        break;
+    }
+    return S_FALSE;
+}
+
+/// @brief Translate the items of the `view`. The unknown items are skipped
+/// @return `E_UNEXPECTED` if the items are not `metadata_view_t::is_well_formed`
+inline HRESULT translate_capture_metadata(const metadata_view_t& view, IMFAttributes* metadata) noexcept {
+    if (view.is_well_formed() == false)
+        return E_UNEXPECTED;
+    for (const metadata_item_t& item : view)
+        if (auto hr = translate_capture_metadata(item, metadata); FAILED(hr))
+            return hr;
+    return S_OK;
+}
+
+/**
+ * @brief Translate the raw items of `MF_CAPTURE_METADATA_FRAME_RAWSTREAM` into the `MF_CAPTURE_METADATA_*` attributes
+ * @details MFT0 translates the items of each frame, so the consumers which read the attributes keep working.
+ *          The consumer of the other sources calls this only when it needs the attributes.
+ *          Calling it again overwrites the attributes with the same values
+ * @param metadata `MFSampleExtension_CaptureMetadata` of the sample
+ * @return `E_UNEXPECTED` if the items are not `metadata_view_t::is_well_formed`
+ */
+inline HRESULT translate_capture_metadata(IMFAttributes* metadata) noexcept {
+    if (metadata == nullptr)
+        return E_POINTER;
+    IMFMediaBuffer* buffer = nullptr;
+    if (auto hr = metadata->GetUnknown(MF_CAPTURE_METADATA_FRAME_RAWSTREAM, IID_PPV_ARGS(&buffer)); FAILED(hr))
+        return hr;
+    BYTE* data = nullptr;
+    DWORD length = 0;
+    HRESULT hr = buffer->Lock(&data, nullptr, &length);
+    if (SUCCEEDED(hr)) {
+        hr = translate_capture_metadata(metadata_view_t{data, length}, metadata);
+        buffer->Unlock();
+    }
+    buffer->Release();
+    return hr;
+}
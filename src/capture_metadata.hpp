@@ -0,0 +1,332 @@
+/**
+ * @file    capture_metadata.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Bounds checked view of the capture metadata items from the camera driver
+ * @see     mft0/MetadataInternal.h
+ * @see     https://docs.microsoft.com/en-us/windows-hardware/drivers/stream/capture-stats-metadata
+ */
+#pragma once
+#include <histogram_metadata.hpp> // histogram_t
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+/// @brief `MetadataId_Custom_*` of MFT0. `MetadataId_Custom_Start` is 0x80000000
+enum class metadata_id_t : uint32_t {
+    image_aggregation = 0x80000000,
+    face_detection = 0x80000001,
+    preview_aggregation = 0x80000002,
+    histogram = 0x80000003,
+};
+
+/// @brief `KSCAMERA_METADATA_ITEMHEADER`. The `size` includes the header
+struct metadata_item_header_t final {
+    uint32_t id;
+    uint32_t size;
+};
+
+/// @brief `METADATA_UINT32`, `METADATA_LONG`. The `value` is valid only if `set` is not 0
+struct metadata_u32_t final {
+    uint32_t set;
+    uint32_t value;
+};
+/// @brief `METADATA_SHORT`
+struct metadata_u16_t final {
+    uint32_t set;
+    uint16_t value;
+    uint16_t reserved;
+};
+/// @brief `METADATA_INT64`
+struct metadata_i64_t final {
+    uint32_t set;
+    uint32_t reserved;
+    int64_t value;
+};
+/// @brief `METADATA_UINT64`
+struct metadata_u64_t final {
+    uint32_t set;
+    uint32_t reserved;
+    uint64_t value;
+};
+/// @brief `METADATA_RATIONAL`
+struct metadata_rational_t final {
+    uint32_t set;
+    uint32_t reserved;
+    uint32_t numerator;
+    uint32_t denominator;
+};
+/// @brief `METADATA_SRATIONAL`
+struct metadata_srational_t final {
+    uint32_t set;
+    uint32_t reserved;
+    int32_t numerator;
+    int32_t denominator;
+};
+/// @brief `METADATA_EVCOMP`
+struct metadata_evcomp_t final {
+    uint32_t set;
+    int32_t value;
+    uint64_t flags;
+};
+/// @brief `METADATA_SHORTSTRING`. Not set if the `length` is 0
+struct metadata_string_t final {
+    uint32_t length;
+    char value[32];
+};
+/// @brief `METADATA_TIMEFIELDS`
+struct metadata_time_t final {
+    uint32_t set;
+    uint32_t reserved;
+    int16_t year, month, day, hour, minute, second, milliseconds, weekday;
+};
+
+/// @brief `METADATA_PREVIEWAGGREGATION`
+struct preview_aggregation_t final {
+    metadata_u32_t focus_state;
+    metadata_i64_t exposure_time;
+    metadata_evcomp_t ev_compensation;
+    metadata_u32_t iso_speed;
+    metadata_u32_t lens_position;
+    metadata_u32_t flash_on;
+    metadata_u32_t white_balance_mode;
+    metadata_srational_t iso_analog_gain;
+    metadata_srational_t iso_digital_gain;
+    metadata_u64_t sensor_frame_rate;
+    metadata_srational_t white_balance_gain_r;
+    metadata_srational_t white_balance_gain_g;
+    metadata_srational_t white_balance_gain_b;
+};
+static_assert(sizeof(preview_aggregation_t) == 168);
+
+/// @brief `METADATA_IMAGEAGGREGATION`. The Exif fields are kept for the layout
+struct image_aggregation_t final {
+    metadata_u32_t frame_id;
+    metadata_i64_t exposure_time;
+    metadata_u32_t iso_speed;
+    metadata_u32_t lens_position;
+    metadata_u64_t scene_mode;
+    metadata_u32_t flash_on;
+    metadata_u32_t flash_power;
+    metadata_u32_t white_balance_mode;
+    metadata_u32_t zoom_factor;
+    metadata_u32_t focus_locked;
+    metadata_u32_t white_balance_locked;
+    metadata_u32_t exposure_locked;
+    // Exif
+    metadata_u16_t orientation;
+    metadata_time_t local_time;
+    metadata_string_t make;
+    metadata_string_t model;
+    metadata_string_t software;
+    metadata_u16_t color_space;
+    metadata_rational_t gamma;
+    metadata_string_t maker_note;
+    metadata_rational_t f_number;
+    metadata_u16_t exposure_program;
+    metadata_srational_t shutter_speed_value;
+    metadata_rational_t aperture;
+    metadata_srational_t brightness;
+    metadata_srational_t exposure_bias;
+    metadata_rational_t subject_distance;
+    metadata_u16_t metering_mode;
+    metadata_u16_t light_source;
+    metadata_u16_t flash;
+    metadata_rational_t focal_length;
+    metadata_rational_t focal_plane_x_resolution;
+    metadata_rational_t focal_plane_y_resolution;
+    metadata_rational_t exposure_index;
+    metadata_u16_t exposure_mode;
+    metadata_u16_t white_balance;
+    metadata_rational_t digital_zoom_ratio;
+    metadata_u16_t focal_length_in_35mm_film;
+    metadata_u16_t scene_capture_type;
+    metadata_rational_t gain_control;
+    metadata_u16_t contrast;
+    metadata_u16_t saturation;
+    metadata_u16_t sharpness;
+    metadata_u16_t subject_distance_range;
+    metadata_evcomp_t ev_compensation;
+    metadata_u32_t focus_state; ///< optional
+};
+static_assert(sizeof(image_aggregation_t) == 624);
+static_assert(offsetof(image_aggregation_t, orientation) == 112);
+static_assert(offsetof(image_aggregation_t, ev_compensation) == 600);
+
+/// @brief `CAMERA_METADATA_FACEHEADER` without the item header. `count` of `metadata_face_t` follow it
+struct metadata_face_header_t final {
+    uint32_t count;
+    uint64_t flags; ///< `KSCAMERA_EXTENDEDPROP_FACEDETECTION_*`
+    uint64_t timestamp;
+};
+static_assert(sizeof(metadata_face_header_t) == 24);
+
+/// @brief `METADATA_FACEDATA`
+struct metadata_face_t final {
+    int32_t left, top, right, bottom;
+    uint32_t confidence; ///< [0, 100]
+    uint32_t blink_score_left;
+    uint32_t blink_score_right;
+    uint32_t reserved;
+    int32_t expression; ///< 1 for `EXPRESSION_SMILE`
+    uint32_t expression_score;
+};
+static_assert(sizeof(metadata_face_t) == 40);
+
+/// @brief 1 item of `metadata_view_t`. The `data` is the payload after the header, in the buffer of the view
+struct metadata_item_t final {
+    metadata_id_t id;
+    const uint8_t* data;
+    uint32_t size; ///< of the payload
+};
+
+/**
+ * @brief Read-only walk over the `KSCAMERA_METADATA_ITEMHEADER` items of `MF_CAPTURE_METADATA_FRAME_RAWSTREAM`
+ *
+ * @details The iteration stops at the first item which is smaller than the header or crosses the end of the buffer.
+ *          `is_well_formed` tells whether the items covered the buffer exactly.
+ *          Nothing is copied or allocated. The buffer must outlive the view and the items.
+ */
+class metadata_view_t final {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+  public:
+    class iterator final {
+        const uint8_t* cursor = nullptr;
+        size_t remaining = 0;
+        metadata_item_t item{};
+
+        /// @brief read the header at the `cursor`. Becomes the end if it's not valid
+        void load() noexcept {
+            metadata_item_header_t header{};
+            if (remaining >= sizeof(header))
+                std::memcpy(&header, cursor, sizeof(header));
+            if (remaining < sizeof(header) || header.size < sizeof(header) || header.size > remaining) {
+                cursor = nullptr;
+                remaining = 0;
+                return;
+            }
+            item.id = static_cast<metadata_id_t>(header.id);
+            item.data = cursor + sizeof(header);
+            item.size = header.size - static_cast<uint32_t>(sizeof(header));
+        }
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = metadata_item_t;
+        using difference_type = ptrdiff_t;
+        using pointer = const metadata_item_t*;
+        using reference = const metadata_item_t&;
+
+        iterator() noexcept = default;
+        iterator(const uint8_t* data, size_t size) noexcept : cursor{data}, remaining{size} {
+            load();
+        }
+
+        reference operator*() const noexcept {
+            return item;
+        }
+        pointer operator->() const noexcept {
+            return &item;
+        }
+        iterator& operator++() noexcept {
+            const size_t step = sizeof(metadata_item_header_t) + item.size;
+            cursor += step;
+            remaining -= step;
+            load();
+            return *this;
+        }
+        iterator operator++(int) noexcept {
+            iterator it = *this;
+            ++(*this);
+            return it;
+        }
+        bool operator==(const iterator& rhs) const noexcept {
+            return cursor == rhs.cursor;
+        }
+        bool operator!=(const iterator& rhs) const noexcept {
+            return cursor != rhs.cursor;
+        }
+    };
+
+    metadata_view_t() noexcept = default;
+    metadata_view_t(const void* data, size_t size) noexcept
+        : data{static_cast<const uint8_t*>(data)}, size{data ? size : 0} {
+    }
+
+    iterator begin() const noexcept {
+        return iterator{data, size};
+    }
+    iterator end() const noexcept {
+        return iterator{};
+    }
+
+    /// @return false if the buffer is empty, or the items don't end at the end of the buffer
+    bool is_well_formed() const noexcept {
+        size_t consumed = 0;
+        for (const metadata_item_t& item : *this)
+            consumed += sizeof(metadata_item_header_t) + item.size;
+        return size > 0 && consumed == size;
+    }
+};
+
+/// @brief The `metadata_id_t` of the decoded type
+template <typename T>
+constexpr metadata_id_t metadata_id_of = static_cast<metadata_id_t>(0);
+template <>
+constexpr metadata_id_t metadata_id_of<preview_aggregation_t> = metadata_id_t::preview_aggregation;
+template <>
+constexpr metadata_id_t metadata_id_of<image_aggregation_t> = metadata_id_t::image_aggregation;
+template <>
+constexpr metadata_id_t metadata_id_of<histogram_t> = metadata_id_t::histogram;
+template <>
+constexpr metadata_id_t metadata_id_of<metadata_face_header_t> = metadata_id_t::face_detection;
+
+/**
+ * @brief Copy the fixed size payload of the `item`. The buffer may be unaligned
+ * @tparam T `preview_aggregation_t`, `image_aggregation_t`, `histogram_t` or `metadata_face_header_t`
+ * @return false if the `item` has the other id or it's smaller than `T`
+ */
+template <typename T>
+bool decode_metadata(const metadata_item_t& item, T& value) noexcept {
+    static_assert(metadata_id_of<T> != static_cast<metadata_id_t>(0), "not a capture metadata payload");
+    if (item.id != metadata_id_of<T> || item.size < sizeof(T))
+        return false;
+    std::memcpy(&value, item.data, sizeof(T));
+    return true;
+}
+
+/// @brief The faces of `metadata_id_t::face_detection` item. They stay in the buffer of `metadata_view_t`
+struct metadata_faces_t final {
+    metadata_face_header_t header{};
+    const uint8_t* faces = nullptr;
+
+    uint32_t size() const noexcept {
+        return faces ? header.count : 0;
+    }
+    /// @note `index` must be less than `size()`
+    metadata_face_t operator[](uint32_t index) const noexcept {
+        metadata_face_t face{};
+        std::memcpy(&face, faces + size_t{index} * sizeof(metadata_face_t), sizeof(face));
+        return face;
+    }
+};
+
+/// @return false if the `item` is not valid or it's smaller than `header.count` faces
+inline bool decode_metadata(const metadata_item_t& item, metadata_faces_t& value) noexcept {
+    value = metadata_faces_t{};
+    if (decode_metadata(item, value.header) == false)
+        return false;
+    const uint64_t required = sizeof(metadata_face_header_t) + uint64_t{value.header.count} * sizeof(metadata_face_t);
+    if (item.size < required)
+        return false;
+    value.faces = item.data + sizeof(metadata_face_header_t);
+    return true;
+}
+
+/// @return `numerator / denominator`. 0 if the `denominator` is 0
+inline float to_float(const metadata_srational_t& value) noexcept {
+    return value.denominator ? static_cast<float>(value.numerator) / static_cast<float>(value.denominator) : 0.0f;
+}
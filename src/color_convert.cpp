@@ -0,0 +1,138 @@
+#include "color_convert.hpp"
+#include "kernels.hpp"
+#include "pixel_traits.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+yuv_coefficients_t get_yuv_coefficients(yuv_color_t color) noexcept {
+    double kr = 0.299, kb = 0.114;
+    switch (color.matrix) {
+    case yuv_matrix_t::bt709:
+        kr = 0.2126, kb = 0.0722;
+        break;
+    case yuv_matrix_t::bt2020:
+        kr = 0.2627, kb = 0.0593;
+        break;
+    default:
+        break;
+    }
+    const double kg = 1 - kr - kb;
+    const bool full = color.range == yuv_range_t::full;
+    const double y_scale = full ? 1.0 : 255.0 / 219;
+    const double c_scale = full ? 1.0 : 255.0 / 224;
+    auto q13 = [](double value) { return static_cast<int32_t>(lround(value * 8192)); };
+    yuv_coefficients_t k{};
+    k.y_offset = full ? 0 : 16;
+    k.y_gain = q13(y_scale);
+    k.v_r = q13(c_scale * 2 * (1 - kr));
+    k.u_g = q13(c_scale * 2 * (1 - kb) * kb / kg);
+    k.v_g = q13(c_scale * 2 * (1 - kr) * kr / kg);
+    k.u_b = q13(c_scale * 2 * (1 - kb));
+    return k;
+}
+
+static uint8_t clamp_q13(int32_t value) noexcept {
+    value = (value + 4096) >> 13;
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static void store_rgb32(uint8_t* dst, int32_t y, int32_t u, int32_t v, const yuv_coefficients_t& k) noexcept {
+    const int32_t luma = k.y_gain * (y - k.y_offset);
+    u -= 128;
+    v -= 128;
+    dst[0] = clamp_q13(luma + k.u_b * u);
+    dst[1] = clamp_q13(luma - k.u_g * u - k.v_g * v);
+    dst[2] = clamp_q13(luma + k.v_r * v);
+    dst[3] = 255;
+}
+
+/// @brief `u` and `v` are the first samples of the chroma rows. The step between the pixels comes from the traits
+template <pixel_format_t F>
+static void convert_row_rgb32_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                                     uint32_t begin, uint32_t end, const yuv_coefficients_t& k) noexcept {
+    constexpr pixel_traits_t traits = pixel_traits_v<F>;
+    static_assert(traits.num_plane > 1 && traits.bytes_per_sample == 1);
+    for (uint32_t x = begin; x < end; ++x) {
+        const uint32_t i = (x >> traits.shift_x) * traits.chroma_samples;
+        store_rgb32(dst + 4 * x, y[x], u[i], v[i], k);
+    }
+}
+
+void convert_row_nv12_rgb32_scalar(const uint8_t* y, const uint8_t* uv, uint8_t* dst, uint32_t begin, uint32_t end,
+                                   const yuv_coefficients_t& k) noexcept {
+    convert_row_rgb32_scalar<pixel_format_t::nv12>(y, uv, uv + 1, dst, begin, end, k);
+}
+
+void convert_row_i420_rgb32_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                                   uint32_t begin, uint32_t end, const yuv_coefficients_t& k) noexcept {
+    convert_row_rgb32_scalar<pixel_format_t::i420>(y, u, v, dst, begin, end, k);
+}
+
+void convert_row_nv12_rgb32(const uint8_t* y, const uint8_t* uv, uint8_t* dst, uint32_t width,
+                            const yuv_coefficients_t& k, simd_level_t level) noexcept {
+    switch (level) {
+#if defined(MEDIA_CORE_X86)
+    case simd_level_t::avx2:
+        return convert_row_nv12_rgb32_avx2(y, uv, dst, width, k);
+    case simd_level_t::sse41:
+        return convert_row_nv12_rgb32_sse41(y, uv, dst, width, k);
+#endif
+    default:
+        return convert_row_nv12_rgb32_scalar(y, uv, dst, 0, width, k);
+    }
+}
+
+void convert_row_i420_rgb32(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width,
+                            const yuv_coefficients_t& k, simd_level_t level) noexcept {
+    switch (level) {
+#if defined(MEDIA_CORE_X86)
+    case simd_level_t::avx2:
+        return convert_row_i420_rgb32_avx2(y, u, v, dst, width, k);
+    case simd_level_t::sse41:
+        return convert_row_i420_rgb32_sse41(y, u, v, dst, width, k);
+#endif
+    default:
+        return convert_row_i420_rgb32_scalar(y, u, v, dst, 0, width, k);
+    }
+}
+
+/// @brief the format is resolved once for the rows, not for each row
+template <pixel_format_t F>
+static void convert_rows_rgb32(const frame_view_t& src, const frame_view_t& dst, const yuv_coefficients_t& k,
+                               simd_level_t level, uint32_t begin, uint32_t end) noexcept {
+    constexpr pixel_traits_t traits = pixel_traits_v<F>;
+    for (uint32_t row = begin; row < end; ++row) {
+        const uint8_t* y = src.planes[0].row(row);
+        const uint32_t chroma_row = row >> traits.shift_y;
+        uint8_t* out = dst.planes[0].row(row);
+        if constexpr (traits.num_plane == 2)
+            convert_row_nv12_rgb32(y, src.planes[1].row(chroma_row), out, src.width, k, level);
+        else
+            convert_row_i420_rgb32(y, src.planes[1].row(chroma_row), src.planes[2].row(chroma_row), out, src.width,
+                                   k, level);
+    }
+}
+
+bool convert_yuv_to_rgb32(const frame_view_t& src, const frame_view_t& dst, yuv_color_t color, simd_level_t level,
+                          row_range_t rows) noexcept {
+    if (dst.format != pixel_format_t::rgb32 || dst.num_plane == 0 || src.num_plane == 0)
+        return false;
+    if (src.width != dst.width || src.height != dst.height)
+        return false;
+    const yuv_coefficients_t k = get_yuv_coefficients(color);
+    level = clamp_simd_level(level);
+    const uint32_t end = min(rows.end, src.height);
+    switch (src.format) {
+    case pixel_format_t::nv12:
+        convert_rows_rgb32<pixel_format_t::nv12>(src, dst, k, level, rows.begin, end);
+        return true;
+    case pixel_format_t::i420:
+        convert_rows_rgb32<pixel_format_t::i420>(src, dst, k, level, rows.begin, end);
+        return true;
+    default:
+        return false;
+    }
+}
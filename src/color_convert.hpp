@@ -0,0 +1,59 @@
+/**
+ * @file    color_convert.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   YUV → RGB conversion which replaces the Color Converter DSP
+ * @see     https://docs.microsoft.com/en-us/windows/win32/medfound/about-yuv-video
+ */
+#pragma once
+#include <frame_buffer.hpp>
+#include <simd.hpp>
+#include <slice.hpp>
+
+#include <cstdint>
+
+/// @brief `MF_MT_YUV_MATRIX`
+enum class yuv_matrix_t : uint32_t {
+    bt601 = 0, ///< SDTV
+    bt709,     ///< HDTV
+    bt2020,    ///< UHDTV. non-constant luminance
+};
+
+/// @brief `MF_MT_VIDEO_NOMINAL_RANGE`
+enum class yuv_range_t : uint32_t {
+    limited = 0, ///< Y [16, 235], UV [16, 240]
+    full,        ///< [0, 255]
+};
+
+struct yuv_color_t final {
+    yuv_matrix_t matrix = yuv_matrix_t::bt601;
+    yuv_range_t range = yuv_range_t::limited;
+};
+
+/**
+ * @brief Fixed point(Q13) factors for the kernels
+ * @details With `y' = y - y_offset`, `u' = u - 128`, `v' = v - 128`
+ *          R = (y_gain * y' + v_r * v' + 4096) >> 13
+ *          G = (y_gain * y' - u_g * u' - v_g * v' + 4096) >> 13
+ *          B = (y_gain * y' + u_b * u' + 4096) >> 13
+ */
+struct yuv_coefficients_t final {
+    int32_t y_offset;
+    int32_t y_gain;
+    int32_t v_r;
+    int32_t u_g;
+    int32_t v_g;
+    int32_t u_b;
+};
+
+yuv_coefficients_t get_yuv_coefficients(yuv_color_t color) noexcept;
+
+/**
+ * @brief NV12/I420 → RGB32. The 4th byte(X) is 255, so the output can be used as BGRA(`ARGB32`) too
+ * @param src `nv12` or `i420`
+ * @param dst `rgb32` with the same width/height
+ * @param level `simd_level_t::scalar` for the reference. clamped with `clamp_simd_level`
+ * @param rows  of the `dst` to write. see `parallel_rows`
+ * @return false if the formats or the sizes don't match
+ */
+bool convert_yuv_to_rgb32(const frame_view_t& src, const frame_view_t& dst, yuv_color_t color = {},
+                          simd_level_t level = get_simd_level(), row_range_t rows = all_rows) noexcept;
@@ -0,0 +1,77 @@
+/**
+ * @note compiled with AVX2. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+struct factors_t final {
+    __m256i y_offset, y_gain, v_r, u_g, v_g, u_b, round, alpha, zero, max, bias;
+
+    explicit factors_t(const yuv_coefficients_t& k) noexcept
+        : y_offset{_mm256_set1_epi32(k.y_offset)}, y_gain{_mm256_set1_epi32(k.y_gain)},
+          v_r{_mm256_set1_epi32(k.v_r)}, u_g{_mm256_set1_epi32(k.u_g)}, v_g{_mm256_set1_epi32(k.v_g)},
+          u_b{_mm256_set1_epi32(k.u_b)}, round{_mm256_set1_epi32(4096)},
+          alpha{_mm256_set1_epi32(static_cast<int32_t>(0xFF00'0000u))}, zero{_mm256_setzero_si256()},
+          max{_mm256_set1_epi32(255)}, bias{_mm256_set1_epi32(128)} {
+    }
+};
+
+__m256i clamp_q13(__m256i value, const factors_t& f) noexcept {
+    value = _mm256_srai_epi32(_mm256_add_epi32(value, f.round), 13);
+    return _mm256_min_epi32(_mm256_max_epi32(value, f.zero), f.max);
+}
+
+/// @param y8 8 luma in the low 64 bit
+/// @param u8 8 chroma(already duplicated for the pixel pairs) in the low 64 bit
+void store_8_pixels(uint8_t* dst, __m128i y8, __m128i u8, __m128i v8, const factors_t& f) noexcept {
+    const __m256i y = _mm256_cvtepu8_epi32(y8);
+    const __m256i u = _mm256_sub_epi32(_mm256_cvtepu8_epi32(u8), f.bias);
+    const __m256i v = _mm256_sub_epi32(_mm256_cvtepu8_epi32(v8), f.bias);
+    const __m256i luma = _mm256_mullo_epi32(_mm256_sub_epi32(y, f.y_offset), f.y_gain);
+    const __m256i b = clamp_q13(_mm256_add_epi32(luma, _mm256_mullo_epi32(u, f.u_b)), f);
+    const __m256i g = clamp_q13(
+        _mm256_sub_epi32(_mm256_sub_epi32(luma, _mm256_mullo_epi32(u, f.u_g)), _mm256_mullo_epi32(v, f.v_g)), f);
+    const __m256i r = clamp_q13(_mm256_add_epi32(luma, _mm256_mullo_epi32(v, f.v_r)), f);
+    const __m256i bgra = _mm256_or_si256(_mm256_or_si256(b, _mm256_slli_epi32(g, 8)),
+                                         _mm256_or_si256(_mm256_slli_epi32(r, 16), f.alpha));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), bgra);
+}
+
+} // namespace
+
+void convert_row_nv12_rgb32_avx2(const uint8_t* y, const uint8_t* uv, uint8_t* dst, uint32_t width,
+                                 const yuv_coefficients_t& k) noexcept {
+    const factors_t f{k};
+    // 8 UV pairs → U for 16 pixels in the low 8 byte of each half
+    const __m128i u_mask = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14);
+    const __m128i v_mask = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i y16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i c16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x));
+        const __m128i u16 = _mm_shuffle_epi8(c16, u_mask);
+        const __m128i v16 = _mm_shuffle_epi8(c16, v_mask);
+        store_8_pixels(dst + 4 * x, y16, u16, v16, f);
+        store_8_pixels(dst + 4 * x + 32, _mm_srli_si128(y16, 8), _mm_srli_si128(u16, 8), _mm_srli_si128(v16, 8), f);
+    }
+    convert_row_nv12_rgb32_scalar(y, uv, dst, x, width, k);
+}
+
+void convert_row_i420_rgb32_avx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width,
+                                 const yuv_coefficients_t& k) noexcept {
+    const factors_t f{k};
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i y16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+        const __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+        const __m128i u16 = _mm_unpacklo_epi8(u8, u8); // duplicate for the pixel pairs
+        const __m128i v16 = _mm_unpacklo_epi8(v8, v8);
+        store_8_pixels(dst + 4 * x, y16, u16, v16, f);
+        store_8_pixels(dst + 4 * x + 32, _mm_srli_si128(y16, 8), _mm_srli_si128(u16, 8), _mm_srli_si128(v16, 8), f);
+    }
+    convert_row_i420_rgb32_scalar(y, u, v, dst, x, width, k);
+}
@@ -0,0 +1,83 @@
+/**
+ * @note compiled with SSE 4.1. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+
+struct factors_t final {
+    __m128i y_offset, y_gain, v_r, u_g, v_g, u_b, round, alpha, zero, max;
+
+    explicit factors_t(const yuv_coefficients_t& k) noexcept
+        : y_offset{_mm_set1_epi32(k.y_offset)}, y_gain{_mm_set1_epi32(k.y_gain)}, v_r{_mm_set1_epi32(k.v_r)},
+          u_g{_mm_set1_epi32(k.u_g)}, v_g{_mm_set1_epi32(k.v_g)}, u_b{_mm_set1_epi32(k.u_b)},
+          round{_mm_set1_epi32(4096)}, alpha{_mm_set1_epi32(static_cast<int32_t>(0xFF00'0000u))}, zero{_mm_setzero_si128()},
+          max{_mm_set1_epi32(255)} {
+    }
+};
+
+__m128i clamp_q13(__m128i value, const factors_t& f) noexcept {
+    value = _mm_srai_epi32(_mm_add_epi32(value, f.round), 13);
+    return _mm_min_epi32(_mm_max_epi32(value, f.zero), f.max);
+}
+
+/// @param y 4 luma in 32 bit lanes
+/// @param u 4 chroma(already duplicated for the pixel pairs)
+void store_rgb32(uint8_t* dst, __m128i y, __m128i u, __m128i v, const factors_t& f) noexcept {
+    const __m128i luma = _mm_mullo_epi32(_mm_sub_epi32(y, f.y_offset), f.y_gain);
+    const __m128i b = clamp_q13(_mm_add_epi32(luma, _mm_mullo_epi32(u, f.u_b)), f);
+    const __m128i g = clamp_q13(
+        _mm_sub_epi32(_mm_sub_epi32(luma, _mm_mullo_epi32(u, f.u_g)), _mm_mullo_epi32(v, f.v_g)), f);
+    const __m128i r = clamp_q13(_mm_add_epi32(luma, _mm_mullo_epi32(v, f.v_r)), f);
+    const __m128i bgra = _mm_or_si128(_mm_or_si128(b, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(r, 16), f.alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), bgra);
+}
+
+/// @param u8 8 chroma for 8 pixels. 128 is subtracted here
+void store_8_pixels(uint8_t* dst, __m128i y8, __m128i u8, __m128i v8, const factors_t& f) noexcept {
+    const __m128i bias = _mm_set1_epi32(128);
+    store_rgb32(dst, _mm_cvtepu8_epi32(y8), _mm_sub_epi32(_mm_cvtepu8_epi32(u8), bias),
+                _mm_sub_epi32(_mm_cvtepu8_epi32(v8), bias), f);
+    store_rgb32(dst + 16, _mm_cvtepu8_epi32(_mm_srli_si128(y8, 4)),
+                _mm_sub_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(u8, 4)), bias),
+                _mm_sub_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(v8, 4)), bias), f);
+}
+
+__m128i load_4_bytes(const uint8_t* ptr) noexcept {
+    int32_t value = 0;
+    std::memcpy(&value, ptr, sizeof(value));
+    return _mm_cvtsi32_si128(value);
+}
+
+} // namespace
+
+void convert_row_nv12_rgb32_sse41(const uint8_t* y, const uint8_t* uv, uint8_t* dst, uint32_t width,
+                                  const yuv_coefficients_t& k) noexcept {
+    const factors_t f{k};
+    const __m128i u_mask = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i v_mask = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i y8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i c8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(uv + x)); // 4 UV pairs
+        store_8_pixels(dst + 4 * x, y8, _mm_shuffle_epi8(c8, u_mask), _mm_shuffle_epi8(c8, v_mask), f);
+    }
+    convert_row_nv12_rgb32_scalar(y, uv, dst, x, width, k);
+}
+
+void convert_row_i420_rgb32_sse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width,
+                                  const yuv_coefficients_t& k) noexcept {
+    const factors_t f{k};
+    const __m128i mask = _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, -1, -1, -1, -1, -1, -1, -1, -1);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i y8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i u4 = load_4_bytes(u + x / 2);
+        const __m128i v4 = load_4_bytes(v + x / 2);
+        store_8_pixels(dst + 4 * x, y8, _mm_shuffle_epi8(u4, mask), _mm_shuffle_epi8(v4, mask), f);
+    }
+    convert_row_i420_rgb32_scalar(y, u, v, dst, x, width, k);
+}
@@ -0,0 +1,22 @@
+/**
+ * @file    coroutine.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Coroutine types for both C++ 20 and the Coroutines TS(MSVC `/await`)
+ */
+#pragma once
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+
+using std::coroutine_handle;
+using std::suspend_always;
+using std::suspend_never;
+#elif __has_include(<experimental/coroutine>)
+#include <experimental/coroutine>
+
+// C++ 17 Coroutines TS
+using std::experimental::coroutine_handle;
+using std::experimental::suspend_always;
+using std::experimental::suspend_never;
+#else
+#error "requires C++ 20 coroutines or Coroutines TS"
+#endif
@@ -0,0 +1,173 @@
+#include "deinterlace.hpp"
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+using namespace std;
+
+deinterlace_t get_deinterlace(interlace_mode_t mode) noexcept {
+    switch (mode) {
+    case interlace_mode_t::upper_first:
+    case interlace_mode_t::lower_first:
+    case interlace_mode_t::mixed: // for the interlaced samples. see `deinterlacer_t::process`
+        return deinterlace_t::blend;
+    default:
+        return deinterlace_t::none;
+    }
+}
+
+uint32_t get_first_field(interlace_mode_t mode) noexcept {
+    return mode == interlace_mode_t::lower_first ? 1 : 0;
+}
+
+bool is_deinterlaceable(pixel_format_t format) noexcept {
+    return format == pixel_format_t::nv12 || format == pixel_format_t::nv21 || format == pixel_format_t::i420;
+}
+
+/**
+ * @details `alpha = min(max(motion - 4, 0), 16)`. The difference under 4 is the noise of the sensor.
+ *          The result is `(weave * (16 - alpha) + bob * alpha + 8) / 16`
+ */
+void blend_motion_scalar(const uint8_t* above, const uint8_t* below, const uint8_t* current,
+                         const uint8_t* previous, uint8_t* dst, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i) {
+        const int32_t bob = (above[i] + below[i] + 1) / 2;
+        const int32_t weave = current[i];
+        const int32_t motion = abs(weave - previous[i]);
+        const int32_t alpha = min(max(motion - 4, 0), 16);
+        dst[i] = static_cast<uint8_t>((weave * 16 + (bob - weave) * alpha + 8) >> 4);
+    }
+}
+
+namespace {
+
+/// @brief row kernels of 1 `simd_level_t`. the scalar ones are adapted to the same signature
+struct deinterlace_kernels_t final {
+    void (*average)(const uint8_t*, const uint8_t*, uint8_t*, uint32_t);
+    void (*blend)(const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, uint32_t);
+};
+
+const deinterlace_kernels_t scalar_kernels{
+    [](const uint8_t* a, const uint8_t* b, uint8_t* dst, uint32_t n) noexcept { average_scalar(a, b, dst, 0, n); },
+    [](const uint8_t* above, const uint8_t* below, const uint8_t* current, const uint8_t* previous, uint8_t* dst,
+       uint32_t n) noexcept { blend_motion_scalar(above, below, current, previous, dst, 0, n); },
+};
+
+#if defined(MEDIA_CORE_X86)
+const deinterlace_kernels_t sse41_kernels{&average_sse41, &blend_motion_sse41};
+const deinterlace_kernels_t avx2_kernels{&average_avx2, &blend_motion_avx2};
+#endif
+
+const deinterlace_kernels_t& get_deinterlace_kernels(simd_level_t level) noexcept {
+    switch (clamp_simd_level(level)) {
+#if defined(MEDIA_CORE_X86)
+    case simd_level_t::avx2:
+        return avx2_kernels;
+    case simd_level_t::sse41:
+        return sse41_kernels;
+#endif
+    default:
+        return scalar_kernels;
+    }
+}
+
+/// @param previous nullptr if it can't be used
+void deinterlace_plane(const plane_t& src, const plane_t* previous, const plane_t& dst, deinterlace_t method,
+                       uint32_t field, const deinterlace_kernels_t& k, row_range_t rows) noexcept {
+    const uint32_t end = min(rows.end, src.rows);
+    for (uint32_t y = rows.begin; y < end; ++y) {
+        const uint8_t* in = src.row(y);
+        uint8_t* out = dst.row(y);
+        const bool keep = method == deinterlace_t::none || method == deinterlace_t::weave || (y & 1) == field;
+        if (keep || src.rows == 1) {
+            if (in != out)
+                memcpy(out, in, src.row_bytes);
+            continue;
+        }
+        // the nearest rows of the kept field. the edge is repeated
+        const uint8_t* above = src.row(y > 0 ? y - 1 : y + 1);
+        const uint8_t* below = src.row(y + 1 < src.rows ? y + 1 : y - 1);
+        if (method == deinterlace_t::bob || previous == nullptr)
+            k.average(above, below, out, src.row_bytes);
+        else
+            k.blend(above, below, in, previous->row(y), out, src.row_bytes);
+    }
+}
+
+bool is_same_layout(const frame_view_t& lhs, const frame_view_t& rhs) noexcept {
+    return lhs.num_plane && lhs.num_plane == rhs.num_plane && lhs.format == rhs.format && lhs.width == rhs.width &&
+           lhs.height == rhs.height;
+}
+
+} // namespace
+
+bool deinterlace(const frame_view_t& src, const frame_view_t& previous, const frame_view_t& dst,
+                 deinterlace_t method, uint32_t field, simd_level_t level, row_range_t rows) noexcept {
+    if (is_deinterlaceable(src.format) == false || is_same_layout(src, dst) == false || field > 1)
+        return false;
+    const deinterlace_kernels_t& k = get_deinterlace_kernels(level);
+    const bool motion = is_same_layout(src, previous);
+    const row_range_t chroma_rows{rows.begin / 2, rows.end / 2 + rows.end % 2};
+    for (uint32_t i = 0; i < src.num_plane; ++i)
+        deinterlace_plane(src.planes[i], motion ? &previous.planes[i] : nullptr, dst.planes[i], method, field, k,
+                          i ? chroma_rows : rows);
+    return true;
+}
+
+deinterlacer_t::deinterlacer_t(interlace_mode_t mode) noexcept {
+    set_interlace_mode(mode);
+}
+
+void deinterlacer_t::set_interlace_mode(interlace_mode_t mode) noexcept {
+    set_method(get_deinterlace(mode), get_first_field(mode));
+    mixed = mode == interlace_mode_t::mixed;
+}
+
+void deinterlacer_t::set_method(deinterlace_t _method, uint32_t _field) noexcept {
+    method = _method;
+    field = _field & 1;
+    mixed = false;
+    previous = frame_buffer_t{};
+}
+
+deinterlace_t deinterlacer_t::get_method() const noexcept {
+    return method;
+}
+
+bool deinterlacer_t::process(const frame_view_t& src, const frame_view_t& dst, simd_level_t level) noexcept {
+    return process(src, dst, sample_fields_t{true, field == 1}, level);
+}
+
+bool deinterlacer_t::process(const frame_view_t& src, const frame_view_t& dst, sample_fields_t fields,
+                             simd_level_t level) noexcept {
+    // the rows of the `src` are kept for the next call
+    if (method == deinterlace_t::blend && src.planes[0].data == dst.planes[0].data)
+        return false;
+    deinterlace_t current = method;
+    uint32_t parity = field;
+    if (mixed) {
+        current = fields.interlaced ? deinterlace_t::blend : deinterlace_t::none;
+        parity = fields.lower_first ? 1 : 0;
+    }
+    if (deinterlace(src, previous.view(), dst, current, parity, level) == false)
+        return false;
+    if (method != deinterlace_t::blend)
+        return true;
+    try {
+        if (is_same_layout(src, previous.view()) == false)
+            previous = frame_buffer_t{src.format, src.width, src.height};
+    } catch (const exception&) { // bad_alloc, invalid_argument
+        previous = frame_buffer_t{};
+        return false;
+    }
+    for (uint32_t i = 0; i < src.num_plane; ++i) {
+        const plane_t& plane = src.planes[i];
+        for (uint32_t y = 0; y < plane.rows; ++y)
+            memcpy(previous.plane(i).row(y), plane.row(y), plane.row_bytes);
+    }
+    return true;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file    deinterlace.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Deinterlacing of NV12/I420 frames which hold both fields
+ * @see     https://docs.microsoft.com/en-us/windows/win32/medfound/video-interlacing
+ */
+#pragma once
+#include <frame_buffer.hpp>
+#include <simd.hpp>
+#include <slice.hpp>
+
+/// @brief `MFVideoInterlaceMode`. The values are same, so it can be casted from `MF_MT_INTERLACE_MODE`
+enum class interlace_mode_t : uint32_t {
+    unknown = 0,
+    progressive = 2,
+    upper_first = 3,  ///< the fields are interleaved. the upper field(even rows) is the first
+    lower_first = 4,  ///< the fields are interleaved. the lower field(odd rows) is the first
+    single_upper = 5, ///< 1 field in a sample. nothing to weave
+    single_lower = 6,
+    mixed = 7, ///< `MFSampleExtension_Interlaced` of each sample tells
+};
+
+enum class deinterlace_t : uint32_t {
+    none = 0, ///< copy the frame
+    weave,    ///< keep both fields. no loss for the static scene, but the moving edges are combed
+    bob,      ///< interpolate the rows of the other field from the kept field. no comb, but half of the resolution
+    blend,    ///< motion adaptive. weave for the static area, bob for the moving area
+};
+
+/**
+ * @return `blend` for the interleaved fields. `none` for the others
+ * @note   `mixed` returns `blend`. `deinterlacer_t` applies it only to the samples which tell they are interlaced
+ */
+deinterlace_t get_deinterlace(interlace_mode_t mode) noexcept;
+
+/// @return the parity of the rows of the first field. 1 for `lower_first`
+uint32_t get_first_field(interlace_mode_t mode) noexcept;
+
+/// @return true for the formats which `deinterlace` can process
+bool is_deinterlaceable(pixel_format_t format) noexcept;
+
+/**
+ * @brief Make a progressive frame from the `field` of the `src`. The rows of the `field` are kept
+ *
+ * @details The chroma rows of 4:2:0 are interlaced too, so each plane is processed with its own parity.
+ *          `blend` compares the other field with the `previous` frame. If the difference is small, the row of
+ *          the `src` is used as it is. The larger difference moves the result to `bob`.
+ * @param previous the last `src`. If it's empty or its format/size doesn't match, `blend` works like `bob`
+ * @param dst may be same with the `src`. It must not be the `previous`
+ * @param field 0 for the even rows, 1 for the odd rows. For 60 frames from 60 fields, call with both fields
+ * @param level `simd_level_t::scalar` for the reference. clamped with `clamp_simd_level`
+ * @param rows  of the `dst` to write. see `parallel_rows`
+ * @return false if the formats or the sizes don't match
+ */
+bool deinterlace(const frame_view_t& src, const frame_view_t& previous, const frame_view_t& dst,
+                 deinterlace_t method, uint32_t field = 0, simd_level_t level = get_simd_level(),
+                 row_range_t rows = all_rows) noexcept;
+
+/// @brief `MFSampleExtension_Interlaced` and `MFSampleExtension_BottomFieldFirst` of 1 sample
+struct sample_fields_t final {
+    bool interlaced = true;
+    bool lower_first = false;
+};
+
+/**
+ * @brief `deinterlace` with the negotiated `interlace_mode_t`. Keeps the previous frame for `blend`
+ * @note  The `frame_buffer_t` can't be shared, so the `src` is copied after the process
+ */
+class deinterlacer_t final {
+    deinterlace_t method = deinterlace_t::none;
+    uint32_t field = 0;
+    bool mixed = false; // `interlace_mode_t::mixed`. the `sample_fields_t` decides
+    frame_buffer_t previous{};
+
+  public:
+    explicit deinterlacer_t(interlace_mode_t mode = interlace_mode_t::unknown) noexcept;
+
+    /// @note the previous frame is dropped
+    void set_interlace_mode(interlace_mode_t mode) noexcept;
+    /// @note the previous frame is dropped
+    void set_method(deinterlace_t method, uint32_t field = 0) noexcept;
+    deinterlace_t get_method() const noexcept;
+
+    /**
+     * @param dst must not be the `src` for `deinterlace_t::blend`
+     * @return false if `deinterlace` fails or the previous frame can't be allocated
+     * @note   For `interlace_mode_t::mixed`, every sample is treated as interlaced with the upper field first
+     */
+    bool process(const frame_view_t& src, const frame_view_t& dst, simd_level_t level = get_simd_level()) noexcept;
+    /**
+     * @brief For `interlace_mode_t::mixed`, the `fields` of the sample select `blend` or the copy and the parity.
+     *        The other modes ignore the `fields`
+     * @note  The progressive sample is kept as the previous frame too
+     */
+    bool process(const frame_view_t& src, const frame_view_t& dst, sample_fields_t fields,
+                 simd_level_t level = get_simd_level()) noexcept;
+};
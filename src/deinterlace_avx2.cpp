@@ -0,0 +1,41 @@
+/**
+ * @note compiled with AVX2. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+__m256i load(const uint8_t* ptr) noexcept {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+
+/// @brief `(weave * 16 + (bob - weave) * alpha + 8) >> 4` of 16 pixels in 16 bit lanes
+__m256i mix(__m256i weave, __m256i bob, __m256i alpha) noexcept {
+    const __m256i sum =
+        _mm256_add_epi16(_mm256_slli_epi16(weave, 4), _mm256_mullo_epi16(_mm256_sub_epi16(bob, weave), alpha));
+    return _mm256_srai_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(8)), 4);
+}
+
+} // namespace
+
+void blend_motion_avx2(const uint8_t* above, const uint8_t* below, const uint8_t* current,
+                       const uint8_t* previous, uint8_t* dst, uint32_t count) noexcept {
+    const __m256i zero = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i bob = _mm256_avg_epu8(load(above + i), load(below + i));
+        const __m256i weave = load(current + i);
+        const __m256i last = load(previous + i);
+        const __m256i motion = _mm256_or_si256(_mm256_subs_epu8(weave, last), _mm256_subs_epu8(last, weave));
+        const __m256i alpha = _mm256_min_epu8(_mm256_subs_epu8(motion, _mm256_set1_epi8(4)), _mm256_set1_epi8(16));
+        // the unpack and the pack work in the same 128 bit lanes, so the order is kept
+        const __m256i lo = mix(_mm256_unpacklo_epi8(weave, zero), _mm256_unpacklo_epi8(bob, zero),
+                               _mm256_unpacklo_epi8(alpha, zero));
+        const __m256i hi = mix(_mm256_unpackhi_epi8(weave, zero), _mm256_unpackhi_epi8(bob, zero),
+                               _mm256_unpackhi_epi8(alpha, zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    blend_motion_scalar(above, below, current, previous, dst, i, count);
+}
@@ -0,0 +1,39 @@
+/**
+ * @note compiled with SSE 4.1. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+__m128i load(const uint8_t* ptr) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+
+/// @brief `(weave * 16 + (bob - weave) * alpha + 8) >> 4` of 8 pixels in 16 bit lanes
+__m128i mix(__m128i weave, __m128i bob, __m128i alpha) noexcept {
+    const __m128i sum = _mm_add_epi16(_mm_slli_epi16(weave, 4), _mm_mullo_epi16(_mm_sub_epi16(bob, weave), alpha));
+    return _mm_srai_epi16(_mm_add_epi16(sum, _mm_set1_epi16(8)), 4);
+}
+
+} // namespace
+
+void blend_motion_sse41(const uint8_t* above, const uint8_t* below, const uint8_t* current,
+                        const uint8_t* previous, uint8_t* dst, uint32_t count) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bob = _mm_avg_epu8(load(above + i), load(below + i));
+        const __m128i weave = load(current + i);
+        const __m128i last = load(previous + i);
+        const __m128i motion = _mm_or_si128(_mm_subs_epu8(weave, last), _mm_subs_epu8(last, weave));
+        const __m128i alpha = _mm_min_epu8(_mm_subs_epu8(motion, _mm_set1_epi8(4)), _mm_set1_epi8(16));
+        const __m128i lo = mix(_mm_unpacklo_epi8(weave, zero), _mm_unpacklo_epi8(bob, zero),
+                               _mm_unpacklo_epi8(alpha, zero));
+        const __m128i hi = mix(_mm_unpackhi_epi8(weave, zero), _mm_unpackhi_epi8(bob, zero),
+                               _mm_unpackhi_epi8(alpha, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    blend_motion_scalar(above, below, current, previous, dst, i, count);
+}
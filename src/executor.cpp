@@ -0,0 +1,198 @@
+#include "executor.hpp"
+
+#include <deque>
+#include <exception>
+#include <thread>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+struct executor_t::worker_t final {
+    mutex mtx{};
+    deque<job_t> jobs{};
+    thread handle{};
+};
+
+static thread_local const executor_t* current_executor = nullptr;
+static thread_local size_t current_index = executor_t::any_worker;
+
+/// @note failure is ignored. it's only a hint for the scheduler
+static void pin_current_thread(size_t cpu) noexcept {
+    const size_t num_cpu = thread::hardware_concurrency();
+    if (num_cpu == 0)
+        return;
+    cpu %= num_cpu;
+#if defined(_WIN32)
+    if (cpu < sizeof(DWORD_PTR) * 8)
+        SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << cpu);
+#elif defined(__linux__)
+    cpu_set_t cpus{};
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+}
+
+executor_t::executor_t(size_t count, bool pin) noexcept(false)
+    : num_worker{count ? count : max(1u, thread::hardware_concurrency())},
+      workers{make_unique<worker_t[]>(num_worker)} {
+    try {
+        for (size_t i = 0; i < num_worker; ++i)
+            workers[i].handle = thread{[this, i, pin]() {
+                if (pin)
+                    pin_current_thread(i);
+                run(i);
+            }};
+    } catch (...) {
+        {
+            lock_guard lck{mtx};
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (size_t i = 0; i < num_worker; ++i)
+            if (workers[i].handle.joinable())
+                workers[i].handle.join();
+        throw;
+    }
+}
+
+executor_t::~executor_t() noexcept {
+    {
+        lock_guard lck{mtx};
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (size_t i = 0; i < num_worker; ++i)
+        workers[i].handle.join();
+}
+
+size_t executor_t::current_worker() const noexcept {
+    return current_executor == this ? current_index : any_worker;
+}
+
+void executor_t::submit(job_t job, size_t hint) noexcept(false) {
+    size_t target = hint;
+    if (target == any_worker)
+        target = current_executor == this ? current_index : round_robin++;
+    worker_t& worker = workers[target % num_worker];
+    {
+        // count first. the job can be taken right after the push
+        lock_guard lck{mtx};
+        ++pending;
+    }
+    try {
+        lock_guard lck{worker.mtx};
+        worker.jobs.emplace_back(move(job));
+    } catch (...) {
+        --pending;
+        throw;
+    }
+    ++submitted;
+    wakeup.notify_one();
+}
+
+bool executor_t::try_take(size_t index, job_t& job) noexcept {
+    // the newest job of its own deque. probably the data is still in the cache
+    if (index < num_worker) {
+        worker_t& worker = workers[index];
+        lock_guard lck{worker.mtx};
+        if (worker.jobs.empty() == false) {
+            job = move(worker.jobs.back());
+            worker.jobs.pop_back();
+            --pending;
+            return true;
+        }
+    }
+    // steal the oldest job of the others
+    const size_t start = index < num_worker ? index + 1 : round_robin.load(memory_order_relaxed);
+    for (size_t i = 0; i < num_worker; ++i) {
+        const size_t victim = (start + i) % num_worker;
+        if (victim == index)
+            continue;
+        worker_t& worker = workers[victim];
+        unique_lock lck{worker.mtx, try_to_lock};
+        if (lck.owns_lock() == false || worker.jobs.empty())
+            continue;
+        job = move(worker.jobs.front());
+        worker.jobs.pop_front();
+        --pending;
+        ++stolen;
+        return true;
+    }
+    return false;
+}
+
+void executor_t::run(size_t index) noexcept {
+    current_executor = this;
+    current_index = index;
+    job_t job{};
+    while (true) {
+        if (try_take(index, job)) {
+            job(); // must not throw
+            job = nullptr;
+            ++executed;
+            continue;
+        }
+        unique_lock lck{mtx};
+        wakeup.wait(lck, [this]() { return stopping || pending > 0; });
+        if (stopping && pending == 0)
+            return;
+    }
+}
+
+void executor_t::parallel_for(size_t count, const function<void(size_t)>& fn) noexcept(false) {
+    if (count == 0)
+        return;
+    atomic_size_t remaining{count};
+    mutex error_mtx{};
+    exception_ptr error{};
+    auto invoke = [&](size_t i) noexcept {
+        try {
+            fn(i);
+        } catch (...) {
+            lock_guard lck{error_mtx};
+            if (error == nullptr)
+                error = current_exception();
+        }
+        remaining.fetch_sub(1, memory_order_release);
+    };
+    size_t i = 1;
+    try {
+        for (; i < count; ++i)
+            submit([&invoke, i]() { invoke(i); }, i % num_worker);
+    } catch (...) {
+        // the submitted jobs are referencing this frame. wait for them
+        remaining.fetch_sub(count - i, memory_order_release);
+        lock_guard lck{error_mtx};
+        error = current_exception();
+    }
+    invoke(0);
+
+    const size_t self = current_worker();
+    job_t job{};
+    while (remaining.load(memory_order_acquire) > 0) {
+        if (try_take(self, job)) {
+            job();
+            job = nullptr;
+        } else {
+            this_thread::yield();
+        }
+    }
+    if (error)
+        rethrow_exception(error);
+}
+
+executor_stats_t executor_t::stats() const noexcept {
+    executor_stats_t result{};
+    result.submitted = submitted.load();
+    result.executed = executed.load();
+    result.stolen = stolen.load();
+    return result;
+}
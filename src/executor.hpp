@@ -0,0 +1,91 @@
+/**
+ * @file    executor.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Work-stealing thread pool for the stages and slice-parallel kernels
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/// @brief Counters to check the load balance of `executor_t`
+struct executor_stats_t final {
+    uint64_t submitted = 0;
+    uint64_t executed = 0; ///< jobs executed by the workers. `parallel_for` callers are not counted
+    uint64_t stolen = 0;   ///< jobs taken from other workers' deque
+};
+
+/**
+ * @brief Thread pool with per-worker deques
+ *
+ * @details The owner takes the newest job from the back of its deque(cache hot),
+ *          and idle workers steal the oldest one from the front of others.
+ *          The affinity hint places a job in a specific worker's deque, so the jobs on the same data
+ *          (e.g. a pipeline stage, the same slice of the frames) tend to run on the same core.
+ * @note    The jobs given with `submit` must not throw. `parallel_for` propagates the exception
+ */
+class executor_t final {
+  public:
+    using job_t = std::function<void()>;
+    static constexpr size_t any_worker = SIZE_MAX;
+
+    struct worker_t;
+
+  private:
+    size_t num_worker;
+    std::unique_ptr<worker_t[]> workers;
+    std::atomic_size_t round_robin{0};
+    std::mutex mtx{}; // for sleep/wake up
+    std::condition_variable wakeup{};
+    std::atomic_size_t pending{0}; // jobs in the deques
+    bool stopping = false;
+    std::atomic_uint64_t submitted{0};
+    std::atomic_uint64_t executed{0};
+    std::atomic_uint64_t stolen{0};
+
+  public:
+    /**
+     * @param num_worker 0 uses `std::thread::hardware_concurrency`
+     * @param pin        bind the worker `i` to the CPU `i`. ignored if not supported
+     * @throw std::system_error
+     */
+    explicit executor_t(size_t num_worker = 0, bool pin = false) noexcept(false);
+    /// @note waits the jobs in the deques
+    ~executor_t() noexcept;
+    executor_t(const executor_t&) = delete;
+    executor_t(executor_t&&) = delete;
+    executor_t& operator=(const executor_t&) = delete;
+    executor_t& operator=(executor_t&&) = delete;
+
+    size_t size() const noexcept {
+        return num_worker;
+    }
+
+    /**
+     * @param hint  index of the preferred worker(modulo `size()`).
+     *              If `any_worker`, the current worker's deque or the round robin
+     */
+    void submit(job_t job, size_t hint = any_worker) noexcept(false);
+
+    /**
+     * @brief Run `fn(0)` ... `fn(count - 1)` and wait for all of them
+     *
+     * @details The index `i` is hinted to the worker `i % size()`. The caller thread runs the index 0
+     *          and then helps the workers, so a nested `parallel_for` in a job doesn't deadlock.
+     * @throw the first exception from the `fn`
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn) noexcept(false);
+
+    /// @return index of the current worker thread. `any_worker` if the caller is not a worker of this executor
+    size_t current_worker() const noexcept;
+
+    executor_stats_t stats() const noexcept;
+
+  private:
+    void run(size_t index) noexcept;
+    bool try_take(size_t index, job_t& job) noexcept;
+};
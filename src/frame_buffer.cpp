@@ -0,0 +1,121 @@
+#include "frame_buffer.hpp"
+#include "pixel_traits.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+using namespace std;
+
+frame_view_t make_frame_view(pixel_format_t format, uint32_t width, uint32_t height, //
+                             uint8_t* data, size_t pitch) noexcept {
+    frame_view_t view{format, width, height};
+    const pixel_traits_t traits = get_pixel_traits(format);
+    const auto row_bytes = static_cast<uint32_t>(get_row_bytes(traits, width));
+    if (row_bytes == 0 || pitch < row_bytes)
+        return view;
+    for (uint32_t i = 0; i < traits.num_plane; ++i) {
+        plane_t& plane = view.planes[i];
+        plane.pitch = get_plane_pitch(traits, pitch, i);
+        if (plane.pitch == 0) // the chroma planes of i420 need the even pitch
+            return view;
+        plane.data = i ? view.planes[i - 1].data + view.planes[i - 1].pitch * view.planes[i - 1].rows : data;
+        plane.row_bytes = static_cast<uint32_t>(get_row_bytes(traits, width, i));
+        plane.rows = get_plane_rows(traits, height, i);
+    }
+    view.num_plane = traits.num_plane;
+    return view;
+}
+
+size_t get_frame_size(pixel_format_t format, uint32_t height, size_t pitch) noexcept {
+    const pixel_traits_t traits = get_pixel_traits(format);
+    size_t total = 0;
+    for (uint32_t i = 0; i < traits.num_plane; ++i)
+        total += get_plane_pitch(traits, pitch, i) * get_plane_rows(traits, height, i);
+    return total;
+}
+
+size_t get_contiguous_size(const frame_view_t& view) noexcept {
+    size_t total = 0;
+    for (auto i = 0u; i < view.num_plane; ++i)
+        total += static_cast<size_t>(view.planes[i].row_bytes) * view.planes[i].rows;
+    return total;
+}
+
+bool copy_to_contiguous(const frame_view_t& view, uint8_t* dst, size_t capacity) noexcept {
+    if (capacity < get_contiguous_size(view))
+        return false;
+    for (auto i = 0u; i < view.num_plane; ++i) {
+        const plane_t& plane = view.planes[i];
+        for (auto y = 0u; y < plane.rows; ++y, dst += plane.row_bytes)
+            memcpy(dst, plane.row(y), plane.row_bytes);
+    }
+    return true;
+}
+
+bool copy_from_contiguous(const frame_view_t& view, const uint8_t* src, size_t length) noexcept {
+    if (length < get_contiguous_size(view))
+        return false;
+    for (auto i = 0u; i < view.num_plane; ++i) {
+        const plane_t& plane = view.planes[i];
+        for (auto y = 0u; y < plane.rows; ++y, src += plane.row_bytes)
+            memcpy(plane.row(y), src, plane.row_bytes);
+    }
+    return true;
+}
+
+size_t get_aligned_pitch(pixel_format_t format, uint32_t width, size_t min_pitch) noexcept {
+    // the chroma planes of i420 use the half of the pitch. they must be aligned too
+    const pixel_traits_t traits = get_pixel_traits(format);
+    size_t unit = frame_buffer_t::alignment;
+    if (traits.num_plane > 1 && get_plane_pitch(traits, unit, 1) < unit)
+        unit <<= traits.shift_x;
+    const size_t pitch = max(min_pitch, get_row_bytes(traits, width));
+    return (pitch + unit - 1) / unit * unit;
+}
+
+/// @throw std::invalid_argument
+static size_t get_aligned_frame_size(pixel_format_t format, uint32_t width, uint32_t height,
+                                     size_t pitch) noexcept(false) {
+    if (width == 0 || height == 0 || get_pixel_traits(format).num_plane == 0)
+        throw invalid_argument{"frame_buffer_t: unsupported format or size"};
+    return get_frame_size(format, height, pitch);
+}
+
+frame_buffer_t::frame_buffer_t(pixel_format_t format, uint32_t width, uint32_t height, size_t min_pitch) noexcept(false) {
+    const size_t pitch = get_aligned_pitch(format, width, min_pitch);
+    const size_t bufsz = get_aligned_frame_size(format, width, height, pitch);
+    auto holder = make_unique<frame_block_t>();
+    holder->data = aligned_allocate(bufsz, alignment);
+    if (holder->data == nullptr)
+        throw bad_alloc{};
+    holder->size = bufsz;
+    holder->alignment = alignment;
+    // if the control block's allocation fails, the deleter is invoked
+    block = shared_ptr<frame_block_t>{holder.release(), [](frame_block_t* block) {
+                                          aligned_deallocate(block->data);
+                                          delete block;
+                                      }};
+    view_ = make_frame_view(format, width, height, static_cast<uint8_t*>(block->data), pitch);
+}
+
+frame_buffer_t::frame_buffer_t(frame_pool_t& pool, pixel_format_t format, uint32_t width, uint32_t height,
+                               size_t min_pitch) noexcept(false) {
+    const size_t pitch = get_aligned_pitch(format, width, min_pitch);
+    block = pool.acquire(get_aligned_frame_size(format, width, height, pitch), alignment);
+    if (block == nullptr)
+        throw bad_alloc{};
+    view_ = make_frame_view(format, width, height, static_cast<uint8_t*>(block->data), pitch);
+}
+
+size_t frame_buffer_t::size() const noexcept {
+    return get_frame_size(view_.format, view_.height, pitch());
+}
+
+bool frame_buffer_t::is_contiguous() const noexcept {
+    for (auto i = 0u; i < view_.num_plane; ++i)
+        if (view_.planes[i].pitch != view_.planes[i].row_bytes)
+            return false;
+    return true;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file    frame_buffer.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Aligned, stride-padded video frame memory
+ */
+#pragma once
+#include <frame_pool.hpp>
+#include <pixel_format.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// @brief Non-owning reference to the rows of 1 plane
+struct plane_t final {
+    uint8_t* data = nullptr;
+    size_t pitch = 0;      ///< bytes between the start of 2 rows. Greater or equal to `row_bytes`
+    uint32_t row_bytes = 0; ///< bytes of pixels in a row (without padding)
+    uint32_t rows = 0;
+
+    uint8_t* row(uint32_t y) const noexcept {
+        return data + y * pitch;
+    }
+};
+
+/// @brief Non-owning reference to the planes of a video frame
+struct frame_view_t final {
+    pixel_format_t format = pixel_format_t::unknown;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t num_plane = 0;
+    plane_t planes[3]{};
+};
+
+/**
+ * @brief Describe the planes in the memory. Uses same layout with `IMF2DBuffer`
+ *
+ * @details The planes are placed one after another. For `i420`, the chroma planes use the half of `pitch`.
+ * @param data  memory which starts with the first plane(scanline 0)
+ * @param pitch bytes between rows of the first plane
+ * @return `num_plane` is 0 if the format is not supported or `pitch` is too small
+ */
+frame_view_t make_frame_view(pixel_format_t format, uint32_t width, uint32_t height, //
+                             uint8_t* data, size_t pitch) noexcept;
+
+/// @brief bytes for the frame in `make_frame_view` layout
+size_t get_frame_size(pixel_format_t format, uint32_t height, size_t pitch) noexcept;
+
+/// @brief bytes for the frame without row padding
+size_t get_contiguous_size(const frame_view_t& view) noexcept;
+
+/// @brief copy planes into a memory without row padding
+/// @return false if `capacity` is not enough
+bool copy_to_contiguous(const frame_view_t& view, uint8_t* dst, size_t capacity) noexcept;
+
+/// @brief copy a memory without row padding into the planes
+/// @return false if `length` is not enough
+bool copy_from_contiguous(const frame_view_t& view, const uint8_t* src, size_t length) noexcept;
+
+/**
+ * @brief Video frame with 64 byte aligned rows and padded pitch.
+ *
+ * @details Each row of the planes starts at 64 byte alignment and the padding after the row belongs to the
+ *          buffer, so SIMD kernels can load/store full vectors without handling the tail of the row.
+ */
+class frame_buffer_t final {
+    std::shared_ptr<frame_block_t> block{};
+    frame_view_t view_{};
+
+  public:
+    static constexpr size_t alignment = 64;
+
+  public:
+    frame_buffer_t() noexcept = default;
+    /**
+     * @param min_pitch if 0, the row size of the first plane is used. rounded up to `alignment`
+     * @throw std::invalid_argument for unsupported format or zero sized frame
+     * @throw std::bad_alloc
+     */
+    frame_buffer_t(pixel_format_t format, uint32_t width, uint32_t height, size_t min_pitch = 0) noexcept(false);
+    /// @note the memory is acquired from the `pool`
+    frame_buffer_t(frame_pool_t& pool, pixel_format_t format, uint32_t width, uint32_t height,
+                   size_t min_pitch = 0) noexcept(false);
+    ~frame_buffer_t() noexcept = default;
+    frame_buffer_t(const frame_buffer_t&) = delete;
+    frame_buffer_t(frame_buffer_t&&) noexcept = default;
+    frame_buffer_t& operator=(const frame_buffer_t&) = delete;
+    frame_buffer_t& operator=(frame_buffer_t&&) noexcept = default;
+
+    const frame_view_t& view() const noexcept {
+        return view_;
+    }
+    pixel_format_t format() const noexcept {
+        return view_.format;
+    }
+    uint32_t width() const noexcept {
+        return view_.width;
+    }
+    uint32_t height() const noexcept {
+        return view_.height;
+    }
+    const plane_t& plane(uint32_t index) const noexcept {
+        return view_.planes[index];
+    }
+    /// @brief scanline 0 of the first plane
+    uint8_t* data() const noexcept {
+        return view_.planes[0].data;
+    }
+    size_t pitch() const noexcept {
+        return view_.planes[0].pitch;
+    }
+    /// @brief bytes of all planes including row padding
+    size_t size() const noexcept;
+    /// @brief true if the rows have no padding
+    bool is_contiguous() const noexcept;
+};
+
+/// @brief pitch which keeps all planes' rows aligned with `frame_buffer_t::alignment`
+size_t get_aligned_pitch(pixel_format_t format, uint32_t width, size_t min_pitch = 0) noexcept;
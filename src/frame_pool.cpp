@@ -0,0 +1,138 @@
+#include "frame_pool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+void* aligned_allocate(size_t size, size_t alignment) noexcept {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        return nullptr;
+    if (alignment < sizeof(void*))
+        alignment = sizeof(void*);
+    size = (size + alignment - 1) & ~(alignment - 1); // std::aligned_alloc requires multiple of alignment
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, alignment);
+#else
+    return std::aligned_alloc(alignment, size);
+#endif
+}
+
+void aligned_deallocate(void* ptr) noexcept {
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+struct frame_pool_t::state_t final {
+    using key_t = pair<size_t, size_t>; // size, alignment
+
+    mutex mtx{};
+    map<key_t, vector<void*>> idle{};
+    size_t max_cached_bytes = 0;
+    frame_pool_stats_t counters{};
+
+  public:
+    explicit state_t(size_t capacity) noexcept : max_cached_bytes{capacity} {
+    }
+    ~state_t() noexcept {
+        trim();
+    }
+
+    void trim() noexcept {
+        lock_guard lck{mtx};
+        for (auto& [key, blocks] : idle)
+            for (void* ptr : blocks)
+                aligned_deallocate(ptr);
+        idle.clear();
+        counters.cached = 0;
+        counters.cached_bytes = 0;
+    }
+
+    /// @return nullptr if there is no cached block
+    void* take(const key_t& key) noexcept {
+        lock_guard lck{mtx};
+        void* ptr = nullptr;
+        if (auto it = idle.find(key); it != idle.end() && it->second.empty() == false) {
+            ptr = it->second.back();
+            it->second.pop_back();
+            counters.hit += 1;
+            counters.cached -= 1;
+            counters.cached_bytes -= key.first;
+        } else {
+            counters.miss += 1;
+        }
+        counters.outstanding += 1;
+        counters.high_water = max(counters.high_water, counters.outstanding);
+        return ptr;
+    }
+
+    void give_back(void* ptr, const key_t& key) noexcept {
+        unique_lock lck{mtx};
+        counters.outstanding -= 1;
+        if (ptr == nullptr)
+            return;
+        if (counters.cached_bytes + key.first <= max_cached_bytes) {
+            try {
+                idle[key].emplace_back(ptr);
+                counters.recycled += 1;
+                counters.cached += 1;
+                counters.cached_bytes += key.first;
+                return;
+            } catch (const bad_alloc&) {
+                // fallthrough. the block can't be cached
+            }
+        }
+        counters.discarded += 1;
+        lck.unlock();
+        aligned_deallocate(ptr);
+    }
+};
+
+frame_pool_t::frame_pool_t(size_t max_cached_bytes) noexcept(false)
+    : state{make_shared<state_t>(max_cached_bytes)} {
+}
+
+shared_ptr<frame_block_t> frame_pool_t::acquire(size_t size, size_t alignment) noexcept {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        return nullptr;
+    const state_t::key_t key{(size + alignment - 1) & ~(alignment - 1), alignment};
+
+    void* ptr = state->take(key);
+    if (ptr == nullptr)
+        ptr = aligned_allocate(key.first, key.second);
+    if (ptr == nullptr) {
+        state->give_back(nullptr, key);
+        return nullptr;
+    }
+    auto* block = new (nothrow) frame_block_t{ptr, key.first, key.second};
+    if (block == nullptr) {
+        state->give_back(ptr, key);
+        return nullptr;
+    }
+    try {
+        // the deleter holds the state, so the block can be recycled after the pool's destruction
+        return shared_ptr<frame_block_t>{block, [s = state, key](frame_block_t* block) {
+                                             s->give_back(block->data, key);
+                                             delete block;
+                                         }};
+    } catch (const bad_alloc&) {
+        return nullptr; // the deleter is already invoked
+    }
+}
+
+frame_pool_stats_t frame_pool_t::stats() const noexcept {
+    lock_guard lck{state->mtx};
+    return state->counters;
+}
+
+void frame_pool_t::trim() noexcept {
+    state->trim();
+}
@@ -0,0 +1,72 @@
+/**
+ * @file    frame_pool.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Recycling allocator for video frame memory
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// @brief to avoid false sharing between the threads. `std::hardware_destructive_interference_size` is not portable
+constexpr size_t cache_line_size = 64;
+
+/**
+ * @brief Allocate memory with the alignment
+ * @param alignment must be a power of 2
+ * @return nullptr if the allocation failed
+ * @see aligned_deallocate
+ */
+void* aligned_allocate(size_t size, size_t alignment) noexcept;
+void aligned_deallocate(void* ptr) noexcept;
+
+/// @brief A memory block from `frame_pool_t`. Recycled when the last `shared_ptr` is released
+struct frame_block_t final {
+    void* data = nullptr;
+    size_t size = 0;      ///< usable bytes. rounded up with the `alignment`
+    size_t alignment = 0; ///< `data` is aligned with this value
+};
+
+/// @brief Counters to size the `frame_pool_t` in the production
+struct frame_pool_stats_t final {
+    uint64_t hit = 0;       ///< `acquire` which reused a cached block
+    uint64_t miss = 0;      ///< `acquire` which required a new allocation
+    uint64_t recycled = 0;  ///< released blocks which went back to the cache
+    uint64_t discarded = 0; ///< released blocks which were deallocated because the cache was full
+    size_t outstanding = 0; ///< blocks in use
+    size_t high_water = 0;  ///< the largest `outstanding` value so far
+    size_t cached = 0;      ///< idle blocks in the cache
+    size_t cached_bytes = 0;
+};
+
+/**
+ * @brief Bounded, thread-safe pool of aligned memory blocks. Keyed by (size, alignment)
+ * @note  Blocks may outlive the pool. The shared state is released with the last block
+ */
+class frame_pool_t final {
+  public:
+    struct state_t;
+
+  private:
+    std::shared_ptr<state_t> state;
+
+  public:
+    /// @param max_cached_bytes  upper bound of the idle blocks' total size
+    explicit frame_pool_t(size_t max_cached_bytes = 64 << 20) noexcept(false);
+    ~frame_pool_t() noexcept = default;
+    frame_pool_t(const frame_pool_t&) = delete;
+    frame_pool_t(frame_pool_t&&) = delete;
+    frame_pool_t& operator=(const frame_pool_t&) = delete;
+    frame_pool_t& operator=(frame_pool_t&&) = delete;
+
+    /**
+     * @param alignment must be a power of 2
+     * @return nullptr if the allocation failed
+     */
+    std::shared_ptr<frame_block_t> acquire(size_t size, size_t alignment = 64) noexcept;
+
+    frame_pool_stats_t stats() const noexcept;
+
+    /// @brief deallocate all idle blocks
+    void trim() noexcept;
+};
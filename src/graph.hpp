@@ -0,0 +1,284 @@
+/**
+ * @file    graph.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Declarative source → converters → stages → sink graph which negotiates the formats once
+ */
+#pragma once
+#include <pipeline.hpp>
+#include <pixel_format.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/// @brief 1 node in the resolved path
+struct graph_step_t final {
+    std::string name;
+    pixel_format_t input = pixel_format_t::unknown; ///< `unknown` for the source
+    pixel_format_t output = pixel_format_t::unknown; ///< `unknown` for the sink
+};
+
+/// @brief Result of the negotiation. The order of `steps` is the order of the pipeline stages
+struct graph_plan_t final {
+    std::vector<graph_step_t> steps{};
+    size_t conversions = 0; ///< number of the converters in the path
+    size_t copies = 0;      ///< sum of the converters' copies
+    size_t fusions = 0;     ///< number of the fused nodes in `steps`
+};
+
+/**
+ * @brief Declares the nodes and finds the path with the fewest conversions, then the fewest copies
+ *
+ * @details The source offers some formats and the sink accepts some formats. The stages(e.g. scaler) are always
+ *          in the path with the declared order, but they don't change the format. The converters are inserted only
+ *          when it's necessary. The negotiation is done once in `resolve`/`build`. The stages receive their
+ *          formats through the factories, so there is no type negotiation while the pipeline is running.
+ *          If the costs are the same, the earlier format in the source's offers is preferred.
+ * @code
+ * graph_builder_t<frame_t> graph{};
+ * graph.set_source("camera", {pixel_format_t::nv12, pixel_format_t::rgb32}, open_camera);
+ * graph.add_converter("nv12→rgb32", pixel_format_t::nv12, pixel_format_t::rgb32, make_converter);
+ * graph.add_stage("scaler", {pixel_format_t::nv12, pixel_format_t::rgb32}, make_scaler);
+ * graph.set_sink("display", {pixel_format_t::rgb32}, open_display);
+ * pipeline_t<frame_t> pipeline{2};
+ * graph_plan_t plan = graph.build(pipeline); // camera(rgb32) → scaler → display
+ * pipeline.start();
+ * pipeline.wait();
+ * @endcode
+ */
+template <typename T>
+class graph_builder_t final {
+  public:
+    using source_t = typename pipeline_t<T>::source_t;
+    using process_t = typename pipeline_t<T>::process_t;
+    using sink_t = typename pipeline_t<T>::sink_t;
+
+    /// @param format selected output of the source
+    using source_factory_t = std::function<source_t(pixel_format_t format)>;
+    using converter_factory_t = std::function<process_t()>;
+    /// @param format of both the input and the output
+    using stage_factory_t = std::function<process_t(pixel_format_t format)>;
+    /// @param format selected input of the sink
+    using sink_factory_t = std::function<sink_t(pixel_format_t format)>;
+    /// @param format input of the first step which is replaced
+    using fusion_factory_t = std::function<process_t(pixel_format_t format)>;
+
+  private:
+    struct endpoint_t final {
+        std::string name{};
+        std::vector<pixel_format_t> formats{};
+    };
+    struct converter_t final {
+        std::string name;
+        pixel_format_t input;
+        pixel_format_t output;
+        uint32_t copies;
+        converter_factory_t make;
+    };
+    struct stage_t final {
+        std::string name;
+        std::vector<pixel_format_t> formats;
+        stage_factory_t make;
+    };
+    struct fusion_t final {
+        std::string name;
+        std::vector<std::string> steps;
+        fusion_factory_t make;
+    };
+
+    /// @brief (number of the converters, copies, rank of the source format). smaller is better
+    using cost_t = std::tuple<size_t, size_t, size_t>;
+    /// @brief (format, number of the stages passed)
+    using state_t = std::pair<pixel_format_t, size_t>;
+    static constexpr size_t no_edge = SIZE_MAX;
+    struct visit_t final {
+        cost_t cost;
+        state_t prev;
+        size_t converter; ///< index of the converter from `prev`. `no_edge` if it's a stage or the start
+    };
+
+    endpoint_t source_node{};
+    source_factory_t make_source{};
+    std::vector<converter_t> converters{};
+    std::vector<stage_t> stages{};
+    std::vector<fusion_t> fusions{};
+    endpoint_t sink_node{};
+    sink_factory_t make_sink{};
+
+  public:
+    /// @param offers formats which the source can produce. the earlier one is preferred
+    void set_source(std::string name, std::vector<pixel_format_t> offers, source_factory_t fn) noexcept {
+        source_node = endpoint_t{std::move(name), std::move(offers)};
+        make_source = std::move(fn);
+    }
+    /// @param copies cost of the conversion. 0 if it doesn't touch the memory(e.g. I420 ⇄ IYUV)
+    void add_converter(std::string name, pixel_format_t input, pixel_format_t output, converter_factory_t fn,
+                       uint32_t copies = 1) noexcept(false) {
+        converters.emplace_back(converter_t{std::move(name), input, output, copies, std::move(fn)});
+    }
+    /// @param formats which the stage can process without conversion
+    void add_stage(std::string name, std::vector<pixel_format_t> formats, stage_factory_t fn) noexcept(false) {
+        stages.emplace_back(stage_t{std::move(name), std::move(formats), std::move(fn)});
+    }
+    /**
+     * @brief Replace the adjacent steps with 1 node if they are in the resolved path with the same order
+     * @details The negotiation doesn't know the fusions. They are applied to the path, so the formats don't change.
+     *          e.g. "crop" → "resize" → "nv12→rgb32" with `scaler_t::scale_to_rgb32`
+     * @param steps names of the stages or the converters. 2 or more
+     * @throw std::invalid_argument
+     */
+    void add_fusion(std::string name, std::vector<std::string> steps, fusion_factory_t fn) noexcept(false) {
+        if (steps.size() < 2)
+            throw std::invalid_argument{"graph_builder_t: fusion requires 2 or more steps"};
+        fusions.emplace_back(fusion_t{std::move(name), std::move(steps), std::move(fn)});
+    }
+    /// @param accepts formats which the sink can consume
+    void set_sink(std::string name, std::vector<pixel_format_t> accepts, sink_factory_t fn) noexcept {
+        sink_node = endpoint_t{std::move(name), std::move(accepts)};
+        make_sink = std::move(fn);
+    }
+
+    /**
+     * @brief Negotiate the formats of all nodes
+     * @throw std::logic_error if there is no source or no sink
+     * @throw std::runtime_error if there is no path from the source to the sink
+     */
+    graph_plan_t resolve() const noexcept(false) {
+        return search(nullptr);
+    }
+
+    /**
+     * @brief `resolve` and set the source/stages/sink of the `pipeline` with the factories
+     * @note  The `pipeline` must not be started
+     * @throw std::logic_error
+     * @throw std::runtime_error
+     */
+    graph_plan_t build(pipeline_t<T>& pipeline) const noexcept(false) {
+        std::vector<size_t> nodes{};
+        graph_plan_t plan = search(&nodes);
+        const std::vector<graph_step_t>& steps = plan.steps;
+        pipeline.set_source(make_source(steps.front().output));
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const graph_step_t& step = steps[i + 1];
+            if (nodes[i] < stages.size())
+                pipeline.add_stage(stages[nodes[i]].make(step.input));
+            else if (nodes[i] < stages.size() + converters.size())
+                pipeline.add_stage(converters[nodes[i] - stages.size()].make());
+            else
+                pipeline.add_stage(fusions[nodes[i] - stages.size() - converters.size()].make(step.input));
+        }
+        pipeline.set_sink(make_sink(steps.back().input));
+        return plan;
+    }
+
+  private:
+    static bool accepts(const std::vector<pixel_format_t>& formats, pixel_format_t format) noexcept {
+        return std::find(formats.begin(), formats.end(), format) != formats.end();
+    }
+
+    /// @param nodes for the steps between the source and the sink. index of the stage, `stages.size()` + index of the
+    ///              converter, or `stages.size()` + `converters.size()` + index of the fusion
+    graph_plan_t search(std::vector<size_t>* nodes) const noexcept(false) {
+        if (make_source == nullptr || make_sink == nullptr)
+            throw std::logic_error{"graph_builder_t: source and sink are required"};
+
+        // Dijkstra over (format, stages passed). the converters are the weighted edges
+        std::map<state_t, visit_t> visits{};
+        using entry_t = std::pair<cost_t, state_t>;
+        std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> candidates{};
+        auto relax = [&visits, &candidates](state_t next, cost_t cost, state_t prev, size_t converter) {
+            auto it = visits.find(next);
+            if (it != visits.end() && !(cost < it->second.cost))
+                return;
+            visits[next] = visit_t{cost, prev, converter};
+            candidates.emplace(cost, next);
+        };
+        for (size_t rank = 0; rank < source_node.formats.size(); ++rank) {
+            const state_t start{source_node.formats[rank], 0};
+            relax(start, cost_t{0, 0, rank}, start, no_edge);
+        }
+        const size_t num_stage = stages.size();
+        while (candidates.empty() == false) {
+            const auto [cost, current] = candidates.top();
+            candidates.pop();
+            if (visits.at(current).cost < cost) // outdated
+                continue;
+            const auto [format, passed] = current;
+            if (passed == num_stage && accepts(sink_node.formats, format))
+                return make_plan(visits, current, nodes);
+            if (passed < num_stage && accepts(stages[passed].formats, format))
+                relax(state_t{format, passed + 1}, cost, current, no_edge);
+            for (size_t i = 0; i < converters.size(); ++i) {
+                const converter_t& converter = converters[i];
+                if (converter.input != format)
+                    continue;
+                const cost_t next{std::get<0>(cost) + 1, std::get<1>(cost) + converter.copies, std::get<2>(cost)};
+                relax(state_t{converter.output, passed}, next, current, i);
+            }
+        }
+        throw std::runtime_error{"graph_builder_t: no path from '" + source_node.name + "' to '" + sink_node.name +
+                                 "'"};
+    }
+
+    graph_plan_t make_plan(const std::map<state_t, visit_t>& visits, state_t last, std::vector<size_t>* nodes) const
+        noexcept(false) {
+        graph_plan_t plan{};
+        std::vector<size_t> indices{};
+        plan.steps.emplace_back(graph_step_t{sink_node.name, last.first, pixel_format_t::unknown});
+        for (state_t current = last;;) {
+            const visit_t& visit = visits.at(current);
+            if (visit.prev == current) // the start
+                break;
+            if (visit.converter != no_edge) {
+                const converter_t& converter = converters[visit.converter];
+                plan.steps.emplace_back(graph_step_t{converter.name, converter.input, converter.output});
+                plan.conversions += 1;
+                plan.copies += converter.copies;
+                indices.emplace_back(stages.size() + visit.converter);
+            } else {
+                const stage_t& stage = stages[visit.prev.second];
+                indices.emplace_back(visit.prev.second);
+                plan.steps.emplace_back(graph_step_t{stage.name, current.first, current.first});
+            }
+            current = visit.prev;
+        }
+        const pixel_format_t start = plan.steps.back().input;
+        plan.steps.emplace_back(graph_step_t{source_node.name, pixel_format_t::unknown, start});
+        std::reverse(plan.steps.begin(), plan.steps.end());
+        std::reverse(indices.begin(), indices.end());
+        fuse(plan, indices);
+        if (nodes)
+            *nodes = std::move(indices);
+        return plan;
+    }
+
+    /// @param indices same with the `nodes` of `search`. `plan.steps` has the source and the sink more
+    void fuse(graph_plan_t& plan, std::vector<size_t>& indices) const noexcept(false) {
+        std::vector<graph_step_t>& steps = plan.steps;
+        for (size_t i = 1; i + 1 < steps.size(); ++i) {
+            for (size_t f = 0; f < fusions.size(); ++f) {
+                const std::vector<std::string>& names = fusions[f].steps;
+                if (i + names.size() >= steps.size()) // the sink is not fused
+                    continue;
+                bool matched = true;
+                for (size_t n = 0; n < names.size() && matched; ++n)
+                    matched = steps[i + n].name == names[n];
+                if (matched == false)
+                    continue;
+                const graph_step_t fused{fusions[f].name, steps[i].input, steps[i + names.size() - 1].output};
+                steps.erase(steps.begin() + i + 1, steps.begin() + i + names.size());
+                steps[i] = fused;
+                indices.erase(indices.begin() + i, indices.begin() + i + names.size() - 1);
+                indices[i - 1] = stages.size() + converters.size() + f;
+                plan.fusions += 1;
+                break;
+            }
+        }
+    }
+};
@@ -0,0 +1,76 @@
+#include "h264_nal.hpp"
+
+/// @return length of the start code at `data[i]`. 0 if there is none
+static size_t get_start_code_length(const uint8_t* data, size_t size, size_t i) noexcept {
+    if (i + 3 <= size && data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+        return 3;
+    if (i + 4 <= size && data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 0 && data[i + 3] == 1)
+        return 4;
+    return 0;
+}
+
+const uint8_t* next_nal_unit(const uint8_t* data, size_t size, size_t& offset, size_t& length) noexcept {
+    if (data == nullptr)
+        return nullptr;
+    size_t begin = offset;
+    for (; begin < size; ++begin) {
+        if (const size_t prefix = get_start_code_length(data, size, begin)) {
+            begin += prefix;
+            break;
+        }
+    }
+    if (begin >= size)
+        return nullptr;
+    size_t end = begin;
+    while (end < size && get_start_code_length(data, size, end) == 0)
+        ++end;
+    // trailing_zero_8bits are not the payload
+    while (end > begin && end < size && data[end - 1] == 0)
+        --end;
+    offset = end;
+    length = end - begin;
+    return data + begin;
+}
+
+bool is_non_reference_h264(const uint8_t* data, size_t size) noexcept {
+    size_t offset = 0, length = 0;
+    size_t count = 0;
+    while (const uint8_t* nal = next_nal_unit(data, size, offset, length)) {
+        if (length == 0)
+            continue;
+        const uint8_t ref_idc = (nal[0] >> 5) & 0b11;
+        const uint8_t type = nal[0] & 0b1'1111;
+        if (type != 1 && type != 5) // not a slice
+            continue;
+        if (type == 5 || ref_idc != 0)
+            return false;
+        ++count;
+    }
+    return count > 0;
+}
+
+bool is_non_reference_h264(const span_list_t& list) noexcept {
+    // the start code is searched byte by byte, so the pieces are not flattened
+    size_t zeros = 0;
+    bool header = false; // the next byte is the NAL unit header
+    size_t count = 0;
+    for (const byte_span_t& span : list) {
+        for (size_t i = 0; i < span.size; ++i) {
+            const uint8_t value = span.data[i];
+            if (header) {
+                header = false;
+                const uint8_t ref_idc = (value >> 5) & 0b11;
+                const uint8_t type = value & 0b1'1111;
+                if (type == 1 || type == 5) {
+                    if (type == 5 || ref_idc != 0)
+                        return false;
+                    ++count;
+                }
+            }
+            if (value == 1 && zeros >= 2)
+                header = true;
+            zeros = value == 0 ? zeros + 1 : 0;
+        }
+    }
+    return count > 0;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file    h264_nal.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Minimal H.264 Annex B inspection for the drop policies
+ */
+#pragma once
+#include <buffer_span.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Find the next NAL unit after the start code(`00 00 01` or `00 00 00 01`)
+ * @param offset in/out. position to start the search. the end of the returned unit
+ * @return nullptr if there is no more NAL unit
+ */
+const uint8_t* next_nal_unit(const uint8_t* data, size_t size, size_t& offset, size_t& length) noexcept;
+
+/**
+ * @brief Nobody refers to this access unit. Dropping it doesn't break the decoding of the others
+ * @details All VCL NAL units(type 1, 5) have `nal_ref_idc == 0`. IDR(type 5) is always a reference
+ * @return false if there is no VCL NAL unit. (e.g. SPS/PPS only)
+ */
+bool is_non_reference_h264(const uint8_t* data, size_t size) noexcept;
+
+/// @brief `is_non_reference_h264` for the access unit in pieces. The start codes may cross the boundaries
+bool is_non_reference_h264(const span_list_t& list) noexcept;
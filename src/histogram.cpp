@@ -0,0 +1,126 @@
+#include "histogram.hpp"
+#include "kernels.hpp"
+#include "pixel_traits.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+bool is_histogram_source(pixel_format_t format) noexcept {
+    return format == pixel_format_t::nv12 || format == pixel_format_t::rgb32;
+}
+
+void count_row_scalar(const uint8_t* src, uint32_t stride, uint32_t* bins, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i)
+        ++bins[src[i * stride]];
+}
+
+namespace {
+
+using count_row_t = void (*)(const uint8_t*, uint32_t, uint32_t (*)[256], uint32_t);
+
+count_row_t get_count_row(simd_level_t level) noexcept {
+    switch (level) {
+#if defined(MEDIA_CORE_X86)
+    case simd_level_t::avx2: // the counts are scattered, so the wider vector doesn't help
+    case simd_level_t::sse41:
+        return &count_row_sse41;
+#endif
+    default:
+        return [](const uint8_t* src, uint32_t stride, uint32_t(*bins)[256], uint32_t count) noexcept {
+            count_row_scalar(src, stride, bins[0], 0, count);
+        };
+    }
+}
+
+/// @brief the bins of 1 channel. `count_row_sse41` uses 4 tables to avoid the dependency between the increments
+struct channel_bins_t final {
+    uint32_t tables[4][256];
+};
+
+void fold(const channel_bins_t& bins, uint32_t* dst) noexcept {
+    for (uint32_t i = 0; i < 256; ++i)
+        dst[i] += bins.tables[0][i] + bins.tables[1][i] + bins.tables[2][i] + bins.tables[3][i];
+}
+
+/// @return the number of the samples to count in the row. `step` is the subsampling
+uint32_t get_sample_count(uint32_t width, uint32_t step) noexcept {
+    return (width + step - 1) / step;
+}
+
+/// @return the first multiple of `step` which is not less than `value`
+uint32_t align_up(uint32_t value, uint32_t step) noexcept {
+    return static_cast<uint32_t>((uint64_t{value} + step - 1) / step * step);
+}
+
+} // namespace
+
+bool compute_histogram(const frame_view_t& src, histogram_t& histogram, uint32_t step, simd_level_t level,
+                       row_range_t rows) noexcept {
+    if (is_histogram_source(src.format) == false || src.num_plane == 0 || step == 0)
+        return false;
+    histogram.width = src.width;
+    histogram.height = src.height;
+    histogram.fourcc = get_pixel_traits(src.format).fourcc;
+    const count_row_t count_row = get_count_row(clamp_simd_level(level));
+    channel_bins_t bins[3]{}; // 12 KB. fits in L1 with the rows
+
+    const uint32_t end = min(rows.end, src.height);
+    if (src.format == pixel_format_t::rgb32) {
+        histogram.channel_mask = histogram_channel_r | histogram_channel_g | histogram_channel_b;
+        const uint32_t count = get_sample_count(src.width, step);
+        for (uint32_t y = align_up(rows.begin, step); y < end; y += step) {
+            const uint8_t* row = src.planes[0].row(y); // B G R X
+            count_row(row + 2, 4 * step, bins[0].tables, count);
+            count_row(row + 1, 4 * step, bins[1].tables, count);
+            count_row(row + 0, 4 * step, bins[2].tables, count);
+        }
+    } else {
+        histogram.channel_mask = histogram_channel_y | histogram_channel_cr | histogram_channel_cb;
+        const uint32_t count = get_sample_count(src.width, step);
+        for (uint32_t y = align_up(rows.begin, step); y < end; y += step)
+            count_row(src.planes[0].row(y), step, bins[0].tables, count);
+        // the chroma row `cy` is counted with the luma row `2 * cy`
+        const plane_t& uv = src.planes[1];
+        const uint32_t chroma_count = get_sample_count(uv.row_bytes / 2, step);
+        const uint32_t chroma_end = min(end / 2 + end % 2, uv.rows);
+        for (uint32_t y = align_up(rows.begin / 2 + rows.begin % 2, step); y < chroma_end; y += step) {
+            count_row(uv.row(y) + 1, 2 * step, bins[1].tables, chroma_count);
+            count_row(uv.row(y) + 0, 2 * step, bins[2].tables, chroma_count);
+        }
+    }
+    fold(bins[0], histogram.p0);
+    fold(bins[1], histogram.p1);
+    fold(bins[2], histogram.p2);
+    return true;
+}
+
+bool compute_histogram(executor_t& executor, const frame_view_t& src, histogram_t& histogram, uint32_t step,
+                       simd_level_t level) noexcept(false) {
+    if (is_histogram_source(src.format) == false || src.num_plane == 0 || step == 0)
+        return false;
+    // the boundaries are the multiple of `2 * step`, so the sampled rows are same with 1 range
+    const vector<row_range_t> ranges = split_rows(src.height, 2 * step, max<size_t>(executor.size(), 1));
+    vector<histogram_t> partials(ranges.size(), histogram_t{});
+    executor.parallel_for(ranges.size(), [&](size_t i) {
+        compute_histogram(src, partials[i], step, level, ranges[i]);
+    });
+    for (const histogram_t& partial : partials)
+        merge_histogram(histogram, partial);
+    return true;
+}
+
+void merge_histogram(histogram_t& dst, const histogram_t& src) noexcept {
+    if (dst.channel_mask == 0) {
+        dst.width = src.width;
+        dst.height = src.height;
+        dst.channel_mask = src.channel_mask;
+        dst.fourcc = src.fourcc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        dst.p0[i] += src.p0[i];
+        dst.p1[i] += src.p1[i];
+        dst.p2[i] += src.p2[i];
+    }
+}
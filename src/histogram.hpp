@@ -0,0 +1,41 @@
+/**
+ * @file    histogram.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   256 bin histograms for the capture metadata
+ * @see     https://docs.microsoft.com/en-us/windows-hardware/drivers/stream/mf-capture-metadata-histogram
+ */
+#pragma once
+#include <executor.hpp>
+#include <frame_buffer.hpp>
+#include <histogram_metadata.hpp>
+#include <simd.hpp>
+#include <slice.hpp>
+
+#include <cstdint>
+
+/// @return true for `nv12` and `rgb32`
+bool is_histogram_source(pixel_format_t format) noexcept;
+
+/**
+ * @brief Count the samples of the `src` rows into the bins of the `histogram`
+ *
+ * @details NV12 fills Y/Cr/Cb and RGB32 fills R/G/B. The header of the `histogram` is set with the `src`.
+ *          The chroma row of NV12 is counted by the range which has its first luma row,
+ *          so the partial histograms of the disjoint ranges can be merged without the double count.
+ * @param step  subsampling. Every `step` sample of every `step` row is counted. 1 for all samples
+ * @param level `simd_level_t::scalar` for the reference. clamped with `clamp_simd_level`
+ * @param rows  of the `src` to count. see `split_rows`
+ * @return false if the format is not supported or `step` is 0
+ */
+bool compute_histogram(const frame_view_t& src, histogram_t& histogram, uint32_t step = 1,
+                       simd_level_t level = get_simd_level(), row_range_t rows = all_rows) noexcept;
+
+/**
+ * @brief `compute_histogram` with the `executor`. Each stripe counts into its own histogram and they are merged
+ * @throw std::bad_alloc
+ */
+bool compute_histogram(executor_t& executor, const frame_view_t& src, histogram_t& histogram, uint32_t step = 1,
+                       simd_level_t level = get_simd_level()) noexcept(false);
+
+/// @brief Add the bins of the `src` to the `dst`. The header of the `dst` is replaced if it's empty
+void merge_histogram(histogram_t& dst, const histogram_t& src) noexcept;
@@ -0,0 +1,32 @@
+/**
+ * @file    histogram_metadata.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   `METADATA_HISTOGRAM` record of the capture metadata
+ * @see     https://docs.microsoft.com/en-us/windows-hardware/drivers/stream/mf-capture-metadata-histogram
+ * @note    Plain data only, so the header-only `capture_metadata.hpp` doesn't pull the histogram kernels
+ */
+#pragma once
+#include <cstdint>
+
+/// @brief `MF_HISTOGRAM_CHANNEL_*`. The bits of `histogram_t::channel_mask`
+constexpr uint32_t histogram_channel_y = 0x01;
+constexpr uint32_t histogram_channel_r = 0x02;
+constexpr uint32_t histogram_channel_g = 0x04;
+constexpr uint32_t histogram_channel_b = 0x08;
+constexpr uint32_t histogram_channel_cb = 0x10;
+constexpr uint32_t histogram_channel_cr = 0x20;
+
+/**
+ * @brief Same layout with `METADATA_HISTOGRAM` of the capture metadata, so it can be copied as it is
+ * @note  Zero initialize it before `compute_histogram`. The bins are accumulated
+ */
+struct histogram_t final {
+    uint32_t width;
+    uint32_t height;
+    uint32_t channel_mask;
+    uint32_t fourcc;
+    uint32_t p0[256]; ///< R or Y
+    uint32_t p1[256]; ///< G or Cr(V)
+    uint32_t p2[256]; ///< B or Cb(U)
+};
+static_assert(sizeof(histogram_t) == 16 + 3 * 256 * 4);
@@ -0,0 +1,53 @@
+/**
+ * @note compiled with SSE 4.1. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+__m128i load(const void* ptr) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+
+/// @brief 16 samples of the `stride` from the `src`. reads `16 * stride` bytes
+__m128i gather(const uint8_t* src, uint32_t stride) noexcept {
+    if (stride == 1)
+        return load(src);
+    if (stride == 2) {
+        const __m128i mask = _mm_set1_epi16(0x00FF);
+        return _mm_packus_epi16(_mm_and_si128(load(src), mask), _mm_and_si128(load(src + 16), mask));
+    }
+    const __m128i mask = _mm_set1_epi32(0x000000FF);
+    const __m128i lo = _mm_packus_epi32(_mm_and_si128(load(src), mask), _mm_and_si128(load(src + 16), mask));
+    const __m128i hi = _mm_packus_epi32(_mm_and_si128(load(src + 32), mask), _mm_and_si128(load(src + 48), mask));
+    return _mm_packus_epi16(lo, hi);
+}
+
+/// @brief the adjacent samples go to the different tables, so the increments of the same value don't wait
+void count_samples(uint32_t samples, uint32_t (*bins)[256]) noexcept {
+    ++bins[0][samples & 0xFF];
+    ++bins[1][(samples >> 8) & 0xFF];
+    ++bins[2][(samples >> 16) & 0xFF];
+    ++bins[3][samples >> 24];
+}
+
+} // namespace
+
+void count_row_sse41(const uint8_t* src, uint32_t stride, uint32_t (*bins)[256], uint32_t count) noexcept {
+    uint32_t i = 0;
+    if (stride == 1 || stride == 2 || stride == 4) {
+        // the last load reads the bytes after the last sample of the stride. keep 1 sample after them
+        const uint32_t end = stride == 1 ? count : count - (count > 0);
+        for (; i + 16 <= end; i += 16) {
+            const __m128i samples = gather(src + i * stride, stride);
+            // 32 bit extracts. the 64 bit ones are not available for the 32 bit x86
+            count_samples(static_cast<uint32_t>(_mm_cvtsi128_si32(samples)), bins);
+            count_samples(static_cast<uint32_t>(_mm_extract_epi32(samples, 1)), bins);
+            count_samples(static_cast<uint32_t>(_mm_extract_epi32(samples, 2)), bins);
+            count_samples(static_cast<uint32_t>(_mm_extract_epi32(samples, 3)), bins);
+        }
+    }
+    count_row_scalar(src, stride, bins[0], i, count);
+}
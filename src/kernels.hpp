@@ -0,0 +1,140 @@
+/**
+ * @file    kernels.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Row kernels for each `simd_level_t`. Internal to `media_core`, so it's not installed
+ *
+ * @note    The SIMD kernels process the multiple of their vector width and
+ *          leave the rest of the row to the scalar kernel with `begin`.
+ */
+#pragma once
+#include <color_convert.hpp>
+#include <scale.hpp>
+
+#include <cstdint>
+
+/// @param uv interleaved chroma row. `uv[2 * (x / 2)]` is U of the pixel x
+void convert_row_nv12_rgb32_scalar(const uint8_t* y, const uint8_t* uv, uint8_t* dst, uint32_t begin, uint32_t end,
+                                   const yuv_coefficients_t& k) noexcept;
+void convert_row_i420_rgb32_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                                   uint32_t begin, uint32_t end, const yuv_coefficients_t& k) noexcept;
+
+void convert_row_nv12_rgb32_sse41(const uint8_t* y, const uint8_t* uv, uint8_t* dst, uint32_t width,
+                                  const yuv_coefficients_t& k) noexcept;
+void convert_row_i420_rgb32_sse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width,
+                                  const yuv_coefficients_t& k) noexcept;
+
+void convert_row_nv12_rgb32_avx2(const uint8_t* y, const uint8_t* uv, uint8_t* dst, uint32_t width,
+                                 const yuv_coefficients_t& k) noexcept;
+void convert_row_i420_rgb32_avx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width,
+                                 const yuv_coefficients_t& k) noexcept;
+
+/// @param level must be clamped with `clamp_simd_level`
+void convert_row_nv12_rgb32(const uint8_t* y, const uint8_t* uv, uint8_t* dst, uint32_t width,
+                            const yuv_coefficients_t& k, simd_level_t level) noexcept;
+void convert_row_i420_rgb32(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width,
+                            const yuv_coefficients_t& k, simd_level_t level) noexcept;
+
+/// @note `count` is the number of the chroma samples(U/V pairs)
+void split_uv_scalar(const uint8_t* uv, uint8_t* u, uint8_t* v, uint32_t begin, uint32_t end) noexcept;
+void merge_uv_scalar(const uint8_t* u, const uint8_t* v, uint8_t* uv, uint32_t begin, uint32_t end) noexcept;
+/// @brief UV ⇄ VU, YUY2 ⇄ UYVY. swaps the bytes of each 2 byte pair
+void swap_pairs_scalar(const uint8_t* src, uint8_t* dst, uint32_t begin, uint32_t end) noexcept;
+/// @brief `(a + b + 1) / 2` for 4:2:2 → 4:2:0 chroma
+void average_scalar(const uint8_t* a, const uint8_t* b, uint8_t* dst, uint32_t begin, uint32_t end) noexcept;
+/// @note `begin`, `end` are the pixel positions. `begin` must be even
+void unpack_yuy2_scalar(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t begin,
+                        uint32_t end) noexcept;
+void unpack_uyvy_scalar(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t begin,
+                        uint32_t end) noexcept;
+void pack_yuy2_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t begin,
+                      uint32_t end) noexcept;
+void pack_uyvy_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t begin,
+                      uint32_t end) noexcept;
+
+void split_uv_sse41(const uint8_t* uv, uint8_t* u, uint8_t* v, uint32_t count) noexcept;
+void merge_uv_sse41(const uint8_t* u, const uint8_t* v, uint8_t* uv, uint32_t count) noexcept;
+void swap_pairs_sse41(const uint8_t* src, uint8_t* dst, uint32_t count) noexcept;
+void average_sse41(const uint8_t* a, const uint8_t* b, uint8_t* dst, uint32_t count) noexcept;
+void unpack_yuy2_sse41(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t width) noexcept;
+void unpack_uyvy_sse41(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t width) noexcept;
+void pack_yuy2_sse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width) noexcept;
+void pack_uyvy_sse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width) noexcept;
+
+void split_uv_avx2(const uint8_t* uv, uint8_t* u, uint8_t* v, uint32_t count) noexcept;
+void merge_uv_avx2(const uint8_t* u, const uint8_t* v, uint8_t* uv, uint32_t count) noexcept;
+void swap_pairs_avx2(const uint8_t* src, uint8_t* dst, uint32_t count) noexcept;
+void average_avx2(const uint8_t* a, const uint8_t* b, uint8_t* dst, uint32_t count) noexcept;
+
+/// @brief 4x4 Bayer matrix. [0, 16)
+extern const uint8_t bayer_4x4[4][4];
+
+/// @param row for the dither pattern. `dither` is false for `dither_t::none`
+void pack_rgb565_scalar(const uint8_t* src, uint16_t* dst, uint32_t begin, uint32_t end, uint32_t row,
+                        bool dither) noexcept;
+void unpack_rgb565_scalar(const uint16_t* src, uint8_t* dst, uint32_t begin, uint32_t end) noexcept;
+
+void pack_rgb565_sse41(const uint8_t* src, uint16_t* dst, uint32_t width, uint32_t row, bool dither) noexcept;
+void unpack_rgb565_sse41(const uint16_t* src, uint8_t* dst, uint32_t width) noexcept;
+
+void pack_rgb565_avx2(const uint8_t* src, uint16_t* dst, uint32_t width, uint32_t row, bool dither) noexcept;
+void unpack_rgb565_avx2(const uint16_t* src, uint8_t* dst, uint32_t width) noexcept;
+
+/// @brief 16 bit → 8 bit with the rounding. `row` and `dither` are same with `pack_rgb565_scalar`
+void narrow_row_scalar(const uint16_t* src, uint8_t* dst, uint32_t begin, uint32_t end, uint32_t row,
+                       bool dither) noexcept;
+/// @param uv interleaved chroma row of P010/P016. `uv[2 * (x / 2)]` is U of the pixel x
+void convert_row_p010_rgba16_scalar(const uint16_t* y, const uint16_t* uv, uint16_t* dst, uint32_t begin,
+                                    uint32_t end, const yuv_coefficients_t& k) noexcept;
+
+void narrow_row_sse41(const uint16_t* src, uint8_t* dst, uint32_t count, uint32_t row, bool dither) noexcept;
+void convert_row_p010_rgba16_sse41(const uint16_t* y, const uint16_t* uv, uint16_t* dst, uint32_t width,
+                                   const yuv_coefficients_t& k) noexcept;
+
+void narrow_row_avx2(const uint16_t* src, uint8_t* dst, uint32_t count, uint32_t row, bool dither) noexcept;
+void convert_row_p010_rgba16_avx2(const uint16_t* y, const uint16_t* uv, uint16_t* dst, uint32_t width,
+                                  const yuv_coefficients_t& k) noexcept;
+
+/// @brief motion adaptive deinterlace. see `deinterlace_t::blend`
+void blend_motion_scalar(const uint8_t* above, const uint8_t* below, const uint8_t* current,
+                         const uint8_t* previous, uint8_t* dst, uint32_t begin, uint32_t end) noexcept;
+void blend_motion_sse41(const uint8_t* above, const uint8_t* below, const uint8_t* current,
+                        const uint8_t* previous, uint8_t* dst, uint32_t count) noexcept;
+void blend_motion_avx2(const uint8_t* above, const uint8_t* below, const uint8_t* current,
+                       const uint8_t* previous, uint8_t* dst, uint32_t count) noexcept;
+
+/// @brief `sum[i] += src[i]` for the box filter of `make_thumbnail`
+void accumulate_row_scalar(const uint8_t* src, uint16_t* sum, uint32_t begin, uint32_t end) noexcept;
+/// @brief sum of the adjacent 2 pixels. `channels` is 1 or 2. `begin`, `end` are the output positions
+/// @note  `dst` may be the `src`. The output is written after its input is read
+void halve_row_scalar(const uint16_t* src, uint16_t* dst, uint32_t channels, uint32_t begin, uint32_t end) noexcept;
+/// @brief `(src[i] + (1 << shift) / 2) >> shift`. The result must fit in 8 bit
+void round_row_scalar(const uint16_t* src, uint8_t* dst, uint32_t shift, uint32_t begin, uint32_t end) noexcept;
+
+void accumulate_row_sse41(const uint8_t* src, uint16_t* sum, uint32_t count) noexcept;
+void halve_row_sse41(const uint16_t* src, uint16_t* dst, uint32_t channels, uint32_t count) noexcept;
+void round_row_sse41(const uint16_t* src, uint8_t* dst, uint32_t shift, uint32_t count) noexcept;
+
+void accumulate_row_avx2(const uint8_t* src, uint16_t* sum, uint32_t count) noexcept;
+void halve_row_avx2(const uint16_t* src, uint16_t* dst, uint32_t channels, uint32_t count) noexcept;
+void round_row_avx2(const uint16_t* src, uint8_t* dst, uint32_t shift, uint32_t count) noexcept;
+
+/// @param rows `taps` rows from the first input. all columns use the same `coefficients`
+void scale_vertical_scalar(const uint8_t* const* rows, const int16_t* coefficients, uint32_t taps, uint8_t* dst,
+                           uint32_t begin, uint32_t end) noexcept;
+/// @param channels interleaved samples of a pixel. 1, 2 or 4. `begin`, `end` are the output positions
+void scale_horizontal_scalar(const uint8_t* src, uint8_t* dst, uint32_t channels, const filter_bank_t& bank,
+                             uint32_t begin, uint32_t end) noexcept;
+
+void scale_vertical_sse41(const uint8_t* const* rows, const int16_t* coefficients, uint32_t taps, uint8_t* dst,
+                          uint32_t count) noexcept;
+void scale_horizontal_sse41(const uint8_t* src, uint8_t* dst, uint32_t channels, const filter_bank_t& bank,
+                            uint32_t width) noexcept;
+
+void scale_vertical_avx2(const uint8_t* const* rows, const int16_t* coefficients, uint32_t taps, uint8_t* dst,
+                         uint32_t count) noexcept;
+
+/// @brief `++bins[src[i * stride]]` for `compute_histogram`
+void count_row_scalar(const uint8_t* src, uint32_t stride, uint32_t* bins, uint32_t begin, uint32_t end) noexcept;
+/// @param bins 4 tables of 256. The samples are counted into them in turn. The caller adds them
+/// @param count samples to count. `stride` 1, 2 and 4 are loaded with the vector, others use the scalar
+void count_row_sse41(const uint8_t* src, uint32_t stride, uint32_t (*bins)[256], uint32_t count) noexcept;
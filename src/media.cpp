@@ -5,6 +5,8 @@
 #include <dshowasf.h>
 #include <mediaobj.h> // for [dsp]
 
+#include <stdexcept>
+
 using namespace std;
 
 auto media_startup() noexcept(false) -> gsl::final_action<HRESULT(WINAPI*)()> {
@@ -106,7 +108,7 @@ HRESULT configure_D3D11_DXGI(gsl::not_null<IMFTransform*> transform,
 }
 
 // @see https://docs.microsoft.com/en-us/windows/win32/medfound/h-264-video-decoder#transform-attributes
-HRESULT configure_acceleration_H264(gsl::not_null<IMFTransform*> transform) noexcept {
+HRESULT configure_acceleration_H264(gsl::not_null<IMFTransform*> transform, UINT32 num_worker) noexcept {
     com_ptr<IMFAttributes> attrs{};
     if (auto hr = transform->GetAttributes(attrs.put()); FAILED(hr))
         return hr;
@@ -114,7 +116,7 @@ HRESULT configure_acceleration_H264(gsl::not_null<IMFTransform*> transform) noex
         spdlog::error("CODECAPI_AVDecVideoAcceleration_H264: {:#08x}", hr);
     if (auto hr = attrs->SetUINT32(CODECAPI_AVLowLatencyMode, TRUE); FAILED(hr))
         spdlog::error("CODECAPI_AVLowLatencyMode: {:#08x}", hr);
-    if (auto hr = attrs->SetUINT32(CODECAPI_AVDecNumWorkerThreads, 1); FAILED(hr))
+    if (auto hr = attrs->SetUINT32(CODECAPI_AVDecNumWorkerThreads, num_worker); FAILED(hr))
         spdlog::error("CODECAPI_AVDecNumWorkerThreads: {:#08x}", hr);
     return S_OK;
 }
@@ -132,6 +134,119 @@ HRESULT make_video_type(gsl::not_null<IMFMediaType**> ptr, const GUID& subtype)
     return S_OK;
 }
 
+/// @note `MFVideoFormat_*` subtypes share the `MFVideoFormat_Base` except the `Data1`, which is the FourCC
+pixel_format_t get_pixel_format(const GUID& subtype) noexcept {
+    GUID base = subtype;
+    base.Data1 = 0;
+    if (base != MFVideoFormat_Base)
+        return pixel_format_t::unknown;
+    const pixel_format_t format = get_pixel_format(static_cast<uint32_t>(subtype.Data1));
+    return format == pixel_format_t::rgba16 ? pixel_format_t::unknown : format;
+}
+
+GUID get_subtype(pixel_format_t format) noexcept {
+    const pixel_traits_t traits = get_pixel_traits(format);
+    // D3DFMT_A16B16G16R16 is not a `MFVideoFormat_*`. `MFVideoFormat_A16B16G16R16F` is the float one
+    if (traits.num_plane == 0 || format == pixel_format_t::rgba16)
+        return GUID_NULL;
+    GUID subtype = MFVideoFormat_Base;
+    subtype.Data1 = traits.fourcc;
+    return subtype;
+}
+
+yuv_color_t get_yuv_color(IMFMediaType* type) noexcept {
+    yuv_color_t color{};
+    if (type == nullptr)
+        return color;
+    switch (MFGetAttributeUINT32(type, MF_MT_YUV_MATRIX, MFVideoTransferMatrix_BT601)) {
+    case MFVideoTransferMatrix_BT709:
+    case MFVideoTransferMatrix_SMPTE240M:
+        color.matrix = yuv_matrix_t::bt709;
+        break;
+    case MFVideoTransferMatrix_BT2020_10:
+    case MFVideoTransferMatrix_BT2020_12:
+        color.matrix = yuv_matrix_t::bt2020;
+        break;
+    default:
+        color.matrix = yuv_matrix_t::bt601;
+        break;
+    }
+    if (MFGetAttributeUINT32(type, MF_MT_VIDEO_NOMINAL_RANGE, MFNominalRange_16_235) == MFNominalRange_0_255)
+        color.range = yuv_range_t::full;
+    return color;
+}
+
+interlace_mode_t get_interlace_mode(IMFMediaType* type) noexcept {
+    if (type == nullptr)
+        return interlace_mode_t::unknown;
+    return static_cast<interlace_mode_t>(MFGetAttributeUINT32(type, MF_MT_INTERLACE_MODE, MFVideoInterlace_Unknown));
+}
+
+sample_fields_t get_sample_fields(IMFSample* sample, interlace_mode_t mode) noexcept {
+    const bool interleaved = mode == interlace_mode_t::upper_first || mode == interlace_mode_t::lower_first;
+    const bool lower_first = mode == interlace_mode_t::lower_first;
+    sample_fields_t fields{interleaved, lower_first};
+    if (sample == nullptr)
+        return fields;
+    fields.interlaced = MFGetAttributeUINT32(sample, MFSampleExtension_Interlaced, interleaved) != FALSE;
+    fields.lower_first = MFGetAttributeUINT32(sample, MFSampleExtension_BottomFieldFirst, lower_first) != FALSE;
+    return fields;
+}
+
+orientation_t get_orientation(IMFSample* sample) noexcept {
+    if (sample == nullptr)
+        return orientation_t::identity;
+    com_ptr<IMFAttributes> metadata{};
+    if (FAILED(sample->GetUnknown(MFSampleExtension_CaptureMetadata, IID_PPV_ARGS(metadata.put()))))
+        return orientation_t::identity;
+    if (UINT32 value = 0; SUCCEEDED(metadata->GetUINT32(MF_CAPTURE_METADATA_ORIENTATION, &value)))
+        return get_orientation(value);
+    // not translated yet. decode the item without `translate_capture_metadata`
+    com_ptr<IMFMediaBuffer> buffer{};
+    if (FAILED(metadata->GetUnknown(MF_CAPTURE_METADATA_FRAME_RAWSTREAM, IID_PPV_ARGS(buffer.put()))))
+        return orientation_t::identity;
+    BYTE* data = nullptr;
+    DWORD length = 0;
+    if (FAILED(buffer->Lock(&data, nullptr, &length)))
+        return orientation_t::identity;
+    auto on_return = gsl::finally([&buffer]() { buffer->Unlock(); });
+    for (const metadata_item_t& item : metadata_view_t{data, length})
+        if (image_aggregation_t image{}; decode_metadata(item, image) && image.orientation.set)
+            return get_orientation(image.orientation.value);
+    return orientation_t::identity;
+}
+
+HRESULT set_orientation(IMFMediaType* type, orientation_t orientation) noexcept {
+    if (type == nullptr)
+        return E_POINTER;
+    if (is_mirrored(orientation))
+        return MF_E_INVALIDMEDIATYPE;
+    // the frame is rotated counter-clockwise by MF_MT_VIDEO_ROTATION. the sink rotates it back with clockwise degrees
+    return type->SetUINT32(MF_MT_VIDEO_ROTATION, get_rotation(orientation));
+}
+
+HRESULT get_metadata_record(IMFSample* sample, metadata_record_t& record) noexcept {
+    if (sample == nullptr)
+        return E_POINTER;
+    record = metadata_record_t{};
+    if (auto hr = sample->GetSampleTime(&record.timestamp); FAILED(hr))
+        return hr;
+    com_ptr<IMFAttributes> metadata{};
+    if (FAILED(sample->GetUnknown(MFSampleExtension_CaptureMetadata, IID_PPV_ARGS(metadata.put()))))
+        return MF_E_NOT_FOUND;
+    com_ptr<IMFMediaBuffer> buffer{};
+    if (FAILED(metadata->GetUnknown(MF_CAPTURE_METADATA_FRAME_RAWSTREAM, IID_PPV_ARGS(buffer.put()))))
+        return MF_E_NOT_FOUND;
+    BYTE* data = nullptr;
+    DWORD length = 0;
+    if (auto hr = buffer->Lock(&data, nullptr, &length); FAILED(hr))
+        return hr;
+    auto on_return = gsl::finally([&buffer]() { buffer->Unlock(); });
+    for (const metadata_item_t& item : metadata_view_t{data, length})
+        update_metadata_record(record, item);
+    return S_OK;
+}
+
 HRESULT make_video_RGB565(gsl::not_null<IMFMediaType**> ptr) noexcept {
     if (auto hr = make_video_type(ptr, MFVideoFormat_RGB565); FAILED(hr))
         return hr;
@@ -262,6 +377,13 @@ HRESULT configure_destination_rectangle(gsl::not_null<IPropertyStore*> props, co
     return props->SetValue(MFPKEY_RESIZE_DST_HEIGHT, val);
 }
 
+scale_rect_t get_scale_rect(const RECT& rect) noexcept {
+    if (rect.left < 0 || rect.top < 0 || rect.right <= rect.left || rect.bottom <= rect.top)
+        return scale_rect_t{};
+    return scale_rect_t{static_cast<uint32_t>(rect.left), static_cast<uint32_t>(rect.top),
+                        static_cast<uint32_t>(rect.right - rect.left), static_cast<uint32_t>(rect.bottom - rect.top)};
+}
+
 HRESULT create_sink_writer(IMFSinkWriterEx** writer, const fs::path& fpath) noexcept {
     com_ptr<IMFAttributes> attrs{};
     if (auto hr = MFCreateAttributes(attrs.put(), 2); FAILED(hr))
@@ -321,14 +443,13 @@ HRESULT get_stream_descriptor(gsl::not_null<IMFPresentationDescriptor*> presenta
     return S_OK;
 }
 
-HRESULT configure_video(com_ptr<IMFMediaType> type) {
+/// @param deinterlacer for `create_deinterlaced_sample`. follows `MF_MT_INTERLACE_MODE` of the `type`
+HRESULT configure_video(com_ptr<IMFMediaType> type, deinterlacer_t& deinterlacer) {
+    deinterlacer.set_interlace_mode(get_interlace_mode(type.get()));
+
     GUID subtype{};
     type->GetGUID(MF_MT_SUBTYPE, &subtype);
 
-    UINT32 interlace = 0;
-    type->GetUINT32(MF_MT_INTERLACE_MODE, &interlace);
-    const auto imode = static_cast<MFVideoInterlaceMode>(interlace);
-
     UINT32 stride = 0;
     type->GetUINT32(MF_MT_DEFAULT_STRIDE, &stride);
 
@@ -399,7 +520,8 @@ auto decode(com_ptr<IMFTransform> transform, DWORD ostream, com_ptr<IMFMediaType
         if (output_stream_info.dwFlags & MFT_OUTPUT_STREAM_PROVIDES_SAMPLES) {
             // ...
         } else {
-            if (ec = create_single_buffer_sample(output_sample.put(), output_stream_info.cbSize); FAILED(ec))
+            if (ec = create_single_buffer_sample(get_sample_pool(), output_sample.put(), output_stream_info.cbSize);
+                FAILED(ec))
                 co_return;
             output_buffer.pSample = output_sample.get();
         }
@@ -486,6 +608,69 @@ auto process(com_ptr<IMFTransform> transform, DWORD istream, DWORD ostream, com_
         co_yield output_sample;
 }
 
+auto process_pipelined(com_ptr<IMFTransform> transform, DWORD istream, DWORD ostream,
+                       com_ptr<IMFSourceReader> source_reader, HRESULT& ec, size_t capacity) noexcept(false)
+    -> generator<com_ptr<IMFSample>> {
+    com_ptr<IMFMediaType> output_type{};
+    if (ec = transform->GetOutputCurrentType(ostream, output_type.put()); FAILED(ec))
+        co_return;
+    if (ec = transform->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, NULL); FAILED(ec))
+        co_return;
+    if (ec = transform->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, NULL); FAILED(ec))
+        co_return;
+
+    pipeline_t<com_ptr<IMFSample>> pipeline{capacity};
+    pipeline.set_source([source_reader](com_ptr<IMFSample>& input_sample) {
+        const auto reader_stream = static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM);
+        DWORD index{};
+        DWORD flags{};
+        LONGLONG timestamp{}; // unit 100-nanosecond
+        while (true) {
+            input_sample = nullptr;
+            if (auto hr = source_reader->ReadSample(reader_stream, 0, //
+                                                    &index, &flags, &timestamp, input_sample.put());
+                FAILED(hr))
+                throw winrt::hresult_error{hr};
+            if (flags & MF_SOURCE_READERF_ENDOFSTREAM)
+                return false;
+            if (input_sample == nullptr) // probably MF_SOURCE_READERF_STREAMTICK
+                continue;
+            input_sample->SetSampleTime(timestamp);
+            return true;
+        }
+    });
+    // `decode` stops with MF_E_TRANSFORM_NEED_MORE_INPUT. the other errors stop the pipeline
+    auto fetch = [transform, ostream, output_type](const auto& emit) {
+        HRESULT hr = S_OK;
+        for (com_ptr<IMFSample> output_sample : decode(transform, ostream, output_type, hr))
+            if (emit(std::move(output_sample)) == false)
+                return;
+        if (FAILED(hr) && hr != MF_E_TRANSFORM_NEED_MORE_INPUT)
+            throw winrt::hresult_error{hr};
+    };
+    pipeline.add_stage(
+        [transform, istream, fetch](com_ptr<IMFSample>&& input_sample, const auto& emit) {
+            if (auto hr = transform->ProcessInput(istream, input_sample.get(), 0); FAILED(hr))
+                throw winrt::hresult_error{hr};
+            fetch(emit);
+        },
+        [transform, fetch](const auto& emit) {
+            winrt::check_hresult(transform->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, NULL));
+            winrt::check_hresult(transform->ProcessMessage(MFT_MESSAGE_COMMAND_DRAIN, NULL));
+            fetch(emit);
+        });
+    pipeline.start();
+
+    for (com_ptr<IMFSample> output_sample{}; pipeline.pop(output_sample);)
+        co_yield output_sample;
+    try {
+        pipeline.wait();
+        ec = S_OK;
+    } catch (const winrt::hresult_error& ex) {
+        ec = ex.code();
+    }
+}
+
 HRESULT create_single_buffer_sample(IMFSample** sample, DWORD bufsz) {
     if (auto hr = MFCreateSample(sample))
         return hr;
@@ -502,6 +687,381 @@ HRESULT create_single_buffer_sample(IMFSample** sample, DWORD bufsz) {
     return (*sample)->AddBuffer(buffer.get());
 }
 
+HRESULT create_single_buffer_sample(frame_pool_t& pool, IMFSample** sample, DWORD bufsz) noexcept {
+    com_ptr<IMFMediaBuffer> buffer{};
+    if (auto hr = create_pooled_buffer(pool, bufsz, buffer.put()); FAILED(hr))
+        return hr;
+    if (auto hr = create_pooled_sample(sample); FAILED(hr))
+        return hr;
+    return (*sample)->AddBuffer(buffer.get());
+}
+
+frame_pool_t& get_sample_pool() noexcept {
+    static frame_pool_t pool{};
+    return pool;
+}
+
+namespace {
+
+/**
+ * @brief Lock the frame of the sample for the `media_core` kernels. The pitch of the device is kept with `IMF2DBuffer`
+ * @note  The single buffer is locked without `ConvertToContiguousBuffer`, which may copy the padded rows
+ */
+class sample_frame_lock_t final {
+    com_ptr<IMFMediaBuffer> buffer{};
+    com_ptr<IMF2DBuffer> buffer2d{};
+    bool locked = false;
+    frame_view_t view{};
+
+  public:
+    sample_frame_lock_t() noexcept = default;
+    ~sample_frame_lock_t() noexcept {
+        if (locked == false)
+            return;
+        if (buffer2d)
+            buffer2d->Unlock2D();
+        else
+            buffer->Unlock();
+    }
+    sample_frame_lock_t(const sample_frame_lock_t&) = delete;
+    sample_frame_lock_t(sample_frame_lock_t&&) = delete;
+    sample_frame_lock_t& operator=(const sample_frame_lock_t&) = delete;
+    sample_frame_lock_t& operator=(sample_frame_lock_t&&) = delete;
+
+    /// @return `MF_E_INVALIDMEDIATYPE` for the bottom-up rows(negative pitch). `E_FAIL` if the buffer is too small
+    HRESULT lock(IMFSample* sample, pixel_format_t format, UINT32 width, UINT32 height) noexcept {
+        DWORD count = 0;
+        if (auto hr = sample->GetBufferCount(&count); FAILED(hr))
+            return hr;
+        if (auto hr = count == 1 ? sample->GetBufferByIndex(0, buffer.put())
+                                 : sample->ConvertToContiguousBuffer(buffer.put());
+            FAILED(hr))
+            return hr;
+        BYTE* data = nullptr;
+        if (buffer2d = buffer.try_as<IMF2DBuffer>(); buffer2d) {
+            LONG pitch = 0;
+            if (auto hr = buffer2d->Lock2D(&data, &pitch); FAILED(hr))
+                return hr;
+            locked = true;
+            if (pitch < 0) // `frame_view_t` has the rows in the increasing address
+                return MF_E_INVALIDMEDIATYPE;
+            view = make_frame_view(format, width, height, data, static_cast<size_t>(pitch));
+        } else {
+            DWORD length = 0;
+            if (auto hr = buffer->Lock(&data, nullptr, &length); FAILED(hr))
+                return hr;
+            locked = true;
+            const size_t row_bytes = get_row_bytes(get_pixel_traits(format), width);
+            if (length < get_frame_size(format, height, row_bytes))
+                return E_FAIL;
+            view = make_frame_view(format, width, height, data, row_bytes);
+        }
+        return view.num_plane ? S_OK : E_FAIL;
+    }
+
+    const frame_view_t& get() const noexcept {
+        return view;
+    }
+};
+
+} // namespace
+
+HRESULT create_oriented_sample(IMFSample* sample, IMFMediaType* type, IMFSample** oriented) noexcept {
+    if (sample == nullptr || type == nullptr || oriented == nullptr)
+        return E_POINTER;
+    const orientation_t orientation = get_orientation(sample);
+    if (orientation == orientation_t::identity) {
+        sample->AddRef();
+        *oriented = sample;
+        return S_OK;
+    }
+    GUID subtype{};
+    if (auto hr = type->GetGUID(MF_MT_SUBTYPE, &subtype); FAILED(hr))
+        return hr;
+    const pixel_format_t format = get_pixel_format(subtype);
+    if (is_orientable(format) == false)
+        return MF_E_INVALIDMEDIATYPE;
+    UINT32 width = 0, height = 0;
+    if (auto hr = MFGetAttributeSize(type, MF_MT_FRAME_SIZE, &width, &height); FAILED(hr))
+        return hr;
+
+    frame_buffer_t frame{};
+    try {
+        if (is_transposed(orientation))
+            frame = frame_buffer_t{format, height, width};
+        else
+            frame = frame_buffer_t{format, width, height};
+    } catch (const bad_alloc&) {
+        return E_OUTOFMEMORY;
+    } catch (const invalid_argument&) {
+        return E_INVALIDARG;
+    }
+    {
+        sample_frame_lock_t lock{};
+        if (auto hr = lock.lock(sample, format, width, height); FAILED(hr))
+            return hr;
+        if (orient(lock.get(), frame.view(), orientation) == false)
+            return E_FAIL;
+    }
+
+    com_ptr<IMFMediaBuffer> output{};
+    if (auto hr = create_media_buffer(std::move(frame), output.put()); FAILED(hr))
+        return hr;
+    com_ptr<IMFSample> result{};
+    if (auto hr = MFCreateSample(result.put()); FAILED(hr))
+        return hr;
+    if (auto hr = sample->CopyAllItems(result.get()); FAILED(hr))
+        return hr;
+    // the frame is oriented. the copied metadata must not make the consumer orient it again
+    if (com_ptr<IMFAttributes> metadata{};
+        SUCCEEDED(sample->GetUnknown(MFSampleExtension_CaptureMetadata, IID_PPV_ARGS(metadata.put())))) {
+        com_ptr<IMFAttributes> copied{};
+        if (auto hr = MFCreateAttributes(copied.put(), 1); FAILED(hr))
+            return hr;
+        if (auto hr = metadata->CopyAllItems(copied.get()); FAILED(hr))
+            return hr;
+        if (auto hr = copied->SetUINT32(MF_CAPTURE_METADATA_ORIENTATION, static_cast<UINT32>(orientation_t::identity));
+            FAILED(hr))
+            return hr;
+        if (auto hr = result->SetUnknown(MFSampleExtension_CaptureMetadata, copied.get()); FAILED(hr))
+            return hr;
+    }
+    if (LONGLONG time = 0; SUCCEEDED(sample->GetSampleTime(&time)))
+        result->SetSampleTime(time);
+    if (LONGLONG duration = 0; SUCCEEDED(sample->GetSampleDuration(&duration)))
+        result->SetSampleDuration(duration);
+    if (auto hr = result->AddBuffer(output.get()); FAILED(hr))
+        return hr;
+    *oriented = result.detach();
+    return S_OK;
+}
+
+HRESULT create_deinterlaced_sample(IMFSample* sample, IMFMediaType* type, deinterlacer_t& deinterlacer,
+                                   IMFSample** deinterlaced) noexcept {
+    if (sample == nullptr || type == nullptr || deinterlaced == nullptr)
+        return E_POINTER;
+    if (deinterlacer.get_method() == deinterlace_t::none) {
+        sample->AddRef();
+        *deinterlaced = sample;
+        return S_OK;
+    }
+    GUID subtype{};
+    if (auto hr = type->GetGUID(MF_MT_SUBTYPE, &subtype); FAILED(hr))
+        return hr;
+    const pixel_format_t format = get_pixel_format(subtype);
+    if (is_deinterlaceable(format) == false)
+        return MF_E_INVALIDMEDIATYPE;
+    UINT32 width = 0, height = 0;
+    if (auto hr = MFGetAttributeSize(type, MF_MT_FRAME_SIZE, &width, &height); FAILED(hr))
+        return hr;
+
+    frame_buffer_t frame{};
+    try {
+        frame = frame_buffer_t{format, width, height};
+    } catch (const bad_alloc&) {
+        return E_OUTOFMEMORY;
+    } catch (const invalid_argument&) {
+        return E_INVALIDARG;
+    }
+    {
+        sample_frame_lock_t lock{};
+        if (auto hr = lock.lock(sample, format, width, height); FAILED(hr))
+            return hr;
+        const sample_fields_t fields = get_sample_fields(sample, get_interlace_mode(type));
+        if (deinterlacer.process(lock.get(), frame.view(), fields) == false)
+            return E_FAIL;
+    }
+
+    com_ptr<IMFMediaBuffer> output{};
+    if (auto hr = create_media_buffer(std::move(frame), output.put()); FAILED(hr))
+        return hr;
+    com_ptr<IMFSample> result{};
+    if (auto hr = MFCreateSample(result.put()); FAILED(hr))
+        return hr;
+    if (auto hr = sample->CopyAllItems(result.get()); FAILED(hr))
+        return hr;
+    if (auto hr = result->SetUINT32(MFSampleExtension_Interlaced, FALSE); FAILED(hr))
+        return hr;
+    result->DeleteItem(MFSampleExtension_BottomFieldFirst);
+    if (LONGLONG time = 0; SUCCEEDED(sample->GetSampleTime(&time)))
+        result->SetSampleTime(time);
+    if (LONGLONG duration = 0; SUCCEEDED(sample->GetSampleDuration(&duration)))
+        result->SetSampleDuration(duration);
+    if (auto hr = result->AddBuffer(output.get()); FAILED(hr))
+        return hr;
+    *deinterlaced = result.detach();
+    return S_OK;
+}
+
+HRESULT compute_capture_histogram(IMFSample* sample, IMFMediaType* type, uint32_t step) noexcept {
+    if (sample == nullptr || type == nullptr)
+        return E_POINTER;
+    com_ptr<IMFAttributes> metadata{};
+    if (FAILED(sample->GetUnknown(MFSampleExtension_CaptureMetadata, IID_PPV_ARGS(metadata.put())))) {
+        if (auto hr = MFCreateAttributes(metadata.put(), 1); FAILED(hr))
+            return hr;
+        if (auto hr = sample->SetUnknown(MFSampleExtension_CaptureMetadata, metadata.get()); FAILED(hr))
+            return hr;
+    }
+    if (UINT32 size = 0; SUCCEEDED(metadata->GetBlobSize(MF_CAPTURE_METADATA_HISTOGRAM, &size)))
+        return S_FALSE;
+    GUID subtype{};
+    if (auto hr = type->GetGUID(MF_MT_SUBTYPE, &subtype); FAILED(hr))
+        return hr;
+    const pixel_format_t format = get_pixel_format(subtype);
+    if (is_histogram_source(format) == false)
+        return MF_E_INVALIDMEDIATYPE;
+    UINT32 width = 0, height = 0;
+    if (auto hr = MFGetAttributeSize(type, MF_MT_FRAME_SIZE, &width, &height); FAILED(hr))
+        return hr;
+
+    unique_ptr<histogram_t> histogram{new (nothrow) histogram_t{}}; // 3K. zero initialized for `compute_histogram`
+    if (histogram == nullptr)
+        return E_OUTOFMEMORY;
+    {
+        sample_frame_lock_t lock{};
+        if (auto hr = lock.lock(sample, format, width, height); FAILED(hr))
+            return hr;
+        if (compute_histogram(lock.get(), *histogram, step) == false)
+            return E_INVALIDARG;
+    }
+    return set_capture_histogram(metadata.get(), *histogram);
+}
+
+HRESULT create_thumbnail_sample(IMFSample* sample, IMFMediaType* type, uint32_t factor,
+                                IMFSample** thumbnail) noexcept {
+    if (sample == nullptr || type == nullptr || thumbnail == nullptr)
+        return E_POINTER;
+    GUID subtype{};
+    if (auto hr = type->GetGUID(MF_MT_SUBTYPE, &subtype); FAILED(hr))
+        return hr;
+    const pixel_format_t format = get_pixel_format(subtype);
+    if (is_thumbnail_source(format) == false)
+        return MF_E_INVALIDMEDIATYPE;
+    if (is_thumbnail_factor(factor) == false)
+        return E_INVALIDARG;
+    UINT32 width = 0, height = 0;
+    if (auto hr = MFGetAttributeSize(type, MF_MT_FRAME_SIZE, &width, &height); FAILED(hr))
+        return hr;
+    if (width / factor == 0 || height / factor == 0)
+        return E_INVALIDARG;
+
+    frame_buffer_t frame{};
+    try {
+        frame = frame_buffer_t{pixel_format_t::rgb32, width / factor, height / factor};
+    } catch (const bad_alloc&) {
+        return E_OUTOFMEMORY;
+    }
+    {
+        sample_frame_lock_t lock{};
+        if (auto hr = lock.lock(sample, format, width, height); FAILED(hr))
+            return hr;
+        if (make_thumbnail(lock.get(), frame.view(), factor, get_yuv_color(type)) == false)
+            return E_FAIL;
+    }
+
+    com_ptr<IMFMediaBuffer> output{};
+    if (auto hr = create_media_buffer(std::move(frame), output.put()); FAILED(hr))
+        return hr;
+    com_ptr<IMFSample> result{};
+    if (auto hr = MFCreateSample(result.put()); FAILED(hr))
+        return hr;
+    if (LONGLONG time = 0; SUCCEEDED(sample->GetSampleTime(&time)))
+        result->SetSampleTime(time);
+    if (LONGLONG duration = 0; SUCCEEDED(sample->GetSampleDuration(&duration)))
+        result->SetSampleDuration(duration);
+    if (auto hr = result->AddBuffer(output.get()); FAILED(hr))
+        return hr;
+    *thumbnail = result.detach();
+    return S_OK;
+}
+
+HRESULT create_shared_sample(IMFSample* src, IMFSample** dst) noexcept {
+    if (src == nullptr || dst == nullptr)
+        return E_INVALIDARG;
+    com_ptr<IMFSample> sample{};
+    if (auto hr = MFCreateSample(sample.put()); FAILED(hr))
+        return hr;
+    if (auto hr = src->CopyAllItems(sample.get()); FAILED(hr))
+        return hr;
+    if (LONGLONG time = 0; SUCCEEDED(src->GetSampleTime(&time)))
+        sample->SetSampleTime(time);
+    if (LONGLONG duration = 0; SUCCEEDED(src->GetSampleDuration(&duration)))
+        sample->SetSampleDuration(duration);
+
+    DWORD count = 0;
+    if (auto hr = src->GetBufferCount(&count); FAILED(hr))
+        return hr;
+    for (DWORD i = 0; i < count; ++i) {
+        com_ptr<IMFMediaBuffer> buffer{};
+        if (auto hr = src->GetBufferByIndex(i, buffer.put()); FAILED(hr))
+            return hr;
+        // re-wrap, so the `Lock` of each sample can detect the sharing
+        if (buffer_view_t view{}; SUCCEEDED(get_buffer_view(buffer.get(), view))) {
+            buffer = nullptr;
+            if (auto hr = create_media_buffer(std::move(view), buffer.put()); FAILED(hr))
+                return hr;
+        }
+        if (auto hr = sample->AddBuffer(buffer.get()); FAILED(hr))
+            return hr;
+    }
+    *dst = sample.detach();
+    return S_OK;
+}
+
+sample_spans_t::~sample_spans_t() noexcept {
+    unlock();
+}
+
+HRESULT sample_spans_t::lock(IMFSample* sample) noexcept {
+    unlock();
+    if (sample == nullptr)
+        return E_INVALIDARG;
+    DWORD count = 0;
+    if (auto hr = sample->GetBufferCount(&count); FAILED(hr))
+        return hr;
+    try {
+        buffers.reserve(count);
+        for (DWORD i = 0; i < count; ++i) {
+            com_ptr<IMFMediaBuffer> buffer{};
+            if (auto hr = sample->GetBufferByIndex(i, buffer.put()); FAILED(hr)) {
+                unlock();
+                return hr;
+            }
+            BYTE* ptr = nullptr;
+            DWORD length = 0;
+            if (auto hr = buffer->Lock(&ptr, nullptr, &length); FAILED(hr)) {
+                unlock();
+                return hr;
+            }
+            buffers.emplace_back(std::move(buffer));
+            spans.push_back(ptr, length);
+        }
+    } catch (const std::bad_alloc&) {
+        unlock();
+        return E_OUTOFMEMORY;
+    }
+    return S_OK;
+}
+
+void sample_spans_t::unlock() noexcept {
+    for (com_ptr<IMFMediaBuffer>& buffer : buffers)
+        buffer->Unlock();
+    buffers.clear();
+    spans.clear();
+}
+
+bool is_non_reference(IMFSample* sample) noexcept {
+    if (sample == nullptr)
+        return false;
+    if (MFGetAttributeUINT32(sample, MFSampleExtension_CleanPoint, FALSE))
+        return false;
+    sample_spans_t spans{};
+    if (FAILED(spans.lock(sample)))
+        return false;
+    return is_non_reference_h264(spans.get());
+}
+
 HRESULT create_and_copy_single_buffer_sample(IMFSample* src, IMFSample** dst) {
     DWORD total{};
     if (auto hr = src->GetTotalLength(&total); FAILED(hr))
@@ -526,7 +1086,7 @@ HRESULT get_transform_output(IMFTransform* transform, IMFSample** sample, BOOL&
 
     MFT_OUTPUT_DATA_BUFFER output{};
     if ((stream_info.dwFlags & MFT_OUTPUT_STREAM_PROVIDES_SAMPLES) == 0) {
-        if (auto hr = create_single_buffer_sample(sample, stream_info.cbSize); FAILED(hr))
+        if (auto hr = create_single_buffer_sample(get_sample_pool(), sample, stream_info.cbSize); FAILED(hr))
             return hr;
         output.pSample = *sample;
     }
@@ -20,6 +20,31 @@
 #include <mfreadwrite.h>
 #include <wmcodecdsp.h>
 
+#include <async_reader.hpp>
+#include <buffer_span.hpp>
+#include <buffer_view.hpp>
+#include <capture_attributes.hpp> // translate_capture_metadata
+#include <capture_metadata.hpp>
+#include <color_convert.hpp>
+#include <deinterlace.hpp>
+#include <executor.hpp>
+#include <frame_buffer.hpp>
+#include <frame_pool.hpp>
+#include <graph.hpp>
+#include <h264_nal.hpp>
+#include <histogram.hpp>
+#include <metadata_log.hpp>
+#include <orientation.hpp>
+#include <p010.hpp>
+#include <pipeline.hpp>
+#include <pixel_traits.hpp>
+#include <repack.hpp>
+#include <rgb565.hpp>
+#include <scale.hpp>
+#include <slice.hpp>
+#include <spsc_ring.hpp>
+#include <thumbnail.hpp>
+
 // C++ 17 Coroutines TS
 using std::experimental::coroutine_handle;
 using std::experimental::generator;
@@ -57,8 +82,12 @@ HRESULT resolve(const fs::path& fpath, IMFMediaSourceEx** source, MF_OBJECT_TYPE
 /// @todo test enCLMFTDx11
 HRESULT make_transform_video(IMFTransform** transform, const IID& iid) noexcept;
 
-/// @see https://docs.microsoft.com/en-us/windows/win32/medfound/h-264-video-decoder#transform-attributes
-HRESULT configure_acceleration_H264(gsl::not_null<IMFTransform*> transform) noexcept;
+/**
+ * @see https://docs.microsoft.com/en-us/windows/win32/medfound/h-264-video-decoder#transform-attributes
+ * @param num_worker `CODECAPI_AVDecNumWorkerThreads`. 1 for the low latency, (UINT32)-1 lets the decoder decide.
+ *                   The color conversion after the decoder can use `executor_t` for the other cores
+ */
+HRESULT configure_acceleration_H264(gsl::not_null<IMFTransform*> transform, UINT32 num_worker = 1) noexcept;
 
 /// @brief configure D3D11 if the transform supports it
 /// @return E_NOTIMPL, E_FAIL ...
@@ -76,10 +105,87 @@ HRESULT configure_source_rectangle(gsl::not_null<IPropertyStore*> props, const R
 /// @see https://docs.microsoft.com/en-us/windows/win32/medfound/videoresizer
 HRESULT configure_destination_rectangle(gsl::not_null<IPropertyStore*> props, const RECT& rect) noexcept;
 
+/// @brief LTRB `RECT` → `scale_rect_t` for `scaler_t`. The negative or the inverted one becomes empty
+scale_rect_t get_scale_rect(const RECT& rect) noexcept;
+
 HRESULT make_video_RGB32(gsl::not_null<IMFMediaType**> ptr) noexcept;
 HRESULT make_video_RGB565(gsl::not_null<IMFMediaType**> ptr) noexcept;
 HRESULT make_video_type(gsl::not_null<IMFMediaType**> ptr, const GUID& subtype) noexcept;
 
+/// @return `pixel_format_t::unknown` if the `subtype` is not supported by `media_core`
+pixel_format_t get_pixel_format(const GUID& subtype) noexcept;
+/// @return `GUID_NULL` for `pixel_format_t::unknown` and `pixel_format_t::rgba16`, which has no subtype
+GUID get_subtype(pixel_format_t format) noexcept;
+
+/**
+ * @brief `MF_MT_YUV_MATRIX` and `MF_MT_VIDEO_NOMINAL_RANGE` for `convert_yuv_to_rgb32`
+ * @note  BT.601 and the limited range if the attributes are missing. SMPTE 240M is treated as BT.709
+ */
+yuv_color_t get_yuv_color(IMFMediaType* type) noexcept;
+
+/// @brief `MF_MT_INTERLACE_MODE` for `deinterlacer_t`. `interlace_mode_t::unknown` if the attribute is missing
+interlace_mode_t get_interlace_mode(IMFMediaType* type) noexcept;
+
+/**
+ * @brief `MFSampleExtension_Interlaced` and `MFSampleExtension_BottomFieldFirst` for `deinterlacer_t::process`
+ * @param mode  of the media type. The missing attributes follow it: interlaced only for `upper_first`/`lower_first`,
+ *              and the lower field first only for `lower_first`. So the sample is progressive by default
+ */
+sample_fields_t get_sample_fields(IMFSample* sample, interlace_mode_t mode = interlace_mode_t::progressive) noexcept;
+
+/**
+ * @note   The raw `image_aggregation_t` is used if the capture metadata is not translated yet
+ * @return `orientation_t::identity` if the `sample` doesn't have the capture metadata
+ */
+orientation_t get_orientation(IMFSample* sample) noexcept;
+
+/**
+ * @brief Tag the `orientation` to `MF_MT_VIDEO_ROTATION` for the sink which can rotate by itself
+ * @return `MF_E_INVALIDMEDIATYPE` if `is_mirrored`. The frames must be processed with `orient` then
+ */
+HRESULT set_orientation(IMFMediaType* type, orientation_t orientation) noexcept;
+
+/**
+ * @brief The orientation stage for the sinks which can't rotate. `orient` the `sample` with `get_orientation`
+ * @details The `oriented` sample has a new RGB32/NV12/I420 frame and the items of the `sample`.
+ *          Its capture metadata tells `orientation_t::identity`. If the `sample` is already `identity`, it is returned.
+ *          The width and the height of the frame are swapped for `is_transposed`, so the output type must follow.
+ *          For the sink which rotates by itself, tag its type with `set_orientation` instead.
+ * @param type  the current media type of the `sample`. `MF_MT_SUBTYPE` and `MF_MT_FRAME_SIZE`
+ * @return `MF_E_INVALIDMEDIATYPE` if the `type` is not `is_orientable` or the rows are bottom-up
+ */
+HRESULT create_oriented_sample(IMFSample* sample, IMFMediaType* type, IMFSample** oriented) noexcept;
+
+/**
+ * @brief The deinterlace stage. `deinterlacer_t::process` the `sample` with `get_sample_fields`
+ * @details The `deinterlaced` sample has a new NV12/I420 frame and the items of the `sample`.
+ *          It is marked progressive with `MFSampleExtension_Interlaced`. If the `deinterlacer` has nothing to do,
+ *          the `sample` is returned. The `deinterlacer` keeps the previous frame, so use 1 for each stream.
+ *          The output type must be `MFVideoInterlace_Progressive`
+ * @param type  the current media type of the `sample`. `MF_MT_SUBTYPE`, `MF_MT_FRAME_SIZE` and `MF_MT_INTERLACE_MODE`
+ * @param deinterlacer  set with `get_interlace_mode` of the `type`. see `configure_video`
+ * @return `MF_E_INVALIDMEDIATYPE` if the `type` is not `is_deinterlaceable` or the rows are bottom-up
+ */
+HRESULT create_deinterlaced_sample(IMFSample* sample, IMFMediaType* type, deinterlacer_t& deinterlacer,
+                                   IMFSample** deinterlaced) noexcept;
+
+/**
+ * @brief `compute_histogram` of the `sample` and `set_capture_histogram` if its capture metadata has no histogram
+ * @details For the sources which don't report `MF_CAPTURE_METADATA_HISTOGRAM`. The sample gets the
+ *          `MFSampleExtension_CaptureMetadata` if it doesn't have one
+ * @param type  the current media type of the `sample`. `MF_MT_SUBTYPE` and `MF_MT_FRAME_SIZE`
+ * @param step  see `compute_histogram`
+ * @return `S_FALSE` if the histogram already exists. `MF_E_INVALIDMEDIATYPE` if the `type` is not `is_histogram_source`
+ */
+HRESULT compute_capture_histogram(IMFSample* sample, IMFMediaType* type, uint32_t step = 1) noexcept;
+
+/**
+ * @brief `metadata_record_t` of the `sample` for `metadata_log_writer_t`
+ * @details The raw items are read without `translate_capture_metadata`
+ * @return `MF_E_NOT_FOUND` if the `sample` doesn't have the raw capture metadata. The `timestamp` is set in the case
+ */
+HRESULT get_metadata_record(IMFSample* sample, metadata_record_t& record) noexcept;
+
 HRESULT try_output_type(com_ptr<IMFTransform> transform, DWORD ostream, const GUID& desired,
                         IMFMediaType** output_type) noexcept;
 
@@ -114,7 +220,131 @@ auto process(com_ptr<IMFTransform> transform, DWORD istream, DWORD ostream, //
              com_ptr<IMFSourceReader> source_reader,                        //
              HRESULT& ec) -> generator<com_ptr<IMFSample>>;
 
+/**
+ * @brief Pipelined version of `process(transform, istream, ostream, source_reader, ec)`
+ *
+ * @details `ReadSample` and the `IMFTransform` run on their own worker threads of `pipeline_t`.
+ *          So reading the frame N+2 and transforming N+1 happen while the caller consumes N.
+ *          If the caller stops the iteration, the destruction of the generator stops the workers.
+ * @param capacity  max number of samples between the stages
+ * @note  `ec` is updated after the last `co_yield`
+ * @throw std::system_error if the worker thread can't be created
+ */
+auto process_pipelined(com_ptr<IMFTransform> transform, DWORD istream, DWORD ostream, //
+                       com_ptr<IMFSourceReader> source_reader,                        //
+                       HRESULT& ec, size_t capacity = 4) noexcept(false) -> generator<com_ptr<IMFSample>>;
+
 HRESULT create_single_buffer_sample(IMFSample** sample, DWORD bufsz);
+
+/**
+ * @brief `IMFSample` with 1 `IMFMediaBuffer` from the `frame_pool_t`
+ * @note  The buffer's memory goes back to the pool when the `IMFMediaBuffer` is released.
+ *        The `IMFSample` is from `create_pooled_sample`
+ */
+HRESULT create_single_buffer_sample(frame_pool_t& pool, IMFSample** sample, DWORD bufsz) noexcept;
+
+/**
+ * @brief Recycled `IMFSample` without buffers and attributes
+ * @details When the last reference is released, the buffers and the attributes are removed and the sample is
+ *          kept for the next call. The sample time/duration are 0 instead of absent.
+ *          The release is notified in the work queue, so the sample and its buffers come back asynchronously.
+ * @see     `IMFTrackedSample`
+ */
+HRESULT create_pooled_sample(IMFSample** sample) noexcept;
+
+/// @brief `IMFMediaBuffer` which uses a `frame_block_t` of the `frame_pool_t`
+HRESULT create_pooled_buffer(frame_pool_t& pool, DWORD bufsz, IMFMediaBuffer** buffer) noexcept;
+
+/// @brief the pool for `decode` and `get_transform_output`
+frame_pool_t& get_sample_pool() noexcept;
+
+/**
+ * @brief Expose the `frame_buffer_t` as `IMFMediaBuffer` and `IMF2DBuffer`
+ * @note  `IMF2DBuffer::Lock2D` provides the aligned/padded rows without copy
+ */
+HRESULT create_media_buffer(frame_buffer_t&& frame, IMFMediaBuffer** buffer) noexcept;
+
+/**
+ * @brief `make_thumbnail` of the NV12/YUY2/UYVY `sample` into a new ARGB32 sample, like the photo confirmation of MFT0
+ * @details The buffer is locked with `IMF2DBuffer` if possible, so the pitch of the device is kept.
+ *          The single buffer of the `sample` is locked without `ConvertToContiguousBuffer`.
+ *          The thumbnail is `create_media_buffer(frame_buffer_t&&)` and has the time/duration of the `sample`
+ * @param type  the current media type of the `sample`. `MF_MT_SUBTYPE`, `MF_MT_FRAME_SIZE` and `MF_MT_YUV_MATRIX`
+ * @param factor see `is_thumbnail_factor`
+ * @return `MF_E_INVALIDMEDIATYPE` if the `type` is not `is_thumbnail_source` or the rows are bottom-up(negative pitch)
+ */
+HRESULT create_thumbnail_sample(IMFSample* sample, IMFMediaType* type, uint32_t factor, IMFSample** thumbnail) noexcept;
+
+/**
+ * @brief Expose the `buffer_view_t` as `IMFMediaBuffer`
+ * @note  `Lock` returns the shared memory without copy. It must be read-only. Use `lock_for_write` to modify
+ */
+HRESULT create_media_buffer(buffer_view_t view, IMFMediaBuffer** buffer) noexcept;
+
+/**
+ * @brief `IMFMediaBuffer::Lock` for the write. Call `Unlock` after the write
+ * @details The buffer from `create_media_buffer(buffer_view_t)` performs the copy-on-write if its block is shared
+ *          with other buffers/views. The other buffers are locked as they are
+ */
+HRESULT lock_for_write(IMFMediaBuffer* buffer, BYTE** ptr, DWORD* max_length) noexcept;
+
+/**
+ * @brief Get the read-only view of the buffer from `create_media_buffer(buffer_view_t)` without copy
+ * @return E_NOINTERFACE if the buffer is not from `create_media_buffer(buffer_view_t)`
+ */
+HRESULT get_buffer_view(IMFMediaBuffer* buffer, buffer_view_t& view) noexcept;
+
+/**
+ * @brief Share the buffers of the `src` with a new `IMFSample`. Replaces `create_and_copy_single_buffer_sample`
+ *
+ * @details Attributes, time and duration are copied, but the memory is not.
+ *          The buffers from `create_media_buffer(buffer_view_t)` are re-wrapped so each sample performs
+ *          copy-on-write independently. Other buffers are shared as they are, so the consumers must not modify them.
+ */
+HRESULT create_shared_sample(IMFSample* src, IMFSample** dst) noexcept;
+
+/**
+ * @brief Lock all `IMFMediaBuffer`s of a `IMFSample` and list them as `span_list_t`
+ *
+ * @details Replaces `IMFSample::ConvertToContiguousBuffer` for the consumers which can visit the pieces
+ *          one by one. The buffers are unlocked with `unlock` or the destructor.
+ * @code
+ * sample_spans_t spans{};
+ * if (auto hr = spans.lock(sample); FAILED(hr))
+ *     return hr;
+ * for (const byte_span_t& span : spans.get())
+ *     consume(span.data, span.size);
+ * @endcode
+ */
+class sample_spans_t final {
+    std::vector<com_ptr<IMFMediaBuffer>> buffers{}; // locked buffers
+    span_list_t spans{};
+
+  public:
+    sample_spans_t() noexcept = default;
+    ~sample_spans_t() noexcept;
+    sample_spans_t(const sample_spans_t&) = delete;
+    sample_spans_t(sample_spans_t&&) = delete;
+    sample_spans_t& operator=(const sample_spans_t&) = delete;
+    sample_spans_t& operator=(sample_spans_t&&) = delete;
+
+    /// @note uses `GetCurrentLength` of each buffer. unlocks the previous sample
+    HRESULT lock(IMFSample* sample) noexcept;
+    void unlock() noexcept;
+
+    const span_list_t& get() const noexcept {
+        return spans;
+    }
+};
+
+/**
+ * @brief The H.264 sample can be discarded without breaking the others. For `overflow_policy_t::drop_non_reference`
+ * @note  The key frames(`MFSampleExtension_CleanPoint`) and the samples which can't be locked are not droppable
+ * @see   is_non_reference_h264
+ */
+bool is_non_reference(IMFSample* sample) noexcept;
+
+/// @note copies all of the memory. consider `create_shared_sample` for the read-only consumers
 HRESULT create_and_copy_single_buffer_sample(IMFSample* src, IMFSample** dst);
 HRESULT get_transform_output(IMFTransform* transform, IMFSample** sample, BOOL& flushed);
 
@@ -127,6 +357,41 @@ HRESULT create_sink_writer(IMFSinkWriterEx** writer, const fs::path& fpath) noex
 /// @todo mock `CoCreateInstance`
 HRESULT create_reader_callback(IMFSourceReaderCallback** callback) noexcept;
 
+/// @brief wait-free hand-off of the samples from `IMFSourceReaderCallback` to 1 consumer thread
+using sample_ring_t = spsc_ring_t<com_ptr<IMFSample>>;
+
+/**
+ * @brief `IMFSourceReaderCallback` which pushes the samples to the `sample_ring_t` without lock
+ * @note  The consumer requests the samples with `IMFSourceReader::ReadSample`. If the ring is full, the sample is dropped
+ */
+HRESULT create_reader_callback(std::shared_ptr<sample_ring_t> ring, IMFSourceReaderCallback** callback) noexcept;
+
+/// @brief `co_await reader.next()` resumes when `OnReadSample` fires
+using sample_reader_t = async_reader_t<com_ptr<IMFSample>>;
+
+/**
+ * @brief `IMFSourceReaderCallback` which completes the requests of the `sample_reader_t`
+ * @note  The end of the stream and the errors close the `reader`. The stream ticks issue the next request
+ * @see   start_reading
+ */
+HRESULT create_reader_callback(std::shared_ptr<sample_reader_t> reader, IMFSourceReaderCallback** callback) noexcept;
+
+/**
+ * @brief Issue `reader.get_depth()` asynchronous `ReadSample`s. Each `co_await reader.next()` issues 1 more
+ * @param source_reader created with the callback from `create_reader_callback(reader)`.
+ *                      It must be alive until `reader.close()` or the end of the stream
+ * @code
+ * auto reader = std::make_shared<sample_reader_t>(3);
+ * create_reader_callback(reader, callback.put());
+ * create_source_reader(source, callback, source_reader.put());
+ * start_reading(*reader, source_reader.get());
+ * while (auto sample = co_await reader->next())
+ *     consume(*sample);
+ * @endcode
+ */
+HRESULT start_reading(sample_reader_t& reader, IMFSourceReader* source_reader,
+                      DWORD stream = static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM)) noexcept;
+
 /**
  * @note `MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING` == `TRUE`
  * @note `MF_READWRITE_DISABLE_CONVERTERS` == `FALSE`
@@ -179,6 +444,9 @@ void print(gsl::not_null<IMFMediaType*> media_type) noexcept;
  */
 void print(gsl::not_null<IMFTransform*> transform, const GUID& iid) noexcept;
 
+/// @brief print statistics of the `frame_pool_t` with logging
+void print(const frame_pool_stats_t& stats) noexcept;
+
 class h264_video_writer_t final {
     com_ptr<IMFSinkWriterEx> writer{}; // expose IMFTransform for each stream
     com_ptr<IMFMediaType> output_type{};
@@ -154,6 +154,153 @@ HRESULT create_reader_callback(IMFSourceReaderCallback** ptr) noexcept {
     }
 }
 
+/// @note `OnReadSample` is invoked in the worker thread of the `IMFSourceReader`. It is the only producer of the ring
+class ring_callback_t final : public IMFSourceReaderCallback {
+    std::shared_ptr<sample_ring_t> ring;
+    LONG ref_count = 0;
+
+  public:
+    explicit ring_callback_t(std::shared_ptr<sample_ring_t> ring) noexcept : ring{std::move(ring)} {
+    }
+
+  private:
+    STDMETHODIMP OnEvent(DWORD, IMFMediaEvent*) noexcept override {
+        return S_OK;
+    }
+    STDMETHODIMP OnFlush(DWORD) noexcept override {
+        return S_OK;
+    }
+    STDMETHODIMP OnReadSample(HRESULT status, DWORD, DWORD flags, //
+                              LONGLONG timestamp, IMFSample* sample) noexcept override {
+        if (flags & MF_SOURCE_READERF_ERROR)
+            return status;
+        if (sample == nullptr) // MF_SOURCE_READERF_STREAMTICK, MF_SOURCE_READERF_ENDOFSTREAM ...
+            return S_OK;
+        if (auto hr = sample->SetSampleTime(timestamp); FAILED(hr))
+            return hr;
+        com_ptr<IMFSample> item{};
+        item.copy_from(sample);
+        // no lock, no wait. the consumer is too slow if the ring is full
+        if (ring->try_push(std::move(item)) == false)
+            spdlog::debug("{}: ring is full. dropped {}", __FUNCTION__, timestamp);
+        return S_OK;
+    }
+
+  public:
+    STDMETHODIMP QueryInterface(REFIID iid, void** ppv) {
+        const QITAB table[]{
+            QITABENT(ring_callback_t, IMFSourceReaderCallback),
+            {},
+        };
+        return QISearch(this, table, iid, ppv);
+    }
+    STDMETHODIMP_(ULONG) AddRef() {
+        return InterlockedIncrement(&ref_count);
+    }
+    STDMETHODIMP_(ULONG) Release() {
+        const auto count = InterlockedDecrement(&ref_count);
+        if (count == 0)
+            delete this;
+        return count;
+    }
+};
+
+HRESULT create_reader_callback(std::shared_ptr<sample_ring_t> ring, IMFSourceReaderCallback** ptr) noexcept {
+    if (ring == nullptr || ptr == nullptr)
+        return E_INVALIDARG;
+    if (IUnknown* unknown = *ptr = new (nothrow) ring_callback_t{std::move(ring)})
+        unknown->AddRef();
+    else
+        return E_OUTOFMEMORY;
+    return S_OK;
+}
+
+/// @note `OnReadSample` completes 1 request of the `sample_reader_t`. The consumer is resumed in this thread
+class async_reader_callback_t final : public IMFSourceReaderCallback {
+    std::shared_ptr<sample_reader_t> reader;
+    LONG ref_count = 0;
+
+  public:
+    explicit async_reader_callback_t(std::shared_ptr<sample_reader_t> reader) noexcept : reader{std::move(reader)} {
+    }
+
+  private:
+    STDMETHODIMP OnEvent(DWORD, IMFMediaEvent*) noexcept override {
+        return S_OK;
+    }
+    STDMETHODIMP OnFlush(DWORD) noexcept override {
+        return S_OK;
+    }
+    STDMETHODIMP OnReadSample(HRESULT status, DWORD, DWORD flags, //
+                              LONGLONG timestamp, IMFSample* sample) noexcept override {
+        if (FAILED(status) || (flags & MF_SOURCE_READERF_ERROR)) {
+            spdlog::error("{}: {:#x}", __FUNCTION__, static_cast<uint32_t>(status));
+            reader->close();
+            return status;
+        }
+        if (flags & MF_SOURCE_READERF_ENDOFSTREAM) {
+            reader->close();
+            return S_OK;
+        }
+        if (sample == nullptr) { // probably MF_SOURCE_READERF_STREAMTICK
+            reader->skip();
+            return S_OK;
+        }
+        if (auto hr = sample->SetSampleTime(timestamp); FAILED(hr))
+            return hr;
+        com_ptr<IMFSample> item{};
+        item.copy_from(sample);
+        try {
+            reader->complete(std::move(item));
+        } catch (const std::exception& ex) {
+            print_error(ex);
+            return E_FAIL;
+        }
+        return S_OK;
+    }
+
+  public:
+    STDMETHODIMP QueryInterface(REFIID iid, void** ppv) {
+        const QITAB table[]{
+            QITABENT(async_reader_callback_t, IMFSourceReaderCallback),
+            {},
+        };
+        return QISearch(this, table, iid, ppv);
+    }
+    STDMETHODIMP_(ULONG) AddRef() {
+        return InterlockedIncrement(&ref_count);
+    }
+    STDMETHODIMP_(ULONG) Release() {
+        const auto count = InterlockedDecrement(&ref_count);
+        if (count == 0)
+            delete this;
+        return count;
+    }
+};
+
+HRESULT create_reader_callback(std::shared_ptr<sample_reader_t> reader, IMFSourceReaderCallback** ptr) noexcept {
+    if (reader == nullptr || ptr == nullptr)
+        return E_INVALIDARG;
+    if (IUnknown* unknown = *ptr = new (nothrow) async_reader_callback_t{std::move(reader)})
+        unknown->AddRef();
+    else
+        return E_OUTOFMEMORY;
+    return S_OK;
+}
+
+HRESULT start_reading(sample_reader_t& reader, IMFSourceReader* source_reader, DWORD stream) noexcept {
+    if (source_reader == nullptr)
+        return E_INVALIDARG;
+    try {
+        reader.start([source_reader, stream]() {
+            return SUCCEEDED(source_reader->ReadSample(stream, 0, NULL, NULL, NULL, NULL));
+        });
+    } catch (const std::bad_alloc&) {
+        return E_OUTOFMEMORY;
+    }
+    return S_OK;
+}
+
 class save_image_sink_t final : public IMFMediaSink {
     LONG ref_count = 0;
 
@@ -245,6 +392,441 @@ HRESULT create_sink(const fs::path& dirpath, IMFMediaSink** ptr) {
     }
 }
 
+/// @see https://docs.microsoft.com/en-us/windows/win32/api/mfobjects/nn-mfobjects-imfmediabuffer
+/// @note the `frame_block_t` goes back to its `frame_pool_t` when the last reference is released
+class pooled_buffer_t final : public IMFMediaBuffer {
+    std::shared_ptr<frame_block_t> block;
+    DWORD capacity = 0;
+    DWORD length = 0;
+    LONG ref_count = 0;
+
+  public:
+    pooled_buffer_t(std::shared_ptr<frame_block_t> block, DWORD capacity) noexcept
+        : block{std::move(block)}, capacity{capacity} {
+    }
+
+    STDMETHODIMP QueryInterface(REFIID iid, void** ppv) {
+        const QITAB table[]{
+            QITABENT(pooled_buffer_t, IMFMediaBuffer),
+            {},
+        };
+        return QISearch(this, table, iid, ppv);
+    }
+    STDMETHODIMP_(ULONG) AddRef() {
+        return InterlockedIncrement(&ref_count);
+    }
+    STDMETHODIMP_(ULONG) Release() {
+        const auto count = InterlockedDecrement(&ref_count);
+        if (count == 0)
+            delete this;
+        return count;
+    }
+
+    STDMETHODIMP Lock(BYTE** ptr, DWORD* max_length, DWORD* current_length) noexcept override {
+        if (ptr == nullptr)
+            return E_INVALIDARG;
+        *ptr = static_cast<BYTE*>(block->data);
+        if (max_length)
+            *max_length = capacity;
+        if (current_length)
+            *current_length = length;
+        return S_OK;
+    }
+    STDMETHODIMP Unlock() noexcept override {
+        return S_OK;
+    }
+    STDMETHODIMP GetCurrentLength(DWORD* current_length) noexcept override {
+        if (current_length == nullptr)
+            return E_INVALIDARG;
+        *current_length = length;
+        return S_OK;
+    }
+    STDMETHODIMP SetCurrentLength(DWORD current_length) noexcept override {
+        if (current_length > capacity)
+            return E_INVALIDARG;
+        length = current_length;
+        return S_OK;
+    }
+    STDMETHODIMP GetMaxLength(DWORD* max_length) noexcept override {
+        if (max_length == nullptr)
+            return E_INVALIDARG;
+        *max_length = capacity;
+        return S_OK;
+    }
+};
+
+HRESULT create_pooled_buffer(frame_pool_t& pool, DWORD bufsz, IMFMediaBuffer** ptr) noexcept {
+    if (ptr == nullptr)
+        return E_INVALIDARG;
+    auto block = pool.acquire(bufsz);
+    if (block == nullptr)
+        return E_OUTOFMEMORY;
+    if (IUnknown* unknown = *ptr = new (nothrow) pooled_buffer_t{std::move(block), bufsz})
+        unknown->AddRef();
+    else
+        return E_OUTOFMEMORY;
+    return S_OK;
+}
+
+/// @see https://docs.microsoft.com/en-us/windows/win32/api/mfidl/nn-mfidl-imftrackedsample
+/// @note `IMFTrackedSample` invokes the callback when the consumer releases the last reference.
+///       The sample is cleared there, so the next owner sees an empty `IMFSample`
+class sample_recycler_t final : public IMFAsyncCallback {
+    critical_section_t mtx{};
+    std::vector<com_ptr<IMFSample>> idle{};
+    LONG ref_count = 0;
+
+  public:
+    static constexpr size_t max_idle_count = 16;
+
+  public:
+    STDMETHODIMP QueryInterface(REFIID iid, void** ppv) {
+        const QITAB table[]{
+            QITABENT(sample_recycler_t, IMFAsyncCallback),
+            {},
+        };
+        return QISearch(this, table, iid, ppv);
+    }
+    STDMETHODIMP_(ULONG) AddRef() {
+        return InterlockedIncrement(&ref_count);
+    }
+    STDMETHODIMP_(ULONG) Release() {
+        const auto count = InterlockedDecrement(&ref_count);
+        if (count == 0)
+            delete this;
+        return count;
+    }
+
+    STDMETHODIMP GetParameters(DWORD*, DWORD*) noexcept override {
+        return E_NOTIMPL;
+    }
+    STDMETHODIMP Invoke(IMFAsyncResult* result) noexcept override {
+        com_ptr<IUnknown> unknown{};
+        if (auto hr = result->GetObject(unknown.put()); FAILED(hr))
+            return hr;
+        auto sample = unknown.try_as<IMFSample>();
+        if (sample == nullptr)
+            return E_NOINTERFACE;
+        // the buffers go back to their `frame_pool_t` here. the sample time can't be removed, so it's 0
+        sample->RemoveAllBuffers();
+        sample->DeleteAllItems();
+        sample->SetSampleTime(0);
+        sample->SetSampleDuration(0);
+        sample->SetSampleFlags(0);
+        lock_guard lck{mtx};
+        if (idle.size() >= max_idle_count)
+            return S_OK;
+        try {
+            idle.emplace_back(std::move(sample));
+        } catch (const std::bad_alloc&) {
+            // the sample is deleted with the last reference
+        }
+        return S_OK;
+    }
+
+    HRESULT acquire(IMFSample** ptr) noexcept {
+        com_ptr<IMFTrackedSample> tracked{};
+        {
+            lock_guard lck{mtx};
+            if (idle.empty() == false) {
+                tracked = idle.back().try_as<IMFTrackedSample>();
+                idle.pop_back();
+            }
+        }
+        if (tracked == nullptr)
+            if (auto hr = MFCreateTrackedSample(tracked.put()); FAILED(hr))
+                return hr;
+        // the notification is 1 shot. register again for each owner
+        if (auto hr = tracked->SetAllocator(this, nullptr); FAILED(hr))
+            return hr;
+        return tracked->QueryInterface(IID_PPV_ARGS(ptr));
+    }
+};
+
+HRESULT create_pooled_sample(IMFSample** ptr) noexcept {
+    if (ptr == nullptr)
+        return E_INVALIDARG;
+    // the outstanding samples hold the recycler with `SetAllocator`, so it is never deleted
+    static sample_recycler_t* recycler = []() {
+        auto* recycler = new (nothrow) sample_recycler_t{};
+        if (recycler)
+            recycler->AddRef();
+        return recycler;
+    }();
+    if (recycler == nullptr)
+        return E_OUTOFMEMORY;
+    return recycler->acquire(ptr);
+}
+
+/// @see https://docs.microsoft.com/en-us/windows/win32/api/mfobjects/nn-mfobjects-imf2dbuffer
+/// @see https://docs.microsoft.com/en-us/windows/win32/medfound/uncompressed-video-buffers
+/// @note `Lock` provides a contiguous copy if the `frame_buffer_t` has row padding.
+///       The nested `Lock`s share the copy and the last `Unlock` writes the changed rows back
+class frame_media_buffer_t final : public IMFMediaBuffer, public IMF2DBuffer {
+    critical_section_t mtx{};
+    frame_buffer_t frame;
+    DWORD length = 0;
+    std::unique_ptr<BYTE[]> contiguous{}; // for `Lock` of the padded frame
+    uint32_t lock_count = 0;
+    LONG ref_count = 0;
+
+  public:
+    explicit frame_media_buffer_t(frame_buffer_t&& frame) noexcept : frame{std::move(frame)} {
+        length = static_cast<DWORD>(get_contiguous_size(this->frame.view()));
+    }
+
+    STDMETHODIMP QueryInterface(REFIID iid, void** ppv) {
+        const QITAB table[]{
+            QITABENT(frame_media_buffer_t, IMFMediaBuffer),
+            QITABENT(frame_media_buffer_t, IMF2DBuffer),
+            {},
+        };
+        return QISearch(this, table, iid, ppv);
+    }
+    STDMETHODIMP_(ULONG) AddRef() {
+        return InterlockedIncrement(&ref_count);
+    }
+    STDMETHODIMP_(ULONG) Release() {
+        const auto count = InterlockedDecrement(&ref_count);
+        if (count == 0)
+            delete this;
+        return count;
+    }
+
+    STDMETHODIMP Lock(BYTE** ptr, DWORD* max_length, DWORD* current_length) noexcept override {
+        if (ptr == nullptr)
+            return E_INVALIDARG;
+        lock_guard lck{mtx};
+        const auto capacity = static_cast<DWORD>(get_contiguous_size(frame.view()));
+        if (frame.is_contiguous()) {
+            *ptr = frame.data();
+        } else {
+            if (contiguous == nullptr) {
+                contiguous.reset(new (nothrow) BYTE[capacity]);
+                if (contiguous == nullptr)
+                    return E_OUTOFMEMORY;
+                copy_to_contiguous(frame.view(), contiguous.get(), capacity);
+            }
+            *ptr = contiguous.get();
+        }
+        ++lock_count;
+        if (max_length)
+            *max_length = capacity;
+        if (current_length)
+            *current_length = length;
+        return S_OK;
+    }
+    /// @note The unchanged rows are not written, so the `Lock` only for the read leaves the frame as it is
+    STDMETHODIMP Unlock() noexcept override {
+        lock_guard lck{mtx};
+        if (lock_count == 0)
+            return MF_E_INVALIDREQUEST;
+        if (--lock_count > 0 || contiguous == nullptr)
+            return S_OK;
+        const frame_view_t view = frame.view();
+        const BYTE* src = contiguous.get();
+        for (auto i = 0u; i < view.num_plane; ++i) {
+            const plane_t& plane = view.planes[i];
+            for (auto y = 0u; y < plane.rows; ++y, src += plane.row_bytes)
+                if (memcmp(plane.row(y), src, plane.row_bytes) != 0)
+                    memcpy(plane.row(y), src, plane.row_bytes);
+        }
+        contiguous = nullptr;
+        return S_OK;
+    }
+    STDMETHODIMP GetCurrentLength(DWORD* current_length) noexcept override {
+        if (current_length == nullptr)
+            return E_INVALIDARG;
+        *current_length = length;
+        return S_OK;
+    }
+    STDMETHODIMP SetCurrentLength(DWORD current_length) noexcept override {
+        if (current_length > get_contiguous_size(frame.view()))
+            return E_INVALIDARG;
+        length = current_length;
+        return S_OK;
+    }
+    STDMETHODIMP GetMaxLength(DWORD* max_length) noexcept override {
+        if (max_length == nullptr)
+            return E_INVALIDARG;
+        *max_length = static_cast<DWORD>(get_contiguous_size(frame.view()));
+        return S_OK;
+    }
+
+    /// @return `MF_E_UNEXPECTED` while the contiguous copy of `Lock` is out. The 2 memories would diverge
+    STDMETHODIMP Lock2D(BYTE** scanline0, LONG* pitch) noexcept override {
+        lock_guard lck{mtx};
+        if (contiguous != nullptr)
+            return MF_E_UNEXPECTED;
+        return GetScanline0AndPitch(scanline0, pitch);
+    }
+    STDMETHODIMP Unlock2D() noexcept override {
+        return S_OK;
+    }
+    STDMETHODIMP GetScanline0AndPitch(BYTE** scanline0, LONG* pitch) noexcept override {
+        if (scanline0 == nullptr || pitch == nullptr)
+            return E_INVALIDARG;
+        *scanline0 = frame.data();
+        *pitch = static_cast<LONG>(frame.pitch());
+        return S_OK;
+    }
+    STDMETHODIMP IsContiguousFormat(BOOL* contiguous_format) noexcept override {
+        if (contiguous_format == nullptr)
+            return E_INVALIDARG;
+        *contiguous_format = frame.is_contiguous();
+        return S_OK;
+    }
+    STDMETHODIMP GetContiguousLength(DWORD* contiguous_length) noexcept override {
+        if (contiguous_length == nullptr)
+            return E_INVALIDARG;
+        *contiguous_length = static_cast<DWORD>(get_contiguous_size(frame.view()));
+        return S_OK;
+    }
+    STDMETHODIMP ContiguousCopyTo(BYTE* dst, DWORD capacity) noexcept override {
+        if (dst == nullptr)
+            return E_INVALIDARG;
+        return copy_to_contiguous(frame.view(), dst, capacity) ? S_OK : MF_E_BUFFERTOOSMALL;
+    }
+    STDMETHODIMP ContiguousCopyFrom(const BYTE* src, DWORD src_length) noexcept override {
+        if (src == nullptr)
+            return E_INVALIDARG;
+        return copy_from_contiguous(frame.view(), src, src_length) ? S_OK : E_INVALIDARG;
+    }
+};
+
+HRESULT create_media_buffer(frame_buffer_t&& frame, IMFMediaBuffer** ptr) noexcept {
+    if (ptr == nullptr)
+        return E_INVALIDARG;
+    if (frame.data() == nullptr)
+        return E_INVALIDARG;
+    if (IUnknown* unknown = *ptr = new (nothrow) frame_media_buffer_t{std::move(frame)})
+        unknown->AddRef();
+    else
+        return E_OUTOFMEMORY;
+    return S_OK;
+}
+
+/// @brief private interface to access the `buffer_view_t` of `view_media_buffer_t` without `Lock`
+struct __declspec(uuid("edf05e9a-d3f5-4104-9969-686bdf7c1b6b")) IBufferView : public IUnknown {
+    virtual HRESULT STDMETHODCALLTYPE GetView(buffer_view_t* view) noexcept = 0;
+    /// @note same with `Lock`, but the memory is writable. Copy-on-write if the block is shared
+    virtual HRESULT STDMETHODCALLTYPE LockWrite(BYTE** ptr, DWORD* max_length) noexcept = 0;
+};
+
+/// @note `Lock` is for the read and returns the shared memory. The write goes through `IBufferView::LockWrite`
+class view_media_buffer_t final : public IMFMediaBuffer, public IBufferView {
+    critical_section_t mtx{};
+    buffer_view_t view;
+    DWORD length = 0;
+    LONG ref_count = 0;
+
+  public:
+    explicit view_media_buffer_t(buffer_view_t view) noexcept
+        : view{std::move(view)}, length{static_cast<DWORD>(this->view.size())} {
+    }
+
+    STDMETHODIMP QueryInterface(REFIID iid, void** ppv) {
+        const QITAB table[]{
+            QITABENT(view_media_buffer_t, IMFMediaBuffer),
+            QITABENT(view_media_buffer_t, IBufferView),
+            {},
+        };
+        return QISearch(this, table, iid, ppv);
+    }
+    STDMETHODIMP_(ULONG) AddRef() {
+        return InterlockedIncrement(&ref_count);
+    }
+    STDMETHODIMP_(ULONG) Release() {
+        const auto count = InterlockedDecrement(&ref_count);
+        if (count == 0)
+            delete this;
+        return count;
+    }
+
+    STDMETHODIMP Lock(BYTE** ptr, DWORD* max_length, DWORD* current_length) noexcept override {
+        if (ptr == nullptr)
+            return E_INVALIDARG;
+        lock_guard lck{mtx};
+        // `IMFMediaBuffer` has no read/write flag. the consumers of the shared sample must not write
+        *ptr = const_cast<BYTE*>(view.data());
+        if (max_length)
+            *max_length = static_cast<DWORD>(view.size());
+        if (current_length)
+            *current_length = length;
+        return S_OK;
+    }
+    STDMETHODIMP Unlock() noexcept override {
+        return S_OK;
+    }
+    STDMETHODIMP GetCurrentLength(DWORD* current_length) noexcept override {
+        if (current_length == nullptr)
+            return E_INVALIDARG;
+        *current_length = length;
+        return S_OK;
+    }
+    STDMETHODIMP SetCurrentLength(DWORD current_length) noexcept override {
+        if (current_length > view.size())
+            return E_INVALIDARG;
+        length = current_length;
+        return S_OK;
+    }
+    STDMETHODIMP GetMaxLength(DWORD* max_length) noexcept override {
+        if (max_length == nullptr)
+            return E_INVALIDARG;
+        *max_length = static_cast<DWORD>(view.size());
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetView(buffer_view_t* ptr) noexcept override {
+        if (ptr == nullptr)
+            return E_INVALIDARG;
+        lock_guard lck{mtx};
+        *ptr = view.slice(0, length);
+        return S_OK;
+    }
+    HRESULT STDMETHODCALLTYPE LockWrite(BYTE** ptr, DWORD* max_length) noexcept override {
+        if (ptr == nullptr)
+            return E_INVALIDARG;
+        lock_guard lck{mtx};
+        try {
+            *ptr = view.mutable_data(&get_sample_pool());
+        } catch (const std::bad_alloc&) {
+            return E_OUTOFMEMORY;
+        }
+        if (max_length)
+            *max_length = static_cast<DWORD>(view.size());
+        return S_OK;
+    }
+};
+
+HRESULT create_media_buffer(buffer_view_t view, IMFMediaBuffer** ptr) noexcept {
+    if (ptr == nullptr)
+        return E_INVALIDARG;
+    if (IUnknown* unknown = *ptr = new (nothrow) view_media_buffer_t{std::move(view)})
+        unknown->AddRef();
+    else
+        return E_OUTOFMEMORY;
+    return S_OK;
+}
+
+HRESULT get_buffer_view(IMFMediaBuffer* buffer, buffer_view_t& view) noexcept {
+    if (buffer == nullptr)
+        return E_INVALIDARG;
+    com_ptr<IBufferView> source{};
+    if (auto hr = buffer->QueryInterface(__uuidof(IBufferView), source.put_void()); FAILED(hr))
+        return hr;
+    return source->GetView(&view);
+}
+
+HRESULT lock_for_write(IMFMediaBuffer* buffer, BYTE** ptr, DWORD* max_length) noexcept {
+    if (buffer == nullptr || ptr == nullptr)
+        return E_INVALIDARG;
+    com_ptr<IBufferView> source{};
+    if (FAILED(buffer->QueryInterface(__uuidof(IBufferView), source.put_void())))
+        return buffer->Lock(ptr, max_length, nullptr);
+    return source->LockWrite(ptr, max_length);
+}
+
 h264_video_writer_t::h264_video_writer_t(const fs::path& fpath) noexcept(false) {
     winrt::check_hresult(create_sink_writer(writer.put(), fpath));
     winrt::check_hresult(MFCreateMediaType(output_type.put()));
@@ -448,3 +448,15 @@ void print(gsl::not_null<IMFTransform*> transform, const GUID& iid) noexcept {
     if (iid == CLSID_CResizerDMO)
         return print_CLSID_CResizerDMO(transform, iid);
 }
+
+void print(const frame_pool_stats_t& stats) noexcept {
+    spdlog::info("- frame_pool:");
+    spdlog::info("  hit: {}", stats.hit);
+    spdlog::info("  miss: {}", stats.miss);
+    spdlog::info("  recycled: {}", stats.recycled);
+    spdlog::info("  discarded: {}", stats.discarded);
+    spdlog::info("  outstanding: {}", stats.outstanding);
+    spdlog::info("  high_water: {}", stats.high_water);
+    spdlog::info("  cached: {}", stats.cached);
+    spdlog::info("  cached_bytes: {}", stats.cached_bytes);
+}
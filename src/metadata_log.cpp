@@ -0,0 +1,385 @@
+#include "metadata_log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+void update_metadata_record(metadata_record_t& record, const metadata_item_t& item) noexcept {
+    auto update = [&record](uint32_t field, uint32_t set, auto& dst, auto value) {
+        if (set == 0)
+            return;
+        record.fields |= field;
+        dst = value;
+    };
+    if (preview_aggregation_t data{}; decode_metadata(item, data)) {
+        update(record_field_exposure_time, data.exposure_time.set, record.exposure_time, data.exposure_time.value);
+        update(record_field_iso_speed, data.iso_speed.set, record.iso_speed, data.iso_speed.value);
+        update(record_field_lens_position, data.lens_position.set, record.lens_position, data.lens_position.value);
+        update(record_field_focus_state, data.focus_state.set, record.focus_state, data.focus_state.value);
+        const metadata_srational_t* gains[3]{&data.white_balance_gain_r, &data.white_balance_gain_g,
+                                             &data.white_balance_gain_b};
+        for (uint32_t i = 0; i < 3; ++i)
+            update(record_field_white_balance_gains, gains[i]->set, record.white_balance_gains[i], to_float(*gains[i]));
+    } else if (image_aggregation_t data{}; decode_metadata(item, data)) {
+        update(record_field_exposure_time, data.exposure_time.set, record.exposure_time, data.exposure_time.value);
+        update(record_field_iso_speed, data.iso_speed.set, record.iso_speed, data.iso_speed.value);
+        update(record_field_lens_position, data.lens_position.set, record.lens_position, data.lens_position.value);
+        update(record_field_focus_state, data.focus_state.set, record.focus_state, data.focus_state.value);
+    } else if (metadata_faces_t faces{}; decode_metadata(item, faces)) {
+        record.fields |= record_field_faces;
+        record.face_count = faces.size();
+        for (uint32_t i = 0; i < max_record_faces; ++i) {
+            const metadata_face_t face = i < faces.size() ? faces[i] : metadata_face_t{};
+            record.faces[i] = metadata_rect_t{face.left, face.top, face.right, face.bottom};
+        }
+    }
+}
+
+size_t get_column_size(metadata_column_t column) noexcept {
+    switch (column) {
+    case metadata_column_t::timestamp:
+    case metadata_column_t::exposure_time:
+        return sizeof(int64_t);
+    case metadata_column_t::faces:
+        return sizeof(metadata_rect_t) * max_record_faces;
+    case metadata_column_t::count:
+        return 0;
+    default:
+        return sizeof(uint32_t);
+    }
+}
+
+namespace {
+
+constexpr uint32_t log_magic = 0x474C444D;   // "MDLG"
+constexpr uint32_t block_magic = 0x4B42444D; // "MDBK"
+constexpr uint32_t log_version = 1;
+constexpr uint32_t column_count = static_cast<uint32_t>(metadata_column_t::count);
+
+struct file_header_t final {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t columns;
+    uint32_t record_bytes; ///< sum of `get_column_size`
+};
+
+/// @note 8 byte aligned, so the first column is
+struct block_header_t final {
+    uint32_t magic;
+    uint32_t count;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+};
+static_assert(sizeof(file_header_t) % 8 == 0 && sizeof(block_header_t) % 8 == 0);
+
+metadata_column_t get_column(uint32_t index) noexcept {
+    return static_cast<metadata_column_t>(index);
+}
+
+size_t get_record_bytes() noexcept {
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < column_count; ++i)
+        bytes += get_column_size(get_column(i));
+    return bytes;
+}
+
+/// @brief the columns in the file are padded to 8 bytes, so all of them are aligned for their type
+uint64_t get_packed_size(metadata_column_t column, uint64_t count) noexcept {
+    return (count * get_column_size(column) + 7) / 8 * 8;
+}
+
+} // namespace
+
+metadata_block_t::metadata_block_t(uint32_t capacity) noexcept(false)
+    : capacity{capacity}, data{make_unique<uint8_t[]>(get_record_bytes() * capacity)} {
+}
+
+uint8_t* metadata_block_t::column(metadata_column_t column) noexcept {
+    size_t offset = 0;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(column); ++i)
+        offset += get_column_size(get_column(i)) * capacity;
+    return data.get() + offset;
+}
+
+void metadata_block_t::push_back(const metadata_record_t& record) noexcept {
+    const void* values[column_count]{&record.timestamp,
+                                     &record.exposure_time,
+                                     &record.fields,
+                                     &record.iso_speed,
+                                     &record.lens_position,
+                                     &record.focus_state,
+                                     &record.white_balance_gains[0],
+                                     &record.white_balance_gains[1],
+                                     &record.white_balance_gains[2],
+                                     &record.face_count,
+                                     record.faces};
+    for (uint32_t i = 0; i < column_count; ++i) {
+        const size_t size = get_column_size(get_column(i));
+        memcpy(column(get_column(i)) + size * count, values[i], size);
+    }
+    ++count;
+}
+
+metadata_log_writer_t::metadata_log_writer_t(const string& path, uint32_t block_records,
+                                             uint32_t block_count) noexcept(false)
+    : stream{nullptr}, empty_blocks{block_count}, full_blocks{block_count} {
+    if (block_records == 0)
+        throw invalid_argument{"metadata_log_writer_t: block_records must be greater than 0"};
+    stream = fopen(path.c_str(), "wb");
+    if (stream == nullptr)
+        throw system_error{errno, generic_category(), path};
+    try {
+        for (uint32_t i = 0; i < block_count; ++i) {
+            auto block = make_unique<metadata_block_t>(block_records);
+            empty_blocks.try_push(std::move(block));
+        }
+        const file_header_t header{log_magic, log_version, column_count, static_cast<uint32_t>(get_record_bytes())};
+        if (fwrite(&header, sizeof(header), 1, stream) != 1 || fflush(stream) != 0)
+            throw system_error{errno, generic_category(), path};
+        writer = thread{&metadata_log_writer_t::run, this};
+    } catch (...) {
+        fclose(stream);
+        throw;
+    }
+}
+
+metadata_log_writer_t::~metadata_log_writer_t() noexcept {
+    flush();
+    stopping.store(true, memory_order_release);
+    wakeup.notify_one();
+    writer.join();
+    fclose(stream);
+}
+
+bool metadata_log_writer_t::append(const metadata_record_t& record) noexcept {
+    if (current == nullptr && empty_blocks.try_pop(current) == false) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    current->push_back(record);
+    appended.fetch_add(1, memory_order_relaxed);
+    if (current->count == current->capacity)
+        flush();
+    return true;
+}
+
+void metadata_log_writer_t::flush() noexcept {
+    if (current == nullptr || current->count == 0)
+        return;
+    // never full. all blocks together fit in the ring
+    full_blocks.try_push(std::move(current));
+    current = nullptr;
+    // without the lock. the writer thread wakes up by itself if this is missed
+    wakeup.notify_one();
+}
+
+metadata_log_stats_t metadata_log_writer_t::get_stats() const noexcept {
+    metadata_log_stats_t stats{};
+    stats.appended = appended.load(memory_order_relaxed);
+    stats.dropped = dropped.load(memory_order_relaxed);
+    stats.blocks = blocks.load(memory_order_relaxed);
+    stats.failed = failed.load(memory_order_relaxed);
+    return stats;
+}
+
+void metadata_log_writer_t::run() noexcept {
+    unique_ptr<metadata_block_t> block{};
+    while (true) {
+        // the blocks pushed before `stopping` are written before the return
+        const bool stop = stopping.load(memory_order_acquire);
+        while (full_blocks.try_pop(block)) {
+            if (failed.load(memory_order_relaxed) == false && write(*block) == false)
+                failed.store(true, memory_order_relaxed);
+            block->count = 0;
+            empty_blocks.try_push(std::move(block));
+        }
+        if (stop)
+            return;
+        unique_lock lck{mtx};
+        wakeup.wait_for(lck, chrono::milliseconds{100});
+    }
+}
+
+bool metadata_log_writer_t::write(const metadata_block_t& block) noexcept {
+    const auto* timestamps = reinterpret_cast<const int64_t*>(block.data.get()); // the first column
+    const block_header_t header{block_magic, block.count, timestamps[0], timestamps[block.count - 1]};
+    if (fwrite(&header, sizeof(header), 1, stream) != 1)
+        return false;
+    constexpr uint8_t padding[8]{};
+    const uint8_t* column = block.data.get();
+    for (uint32_t i = 0; i < column_count; ++i) {
+        const size_t size = get_column_size(get_column(i)) * block.count;
+        const size_t packed = static_cast<size_t>(get_packed_size(get_column(i), block.count));
+        if (fwrite(column, 1, size, stream) != size || fwrite(padding, 1, packed - size, stream) != packed - size)
+            return false;
+        column += get_column_size(get_column(i)) * block.capacity;
+    }
+    if (fflush(stream) != 0)
+        return false;
+    blocks.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+metadata_record_t metadata_block_view_t::record(uint32_t index) const noexcept {
+    metadata_record_t record{};
+    record.timestamp = timestamp[index];
+    record.exposure_time = exposure_time[index];
+    record.fields = fields[index];
+    record.iso_speed = iso_speed[index];
+    record.lens_position = lens_position[index];
+    record.focus_state = focus_state[index];
+    for (uint32_t i = 0; i < 3; ++i)
+        record.white_balance_gains[i] = white_balance_gains[i][index];
+    record.face_count = face_count[index];
+    for (uint32_t i = 0; i < max_record_faces; ++i)
+        record.faces[i] = faces[size_t{index} * max_record_faces + i];
+    return record;
+}
+
+namespace {
+
+void unmap(const uint8_t* data, size_t size) noexcept {
+#if defined(_WIN32)
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<uint8_t*>(data), size);
+#endif
+}
+
+/// @throw std::system_error
+const uint8_t* map(const string& path, size_t& size) noexcept(false) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw system_error{static_cast<int>(GetLastError()), system_category(), path};
+    LARGE_INTEGER length{};
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &length) && length.QuadPart >= static_cast<LONGLONG>(sizeof(file_header_t)))
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const DWORD ec = GetLastError();
+    CloseHandle(file);
+    if (length.QuadPart < static_cast<LONGLONG>(sizeof(file_header_t)))
+        throw runtime_error{"metadata_log_reader_t: too small for the log: " + path};
+    if (mapping == nullptr)
+        throw system_error{static_cast<int>(ec), system_category(), path};
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    const DWORD map_ec = GetLastError();
+    CloseHandle(mapping); // the view keeps the mapping
+    if (data == nullptr)
+        throw system_error{static_cast<int>(map_ec), system_category(), path};
+    size = static_cast<size_t>(length.QuadPart);
+    return static_cast<const uint8_t*>(data);
+#else
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw system_error{errno, generic_category(), path};
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        const int ec = errno;
+        close(fd);
+        throw system_error{ec, generic_category(), path};
+    }
+    if (info.st_size < static_cast<off_t>(sizeof(file_header_t))) {
+        close(fd);
+        throw runtime_error{"metadata_log_reader_t: too small for the log: " + path};
+    }
+    size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int ec = errno;
+    close(fd); // the mapping keeps the file
+    if (data == MAP_FAILED)
+        throw system_error{ec, generic_category(), path};
+    madvise(data, size, MADV_SEQUENTIAL);
+    return static_cast<const uint8_t*>(data);
+#endif
+}
+
+} // namespace
+
+metadata_log_reader_t::metadata_log_reader_t(const string& path) noexcept(false) : data{map(path, size)} {
+    try {
+        file_header_t header{};
+        memcpy(&header, data, sizeof(header));
+        if (header.magic != log_magic || header.version != log_version || header.columns != column_count ||
+            header.record_bytes != get_record_bytes())
+            throw runtime_error{"metadata_log_reader_t: not a metadata log: " + path};
+        offsets.emplace_back(0);
+        size_t offset = sizeof(file_header_t);
+        while (size - offset >= sizeof(block_header_t)) {
+            block_header_t block{};
+            memcpy(&block, data + offset, sizeof(block));
+            if (block.magic != block_magic)
+                break;
+            uint64_t bytes = sizeof(block_header_t);
+            for (uint32_t i = 0; i < column_count; ++i)
+                bytes += get_packed_size(get_column(i), block.count);
+            if (bytes > size - offset) // truncated
+                break;
+            const uint8_t* columns[column_count]{};
+            const uint8_t* column = data + offset + sizeof(block_header_t);
+            for (uint32_t i = 0; i < column_count; ++i) {
+                columns[i] = column;
+                column += get_packed_size(get_column(i), block.count);
+            }
+            metadata_block_view_t view{};
+            view.count = block.count;
+            view.first_timestamp = block.first_timestamp;
+            view.last_timestamp = block.last_timestamp;
+            view.timestamp = reinterpret_cast<const int64_t*>(columns[0]);
+            view.exposure_time = reinterpret_cast<const int64_t*>(columns[1]);
+            view.fields = reinterpret_cast<const uint32_t*>(columns[2]);
+            view.iso_speed = reinterpret_cast<const uint32_t*>(columns[3]);
+            view.lens_position = reinterpret_cast<const uint32_t*>(columns[4]);
+            view.focus_state = reinterpret_cast<const uint32_t*>(columns[5]);
+            for (uint32_t i = 0; i < 3; ++i)
+                view.white_balance_gains[i] = reinterpret_cast<const float*>(columns[6 + i]);
+            view.face_count = reinterpret_cast<const uint32_t*>(columns[9]);
+            view.faces = reinterpret_cast<const metadata_rect_t*>(columns[10]);
+            blocks.emplace_back(view);
+            offsets.emplace_back(offsets.back() + block.count);
+            offset += static_cast<size_t>(bytes);
+        }
+    } catch (...) {
+        unmap(data, size);
+        throw;
+    }
+}
+
+metadata_log_reader_t::~metadata_log_reader_t() noexcept {
+    unmap(data, size);
+}
+
+metadata_record_t metadata_log_reader_t::operator[](size_t index) const noexcept {
+    const size_t block = static_cast<size_t>(upper_bound(offsets.begin(), offsets.end(), index) - offsets.begin()) - 1;
+    return blocks[block].record(static_cast<uint32_t>(index - offsets[block]));
+}
+
+size_t metadata_log_reader_t::lower_bound(int64_t timestamp) const noexcept {
+    // the block headers first. then the column of 1 block
+    const auto it = partition_point(blocks.begin(), blocks.end(), [timestamp](const metadata_block_view_t& block) {
+        return block.count == 0 || block.last_timestamp < timestamp;
+    });
+    if (it == blocks.end())
+        return record_count();
+    const size_t block = static_cast<size_t>(it - blocks.begin());
+    const int64_t* first = it->timestamp;
+    const int64_t* found = std::lower_bound(first, first + it->count, timestamp);
+    return offsets[block] + static_cast<size_t>(found - first);
+}
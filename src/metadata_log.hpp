@@ -0,0 +1,203 @@
+/**
+ * @file    metadata_log.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Append-only columnar sidecar log of the capture metadata
+ */
+#pragma once
+#include <capture_metadata.hpp>
+#include <spsc_ring.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief The bits of `metadata_record_t::fields`. Set if the driver reported the field for the frame
+constexpr uint32_t record_field_exposure_time = 0x01;
+constexpr uint32_t record_field_iso_speed = 0x02;
+constexpr uint32_t record_field_lens_position = 0x04;
+constexpr uint32_t record_field_focus_state = 0x08;
+constexpr uint32_t record_field_white_balance_gains = 0x10;
+constexpr uint32_t record_field_faces = 0x20;
+
+struct metadata_rect_t final {
+    int32_t left, top, right, bottom;
+};
+
+/// @brief The record keeps the first faces only, so its size is fixed. The others are counted in `face_count`
+constexpr uint32_t max_record_faces = 4;
+
+/// @brief 1 frame of the log. Keyed by the sample time
+struct metadata_record_t final {
+    int64_t timestamp;     ///< sample time in 100 ns
+    int64_t exposure_time; ///< 100 ns
+    uint32_t fields;       ///< `record_field_*`
+    uint32_t iso_speed;
+    uint32_t lens_position;
+    uint32_t focus_state;
+    float white_balance_gains[3]; ///< R, G, B
+    uint32_t face_count;
+    metadata_rect_t faces[max_record_faces];
+};
+
+/// @brief Fill the `record` with the known items. The unknown ones are ignored
+void update_metadata_record(metadata_record_t& record, const metadata_item_t& item) noexcept;
+
+/// @brief The columns of the log in the file order. The 8 byte columns are placed first
+enum class metadata_column_t : uint32_t {
+    timestamp,
+    exposure_time,
+    fields,
+    iso_speed,
+    lens_position,
+    focus_state,
+    white_balance_r,
+    white_balance_g,
+    white_balance_b,
+    face_count,
+    faces, ///< `max_record_faces` of `metadata_rect_t` for each record
+    count,
+};
+
+/// @return bytes of 1 element of the `column`
+size_t get_column_size(metadata_column_t column) noexcept;
+
+/**
+ * @brief Columns of 1 block. Same layout with the file, so the writer stores it with a few `fwrite`
+ * @note  The column `i` starts at `get_column_size * capacity` offset. The file packs them with `count`
+ */
+struct metadata_block_t final {
+    uint32_t capacity = 0;
+    uint32_t count = 0;
+    std::unique_ptr<uint8_t[]> data{};
+
+    explicit metadata_block_t(uint32_t capacity) noexcept(false);
+
+    uint8_t* column(metadata_column_t column) noexcept;
+    void push_back(const metadata_record_t& record) noexcept;
+};
+
+/// @brief Counters of `metadata_log_writer_t`
+struct metadata_log_stats_t final {
+    uint64_t appended = 0; ///< records given to the writer thread
+    uint64_t dropped = 0;  ///< records dropped because the writer thread was behind
+    uint64_t blocks = 0;   ///< blocks written in the file
+    bool failed = false;   ///< `fwrite` failed. The blocks after it are dropped
+};
+
+/**
+ * @brief Append the records to the file in the background thread
+ *
+ * @details The capture thread fills a block in the memory. The full block goes to the writer thread
+ *          through `spsc_ring_t` and comes back empty after `fwrite`, so `append` doesn't allocate, lock or wait.
+ *          If all blocks are in the writer thread, the record is dropped and counted.
+ * @note    Only 1 thread may call `append` and `flush`
+ */
+class metadata_log_writer_t final {
+    std::FILE* stream;
+    spsc_ring_t<std::unique_ptr<metadata_block_t>> empty_blocks;
+    spsc_ring_t<std::unique_ptr<metadata_block_t>> full_blocks;
+    std::unique_ptr<metadata_block_t> current{};
+    std::mutex mtx{}; // for sleep/wake up of the writer thread
+    std::condition_variable wakeup{};
+    std::atomic_bool stopping{false};
+    std::atomic_uint64_t appended{0};
+    std::atomic_uint64_t dropped{0};
+    std::atomic_uint64_t blocks{0};
+    std::atomic_bool failed{false};
+    std::thread writer{};
+
+  public:
+    /**
+     * @param block_records records in 1 block. The writer thread wakes up once for each block
+     * @param block_count   blocks of the capture thread and the writer thread
+     * @throw std::system_error if the file can't be opened or the thread can't be started
+     * @throw std::invalid_argument if `block_records` or `block_count` is 0
+     */
+    explicit metadata_log_writer_t(const std::string& path, uint32_t block_records = 4096,
+                                   uint32_t block_count = 4) noexcept(false);
+    /// @brief `flush` and wait for the writer thread
+    ~metadata_log_writer_t() noexcept;
+    metadata_log_writer_t(const metadata_log_writer_t&) = delete;
+    metadata_log_writer_t(metadata_log_writer_t&&) = delete;
+    metadata_log_writer_t& operator=(const metadata_log_writer_t&) = delete;
+    metadata_log_writer_t& operator=(metadata_log_writer_t&&) = delete;
+
+    /// @return false if the `record` is dropped
+    bool append(const metadata_record_t& record) noexcept;
+    /// @brief Send the partial block to the writer thread. The file can have the blocks smaller than `block_records`
+    void flush() noexcept;
+
+    metadata_log_stats_t get_stats() const noexcept;
+
+  private:
+    void run() noexcept;
+    bool write(const metadata_block_t& block) noexcept;
+};
+
+/// @brief Columns of 1 block in the mapped file. The pointers are aligned for their type
+struct metadata_block_view_t final {
+    uint32_t count = 0;
+    int64_t first_timestamp = 0;
+    int64_t last_timestamp = 0;
+    const int64_t* timestamp = nullptr;
+    const int64_t* exposure_time = nullptr;
+    const uint32_t* fields = nullptr;
+    const uint32_t* iso_speed = nullptr;
+    const uint32_t* lens_position = nullptr;
+    const uint32_t* focus_state = nullptr;
+    const float* white_balance_gains[3]{}; ///< R, G, B
+    const uint32_t* face_count = nullptr;
+    const metadata_rect_t* faces = nullptr; ///< `max_record_faces` for each record
+
+    /// @note `index` must be less than `count`
+    metadata_record_t record(uint32_t index) const noexcept;
+};
+
+/**
+ * @brief Read-only memory mapped log of `metadata_log_writer_t`
+ *
+ * @details The block headers are read when it's opened. The columns are not copied,
+ *          so a scan over 1 field touches the pages of the column only.
+ *          A truncated block at the end(e.g. the capture process was killed) is ignored.
+ */
+class metadata_log_reader_t final {
+    size_t size = 0; // before `data`. `data` is initialized with it
+    const uint8_t* data = nullptr;
+    std::vector<metadata_block_view_t> blocks{};
+    std::vector<size_t> offsets{}; ///< index of the first record of each block. `record_count()` at the end
+
+  public:
+    /// @throw std::system_error if the file can't be mapped. std::runtime_error if it's not a log
+    explicit metadata_log_reader_t(const std::string& path) noexcept(false);
+    ~metadata_log_reader_t() noexcept;
+    metadata_log_reader_t(const metadata_log_reader_t&) = delete;
+    metadata_log_reader_t(metadata_log_reader_t&&) = delete;
+    metadata_log_reader_t& operator=(const metadata_log_reader_t&) = delete;
+    metadata_log_reader_t& operator=(metadata_log_reader_t&&) = delete;
+
+    /// @brief number of the records
+    size_t record_count() const noexcept {
+        return offsets.back();
+    }
+    size_t block_count() const noexcept {
+        return blocks.size();
+    }
+    const metadata_block_view_t& block(size_t index) const noexcept {
+        return blocks[index];
+    }
+    /// @note `index` must be less than `record_count()`
+    metadata_record_t operator[](size_t index) const noexcept;
+
+    /**
+     * @brief The first record which is not earlier than the `timestamp`. The timestamps must increase
+     * @return `record_count()` if there is no such record
+     */
+    size_t lower_bound(int64_t timestamp) const noexcept;
+};
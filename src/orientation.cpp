@@ -0,0 +1,170 @@
+#include "orientation.hpp"
+#include "pixel_traits.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+orientation_t get_orientation(uint32_t value) noexcept {
+    if (value < 1 || value > 8)
+        return orientation_t::identity;
+    return static_cast<orientation_t>(value);
+}
+
+bool is_transposed(orientation_t orientation) noexcept {
+    return static_cast<uint32_t>(orientation) >= 5;
+}
+
+bool is_mirrored(orientation_t orientation) noexcept {
+    switch (orientation) {
+    case orientation_t::mirror:
+    case orientation_t::flip:
+    case orientation_t::transpose:
+    case orientation_t::transverse:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t get_rotation(orientation_t orientation) noexcept {
+    switch (orientation) {
+    case orientation_t::rotate_90:
+    case orientation_t::transverse:
+        return 90;
+    case orientation_t::rotate_180:
+    case orientation_t::flip: // mirror + 180
+        return 180;
+    case orientation_t::rotate_270:
+    case orientation_t::transpose:
+        return 270;
+    default:
+        return 0;
+    }
+}
+
+bool is_orientable(pixel_format_t format) noexcept {
+    const pixel_traits_t traits = get_pixel_traits(format);
+    return traits.num_plane > 0 && traits.block_pixels == 1 && traits.shift_x == traits.shift_y;
+}
+
+namespace {
+
+/// @brief the pixel `dst(x, y)` is from `src(x, y)` after the reverse of each flag. `transposed` swaps x and y first
+struct orient_flags_t final {
+    bool transposed;
+    bool reverse_x; ///< the columns of the `dst`
+    bool reverse_y; ///< the rows of the `dst`
+};
+
+orient_flags_t get_orient_flags(orientation_t orientation) noexcept {
+    switch (orientation) {
+    case orientation_t::mirror:
+        return {false, true, false};
+    case orientation_t::rotate_180:
+        return {false, true, true};
+    case orientation_t::flip:
+        return {false, false, true};
+    case orientation_t::transpose:
+        return {true, false, false};
+    case orientation_t::rotate_90:
+        return {true, true, false};
+    case orientation_t::transverse:
+        return {true, true, true};
+    case orientation_t::rotate_270:
+        return {true, false, true};
+    default:
+        return {false, false, false};
+    }
+}
+
+/// @brief copy the rows, reversing the pixels of each row for `reverse_x`
+template <typename T>
+void orient_rows(const plane_t& src, const plane_t& dst, orient_flags_t flags, uint32_t begin, uint32_t end) noexcept {
+    const uint32_t width = static_cast<uint32_t>(dst.row_bytes / sizeof(T));
+    for (uint32_t y = begin; y < end; ++y) {
+        const uint8_t* in = src.row(flags.reverse_y ? src.rows - 1 - y : y);
+        if (flags.reverse_x == false) {
+            memcpy(dst.row(y), in, dst.row_bytes);
+            continue;
+        }
+        const T* first = reinterpret_cast<const T*>(in);
+        reverse_copy(first, first + width, reinterpret_cast<T*>(dst.row(y)));
+    }
+}
+
+/**
+ * @brief The row of the `dst` is the column of the `src`
+ * @details The naive loop reads 1 pixel from each row of the `src`, so the cache line is evicted before
+ *          its next pixel is used for the large frames. The `tile` x `tile` block reads `tile` lines of the `src`
+ *          for `tile` lines of the `dst`. The lines to read and the lines to write stay in L1 together.
+ */
+template <typename T, uint32_t tile = cache_line_size / sizeof(T)>
+void orient_tiles(const plane_t& src, const plane_t& dst, orient_flags_t flags, uint32_t begin, uint32_t end) noexcept {
+    const uint32_t width = static_cast<uint32_t>(dst.row_bytes / sizeof(T)); // == src.rows
+    for (uint32_t y0 = begin; y0 < end; y0 += tile) {
+        const uint32_t y1 = min(y0 + tile, end);
+        for (uint32_t x0 = 0; x0 < width; x0 += tile) {
+            const uint32_t x1 = min(x0 + tile, width);
+            for (uint32_t y = y0; y < y1; ++y) {
+                // the column of the `src`
+                const uint32_t sx = flags.reverse_y ? dst.rows - 1 - y : y;
+                const uint8_t* in = src.data + sx * sizeof(T);
+                T* out = reinterpret_cast<T*>(dst.row(y));
+                for (uint32_t x = x0; x < x1; ++x) {
+                    const uint32_t sy = flags.reverse_x ? width - 1 - x : x;
+                    out[x] = *reinterpret_cast<const T*>(in + sy * src.pitch);
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void orient_plane(const plane_t& src, const plane_t& dst, orient_flags_t flags, row_range_t rows) noexcept {
+    const uint32_t end = min(rows.end, dst.rows);
+    if (rows.begin >= end)
+        return;
+    if (flags.transposed)
+        orient_tiles<T>(src, dst, flags, rows.begin, end);
+    else
+        orient_rows<T>(src, dst, flags, rows.begin, end);
+}
+
+} // namespace
+
+bool orient(const frame_view_t& src, const frame_view_t& dst, orientation_t orientation, row_range_t rows) noexcept {
+    if (is_orientable(src.format) == false || src.format != dst.format || src.num_plane != dst.num_plane)
+        return false;
+    const orient_flags_t flags = get_orient_flags(orientation);
+    const uint32_t width = flags.transposed ? src.height : src.width;
+    const uint32_t height = flags.transposed ? src.width : src.height;
+    if (dst.width != width || dst.height != height)
+        return false;
+    const pixel_traits_t traits = get_pixel_traits(src.format);
+    const uint32_t shift = traits.shift_y;
+    const row_range_t chroma_rows{rows.begin >> shift, (rows.end >> shift) + (rows.end % (1u << shift) != 0)};
+    for (uint32_t i = 0; i < src.num_plane; ++i) {
+        const plane_t& in = src.planes[i];
+        const plane_t& out = dst.planes[i];
+        const row_range_t range = i ? chroma_rows : rows;
+        switch (get_samples_per_pixel(traits, i) * traits.bytes_per_sample) {
+        case 1:
+            orient_plane<uint8_t>(in, out, flags, range);
+            break;
+        case 2:
+            orient_plane<uint16_t>(in, out, flags, range);
+            break;
+        case 4:
+            orient_plane<uint32_t>(in, out, flags, range);
+            break;
+        case 8:
+            orient_plane<uint64_t>(in, out, flags, range);
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
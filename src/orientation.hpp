@@ -0,0 +1,52 @@
+/**
+ * @file    orientation.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Rotation and mirroring of the frames for the capture orientation
+ * @see     https://docs.microsoft.com/en-us/windows-hardware/drivers/stream/capture-stats-metadata-attributes
+ */
+#pragma once
+#include <frame_buffer.hpp>
+#include <slice.hpp>
+
+/**
+ * @brief `METADATA_ORIENTATION_ENUM` of the capture metadata. The values are same with the Exif Orientation tag
+ * @details Each one tells how the stored frame must be transformed for the display.
+ *          The rotations are clockwise. `transpose` and `transverse` are the mirrored `rotate_270` and `rotate_90`
+ */
+enum class orientation_t : uint32_t {
+    identity = 1,   ///< `Metadata_Orientation_TopBottomLeftRight`
+    mirror = 2,     ///< horizontal flip. `Metadata_Orientation_TopBottomRightLeft`
+    rotate_180 = 3, ///< `Metadata_Orientation_BottomTopLeftRight`
+    flip = 4,       ///< vertical flip. `Metadata_Orientation_BottomTopRightLeft`
+    transpose = 5,  ///< `Metadata_Orientation_LeftRightTopBottom`
+    rotate_90 = 6,  ///< `Metadata_Orientation_RightLeftTopBottom`
+    transverse = 7, ///< `Metadata_Orientation_LeftRightBottomTop`
+    rotate_270 = 8, ///< `Metadata_Orientation_RightLeftBottomTop`
+};
+
+/// @return `orientation_t::identity` for the values out of the range
+orientation_t get_orientation(uint32_t value) noexcept;
+
+/// @return true if the width and the height are swapped
+bool is_transposed(orientation_t orientation) noexcept;
+
+/// @return true if the `orientation` can't be made with the rotation only
+bool is_mirrored(orientation_t orientation) noexcept;
+
+/// @return clockwise degrees of the rotation after the horizontal flip of `is_mirrored`. 0, 90, 180, 270
+uint32_t get_rotation(orientation_t orientation) noexcept;
+
+/// @return true for the formats which `orient` can process. The packed 4:2:2 formats are not
+bool is_orientable(pixel_format_t format) noexcept;
+
+/**
+ * @brief Write the `src` to the `dst` with the `orientation`
+ *
+ * @details The transposing orientations are processed in the square tiles, so both of the rows to read and the rows
+ *          to write stay in L1 while the tile is processed. The others copy the rows in the reversed order/direction.
+ * @param dst its size must be the transposed one of the `src` if `is_transposed`. It must not overlap the `src`
+ * @param rows of the `dst` to write. The boundaries must be even for 4:2:0. see `parallel_rows`
+ * @return false if the formats or the sizes don't match
+ */
+bool orient(const frame_view_t& src, const frame_view_t& dst, orientation_t orientation,
+            row_range_t rows = all_rows) noexcept;
@@ -0,0 +1,141 @@
+#include "p010.hpp"
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+bool is_high_bit_depth(pixel_format_t format) noexcept {
+    return format == pixel_format_t::p010 || format == pixel_format_t::p016;
+}
+
+/**
+ * @details `threshold` is 128 for the rounding. With the dithering, it's `bayer * 16 + 8`,
+ *          so its average is still 128 and the flat area keeps the fraction of 8 bit
+ */
+void narrow_row_scalar(const uint16_t* src, uint8_t* dst, uint32_t begin, uint32_t end, uint32_t row,
+                       bool dither) noexcept {
+    for (uint32_t x = begin; x < end; ++x) {
+        const uint32_t threshold = dither ? bayer_4x4[row % 4][x % 4] * 16u + 8 : 128;
+        dst[x] = static_cast<uint8_t>(min<uint32_t>(src[x] + threshold, 0xFFFF) >> 8);
+    }
+}
+
+/// @brief Q13 in 16 bit scale → [0, 65535]. `v + (v >> 8)` stretches 255 * 256 to 65535
+static uint16_t clamp_q13_16(int32_t value) noexcept {
+    value = (value + 4096) >> 13;
+    const uint32_t v = static_cast<uint32_t>(value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value));
+    return static_cast<uint16_t>(min<uint32_t>(v + (v >> 8), 0xFFFF));
+}
+
+void convert_row_p010_rgba16_scalar(const uint16_t* y, const uint16_t* uv, uint16_t* dst, uint32_t begin,
+                                    uint32_t end, const yuv_coefficients_t& k) noexcept {
+    const int32_t y_offset = k.y_offset << 8;
+    for (uint32_t x = begin; x < end; ++x) {
+        const uint16_t* chroma = uv + (x / 2) * 2;
+        const int32_t luma = k.y_gain * (y[x] - y_offset);
+        const int32_t u = chroma[0] - 32768;
+        const int32_t v = chroma[1] - 32768;
+        uint16_t* rgba = dst + 4 * x;
+        rgba[0] = clamp_q13_16(luma + k.v_r * v);
+        rgba[1] = clamp_q13_16(luma - k.u_g * u - k.v_g * v);
+        rgba[2] = clamp_q13_16(luma + k.u_b * u);
+        rgba[3] = 0xFFFF;
+    }
+}
+
+/// @param level must be clamped with `clamp_simd_level`
+static void narrow_row(const uint16_t* src, uint8_t* dst, uint32_t count, uint32_t row, bool dither,
+                       simd_level_t level) noexcept {
+    switch (level) {
+#if defined(MEDIA_CORE_X86)
+    case simd_level_t::avx2:
+        return narrow_row_avx2(src, dst, count, row, dither);
+    case simd_level_t::sse41:
+        return narrow_row_sse41(src, dst, count, row, dither);
+#endif
+    default:
+        return narrow_row_scalar(src, dst, 0, count, row, dither);
+    }
+}
+
+static bool is_same_size(const frame_view_t& src, const frame_view_t& dst) noexcept {
+    return src.num_plane && dst.num_plane && src.width == dst.width && src.height == dst.height;
+}
+
+bool convert_p010_to_nv12(const frame_view_t& src, const frame_view_t& dst, dither_t dither, simd_level_t level,
+                          row_range_t rows) noexcept {
+    if (is_high_bit_depth(src.format) == false || dst.format != pixel_format_t::nv12 || !is_same_size(src, dst))
+        return false;
+    level = clamp_simd_level(level);
+    const bool ordered = dither == dither_t::ordered;
+    const uint32_t end = min(rows.end, src.height);
+    for (uint32_t y = rows.begin; y < end; ++y)
+        narrow_row(reinterpret_cast<const uint16_t*>(src.planes[0].row(y)), dst.planes[0].row(y), src.width, y,
+                   ordered, level);
+    // the chroma rows of the range. same with `get_chroma_rows` of the scaler
+    const uint32_t count = dst.planes[1].row_bytes;
+    for (uint32_t y = rows.begin / 2; y < (end + 1) / 2; ++y)
+        narrow_row(reinterpret_cast<const uint16_t*>(src.planes[1].row(y)), dst.planes[1].row(y), count, y, ordered,
+                   level);
+    return true;
+}
+
+bool convert_p010_to_rgb32(const frame_view_t& src, const frame_view_t& dst, yuv_color_t color, simd_level_t level,
+                           row_range_t rows) noexcept {
+    if (is_high_bit_depth(src.format) == false || dst.format != pixel_format_t::rgb32 || !is_same_size(src, dst))
+        return false;
+    const yuv_coefficients_t k = get_yuv_coefficients(color);
+    level = clamp_simd_level(level);
+    // reused by the thread, so the repeated calls don't allocate
+    static thread_local vector<uint8_t> luma{};
+    static thread_local vector<uint8_t> chroma{};
+    try {
+        luma.resize(max<size_t>(luma.size(), src.width));
+        chroma.resize(max<size_t>(chroma.size(), src.planes[1].row_bytes / 2));
+    } catch (const bad_alloc&) {
+        return false;
+    }
+    const uint32_t count = src.planes[1].row_bytes / 2;
+    const uint32_t end = min(rows.end, src.height);
+    for (uint32_t y = rows.begin; y < end; ++y) {
+        // 2 rows share the chroma row
+        if (y % 2 == 0 || y == rows.begin)
+            narrow_row(reinterpret_cast<const uint16_t*>(src.planes[1].row(y / 2)), chroma.data(), count, y / 2,
+                       false, level);
+        narrow_row(reinterpret_cast<const uint16_t*>(src.planes[0].row(y)), luma.data(), src.width, y, false,
+                   level);
+        convert_row_nv12_rgb32(luma.data(), chroma.data(), dst.planes[0].row(y), src.width, k, level);
+    }
+    return true;
+}
+
+bool convert_p010_to_rgba16(const frame_view_t& src, const frame_view_t& dst, yuv_color_t color, simd_level_t level,
+                            row_range_t rows) noexcept {
+    if (is_high_bit_depth(src.format) == false || dst.format != pixel_format_t::rgba16 || !is_same_size(src, dst))
+        return false;
+    const yuv_coefficients_t k = get_yuv_coefficients(color);
+    level = clamp_simd_level(level);
+    const uint32_t end = min(rows.end, src.height);
+    for (uint32_t row = rows.begin; row < end; ++row) {
+        const auto* y = reinterpret_cast<const uint16_t*>(src.planes[0].row(row));
+        const auto* uv = reinterpret_cast<const uint16_t*>(src.planes[1].row(row / 2));
+        auto* out = reinterpret_cast<uint16_t*>(dst.planes[0].row(row));
+        switch (level) {
+#if defined(MEDIA_CORE_X86)
+        case simd_level_t::avx2:
+            convert_row_p010_rgba16_avx2(y, uv, out, src.width, k);
+            break;
+        case simd_level_t::sse41:
+            convert_row_p010_rgba16_sse41(y, uv, out, src.width, k);
+            break;
+#endif
+        default:
+            convert_row_p010_rgba16_scalar(y, uv, out, 0, src.width, k);
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file    p010.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   P010/P016 → 8 bit formats without the MFT round trip
+ * @see     https://docs.microsoft.com/en-us/windows/win32/medfound/10-bit-and-16-bit-yuv-video-formats
+ */
+#pragma once
+#include <color_convert.hpp>
+#include <frame_buffer.hpp>
+#include <rgb565.hpp>
+#include <simd.hpp>
+#include <slice.hpp>
+
+/// @return true for `p010` and `p016`. Their samples are in the high bits, so the kernels are shared
+bool is_high_bit_depth(pixel_format_t format) noexcept;
+
+/**
+ * @brief P010/P016 → NV12. The high 8 bits of each sample are rounded
+ * @param dither `dither_t::ordered` spreads the dropped bits with 4x4 Bayer matrix. Same with `dither_t` of RGB565
+ * @param level `simd_level_t::scalar` for the reference. clamped with `clamp_simd_level`
+ * @param rows  of the `dst` to write. see `parallel_rows`
+ * @return false if the formats or the sizes don't match
+ */
+bool convert_p010_to_nv12(const frame_view_t& src, const frame_view_t& dst, dither_t dither = dither_t::none,
+                          simd_level_t level = get_simd_level(), row_range_t rows = all_rows) noexcept;
+
+/**
+ * @brief P010/P016 → RGB32. Same with P010 → NV12 → RGB32, but the NV12 rows are not stored
+ * @note  The 4th byte is 255
+ */
+bool convert_p010_to_rgb32(const frame_view_t& src, const frame_view_t& dst, yuv_color_t color = {},
+                           simd_level_t level = get_simd_level(), row_range_t rows = all_rows) noexcept;
+
+/**
+ * @brief P010/P016 → RGBA16. Keeps the precision of the samples for the HDR processing
+ * @details The `color` is applied in 16 bit scale. 255 of 8 bit becomes 65535, so the limited range white
+ *          (940 of 10 bit) becomes 65535 too. The 4th sample is 65535
+ */
+bool convert_p010_to_rgba16(const frame_view_t& src, const frame_view_t& dst, yuv_color_t color = {},
+                            simd_level_t level = get_simd_level(), row_range_t rows = all_rows) noexcept;
@@ -0,0 +1,76 @@
+/**
+ * @note compiled with AVX2. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+/// @brief the thresholds of 16 samples for the `row`. see `narrow_row_scalar`
+__m256i make_threshold(uint32_t row, bool dither) noexcept {
+    if (dither == false)
+        return _mm256_set1_epi16(128);
+    const uint8_t* t = bayer_4x4[row % 4];
+    const __m128i lane = _mm_setr_epi16(t[0] * 16 + 8, t[1] * 16 + 8, t[2] * 16 + 8, t[3] * 16 + 8, //
+                                        t[0] * 16 + 8, t[1] * 16 + 8, t[2] * 16 + 8, t[3] * 16 + 8);
+    return _mm256_broadcastsi128_si256(lane);
+}
+
+__m256i round_q13(__m256i sum) noexcept {
+    return _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(4096)), 13);
+}
+
+__m256i mul(__m256i a, int32_t b) noexcept {
+    return _mm256_mullo_epi32(a, _mm256_set1_epi32(b));
+}
+
+} // namespace
+
+void narrow_row_avx2(const uint16_t* src, uint8_t* dst, uint32_t count, uint32_t row, bool dither) noexcept {
+    const __m256i threshold = make_threshold(row, dither);
+    uint32_t x = 0;
+    for (; x + 32 <= count; x += 32) {
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x + 16));
+        const __m256i a = _mm256_srli_epi16(_mm256_adds_epu16(lo, threshold), 8);
+        const __m256i b = _mm256_srli_epi16(_mm256_adds_epu16(hi, threshold), 8);
+        // the pack works in the 128 bit lanes. [a0 b0 a1 b1] → [a0 a1 b0 b1]
+        const __m256i packed = _mm256_packus_epi16(a, b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_permute4x64_epi64(packed, 0b11'01'10'00));
+    }
+    narrow_row_scalar(src, dst, x, count, row, dither);
+}
+
+void convert_row_p010_rgba16_avx2(const uint16_t* y, const uint16_t* uv, uint16_t* dst, uint32_t width,
+                                  const yuv_coefficients_t& k) noexcept {
+    const __m256i alpha = _mm256_set1_epi32(0xFFFF);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m256i luma = mul(
+            _mm256_sub_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x))),
+                             _mm256_set1_epi32(k.y_offset << 8)),
+            k.y_gain);
+        // 4 U/V pairs. the pixels 0-3 are in the low lane, 4-7 are in the high lane
+        const __m256i uv8 = _mm256_sub_epi32(
+            _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x))), _mm256_set1_epi32(32768));
+        const __m256i u = _mm256_shuffle_epi32(uv8, _MM_SHUFFLE(2, 2, 0, 0));
+        const __m256i v = _mm256_shuffle_epi32(uv8, _MM_SHUFFLE(3, 3, 1, 1));
+        const __m256i r = round_q13(_mm256_add_epi32(luma, mul(v, k.v_r)));
+        const __m256i g = round_q13(_mm256_sub_epi32(_mm256_sub_epi32(luma, mul(u, k.u_g)), mul(v, k.v_g)));
+        const __m256i b = round_q13(_mm256_add_epi32(luma, mul(u, k.u_b)));
+        // [r0-3 g0-3 | r4-7 g4-7], [b0-3 a0-3 | b4-7 a4-7]. see `clamp_q13_16` for the stretch
+        __m256i rg = _mm256_packus_epi32(r, g);
+        rg = _mm256_adds_epu16(rg, _mm256_srli_epi16(rg, 8));
+        __m256i ba = _mm256_packus_epi32(b, alpha);
+        ba = _mm256_adds_epu16(ba, _mm256_srli_epi16(ba, 8));
+        const __m256i rb = _mm256_unpacklo_epi16(rg, ba); // r0 b0 r1 b1 ...
+        const __m256i ga = _mm256_unpackhi_epi16(rg, ba); // g0 a0 g1 a1 ...
+        const __m256i lo = _mm256_unpacklo_epi16(rb, ga); // [pixel 0-1 | pixel 4-5]
+        const __m256i hi = _mm256_unpackhi_epi16(rb, ga); // [pixel 2-3 | pixel 6-7]
+        auto* out = reinterpret_cast<__m256i*>(dst + 4 * x);
+        _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    convert_row_p010_rgba16_scalar(y, uv, dst, x, width, k);
+}
@@ -0,0 +1,79 @@
+/**
+ * @note compiled with SSE 4.1. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+/// @brief the thresholds of 8 samples for the `row`. see `narrow_row_scalar`
+__m128i make_threshold(uint32_t row, bool dither) noexcept {
+    if (dither == false)
+        return _mm_set1_epi16(128);
+    const uint8_t* t = bayer_4x4[row % 4];
+    return _mm_setr_epi16(t[0] * 16 + 8, t[1] * 16 + 8, t[2] * 16 + 8, t[3] * 16 + 8, //
+                          t[0] * 16 + 8, t[1] * 16 + 8, t[2] * 16 + 8, t[3] * 16 + 8);
+}
+
+/// @brief `(sum + 4096) >> 13` of 4 pixels
+__m128i round_q13(__m128i sum) noexcept {
+    return _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(4096)), 13);
+}
+
+/// @brief R, G, B of 4 pixels. `y` and `uv` are 32 bit lanes
+void convert_4(__m128i y, __m128i uv, const yuv_coefficients_t& k, __m128i& r, __m128i& g, __m128i& b) noexcept {
+    uv = _mm_sub_epi32(uv, _mm_set1_epi32(32768));
+    const __m128i u = _mm_shuffle_epi32(uv, _MM_SHUFFLE(2, 2, 0, 0));
+    const __m128i v = _mm_shuffle_epi32(uv, _MM_SHUFFLE(3, 3, 1, 1));
+    const __m128i luma = _mm_mullo_epi32(_mm_sub_epi32(y, _mm_set1_epi32(k.y_offset << 8)), _mm_set1_epi32(k.y_gain));
+    r = round_q13(_mm_add_epi32(luma, _mm_mullo_epi32(v, _mm_set1_epi32(k.v_r))));
+    g = round_q13(_mm_sub_epi32(_mm_sub_epi32(luma, _mm_mullo_epi32(u, _mm_set1_epi32(k.u_g))),
+                                _mm_mullo_epi32(v, _mm_set1_epi32(k.v_g))));
+    b = round_q13(_mm_add_epi32(luma, _mm_mullo_epi32(u, _mm_set1_epi32(k.u_b))));
+}
+
+/// @brief clamp to [0, 65535] and `v + (v >> 8)` with the saturation. see `clamp_q13_16`
+__m128i stretch(__m128i lo, __m128i hi) noexcept {
+    const __m128i v = _mm_packus_epi32(lo, hi);
+    return _mm_adds_epu16(v, _mm_srli_epi16(v, 8));
+}
+
+} // namespace
+
+void narrow_row_sse41(const uint16_t* src, uint8_t* dst, uint32_t count, uint32_t row, bool dither) noexcept {
+    // the pattern repeats every 4 samples, so the vector is reused for the row
+    const __m128i threshold = make_threshold(row, dither);
+    uint32_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 8));
+        const __m128i a = _mm_srli_epi16(_mm_adds_epu16(lo, threshold), 8);
+        const __m128i b = _mm_srli_epi16(_mm_adds_epu16(hi, threshold), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a, b));
+    }
+    narrow_row_scalar(src, dst, x, count, row, dither);
+}
+
+void convert_row_p010_rgba16_sse41(const uint16_t* y, const uint16_t* uv, uint16_t* dst, uint32_t width,
+                                   const yuv_coefficients_t& k) noexcept {
+    const __m128i alpha = _mm_set1_epi16(-1);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i uv8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x)); // 4 U/V pairs
+        __m128i r0, g0, b0, r1, g1, b1;
+        convert_4(_mm_cvtepu16_epi32(y8), _mm_cvtepu16_epi32(uv8), k, r0, g0, b0);
+        convert_4(_mm_cvtepu16_epi32(_mm_srli_si128(y8, 8)), _mm_cvtepu16_epi32(_mm_srli_si128(uv8, 8)), k, r1, g1,
+                  b1);
+        const __m128i r = stretch(r0, r1), g = stretch(g0, g1), b = stretch(b0, b1);
+        const __m128i rg_lo = _mm_unpacklo_epi16(r, g), rg_hi = _mm_unpackhi_epi16(r, g);
+        const __m128i ba_lo = _mm_unpacklo_epi16(b, alpha), ba_hi = _mm_unpackhi_epi16(b, alpha);
+        auto* out = reinterpret_cast<__m128i*>(dst + 4 * x);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi32(rg_lo, ba_lo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi32(rg_lo, ba_lo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi32(rg_hi, ba_hi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi32(rg_hi, ba_hi));
+    }
+    convert_row_p010_rgba16_scalar(y, uv, dst, x, width, k);
+}
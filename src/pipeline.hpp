@@ -0,0 +1,233 @@
+/**
+ * @file    pipeline.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Multi-threaded source → stages → sink engine
+ */
+#pragma once
+#include <bounded_queue.hpp>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs each stage on its own worker thread and connects them with `bounded_queue_t`
+ *
+ * @details While the sink consumes the frame N, the stages work on N+1 and the source reads N+2.
+ *          The queue capacity bounds the latency and the memory between the stages.
+ *          If a stage throws, the pipeline stops and `wait` rethrows the first exception.
+ *
+ * @code
+ * pipeline_t<frame_t> pipeline{2};
+ * pipeline.set_source([&](frame_t& frame) { return read(frame); }); // false for the end of stream
+ * pipeline.add_stage([](frame_t&& frame, const auto& emit) { emit(convert(frame)); });
+ * pipeline.set_sink([&](frame_t&& frame) { write(frame); });
+ * pipeline.start();
+ * pipeline.wait();
+ * @endcode
+ */
+template <typename T>
+class pipeline_t final {
+  public:
+    /// @return false if the pipeline is stopping. the stage may return early
+    using emit_t = std::function<bool(T&&)>;
+    /// @return false for the end of the stream
+    using source_t = std::function<bool(T&)>;
+    /// @note 1 input can emit 0 or more outputs. (e.g. decoder)
+    using process_t = std::function<void(T&&, const emit_t&)>;
+    /// @note invoked after the last input. the stage can emit its buffered outputs
+    using drain_t = std::function<void(const emit_t&)>;
+    using sink_t = std::function<void(T&&)>;
+    using drop_hook_t = typename bounded_queue_t<T>::drop_hook_t;
+    using droppable_t = typename bounded_queue_t<T>::droppable_t;
+
+  private:
+    struct stage_t final {
+        process_t process;
+        drain_t drain;
+    };
+
+    size_t capacity;
+    source_t source{};
+    std::vector<stage_t> stages{};
+    sink_t sink{};
+    /// @note `queues[i]` is the input of `stages[i]`. the last one is the output of the pipeline
+    std::vector<std::unique_ptr<bounded_queue_t<T>>> queues{};
+    std::vector<overflow_policy_t> policies{}; // for `queues`. `block` if not specified
+    drop_hook_t on_drop{};
+    droppable_t droppable{};
+    std::vector<std::thread> workers{};
+    std::atomic_bool stopped{false};
+    std::mutex mtx{};
+    std::exception_ptr error{};
+
+  public:
+    /// @param capacity of the queue between the stages
+    explicit pipeline_t(size_t capacity = 4) noexcept : capacity{capacity} {
+    }
+    ~pipeline_t() noexcept {
+        stop();
+        join();
+    }
+    pipeline_t(const pipeline_t&) = delete;
+    pipeline_t(pipeline_t&&) = delete;
+    pipeline_t& operator=(const pipeline_t&) = delete;
+    pipeline_t& operator=(pipeline_t&&) = delete;
+
+    void set_source(source_t fn) noexcept {
+        source = std::move(fn);
+    }
+    void add_stage(process_t process, drain_t drain = nullptr) noexcept(false) {
+        stages.emplace_back(stage_t{std::move(process), std::move(drain)});
+    }
+    /// @note if there is no sink, the caller must consume the outputs with `pop`
+    void set_sink(sink_t fn) noexcept {
+        sink = std::move(fn);
+    }
+
+    /**
+     * @param index of the queue. `0` is the output of the source, `num_stage()` is the output of the pipeline
+     * @note  applied when `start`
+     */
+    void set_policy(size_t index, overflow_policy_t policy) noexcept(false) {
+        if (policies.size() <= index)
+            policies.resize(index + 1, overflow_policy_t::block);
+        policies[index] = policy;
+    }
+    /// @note shared by all queues. invoked in the thread of the producer
+    void set_drop_hook(drop_hook_t fn) noexcept {
+        on_drop = std::move(fn);
+    }
+    /// @see `overflow_policy_t::drop_non_reference`
+    void set_droppable(droppable_t fn) noexcept {
+        droppable = std::move(fn);
+    }
+
+    size_t num_stage() const noexcept {
+        return stages.size();
+    }
+
+    /// @return counters of the queue. empty if not started
+    queue_stats_t stats(size_t index) const noexcept {
+        if (index < queues.size())
+            return queues[index]->stats();
+        return {};
+    }
+
+    /**
+     * @brief create the queues and the worker threads
+     * @throw std::logic_error if there is no source or already started
+     * @throw std::system_error
+     */
+    void start() noexcept(false) {
+        if (source == nullptr)
+            throw std::logic_error{"pipeline_t: source is required"};
+        if (workers.empty() == false)
+            throw std::logic_error{"pipeline_t: already started"};
+        for (size_t i = 0; i <= stages.size(); ++i) {
+            const auto policy = i < policies.size() ? policies[i] : overflow_policy_t::block;
+            auto& queue = queues.emplace_back(std::make_unique<bounded_queue_t<T>>(capacity, policy));
+            queue->set_drop_hook(on_drop);
+            queue->set_droppable(droppable);
+        }
+        try {
+            workers.emplace_back(&pipeline_t::run_source, this);
+            for (size_t i = 0; i < stages.size(); ++i)
+                workers.emplace_back(&pipeline_t::run_stage, this, i);
+            if (sink)
+                workers.emplace_back(&pipeline_t::run_sink, this);
+        } catch (...) {
+            stop();
+            join();
+            throw;
+        }
+    }
+
+    /// @brief output of the last stage when there is no sink
+    /// @return false if the pipeline is finished
+    bool pop(T& item) noexcept(false) {
+        return queues.back()->pop(item);
+    }
+
+    /// @brief cancel the pipeline. the items in the queues are discarded
+    void stop() noexcept {
+        stopped = true;
+        for (auto& queue : queues)
+            queue->cancel();
+    }
+
+    /**
+     * @brief join the worker threads
+     * @throw the first exception from the source/stages/sink
+     */
+    void wait() noexcept(false) {
+        join();
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    bool is_stopped() const noexcept {
+        return stopped;
+    }
+
+  private:
+    void join() noexcept {
+        for (auto& worker : workers)
+            if (worker.joinable())
+                worker.join();
+    }
+
+    void fail(std::exception_ptr ex) noexcept {
+        {
+            std::lock_guard lck{mtx};
+            if (error == nullptr)
+                error = ex;
+        }
+        stop();
+    }
+
+    void run_source() noexcept {
+        bounded_queue_t<T>& output = *queues.front();
+        try {
+            T item{};
+            while (stopped == false && source(item))
+                if (output.push(std::move(item)) == false)
+                    break;
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        output.close();
+    }
+
+    void run_stage(size_t index) noexcept {
+        stage_t& stage = stages[index];
+        bounded_queue_t<T>& input = *queues[index];
+        bounded_queue_t<T>& output = *queues[index + 1];
+        const emit_t emit = [&output](T&& item) { return output.push(std::move(item)); };
+        try {
+            T item{};
+            while (input.pop(item))
+                stage.process(std::move(item), emit);
+            if (stage.drain && stopped == false)
+                stage.drain(emit);
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        output.close();
+    }
+
+    void run_sink() noexcept {
+        bounded_queue_t<T>& input = *queues.back();
+        try {
+            T item{};
+            while (input.pop(item))
+                sink(std::move(item));
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    }
+};
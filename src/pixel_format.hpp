@@ -0,0 +1,22 @@
+/**
+ * @file    pixel_format.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Uncompressed video formats for `media_core`. Maps to `MFVideoFormat_*` subtypes in Windows
+ * @see     https://docs.microsoft.com/en-us/windows/win32/medfound/video-subtype-guids
+ */
+#pragma once
+#include <cstdint>
+
+enum class pixel_format_t : uint32_t {
+    unknown = 0,
+    nv12,   ///< 4:2:0 semi-planar. Y plane + interleaved UV plane
+    i420,   ///< 4:2:0 planar. Y, U, V planes. Same memory layout with IYUV
+    rgb32,  ///< packed 32 bit. B, G, R, X order in the memory
+    rgb565, ///< packed 16 bit
+    nv21,   ///< 4:2:0 semi-planar. Y plane + interleaved VU plane
+    yuy2,   ///< 4:2:2 packed. Y0, U, Y1, V order in the memory
+    uyvy,   ///< 4:2:2 packed. U, Y0, V, Y1 order in the memory
+    p010,   ///< 4:2:0 semi-planar with 16 bit little endian samples. 10 bits in the high bits
+    p016,   ///< 4:2:0 semi-planar with 16 bit little endian samples
+    rgba16, ///< packed 64 bit. R, G, B, A order in the memory with 16 bit each
+};
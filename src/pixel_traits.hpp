@@ -0,0 +1,137 @@
+/**
+ * @file    pixel_traits.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Compile-time layout of `pixel_format_t`
+ * @see     https://docs.microsoft.com/en-us/windows/win32/medfound/video-subtype-guids
+ * @see     https://docs.microsoft.com/en-us/windows/win32/medfound/recommended-8-bit-yuv-formats-for-video-rendering
+ */
+#pragma once
+#include <pixel_format.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+/// @brief same with `MAKEFOURCC`. The `Data1` of the `MFVideoFormat_*` GUIDs
+constexpr uint32_t make_fourcc(char a, char b, char c, char d) noexcept {
+    return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+}
+
+/**
+ * @brief Memory layout of 1 `pixel_format_t`
+ *
+ * @details The first plane holds the luma(or the packed pixels). The others hold the chroma with the subsampling.
+ *          A row of the first plane is a sequence of the blocks. YUY2 uses 4 byte block for 2 pixels.
+ */
+struct pixel_traits_t final {
+    uint32_t fourcc;           ///< `FourCC`, or `D3DFORMAT` for the RGB formats. The `Data1` of the subtype GUID
+    uint32_t num_plane;        ///< 0 for `pixel_format_t::unknown`
+    uint32_t shift_x;          ///< log2 of the horizontal chroma subsampling. 1 for 4:2:0 and 4:2:2
+    uint32_t shift_y;          ///< log2 of the vertical chroma subsampling. 1 for 4:2:0
+    uint32_t bits_per_sample;  ///< significant bits. 5 for RGB565 (its G has 6)
+    uint32_t bytes_per_sample; ///< storage of a sample. RGB565 stores a pixel in 1 sample
+    uint32_t block_bytes;      ///< bytes of a block in the first plane
+    uint32_t block_pixels;     ///< pixels in a block of the first plane
+    uint32_t chroma_samples;   ///< interleaved samples in a row of the chroma plane. 2 for NV12, 1 for I420
+};
+
+/// @note `constexpr`. Add a case here for a new `pixel_format_t`
+constexpr pixel_traits_t get_pixel_traits(pixel_format_t format) noexcept {
+    switch (format) {
+    case pixel_format_t::nv12:
+        return {make_fourcc('N', 'V', '1', '2'), 2, 1, 1, 8, 1, 1, 1, 2};
+    case pixel_format_t::nv21:
+        return {make_fourcc('N', 'V', '2', '1'), 2, 1, 1, 8, 1, 1, 1, 2};
+    case pixel_format_t::i420:
+        return {make_fourcc('I', '4', '2', '0'), 3, 1, 1, 8, 1, 1, 1, 1};
+    case pixel_format_t::rgb32:
+        return {22, 1, 0, 0, 8, 1, 4, 1, 0}; // D3DFMT_X8R8G8B8
+    case pixel_format_t::rgb565:
+        return {23, 1, 0, 0, 5, 2, 2, 1, 0}; // D3DFMT_R5G6B5
+    case pixel_format_t::yuy2:
+        return {make_fourcc('Y', 'U', 'Y', '2'), 1, 1, 0, 8, 1, 4, 2, 0};
+    case pixel_format_t::uyvy:
+        return {make_fourcc('U', 'Y', 'V', 'Y'), 1, 1, 0, 8, 1, 4, 2, 0};
+    case pixel_format_t::p010:
+        return {make_fourcc('P', '0', '1', '0'), 2, 1, 1, 10, 2, 2, 1, 2};
+    case pixel_format_t::p016:
+        return {make_fourcc('P', '0', '1', '6'), 2, 1, 1, 16, 2, 2, 1, 2};
+    case pixel_format_t::rgba16:
+        return {36, 1, 0, 0, 16, 2, 8, 1, 0}; // D3DFMT_A16B16G16R16. not a Media Foundation subtype
+    default:
+        return {};
+    }
+}
+
+/// @brief for the kernels which are specialized with the format. `pixel_traits_v<pixel_format_t::nv12>.num_plane`
+template <pixel_format_t F>
+constexpr pixel_traits_t pixel_traits_v = get_pixel_traits(F);
+
+/// @return `pixel_format_t::unknown` if the `fourcc` is not supported. IYUV is same with I420
+constexpr pixel_format_t get_pixel_format(uint32_t fourcc) noexcept {
+    if (fourcc == make_fourcc('I', 'Y', 'U', 'V'))
+        return pixel_format_t::i420;
+    for (auto format : {pixel_format_t::nv12, pixel_format_t::i420, pixel_format_t::rgb32, pixel_format_t::rgb565,
+                        pixel_format_t::nv21, pixel_format_t::yuy2, pixel_format_t::uyvy, pixel_format_t::p010,
+                        pixel_format_t::p016, pixel_format_t::rgba16})
+        if (get_pixel_traits(format).fourcc == fourcc)
+            return format;
+    return pixel_format_t::unknown;
+}
+
+/// @return interleaved samples of a pixel in the plane. 4 for RGB32, 2 for YUY2
+constexpr uint32_t get_samples_per_pixel(const pixel_traits_t& traits, uint32_t plane) noexcept {
+    if (plane >= traits.num_plane)
+        return 0;
+    if (plane > 0)
+        return traits.chroma_samples;
+    return traits.block_bytes / traits.block_pixels / traits.bytes_per_sample;
+}
+
+/// @return bytes of pixels in a row of the plane. 0 if the format doesn't have the plane
+constexpr size_t get_row_bytes(const pixel_traits_t& traits, uint32_t width, uint32_t plane = 0) noexcept {
+    if (plane >= traits.num_plane)
+        return 0;
+    if (plane == 0)
+        return static_cast<size_t>((width + traits.block_pixels - 1) / traits.block_pixels) * traits.block_bytes;
+    const uint32_t chroma_width = (width + (1u << traits.shift_x) - 1) >> traits.shift_x;
+    return static_cast<size_t>(chroma_width) * traits.chroma_samples * traits.bytes_per_sample;
+}
+
+/// @return rows of the plane. 0 if the format doesn't have the plane
+constexpr uint32_t get_plane_rows(const pixel_traits_t& traits, uint32_t height, uint32_t plane = 0) noexcept {
+    if (plane >= traits.num_plane)
+        return 0;
+    if (plane == 0)
+        return height;
+    return (height + (1u << traits.shift_y) - 1) >> traits.shift_y;
+}
+
+/**
+ * @return the pitch of the plane when the first plane uses `pitch`. Same with `IMF2DBuffer`.
+ *         For I420, the chroma planes use the half. 0 if the plane can't use the `pitch`
+ */
+constexpr size_t get_plane_pitch(const pixel_traits_t& traits, size_t pitch, uint32_t plane = 0) noexcept {
+    if (plane >= traits.num_plane)
+        return 0;
+    if (plane == 0)
+        return pitch;
+    const size_t scaled = pitch * traits.chroma_samples;
+    if (scaled % (size_t{1} << traits.shift_x))
+        return 0;
+    return scaled >> traits.shift_x;
+}
+
+/**
+ * @brief bytes of the frame without row padding. The planes are placed one after another
+ * @note  Same with `MFCalculateImageSize` for the even sizes, but it can be used in `constexpr`
+ */
+constexpr size_t get_image_size(pixel_format_t format, uint32_t width, uint32_t height) noexcept {
+    const pixel_traits_t traits = get_pixel_traits(format);
+    size_t total = 0;
+    for (uint32_t plane = 0; plane < traits.num_plane; ++plane)
+        total += get_row_bytes(traits, width, plane) * get_plane_rows(traits, height, plane);
+    return total;
+}
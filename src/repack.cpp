@@ -0,0 +1,334 @@
+#include "repack.hpp"
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+void split_uv_scalar(const uint8_t* uv, uint8_t* u, uint8_t* v, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i) {
+        u[i] = uv[2 * i];
+        v[i] = uv[2 * i + 1];
+    }
+}
+
+void merge_uv_scalar(const uint8_t* u, const uint8_t* v, uint8_t* uv, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i) {
+        uv[2 * i] = u[i];
+        uv[2 * i + 1] = v[i];
+    }
+}
+
+void swap_pairs_scalar(const uint8_t* src, uint8_t* dst, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i) {
+        const uint8_t first = src[2 * i];
+        dst[2 * i] = src[2 * i + 1];
+        dst[2 * i + 1] = first;
+    }
+}
+
+void average_scalar(const uint8_t* a, const uint8_t* b, uint8_t* dst, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i)
+        dst[i] = static_cast<uint8_t>((a[i] + b[i] + 1) / 2);
+}
+
+/// @tparam Y0 offset of the first luma in the 4 byte group. U, V follow with 2 byte step
+template <uint32_t Y0, uint32_t U>
+static void unpack_422(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t m = begin / 2; m < (end + 1) / 2; ++m) {
+        const uint8_t* group = src + 4 * m;
+        y[2 * m] = group[Y0];
+        if (2 * m + 1 < end)
+            y[2 * m + 1] = group[Y0 + 2];
+        u[m] = group[U];
+        v[m] = group[U + 2];
+    }
+}
+
+template <uint32_t Y0, uint32_t U>
+static void pack_422(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t begin,
+                     uint32_t end) noexcept {
+    for (uint32_t m = begin / 2; m < (end + 1) / 2; ++m) {
+        uint8_t* group = dst + 4 * m;
+        group[Y0] = y[2 * m];
+        group[Y0 + 2] = 2 * m + 1 < end ? y[2 * m + 1] : y[2 * m]; // repeat for the odd width
+        group[U] = u[m];
+        group[U + 2] = v[m];
+    }
+}
+
+void unpack_yuy2_scalar(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t begin,
+                        uint32_t end) noexcept {
+    unpack_422<0, 1>(src, y, u, v, begin, end);
+}
+void unpack_uyvy_scalar(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t begin,
+                        uint32_t end) noexcept {
+    unpack_422<1, 0>(src, y, u, v, begin, end);
+}
+void pack_yuy2_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t begin,
+                      uint32_t end) noexcept {
+    pack_422<0, 1>(y, u, v, dst, begin, end);
+}
+void pack_uyvy_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t begin,
+                      uint32_t end) noexcept {
+    pack_422<1, 0>(y, u, v, dst, begin, end);
+}
+
+namespace {
+
+/// @brief row kernels of 1 `simd_level_t`. the scalar ones are adapted to the same signature
+struct repack_kernels_t final {
+    void (*split_uv)(const uint8_t*, uint8_t*, uint8_t*, uint32_t);
+    void (*merge_uv)(const uint8_t*, const uint8_t*, uint8_t*, uint32_t);
+    void (*swap_pairs)(const uint8_t*, uint8_t*, uint32_t);
+    void (*average)(const uint8_t*, const uint8_t*, uint8_t*, uint32_t);
+    void (*unpack_yuy2)(const uint8_t*, uint8_t*, uint8_t*, uint8_t*, uint32_t);
+    void (*unpack_uyvy)(const uint8_t*, uint8_t*, uint8_t*, uint8_t*, uint32_t);
+    void (*pack_yuy2)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, uint32_t);
+    void (*pack_uyvy)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, uint32_t);
+};
+
+const repack_kernels_t scalar_kernels{
+    [](const uint8_t* uv, uint8_t* u, uint8_t* v, uint32_t n) noexcept { split_uv_scalar(uv, u, v, 0, n); },
+    [](const uint8_t* u, const uint8_t* v, uint8_t* uv, uint32_t n) noexcept { merge_uv_scalar(u, v, uv, 0, n); },
+    [](const uint8_t* src, uint8_t* dst, uint32_t n) noexcept { swap_pairs_scalar(src, dst, 0, n); },
+    [](const uint8_t* a, const uint8_t* b, uint8_t* dst, uint32_t n) noexcept { average_scalar(a, b, dst, 0, n); },
+    [](const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t w) noexcept {
+        unpack_yuy2_scalar(src, y, u, v, 0, w);
+    },
+    [](const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t w) noexcept {
+        unpack_uyvy_scalar(src, y, u, v, 0, w);
+    },
+    [](const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t w) noexcept {
+        pack_yuy2_scalar(y, u, v, dst, 0, w);
+    },
+    [](const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t w) noexcept {
+        pack_uyvy_scalar(y, u, v, dst, 0, w);
+    },
+};
+
+#if defined(MEDIA_CORE_X86)
+const repack_kernels_t sse41_kernels{
+    &split_uv_sse41,    &merge_uv_sse41,    &swap_pairs_sse41, &average_sse41,
+    &unpack_yuy2_sse41, &unpack_uyvy_sse41, &pack_yuy2_sse41,  &pack_uyvy_sse41,
+};
+// the 4:2:2 kernels cross the 128 bit lanes too often. SSE 4.1 ones are used
+const repack_kernels_t avx2_kernels{
+    &split_uv_avx2,     &merge_uv_avx2,     &swap_pairs_avx2, &average_avx2,
+    &unpack_yuy2_sse41, &unpack_uyvy_sse41, &pack_yuy2_sse41, &pack_uyvy_sse41,
+};
+#endif
+
+const repack_kernels_t& get_repack_kernels(simd_level_t level) noexcept {
+    switch (clamp_simd_level(level)) {
+#if defined(MEDIA_CORE_X86)
+    case simd_level_t::avx2:
+        return avx2_kernels;
+    case simd_level_t::sse41:
+        return sse41_kernels;
+#endif
+    default:
+        return scalar_kernels;
+    }
+}
+
+bool is_packed_422(pixel_format_t format) noexcept {
+    return format == pixel_format_t::yuy2 || format == pixel_format_t::uyvy;
+}
+
+/// @brief planar chroma rows of 1 row pair. points into the frame or the scratch memory
+struct chroma_rows_t final {
+    const uint8_t* u;
+    const uint8_t* v;
+};
+
+class repacker_t final {
+    const frame_view_t& src;
+    const frame_view_t& dst;
+    const repack_kernels_t& k;
+    const uint32_t width;
+    const uint32_t chroma_width;
+    uint8_t* scratch; // 4 rows of `chroma_width`
+    row_range_t range{};
+
+  public:
+    repacker_t(const frame_view_t& src, const frame_view_t& dst, const repack_kernels_t& k,
+               uint8_t* scratch) noexcept
+        : src{src}, dst{dst}, k{k}, width{src.width}, chroma_width{(src.width + 1) / 2}, scratch{scratch} {
+    }
+
+    /// @note `begin` is even for 4:2:0 `dst`. the row pairs are not split
+    void run(row_range_t rows) noexcept {
+        range = rows;
+        const uint32_t end = min(rows.end, src.height);
+        for (uint32_t row = rows.begin & ~1u; row < end; row += 2) {
+            const bool pair = row + 1 < src.height;
+            if (is_packed_422(src.format))
+                from_422(row, pair);
+            else
+                from_420(row, pair);
+        }
+    }
+
+  private:
+    /// @brief the row of the 4:2:2 `dst` is written alone
+    bool is_in_range(uint32_t row) const noexcept {
+        return row >= range.begin && row < range.end;
+    }
+
+    uint8_t* scratch_row(uint32_t index) const noexcept {
+        return scratch + index * chroma_width;
+    }
+
+    /// @brief I420/NV12/NV21 → any
+    void from_420(uint32_t row, bool pair) noexcept {
+        const uint32_t chroma_row = row / 2;
+        for (uint32_t i = 0; i < (pair ? 2u : 1u); ++i) {
+            if (is_packed_422(dst.format) == false)
+                memcpy(dst.planes[0].row(row + i), src.planes[0].row(row + i), width);
+        }
+        if (src.format != pixel_format_t::i420 && dst.format != pixel_format_t::i420 &&
+            is_packed_422(dst.format) == false) {
+            // NV12/NV21 → NV12/NV21
+            const uint8_t* uv = src.planes[1].row(chroma_row);
+            uint8_t* out = dst.planes[1].row(chroma_row);
+            if (src.format == dst.format)
+                memcpy(out, uv, chroma_width * 2);
+            else
+                k.swap_pairs(uv, out, chroma_width);
+            return;
+        }
+        const chroma_rows_t chroma = read_420_chroma(chroma_row);
+        switch (dst.format) {
+        case pixel_format_t::i420:
+            if (chroma.u != dst.planes[1].row(chroma_row)) { // not split into the `dst` directly
+                memcpy(dst.planes[1].row(chroma_row), chroma.u, chroma_width);
+                memcpy(dst.planes[2].row(chroma_row), chroma.v, chroma_width);
+            }
+            break;
+        case pixel_format_t::nv12:
+            k.merge_uv(chroma.u, chroma.v, dst.planes[1].row(chroma_row), chroma_width);
+            break;
+        case pixel_format_t::nv21:
+            k.merge_uv(chroma.v, chroma.u, dst.planes[1].row(chroma_row), chroma_width);
+            break;
+        default: // 4:2:2 repeats the chroma row
+            for (uint32_t i = 0; i < (pair ? 2u : 1u); ++i)
+                if (is_in_range(row + i))
+                    pack(src.planes[0].row(row + i), chroma, dst.planes[0].row(row + i));
+            break;
+        }
+    }
+
+    /// @note for I420 `dst`, NV12/NV21 chroma is split into the `dst` directly
+    chroma_rows_t read_420_chroma(uint32_t chroma_row) noexcept {
+        if (src.format == pixel_format_t::i420)
+            return {src.planes[1].row(chroma_row), src.planes[2].row(chroma_row)};
+        uint8_t* u = scratch_row(0);
+        uint8_t* v = scratch_row(1);
+        if (dst.format == pixel_format_t::i420) {
+            u = dst.planes[1].row(chroma_row);
+            v = dst.planes[2].row(chroma_row);
+        }
+        if (src.format == pixel_format_t::nv12)
+            k.split_uv(src.planes[1].row(chroma_row), u, v, chroma_width);
+        else
+            k.split_uv(src.planes[1].row(chroma_row), v, u, chroma_width);
+        return {u, v};
+    }
+
+    void pack(const uint8_t* y, chroma_rows_t chroma, uint8_t* out) noexcept {
+        if (dst.format == pixel_format_t::yuy2)
+            k.pack_yuy2(y, chroma.u, chroma.v, out, width);
+        else
+            k.pack_uyvy(y, chroma.u, chroma.v, out, width);
+    }
+
+    void unpack(const uint8_t* in, uint8_t* y, uint8_t* u, uint8_t* v) noexcept {
+        if (src.format == pixel_format_t::yuy2)
+            k.unpack_yuy2(in, y, u, v, width);
+        else
+            k.unpack_uyvy(in, y, u, v, width);
+    }
+
+    /// @brief YUY2/UYVY → any
+    void from_422(uint32_t row, bool pair) noexcept {
+        if (is_packed_422(dst.format)) {
+            for (uint32_t i = 0; i < (pair ? 2u : 1u); ++i) {
+                if (is_in_range(row + i) == false)
+                    continue;
+                const uint8_t* in = src.planes[0].row(row + i);
+                uint8_t* out = dst.planes[0].row(row + i);
+                if (src.format == dst.format)
+                    memcpy(out, in, chroma_width * 4);
+                else
+                    k.swap_pairs(in, out, chroma_width * 2);
+            }
+            return;
+        }
+        // the luma goes to the `dst` directly. the chroma of 2 rows are averaged
+        uint8_t* u0 = scratch_row(0);
+        uint8_t* v0 = scratch_row(1);
+        uint8_t* u1 = scratch_row(2);
+        uint8_t* v1 = scratch_row(3);
+        unpack(src.planes[0].row(row), dst.planes[0].row(row), u0, v0);
+        if (pair)
+            unpack(src.planes[0].row(row + 1), dst.planes[0].row(row + 1), u1, v1);
+        const uint32_t chroma_row = row / 2;
+        uint8_t* u = u0;
+        uint8_t* v = v0;
+        if (dst.format == pixel_format_t::i420) {
+            u = dst.planes[1].row(chroma_row);
+            v = dst.planes[2].row(chroma_row);
+        }
+        if (pair) {
+            k.average(u0, u1, u, chroma_width);
+            k.average(v0, v1, v, chroma_width);
+        } else if (u != u0) {
+            memcpy(u, u0, chroma_width);
+            memcpy(v, v0, chroma_width);
+        }
+        if (dst.format == pixel_format_t::nv12)
+            k.merge_uv(u, v, dst.planes[1].row(chroma_row), chroma_width);
+        else if (dst.format == pixel_format_t::nv21)
+            k.merge_uv(v, u, dst.planes[1].row(chroma_row), chroma_width);
+    }
+};
+
+} // namespace
+
+bool is_repackable(pixel_format_t format) noexcept {
+    switch (format) {
+    case pixel_format_t::i420:
+    case pixel_format_t::nv12:
+    case pixel_format_t::nv21:
+    case pixel_format_t::yuy2:
+    case pixel_format_t::uyvy:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool repack_yuv(const frame_view_t& src, const frame_view_t& dst, simd_level_t level, row_range_t rows) noexcept {
+    if (is_repackable(src.format) == false || is_repackable(dst.format) == false)
+        return false;
+    if (src.num_plane == 0 || dst.num_plane == 0 || src.width != dst.width || src.height != dst.height)
+        return false;
+    if (rows.begin % 2 && is_packed_422(dst.format) == false)
+        return false;
+    // reused by the thread, so the repeated calls don't allocate
+    static thread_local vector<uint8_t> scratch{};
+    try {
+        const size_t required = 4 * static_cast<size_t>((src.width + 1) / 2);
+        if (scratch.size() < required)
+            scratch.resize(required);
+    } catch (const bad_alloc&) {
+        return false;
+    }
+    repacker_t{src, dst, get_repack_kernels(level), scratch.data()}.run(rows);
+    return true;
+}
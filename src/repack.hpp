@@ -0,0 +1,27 @@
+/**
+ * @file    repack.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   YUV layout conversion without the DSP round trip
+ * @see     https://docs.microsoft.com/en-us/windows/win32/medfound/recommended-8-bit-yuv-formats-for-video-rendering
+ */
+#pragma once
+#include <frame_buffer.hpp>
+#include <simd.hpp>
+#include <slice.hpp>
+
+/// @return true for the layouts which `repack_yuv` can read/write
+bool is_repackable(pixel_format_t format) noexcept;
+
+/**
+ * @brief Repack the planes between I420(IYUV), NV12, NV21, YUY2 and UYVY
+ *
+ * @details Each plane of the `src` and the `dst` may have its own pitch, so the views of the locked
+ *          `IMF2DBuffer` can be used as they are. The `dst` is not allocated here. The caller can reuse it.
+ *          4:2:0 → 4:2:2 repeats the chroma rows. 4:2:2 → 4:2:0 averages 2 chroma rows.
+ * @param level `simd_level_t::scalar` for the reference. clamped with `clamp_simd_level`
+ * @param rows  of the `dst` to write. see `parallel_rows`. For 4:2:0 `dst`, `begin` must be even and
+ *              the row pair at the odd `end` is written together
+ * @return false if the formats are not supported, the sizes don't match, or `rows.begin` can't be used
+ */
+bool repack_yuv(const frame_view_t& src, const frame_view_t& dst, simd_level_t level = get_simd_level(),
+                row_range_t rows = all_rows) noexcept;
@@ -0,0 +1,60 @@
+/**
+ * @note compiled with AVX2. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+__m256i load(const uint8_t* ptr) noexcept {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+void store(uint8_t* ptr, __m256i value) noexcept {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), value);
+}
+
+} // namespace
+
+void split_uv_avx2(const uint8_t* uv, uint8_t* u, uint8_t* v, uint32_t count) noexcept {
+    const __m256i mask = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, //
+                                          0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        // [U 8 | V 8 | U 8 | V 8] → [U 16 | V 16]
+        const __m256i a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(load(uv + 2 * i), mask), 0b11'01'10'00);
+        const __m256i b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(load(uv + 2 * i + 32), mask), 0b11'01'10'00);
+        store(u + i, _mm256_permute2x128_si256(a, b, 0x20));
+        store(v + i, _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    split_uv_scalar(uv, u, v, i, count);
+}
+
+void merge_uv_avx2(const uint8_t* u, const uint8_t* v, uint8_t* uv, uint32_t count) noexcept {
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i u32 = load(u + i);
+        const __m256i v32 = load(v + i);
+        const __m256i lo = _mm256_unpacklo_epi8(u32, v32); // pairs [0, 8) and [16, 24)
+        const __m256i hi = _mm256_unpackhi_epi8(u32, v32); // pairs [8, 16) and [24, 32)
+        store(uv + 2 * i, _mm256_permute2x128_si256(lo, hi, 0x20));
+        store(uv + 2 * i + 32, _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    merge_uv_scalar(u, v, uv, i, count);
+}
+
+void swap_pairs_avx2(const uint8_t* src, uint8_t* dst, uint32_t count) noexcept {
+    const __m256i mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, //
+                                          1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+        store(dst + 2 * i, _mm256_shuffle_epi8(load(src + 2 * i), mask));
+    swap_pairs_scalar(src, dst, i, count);
+}
+
+void average_avx2(const uint8_t* a, const uint8_t* b, uint8_t* dst, uint32_t count) noexcept {
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32)
+        store(dst + i, _mm256_avg_epu8(load(a + i), load(b + i)));
+    average_scalar(a, b, dst, i, count);
+}
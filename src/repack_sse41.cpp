@@ -0,0 +1,108 @@
+/**
+ * @note compiled with SSE 4.1. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+__m128i load(const uint8_t* ptr) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+__m128i load_low(const uint8_t* ptr) noexcept {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+}
+void store(uint8_t* ptr, __m128i value) noexcept {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value);
+}
+void store_low(uint8_t* ptr, __m128i value) noexcept {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(ptr), value);
+}
+
+/// @param mask gathers [Y 8 | U 4 | V 4] from 8 pixels
+void unpack_422(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t width, __m128i mask) noexcept {
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i a = _mm_shuffle_epi8(load(src + 2 * x), mask);
+        const __m128i b = _mm_shuffle_epi8(load(src + 2 * x + 16), mask);
+        store(y + x, _mm_unpacklo_epi64(a, b));
+        const __m128i uv = _mm_unpacklo_epi32(_mm_srli_si128(a, 8), _mm_srli_si128(b, 8)); // [U 8 | V 8]
+        store_low(u + x / 2, uv);
+        store_low(v + x / 2, _mm_srli_si128(uv, 8));
+    }
+}
+
+} // namespace
+
+void split_uv_sse41(const uint8_t* uv, uint8_t* u, uint8_t* v, uint32_t count) noexcept {
+    const __m128i mask = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_shuffle_epi8(load(uv + 2 * i), mask);      // [U 8 | V 8]
+        const __m128i b = _mm_shuffle_epi8(load(uv + 2 * i + 16), mask); // [U 8 | V 8]
+        store(u + i, _mm_unpacklo_epi64(a, b));
+        store(v + i, _mm_unpackhi_epi64(a, b));
+    }
+    split_uv_scalar(uv, u, v, i, count);
+}
+
+void merge_uv_sse41(const uint8_t* u, const uint8_t* v, uint8_t* uv, uint32_t count) noexcept {
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i u16 = load(u + i);
+        const __m128i v16 = load(v + i);
+        store(uv + 2 * i, _mm_unpacklo_epi8(u16, v16));
+        store(uv + 2 * i + 16, _mm_unpackhi_epi8(u16, v16));
+    }
+    merge_uv_scalar(u, v, uv, i, count);
+}
+
+void swap_pairs_sse41(const uint8_t* src, uint8_t* dst, uint32_t count) noexcept {
+    const __m128i mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        store(dst + 2 * i, _mm_shuffle_epi8(load(src + 2 * i), mask));
+    swap_pairs_scalar(src, dst, i, count);
+}
+
+void average_sse41(const uint8_t* a, const uint8_t* b, uint8_t* dst, uint32_t count) noexcept {
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+        store(dst + i, _mm_avg_epu8(load(a + i), load(b + i))); // (a + b + 1) >> 1
+    average_scalar(a, b, dst, i, count);
+}
+
+void unpack_yuy2_sse41(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t width) noexcept {
+    const __m128i mask = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15);
+    unpack_422(src, y, u, v, width, mask);
+    unpack_yuy2_scalar(src, y, u, v, width & ~15u, width);
+}
+
+void unpack_uyvy_sse41(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, uint32_t width) noexcept {
+    const __m128i mask = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, 0, 4, 8, 12, 2, 6, 10, 14);
+    unpack_422(src, y, u, v, width, mask);
+    unpack_uyvy_scalar(src, y, u, v, width & ~15u, width);
+}
+
+void pack_yuy2_sse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width) noexcept {
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i y16 = load(y + x);
+        const __m128i uv = _mm_unpacklo_epi8(load_low(u + x / 2), load_low(v + x / 2));
+        store(dst + 2 * x, _mm_unpacklo_epi8(y16, uv));
+        store(dst + 2 * x + 16, _mm_unpackhi_epi8(y16, uv));
+    }
+    pack_yuy2_scalar(y, u, v, dst, x, width);
+}
+
+void pack_uyvy_sse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, uint32_t width) noexcept {
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i y16 = load(y + x);
+        const __m128i uv = _mm_unpacklo_epi8(load_low(u + x / 2), load_low(v + x / 2));
+        store(dst + 2 * x, _mm_unpacklo_epi8(uv, y16));
+        store(dst + 2 * x + 16, _mm_unpackhi_epi8(uv, y16));
+    }
+    pack_uyvy_scalar(y, u, v, dst, x, width);
+}
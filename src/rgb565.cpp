@@ -0,0 +1,104 @@
+#include "rgb565.hpp"
+#include "kernels.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+const uint8_t bayer_4x4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+/**
+ * @details The expansion replicates the high bits(`(q << 3) | (q >> 2)`), so the value is scaled by 255/248.
+ *          `v - (v >> 5)` removes the replicated part before the threshold is added. The 565 values are kept and
+ *          the sum doesn't overflow the byte.
+ */
+void pack_rgb565_scalar(const uint8_t* src, uint16_t* dst, uint32_t begin, uint32_t end, uint32_t row,
+                        bool dither) noexcept {
+    for (uint32_t x = begin; x < end; ++x) {
+        const uint8_t* bgra = src + 4 * x;
+        uint32_t b = bgra[0], g = bgra[1], r = bgra[2];
+        if (dither) {
+            // the step of 5 bit is 8, and the step of 6 bit is 4
+            const uint32_t threshold = bayer_4x4[row % 4][x % 4];
+            b = b - (b >> 5) + threshold / 2;
+            g = g - (g >> 6) + threshold / 4;
+            r = r - (r >> 5) + threshold / 2;
+        }
+        dst[x] = static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+    }
+}
+
+void unpack_rgb565_scalar(const uint16_t* src, uint8_t* dst, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t x = begin; x < end; ++x) {
+        const uint32_t b = src[x] & 0x1F;
+        const uint32_t g = (src[x] >> 5) & 0x3F;
+        const uint32_t r = src[x] >> 11;
+        uint8_t* bgra = dst + 4 * x;
+        bgra[0] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        bgra[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        bgra[2] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        bgra[3] = 255;
+    }
+}
+
+static bool is_same_size(const frame_view_t& src, const frame_view_t& dst) noexcept {
+    return src.num_plane && dst.num_plane && src.width == dst.width && src.height == dst.height;
+}
+
+bool convert_rgb32_to_rgb565(const frame_view_t& src, const frame_view_t& dst, dither_t dither, simd_level_t level,
+                             row_range_t rows) noexcept {
+    if (src.format != pixel_format_t::rgb32 || dst.format != pixel_format_t::rgb565 || !is_same_size(src, dst))
+        return false;
+    level = clamp_simd_level(level);
+    const bool ordered = dither == dither_t::ordered;
+    const uint32_t end = min(rows.end, src.height);
+    for (uint32_t y = rows.begin; y < end; ++y) {
+        const uint8_t* in = src.planes[0].row(y);
+        auto* out = reinterpret_cast<uint16_t*>(dst.planes[0].row(y));
+        switch (level) {
+#if defined(MEDIA_CORE_X86)
+        case simd_level_t::avx2:
+            pack_rgb565_avx2(in, out, src.width, y, ordered);
+            break;
+        case simd_level_t::sse41:
+            pack_rgb565_sse41(in, out, src.width, y, ordered);
+            break;
+#endif
+        default:
+            pack_rgb565_scalar(in, out, 0, src.width, y, ordered);
+            break;
+        }
+    }
+    return true;
+}
+
+bool convert_rgb565_to_rgb32(const frame_view_t& src, const frame_view_t& dst, simd_level_t level,
+                             row_range_t rows) noexcept {
+    if (src.format != pixel_format_t::rgb565 || dst.format != pixel_format_t::rgb32 || !is_same_size(src, dst))
+        return false;
+    level = clamp_simd_level(level);
+    const uint32_t end = min(rows.end, src.height);
+    for (uint32_t y = rows.begin; y < end; ++y) {
+        const auto* in = reinterpret_cast<const uint16_t*>(src.planes[0].row(y));
+        uint8_t* out = dst.planes[0].row(y);
+        switch (level) {
+#if defined(MEDIA_CORE_X86)
+        case simd_level_t::avx2:
+            unpack_rgb565_avx2(in, out, src.width);
+            break;
+        case simd_level_t::sse41:
+            unpack_rgb565_sse41(in, out, src.width);
+            break;
+#endif
+        default:
+            unpack_rgb565_scalar(in, out, 0, src.width);
+            break;
+        }
+    }
+    return true;
+}
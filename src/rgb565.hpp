@@ -0,0 +1,30 @@
+/**
+ * @file    rgb565.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   RGB32 ⇄ RGB565 for the low bandwidth preview
+ */
+#pragma once
+#include <frame_buffer.hpp>
+#include <simd.hpp>
+#include <slice.hpp>
+
+enum class dither_t : uint32_t {
+    none = 0, ///< truncate the low bits. visible banding on the gradients
+    ordered,  ///< 4x4 Bayer matrix. the error is spread to the neighbor pixels without the state
+};
+
+/**
+ * @brief RGB32(BGRA) → RGB565. The 4th byte is ignored
+ * @param level `simd_level_t::scalar` for the reference. clamped with `clamp_simd_level`
+ * @param rows  of the `dst` to write. see `parallel_rows`
+ * @return false if the formats or the sizes don't match
+ */
+bool convert_rgb32_to_rgb565(const frame_view_t& src, const frame_view_t& dst, dither_t dither = dither_t::ordered,
+                             simd_level_t level = get_simd_level(), row_range_t rows = all_rows) noexcept;
+
+/**
+ * @brief RGB565 → RGB32. The low bits are filled with the high bits, so 0 and 31(63) become 0 and 255
+ * @note  The 4th byte is 255
+ */
+bool convert_rgb565_to_rgb32(const frame_view_t& src, const frame_view_t& dst, simd_level_t level = get_simd_level(),
+                             row_range_t rows = all_rows) noexcept;
@@ -0,0 +1,77 @@
+/**
+ * @note compiled with AVX2. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+/// @brief offsets of [B G R A] × 4 pixels for the `row`, in both lanes
+__m256i make_threshold(uint32_t row, bool dither) noexcept {
+    if (dither == false)
+        return _mm256_setzero_si256();
+    const uint8_t* t = bayer_4x4[row % 4];
+    uint32_t pixels[4]{};
+    for (int i = 0; i < 4; ++i)
+        pixels[i] = (t[i] / 2u) | ((t[i] / 4u) << 8) | ((t[i] / 2u) << 16);
+    const __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+    return _mm256_broadcastsi128_si256(lane);
+}
+
+/// @brief `v - (v >> 5)` for B/R and `v - (v >> 6)` for G. see `pack_rgb565_scalar`
+__m256i remove_replica(__m256i bgra) noexcept {
+    const __m256i br = _mm256_and_si256(_mm256_srli_epi16(bgra, 5), _mm256_set1_epi32(0x00'07'00'07));
+    const __m256i g = _mm256_and_si256(_mm256_srli_epi16(bgra, 6), _mm256_set1_epi32(0x00'00'03'00));
+    return _mm256_sub_epi8(bgra, _mm256_or_si256(br, g));
+}
+
+/// @return RGB565 in the low 16 bits of the 32 bit lanes
+__m256i pack_8(__m256i bgra) noexcept {
+    const __m256i b = _mm256_and_si256(_mm256_srli_epi32(bgra, 3), _mm256_set1_epi32(0x001F));
+    const __m256i g = _mm256_and_si256(_mm256_srli_epi32(bgra, 5), _mm256_set1_epi32(0x07E0));
+    const __m256i r = _mm256_and_si256(_mm256_srli_epi32(bgra, 8), _mm256_set1_epi32(0xF800));
+    return _mm256_or_si256(_mm256_or_si256(b, g), r);
+}
+
+/// @param rgb565 in the 32 bit lanes
+__m256i unpack_8(__m256i rgb565) noexcept {
+    const __m256i b5 = _mm256_and_si256(rgb565, _mm256_set1_epi32(0x1F));
+    const __m256i g6 = _mm256_and_si256(_mm256_srli_epi32(rgb565, 5), _mm256_set1_epi32(0x3F));
+    const __m256i r5 = _mm256_srli_epi32(rgb565, 11);
+    const __m256i b = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+    const __m256i g = _mm256_or_si256(_mm256_slli_epi32(g6, 2), _mm256_srli_epi32(g6, 4));
+    const __m256i r = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int32_t>(0xFF00'0000u));
+    return _mm256_or_si256(_mm256_or_si256(b, _mm256_slli_epi32(g, 8)), _mm256_or_si256(_mm256_slli_epi32(r, 16), alpha));
+}
+
+} // namespace
+
+void pack_rgb565_avx2(const uint8_t* src, uint16_t* dst, uint32_t width, uint32_t row, bool dither) noexcept {
+    const __m256i threshold = make_threshold(row, dither);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * x));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * x + 32));
+        if (dither) {
+            lo = _mm256_add_epi8(remove_replica(lo), threshold);
+            hi = _mm256_add_epi8(remove_replica(hi), threshold);
+        }
+        // the pack works in the 128 bit lanes. [lo0 hi0 lo1 hi1] → [lo0 lo1 hi0 hi1]
+        const __m256i packed = _mm256_packus_epi32(pack_8(lo), pack_8(hi));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_permute4x64_epi64(packed, 0b11'01'10'00));
+    }
+    pack_rgb565_scalar(src, dst, x, width, row, dither);
+}
+
+void unpack_rgb565_avx2(const uint16_t* src, uint8_t* dst, uint32_t width) noexcept {
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * x), unpack_8(_mm256_cvtepu16_epi32(lo)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * x + 32), unpack_8(_mm256_cvtepu16_epi32(hi)));
+    }
+    unpack_rgb565_scalar(src, dst, x, width);
+}
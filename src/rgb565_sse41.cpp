@@ -0,0 +1,76 @@
+/**
+ * @note compiled with SSE 4.1. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+/// @brief offsets of [B G R A] × 4 pixels for the `row`
+__m128i make_threshold(uint32_t row, bool dither) noexcept {
+    if (dither == false)
+        return _mm_setzero_si128();
+    const uint8_t* t = bayer_4x4[row % 4];
+    return _mm_setr_epi8(static_cast<char>(t[0] / 2), static_cast<char>(t[0] / 4), static_cast<char>(t[0] / 2), 0,
+                         static_cast<char>(t[1] / 2), static_cast<char>(t[1] / 4), static_cast<char>(t[1] / 2), 0,
+                         static_cast<char>(t[2] / 2), static_cast<char>(t[2] / 4), static_cast<char>(t[2] / 2), 0,
+                         static_cast<char>(t[3] / 2), static_cast<char>(t[3] / 4), static_cast<char>(t[3] / 2), 0);
+}
+
+/// @brief `v - (v >> 5)` for B/R and `v - (v >> 6)` for G. see `pack_rgb565_scalar`
+__m128i remove_replica(__m128i bgra) noexcept {
+    const __m128i br = _mm_and_si128(_mm_srli_epi16(bgra, 5), _mm_set1_epi32(0x00'07'00'07));
+    const __m128i g = _mm_and_si128(_mm_srli_epi16(bgra, 6), _mm_set1_epi32(0x00'00'03'00));
+    return _mm_sub_epi8(bgra, _mm_or_si128(br, g));
+}
+
+/// @return RGB565 in the low 16 bits of the 32 bit lanes
+__m128i pack_4(__m128i bgra) noexcept {
+    const __m128i b = _mm_and_si128(_mm_srli_epi32(bgra, 3), _mm_set1_epi32(0x001F));
+    const __m128i g = _mm_and_si128(_mm_srli_epi32(bgra, 5), _mm_set1_epi32(0x07E0));
+    const __m128i r = _mm_and_si128(_mm_srli_epi32(bgra, 8), _mm_set1_epi32(0xF800));
+    return _mm_or_si128(_mm_or_si128(b, g), r);
+}
+
+/// @param rgb565 in the 32 bit lanes
+__m128i unpack_4(__m128i rgb565) noexcept {
+    const __m128i b5 = _mm_and_si128(rgb565, _mm_set1_epi32(0x1F));
+    const __m128i g6 = _mm_and_si128(_mm_srli_epi32(rgb565, 5), _mm_set1_epi32(0x3F));
+    const __m128i r5 = _mm_srli_epi32(rgb565, 11);
+    const __m128i b = _mm_or_si128(_mm_slli_epi32(b5, 3), _mm_srli_epi32(b5, 2));
+    const __m128i g = _mm_or_si128(_mm_slli_epi32(g6, 2), _mm_srli_epi32(g6, 4));
+    const __m128i r = _mm_or_si128(_mm_slli_epi32(r5, 3), _mm_srli_epi32(r5, 2));
+    const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF00'0000u));
+    return _mm_or_si128(_mm_or_si128(b, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(r, 16), alpha));
+}
+
+} // namespace
+
+void pack_rgb565_sse41(const uint8_t* src, uint16_t* dst, uint32_t width, uint32_t row, bool dither) noexcept {
+    // the pattern repeats every 4 pixels, so the vector is reused for the row
+    const __m128i threshold = make_threshold(row, dither);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * x));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * x + 16));
+        if (dither) {
+            lo = _mm_add_epi8(remove_replica(lo), threshold);
+            hi = _mm_add_epi8(remove_replica(hi), threshold);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi32(pack_4(lo), pack_4(hi)));
+    }
+    pack_rgb565_scalar(src, dst, x, width, row, dither);
+}
+
+void unpack_rgb565_sse41(const uint16_t* src, uint8_t* dst, uint32_t width) noexcept {
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i rgb565 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        const __m128i lo = unpack_4(_mm_cvtepu16_epi32(rgb565));
+        const __m128i hi = unpack_4(_mm_cvtepu16_epi32(_mm_srli_si128(rgb565, 8)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x + 16), hi);
+    }
+    unpack_rgb565_scalar(src, dst, x, width);
+}
@@ -0,0 +1,390 @@
+#include "scale.hpp"
+#include "kernels.hpp"
+#include "pixel_traits.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+static uint8_t clamp_filtered(int32_t sum) noexcept {
+    sum = (sum + (1 << (filter_bits - 1))) >> filter_bits;
+    return static_cast<uint8_t>(sum < 0 ? 0 : (sum > 255 ? 255 : sum));
+}
+
+void scale_vertical_scalar(const uint8_t* const* rows, const int16_t* coefficients, uint32_t taps, uint8_t* dst,
+                           uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i) {
+        int32_t sum = 0;
+        for (uint32_t k = 0; k < taps; ++k)
+            sum += coefficients[k] * rows[k][i];
+        dst[i] = clamp_filtered(sum);
+    }
+}
+
+/// @tparam C interleaved samples of a pixel. see `get_samples_per_pixel`
+template <uint32_t C>
+static void scale_horizontal_scalar(const uint8_t* src, uint8_t* dst, const filter_bank_t& bank, uint32_t begin,
+                                    uint32_t end) noexcept {
+    for (uint32_t x = begin; x < end; ++x) {
+        const uint8_t* input = src + bank.offsets[x] * C;
+        const int16_t* coefficients = bank.coefficients.data() + x * bank.taps;
+        for (uint32_t c = 0; c < C; ++c) {
+            int32_t sum = 0;
+            for (uint32_t k = 0; k < bank.taps; ++k)
+                sum += coefficients[k] * input[k * C + c];
+            dst[x * C + c] = clamp_filtered(sum);
+        }
+    }
+}
+
+void scale_horizontal_scalar(const uint8_t* src, uint8_t* dst, uint32_t channels, const filter_bank_t& bank,
+                             uint32_t begin, uint32_t end) noexcept {
+    switch (channels) {
+    case 1:
+        return scale_horizontal_scalar<1>(src, dst, bank, begin, end);
+    case 2:
+        return scale_horizontal_scalar<2>(src, dst, bank, begin, end);
+    case 4:
+        return scale_horizontal_scalar<4>(src, dst, bank, begin, end);
+    default:
+        return;
+    }
+}
+
+/// @see https://en.wikipedia.org/wiki/Bicubic_interpolation (a = -0.5)
+static double get_cubic_weight(double distance) noexcept {
+    const double d = abs(distance);
+    if (d < 1)
+        return (1.5 * d - 2.5) * d * d + 1;
+    if (d < 2)
+        return ((-0.5 * d + 2.5) * d - 4) * d + 2;
+    return 0;
+}
+
+/// @brief (position, weight) of 1 output. the positions may be out of the input
+using weights_t = vector<pair<int64_t, double>>;
+
+static void get_weights(scale_filter_t filter, double ratio, uint32_t index, weights_t& weights) noexcept(false) {
+    weights.clear();
+    // the centers of the pixels are aligned. same with the most of the resizers
+    const double center = (index + 0.5) * ratio - 0.5;
+    const auto base = static_cast<int64_t>(floor(center));
+    const double fraction = center - base;
+    switch (filter) {
+    case scale_filter_t::nearest:
+        weights.emplace_back(static_cast<int64_t>(floor((index + 0.5) * ratio)), 1.0);
+        break;
+    case scale_filter_t::bilinear:
+        weights.emplace_back(base, 1 - fraction);
+        weights.emplace_back(base + 1, fraction);
+        break;
+    case scale_filter_t::bicubic:
+        for (int64_t k = -1; k <= 2; ++k)
+            weights.emplace_back(base + k, get_cubic_weight(k - fraction));
+        break;
+    case scale_filter_t::area: {
+        const double low = index * ratio;
+        const double high = (index + 1) * ratio;
+        for (auto p = static_cast<int64_t>(floor(low)); p < high; ++p) {
+            const double overlap = min(high, p + 1.0) - max(low, static_cast<double>(p));
+            if (overlap > 1e-9)
+                weights.emplace_back(p, overlap);
+        }
+        break;
+    }
+    }
+}
+
+filter_bank_t make_filter_bank(scale_filter_t filter, uint32_t input, uint32_t output) noexcept(false) {
+    if (input == 0 || output == 0)
+        throw invalid_argument{"make_filter_bank: zero length"};
+    const double ratio = static_cast<double>(input) / output;
+    const auto last = static_cast<int64_t>(input) - 1;
+    // clamp the positions to the edge, then find the widest window
+    vector<weights_t> outputs(output);
+    uint32_t taps = 1;
+    for (uint32_t i = 0; i < output; ++i) {
+        weights_t& weights = outputs[i];
+        get_weights(filter, ratio, i, weights);
+        int64_t low = last, high = 0;
+        for (auto& [position, weight] : weights) {
+            position = clamp<int64_t>(position, 0, last);
+            if (weight != 0) {
+                low = min(low, position);
+                high = max(high, position);
+            }
+        }
+        if (high >= low)
+            taps = max(taps, static_cast<uint32_t>(high - low + 1));
+    }
+    filter_bank_t bank{};
+    bank.taps = taps;
+    bank.offsets.resize(output);
+    bank.coefficients.resize(static_cast<size_t>(output) * taps);
+    vector<double> window(taps);
+    for (uint32_t i = 0; i < output; ++i) {
+        const weights_t& weights = outputs[i];
+        int64_t low = last;
+        double total = 0;
+        for (const auto& [position, weight] : weights) {
+            if (weight != 0)
+                low = min(low, position);
+            total += weight;
+        }
+        const int64_t offset = min<int64_t>(low, input - taps);
+        fill(window.begin(), window.end(), 0.0);
+        for (const auto& [position, weight] : weights)
+            window[clamp<int64_t>(position - offset, 0, taps - 1)] += weight / total;
+        // round each, then give the error to the largest one. the sum must be exact for the flat area
+        int16_t* coefficients = bank.coefficients.data() + static_cast<size_t>(i) * taps;
+        int32_t sum = 0;
+        uint32_t largest = 0;
+        for (uint32_t k = 0; k < taps; ++k) {
+            coefficients[k] = static_cast<int16_t>(lround(window[k] * (1 << filter_bits)));
+            sum += coefficients[k];
+            if (window[k] > window[largest])
+                largest = k;
+        }
+        coefficients[largest] = static_cast<int16_t>(coefficients[largest] + (1 << filter_bits) - sum);
+        bank.offsets[i] = static_cast<uint32_t>(offset);
+    }
+    return bank;
+}
+
+namespace {
+
+/// @brief row kernels of 1 `simd_level_t`. the scalar ones are adapted to the same signature
+struct scale_kernels_t final {
+    void (*vertical)(const uint8_t* const*, const int16_t*, uint32_t, uint8_t*, uint32_t);
+    void (*horizontal)(const uint8_t*, uint8_t*, uint32_t, const filter_bank_t&, uint32_t);
+};
+
+const scale_kernels_t scalar_kernels{
+    [](const uint8_t* const* rows, const int16_t* coefficients, uint32_t taps, uint8_t* dst, uint32_t n) noexcept {
+        scale_vertical_scalar(rows, coefficients, taps, dst, 0, n);
+    },
+    [](const uint8_t* src, uint8_t* dst, uint32_t channels, const filter_bank_t& bank, uint32_t w) noexcept {
+        scale_horizontal_scalar(src, dst, channels, bank, 0, w);
+    },
+};
+
+#if defined(MEDIA_CORE_X86)
+const scale_kernels_t sse41_kernels{&scale_vertical_sse41, &scale_horizontal_sse41};
+// the horizontal kernel gathers the pixels. the 256 bit version is not faster
+const scale_kernels_t avx2_kernels{&scale_vertical_avx2, &scale_horizontal_sse41};
+#endif
+
+const scale_kernels_t& get_scale_kernels(simd_level_t level) noexcept {
+    switch (clamp_simd_level(level)) {
+#if defined(MEDIA_CORE_X86)
+    case simd_level_t::avx2:
+        return avx2_kernels;
+    case simd_level_t::sse41:
+        return sse41_kernels;
+#endif
+    default:
+        return scalar_kernels;
+    }
+}
+
+/// @return the whole frame if the `rect` is empty. the empty one if it's out of the frame
+scale_rect_t resolve(const scale_rect_t& rect, const frame_view_t& frame) noexcept {
+    if (rect.width == 0 || rect.height == 0)
+        return scale_rect_t{0, 0, frame.width, frame.height};
+    if (rect.x + uint64_t{rect.width} > frame.width || rect.y + uint64_t{rect.height} > frame.height)
+        return scale_rect_t{};
+    return rect;
+}
+
+/// @brief the rectangle in the 4:2:0 chroma plane
+scale_rect_t get_chroma_rect(const scale_rect_t& rect) noexcept {
+    const uint32_t x = rect.x / 2;
+    const uint32_t y = rect.y / 2;
+    return scale_rect_t{x, y, (rect.x + rect.width + 1) / 2 - x, (rect.y + rect.height + 1) / 2 - y};
+}
+
+/// @brief the source plane and the filter banks. makes 1 output row with `run`
+struct plane_scaler_t final {
+    const plane_t& src;
+    uint32_t channels;
+    const scale_rect_t& from;
+    const filter_bank_t& horizontal;
+    const filter_bank_t& vertical;
+    const scale_kernels_t& k;
+    uint8_t* line;        ///< for the vertical pass. `from.width * channels` bytes
+    const uint8_t** rows; ///< for the vertical pass. `vertical.taps` pointers
+
+    /// @param out `horizontal.offsets.size()` pixels
+    void run(uint32_t y, uint8_t* out) const noexcept {
+        for (uint32_t i = 0; i < vertical.taps; ++i)
+            rows[i] = src.row(from.y + vertical.offsets[y] + i) + from.x * channels;
+        const uint8_t* input = rows[0]; // 1 tap is always `1 << filter_bits`
+        if (vertical.taps > 1) {
+            k.vertical(rows, vertical.coefficients.data() + y * vertical.taps, vertical.taps, line,
+                       from.width * channels);
+            input = line;
+        }
+        k.horizontal(input, out, channels, horizontal, static_cast<uint32_t>(horizontal.offsets.size()));
+    }
+};
+
+/// @param rows of the `dst` plane. intersected with the `to`
+void scale_plane(const plane_scaler_t& scaler, const plane_t& dst, const scale_rect_t& to,
+                 row_range_t rows) noexcept {
+    const uint32_t begin = max(rows.begin, to.y);
+    const auto end = static_cast<uint32_t>(min<uint64_t>(rows.end, uint64_t{to.y} + to.height));
+    for (uint32_t y = begin; y < end; ++y)
+        scaler.run(y - to.y, dst.row(y) + to.x * scaler.channels);
+}
+
+/// @brief rows of the 4:2:0 chroma plane
+row_range_t get_chroma_rows(row_range_t rows) noexcept {
+    return row_range_t{rows.begin / 2, rows.end / 2 + rows.end % 2};
+}
+
+} // namespace
+
+bool is_scalable(pixel_format_t format) noexcept {
+    switch (format) {
+    case pixel_format_t::nv12:
+    case pixel_format_t::nv21:
+    case pixel_format_t::i420:
+    case pixel_format_t::rgb32:
+        return true;
+    default:
+        return false;
+    }
+}
+
+scaler_t::scaler_t(scale_filter_t filter) noexcept : filter{filter} {
+}
+
+void scaler_t::set_filter(scale_filter_t value) noexcept {
+    filter = value;
+}
+
+void scaler_t::set_source_rectangle(const scale_rect_t& rect) noexcept {
+    source = rect;
+}
+
+void scaler_t::set_destination_rectangle(const scale_rect_t& rect) noexcept {
+    destination = rect;
+}
+
+shared_ptr<const filter_bank_t> scaler_t::get_filter_bank(uint32_t input, uint32_t output) noexcept(false) {
+    const key_t key{filter, input, output};
+    lock_guard lck{mtx};
+    if (auto it = banks.find(key); it != banks.end())
+        return it->second;
+    auto bank = make_shared<const filter_bank_t>(make_filter_bank(filter, input, output));
+    if (banks.size() >= max_bank_count)
+        banks.clear();
+    banks.emplace(key, bank);
+    return bank;
+}
+
+bool scaler_t::scale(const frame_view_t& src, const frame_view_t& dst, simd_level_t level,
+                     row_range_t range) noexcept {
+    if (is_scalable(src.format) == false || src.format != dst.format || src.num_plane == 0 || dst.num_plane == 0)
+        return false;
+    const scale_rect_t from = resolve(source, src);
+    const scale_rect_t to = resolve(destination, dst);
+    if (from.width == 0 || to.width == 0)
+        return false;
+    const scale_kernels_t& k = get_scale_kernels(level);
+    // reused by the thread, so the repeated calls don't allocate
+    static thread_local vector<uint8_t> line{};
+    static thread_local vector<const uint8_t*> rows{};
+    try {
+        const pixel_traits_t traits = get_pixel_traits(src.format);
+        const uint32_t channels = get_samples_per_pixel(traits, 0);
+        const auto luma_h = get_filter_bank(from.width, to.width);
+        const auto luma_v = get_filter_bank(from.height, to.height);
+        // the chroma row of the odd width/x is wider than the half of the luma row
+        const scale_rect_t chroma_from = get_chroma_rect(from);
+        const uint32_t chroma_channels = traits.num_plane > 1 ? get_samples_per_pixel(traits, 1) : 0;
+        line.resize(max<size_t>(line.size(), max<size_t>(size_t{from.width} * channels,
+                                                          size_t{chroma_from.width} * chroma_channels)));
+        rows.resize(max<size_t>(rows.size(), luma_v->taps));
+        const plane_scaler_t luma{src.planes[0], channels, from, *luma_h, *luma_v, k, line.data(), rows.data()};
+        scale_plane(luma, dst.planes[0], to, range);
+        if (traits.num_plane == 1)
+            return true;
+
+        const scale_rect_t chroma_to = get_chroma_rect(to);
+        const auto chroma_h = get_filter_bank(chroma_from.width, chroma_to.width);
+        const auto chroma_v = get_filter_bank(chroma_from.height, chroma_to.height);
+        rows.resize(max<size_t>(rows.size(), chroma_v->taps));
+        for (uint32_t i = 1; i < src.num_plane; ++i) // UV for NV12/NV21, U and V for I420
+            scale_plane({src.planes[i], chroma_channels, chroma_from, *chroma_h, *chroma_v, k, line.data(),
+                         rows.data()},
+                        dst.planes[i], chroma_to, get_chroma_rows(range));
+        return true;
+    } catch (const bad_alloc&) {
+        return false;
+    }
+}
+
+bool scaler_t::scale_to_rgb32(const frame_view_t& src, const frame_view_t& dst, yuv_color_t color, simd_level_t level,
+                              row_range_t range) noexcept {
+    if ((src.format != pixel_format_t::nv12 && src.format != pixel_format_t::i420) || src.num_plane == 0)
+        return false;
+    if (dst.format != pixel_format_t::rgb32 || dst.num_plane == 0)
+        return false;
+    const scale_rect_t from = resolve(source, src);
+    const scale_rect_t to = resolve(destination, dst);
+    if (from.width == 0 || to.width == 0)
+        return false;
+    level = clamp_simd_level(level);
+    const scale_kernels_t& k = get_scale_kernels(level);
+    const yuv_coefficients_t coefficients = get_yuv_coefficients(color);
+    // the scaled rows are in the scratch. same with the intermediate NV12/I420 frame at (0, 0)
+    const scale_rect_t chroma_from = get_chroma_rect(from);
+    const scale_rect_t chroma_to = get_chroma_rect(scale_rect_t{0, 0, to.width, to.height});
+    const bool nv12 = src.format == pixel_format_t::nv12;
+    static thread_local vector<uint8_t> line{};
+    static thread_local vector<const uint8_t*> rows{};
+    static thread_local vector<uint8_t> scaled{};
+    try {
+        const auto luma_h = get_filter_bank(from.width, to.width);
+        const auto luma_v = get_filter_bank(from.height, to.height);
+        const auto chroma_h = get_filter_bank(chroma_from.width, chroma_to.width);
+        const auto chroma_v = get_filter_bank(chroma_from.height, chroma_to.height);
+        line.resize(max<size_t>(line.size(), max(from.width, chroma_from.width * 2)));
+        rows.resize(max<size_t>(rows.size(), max(luma_v->taps, chroma_v->taps)));
+        scaled.resize(max<size_t>(scaled.size(), to.width + chroma_to.width * 2));
+
+        uint8_t* y = scaled.data();
+        uint8_t* u = y + to.width; // UV for NV12
+        uint8_t* v = u + chroma_to.width;
+        const plane_scaler_t luma{src.planes[0], 1, from, *luma_h, *luma_v, k, line.data(), rows.data()};
+        const plane_scaler_t chroma[2]{
+            {src.planes[1], nv12 ? 2u : 1u, chroma_from, *chroma_h, *chroma_v, k, line.data(), rows.data()},
+            {src.planes[nv12 ? 1 : 2], 1, chroma_from, *chroma_h, *chroma_v, k, line.data(), rows.data()},
+        };
+        // the rows in the destination rectangle
+        const uint32_t first = max(range.begin, to.y) - to.y;
+        const int64_t end = min<int64_t>(range.end, int64_t{to.y} + to.height);
+        const auto last = static_cast<uint32_t>(max<int64_t>(end - to.y, 0));
+        for (uint32_t row = first; row < last; ++row) {
+            luma.run(row, y);
+            if (row % 2 == 0 || row == first) { // 2 rows share the chroma row
+                chroma[0].run(row / 2, u);
+                if (nv12 == false)
+                    chroma[1].run(row / 2, v);
+            }
+            uint8_t* out = dst.planes[0].row(to.y + row) + to.x * 4;
+            if (nv12)
+                convert_row_nv12_rgb32(y, u, out, to.width, coefficients, level);
+            else
+                convert_row_i420_rgb32(y, u, v, out, to.width, coefficients, level);
+        }
+        return true;
+    } catch (const bad_alloc&) {
+        return false;
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * @file    scale.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Crop and resize which replaces the Video Resizer DSP
+ * @see     https://docs.microsoft.com/en-us/windows/win32/medfound/videoresizer
+ */
+#pragma once
+#include <color_convert.hpp>
+#include <frame_buffer.hpp>
+#include <simd.hpp>
+#include <slice.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+enum class scale_filter_t : uint32_t {
+    nearest = 0,
+    bilinear, ///< 2 taps
+    bicubic,  ///< 4 taps. Catmull-Rom
+    area,     ///< box filter. the weight is the overlapped length. for the downscale
+};
+
+/**
+ * @brief Same meaning with `MFPKEY_RESIZE_SRC_*`, `MFPKEY_RESIZE_DST_*`
+ * @note  The empty rectangle(0 width or height) means the whole frame
+ */
+struct scale_rect_t final {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+/// @brief The sum of the coefficients of each output is `1 << filter_bits`
+constexpr int32_t filter_bits = 14;
+
+/**
+ * @brief Resampling coefficients of 1 axis. Precomputed for each output position
+ * @details The output `i` is the weighted sum of `taps` inputs from `offsets[i]`.
+ *          The weights are `coefficients[i * taps, (i + 1) * taps)`.
+ */
+struct filter_bank_t final {
+    uint32_t taps = 0;
+    std::vector<uint32_t> offsets{}; ///< always `offsets[i] + taps <= input`
+    std::vector<int16_t> coefficients{};
+};
+
+/**
+ * @brief The inputs out of [0, `input`) are clamped to the edge, so the pixels out of the source rectangle are not used
+ * @param input  length of the source rectangle in the axis
+ * @param output length of the destination rectangle in the axis
+ * @throw std::invalid_argument if `input` or `output` is 0
+ * @throw std::bad_alloc
+ */
+filter_bank_t make_filter_bank(scale_filter_t filter, uint32_t input, uint32_t output) noexcept(false);
+
+/// @return true for the formats which `scaler_t` can process
+bool is_scalable(pixel_format_t format) noexcept;
+
+/**
+ * @brief Separable scaler for NV12, NV21, I420 and RGB32 with the cached filter banks
+ *
+ * @details The source rectangle is scaled into the destination rectangle. The pixels of the `dst` out of the
+ *          destination rectangle are not touched, so the caller can fill the letterbox once.
+ *          The filter banks are made for each (filter, source length, destination length) and reused while the
+ *          rectangles don't change. For 4:2:0, the chroma rectangles are the half of the luma ones.
+ * @note    The filter banks are not shared between the instances. Use 1 instance for each stream.
+ *          `scale`/`scale_to_rgb32` can run concurrently with the different `rows`, but the setters can't
+ * @code
+ * scaler_t scaler{scale_filter_t::bilinear};
+ * scaler.set_source_rectangle({0, 140, 1920, 800}); // crop the letterbox
+ * for (...)
+ *     scaler.scale(input.view(), output.view());
+ * @endcode
+ */
+class scaler_t final {
+    using key_t = std::tuple<scale_filter_t, uint32_t, uint32_t>;
+
+    scale_filter_t filter;
+    scale_rect_t source{};
+    scale_rect_t destination{};
+    std::mutex mtx{}; // for `banks`
+    std::map<key_t, std::shared_ptr<const filter_bank_t>> banks{};
+
+  public:
+    static constexpr size_t max_bank_count = 16;
+
+  public:
+    explicit scaler_t(scale_filter_t filter = scale_filter_t::bilinear) noexcept;
+
+    void set_filter(scale_filter_t value) noexcept;
+    void set_source_rectangle(const scale_rect_t& rect) noexcept;
+    void set_destination_rectangle(const scale_rect_t& rect) noexcept;
+
+    /**
+     * @param src `nv12`, `nv21`, `i420` or `rgb32`
+     * @param dst same format with the `src`. the size may differ
+     * @param level `simd_level_t::scalar` for the reference. clamped with `clamp_simd_level`
+     * @param rows  of the `dst` to write. the boundaries must be even for 4:2:0. see `parallel_rows`
+     * @return false if the formats don't match, the rectangles are out of the frames, or the allocation failed
+     */
+    bool scale(const frame_view_t& src, const frame_view_t& dst, simd_level_t level = get_simd_level(),
+               row_range_t rows = all_rows) noexcept;
+
+    /**
+     * @brief Crop, scale and NV12/I420 → RGB32 with 1 read of the source
+     * @details The scaled rows stay in the scratch memory and they are converted right away.
+     *          The result is same with `scale` into the NV12/I420 frame of the destination rectangle's size and
+     *          `convert_yuv_to_rgb32`, then the copy into the destination rectangle.
+     * @note    The chroma grid starts at the destination rectangle. `scale` into the odd x/y of the 4:2:0 frame
+     *          uses the chroma grid of the frame, so the result differs from this for the odd x/y
+     * @param src `nv12` or `i420`
+     * @param dst `rgb32`. the destination rectangle is applied
+     * @param rows of the `dst` to write
+     * @return false if the formats don't match, the rectangles are out of the frames, or the allocation failed
+     */
+    bool scale_to_rgb32(const frame_view_t& src, const frame_view_t& dst, yuv_color_t color = {},
+                        simd_level_t level = get_simd_level(), row_range_t rows = all_rows) noexcept;
+
+    /**
+     * @brief The filter bank for the axis. Made only if it's not in the cache
+     * @note  If the cache is full, it's cleared. The returned bank is still valid
+     * @throw std::bad_alloc
+     */
+    std::shared_ptr<const filter_bank_t> get_filter_bank(uint32_t input, uint32_t output) noexcept(false);
+};
@@ -0,0 +1,50 @@
+/**
+ * @note compiled with AVX2. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+int32_t make_pair(int16_t first, int16_t second) noexcept {
+    return static_cast<int32_t>(static_cast<uint16_t>(first) | (static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16));
+}
+
+__m256i load_16(const uint8_t* ptr) noexcept {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+}
+
+} // namespace
+
+void scale_vertical_avx2(const uint8_t* const* rows, const int16_t* coefficients, uint32_t taps, uint8_t* dst,
+                         uint32_t count) noexcept {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i half = _mm256_set1_epi32(1 << (filter_bits - 1));
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // the unpack works in the 128 bit lanes. the pack below restores the order
+        __m256i lo = _mm256_setzero_si256();
+        __m256i hi = _mm256_setzero_si256();
+        uint32_t k = 0;
+        for (; k + 2 <= taps; k += 2) {
+            const __m256i a = load_16(rows[k] + i);
+            const __m256i b = load_16(rows[k + 1] + i);
+            const __m256i w = _mm256_set1_epi32(make_pair(coefficients[k], coefficients[k + 1]));
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+        }
+        if (k < taps) {
+            const __m256i a = load_16(rows[k] + i);
+            const __m256i w = _mm256_set1_epi32(make_pair(coefficients[k], 0));
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, zero), w));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, zero), w));
+        }
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, half), filter_bits);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, half), filter_bits);
+        const __m256i words = _mm256_packs_epi32(lo, hi);
+        const __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0b11'01'10'00);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(bytes));
+    }
+    scale_vertical_scalar(rows, coefficients, taps, dst, i, count);
+}
@@ -0,0 +1,71 @@
+#include "scale_graph.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+using process_t = graph_builder_t<frame_buffer_t>::process_t;
+using emit_t = pipeline_t<frame_buffer_t>::emit_t;
+
+/// @brief `frame` is forwarded if the `scaler` doesn't change anything
+static process_t make_scale_stage(shared_ptr<scaler_t> scaler, uint32_t width, uint32_t height, frame_pool_t& pool,
+                                  const char* name) {
+    if (width == 0 || height == 0)
+        return [](frame_buffer_t&& frame, const emit_t& emit) { emit(move(frame)); };
+    return [scaler, width, height, &pool, name](frame_buffer_t&& frame, const emit_t& emit) {
+        frame_buffer_t output{pool, frame.format(), width, height};
+        if (scaler->scale(frame.view(), output.view()) == false)
+            throw runtime_error{string{"add_scale_nodes: "} + name + " failed"};
+        emit(move(output));
+    };
+}
+
+static process_t make_converter(const yuv_color_t& color, frame_pool_t& pool) {
+    return [color, &pool](frame_buffer_t&& frame, const emit_t& emit) {
+        frame_buffer_t output{pool, pixel_format_t::rgb32, frame.width(), frame.height()};
+        if (convert_yuv_to_rgb32(frame.view(), output.view(), color) == false)
+            throw runtime_error{"add_scale_nodes: yuv→rgb32 failed"};
+        emit(move(output));
+    };
+}
+
+static process_t make_fused(const scale_graph_options_t& options, frame_pool_t& pool) {
+    // 1:1 of the chain's crop is the copy. `nearest` keeps it without the resize
+    const bool resize = options.width && options.height;
+    auto scaler = make_shared<scaler_t>(resize ? options.filter : scale_filter_t::nearest);
+    scaler->set_source_rectangle(options.crop);
+    return [scaler, options, resize, &pool](frame_buffer_t&& frame, const emit_t& emit) {
+        const bool crop = options.crop.width && options.crop.height;
+        uint32_t width = crop ? options.crop.width : frame.width();
+        uint32_t height = crop ? options.crop.height : frame.height();
+        if (resize)
+            width = options.width, height = options.height;
+        frame_buffer_t output{pool, pixel_format_t::rgb32, width, height};
+        if (scaler->scale_to_rgb32(frame.view(), output.view(), options.color) == false)
+            throw runtime_error{"add_scale_nodes: crop+resize+yuv→rgb32 failed"};
+        emit(move(output));
+    };
+}
+
+void add_scale_nodes(graph_builder_t<frame_buffer_t>& graph, const scale_graph_options_t& options,
+                     frame_pool_t& pool) noexcept(false) {
+    const vector<pixel_format_t> scalable{pixel_format_t::nv12, pixel_format_t::nv21, pixel_format_t::i420,
+                                          pixel_format_t::rgb32};
+    graph.add_stage("crop", scalable, [options, &pool](pixel_format_t) {
+        auto scaler = make_shared<scaler_t>(scale_filter_t::nearest);
+        scaler->set_source_rectangle(options.crop);
+        return make_scale_stage(move(scaler), options.crop.width, options.crop.height, pool, "crop");
+    });
+    graph.add_stage("resize", scalable, [options, &pool](pixel_format_t) {
+        return make_scale_stage(make_shared<scaler_t>(options.filter), options.width, options.height, pool,
+                                "resize");
+    });
+    for (auto [name, format] : {pair{"nv12→rgb32", pixel_format_t::nv12}, pair{"i420→rgb32", pixel_format_t::i420}}) {
+        graph.add_converter(name, format, pixel_format_t::rgb32,
+                            [color = options.color, &pool]() { return make_converter(color, pool); });
+        graph.add_fusion(string{"crop+resize+"} + name, {"crop", "resize", name},
+                         [options, &pool](pixel_format_t) { return make_fused(options, pool); });
+    }
+}
@@ -0,0 +1,42 @@
+/**
+ * @file    scale_graph.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   `scaler_t` and `convert_yuv_to_rgb32` as the nodes of `graph_builder_t`
+ */
+#pragma once
+#include <frame_buffer.hpp>
+#include <graph.hpp>
+#include <scale.hpp>
+
+#include <cstdint>
+
+/// @brief The parameters of the nodes which are registered by `add_scale_nodes`
+struct scale_graph_options_t final {
+    scale_rect_t crop{};  ///< the source rectangle. empty to skip the crop
+    uint32_t width = 0;   ///< of the resized frame. 0 to skip the resize
+    uint32_t height = 0;
+    scale_filter_t filter = scale_filter_t::bilinear; ///< for the resize
+    yuv_color_t color{};
+};
+
+/**
+ * @brief Register the crop/resize stages, the YUV → RGB32 converters and their fusions
+ *
+ * @details The stages are "crop" and "resize" with `scaler_t::scale`. The converters are "nv12→rgb32" and
+ *          "i420→rgb32" with `convert_yuv_to_rgb32`. If the 3 steps are adjacent in the resolved path, they are
+ *          replaced with "crop+resize+nv12→rgb32"(or "i420") which runs `scaler_t::scale_to_rgb32`,
+ *          so the cropped and the resized frames are not written to the memory.
+ *          The fused output is same with the chain if the crop rectangle starts at the even x/y.
+ * @param pool for the output frames of the nodes. must outlive the pipeline
+ * @throw std::bad_alloc
+ * @note  The nodes throw `std::runtime_error` if the kernel fails, so the pipeline stops
+ * @code
+ * graph_builder_t<frame_buffer_t> graph{};
+ * graph.set_source("decoder", {pixel_format_t::nv12}, open_decoder);
+ * add_scale_nodes(graph, {{240, 0, 1440, 1080}, 960, 720}, pool);
+ * graph.set_sink("display", {pixel_format_t::rgb32}, open_display);
+ * graph.build(pipeline); // decoder → crop+resize+nv12→rgb32 → display
+ * @endcode
+ */
+void add_scale_nodes(graph_builder_t<frame_buffer_t>& graph, const scale_graph_options_t& options,
+                     frame_pool_t& pool) noexcept(false);
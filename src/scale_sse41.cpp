@@ -0,0 +1,131 @@
+/**
+ * @note compiled with SSE 4.1. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+
+/// @brief 2 coefficients in the 32 bit lane for `_mm_madd_epi16`
+int32_t make_pair(int16_t first, int16_t second) noexcept {
+    return static_cast<int32_t>(static_cast<uint16_t>(first) | (static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16));
+}
+
+/// @brief round, shift, and saturate to [0, 255]. 4 bytes in the low 32 bits
+__m128i narrow(__m128i lo, __m128i hi) noexcept {
+    const __m128i half = _mm_set1_epi32(1 << (filter_bits - 1));
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, half), filter_bits);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, half), filter_bits);
+    const __m128i words = _mm_packs_epi32(lo, hi);
+    return _mm_packus_epi16(words, words);
+}
+
+/// @brief samples of 1 channel(Y, U, V) or 2 channels(UV). 4 samples with 1 loop
+template <uint32_t C>
+void scale_horizontal(const uint8_t* src, uint8_t* dst, const filter_bank_t& bank, uint32_t width) noexcept {
+    const uint32_t taps = bank.taps;
+    const uint32_t count = width * C;
+    const int16_t* coefficients = bank.coefficients.data();
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i sum = _mm_setzero_si128();
+        uint32_t k = 0;
+        for (; k + 2 <= taps; k += 2) {
+            int32_t pixels[4], weights[4];
+            for (uint32_t j = 0; j < 4; ++j) {
+                const uint32_t x = (i + j) / C;
+                const uint8_t* input = src + (bank.offsets[x] + k) * C + (i + j) % C;
+                pixels[j] = input[0] | (input[C] << 16);
+                weights[j] = make_pair(coefficients[x * taps + k], coefficients[x * taps + k + 1]);
+            }
+            const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(p, w));
+        }
+        if (k < taps) {
+            int32_t pixels[4], weights[4];
+            for (uint32_t j = 0; j < 4; ++j) {
+                const uint32_t x = (i + j) / C;
+                pixels[j] = src[(bank.offsets[x] + k) * C + (i + j) % C];
+                weights[j] = make_pair(coefficients[x * taps + k], 0);
+            }
+            const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(p, w));
+        }
+        const int32_t packed = _mm_cvtsi128_si32(narrow(sum, sum));
+        std::memcpy(dst + i, &packed, 4);
+    }
+    // `i` is the multiple of `C`, so it's the start of the pixel
+    scale_horizontal_scalar(src, dst, C, bank, i / C, width);
+}
+
+/// @brief B, G, R, X of 1 pixel with 1 loop. 2 taps are interleaved for `_mm_madd_epi16`
+void scale_horizontal_rgb32(const uint8_t* src, uint8_t* dst, const filter_bank_t& bank, uint32_t width) noexcept {
+    const uint32_t taps = bank.taps;
+    const __m128i interleave = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+    for (uint32_t x = 0; x < width; ++x) {
+        const uint8_t* input = src + bank.offsets[x] * 4;
+        const int16_t* coefficients = bank.coefficients.data() + x * taps;
+        __m128i sum = _mm_setzero_si128();
+        uint32_t k = 0;
+        for (; k + 2 <= taps; k += 2) {
+            const __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 4 * k));
+            const __m128i p = _mm_cvtepu8_epi16(_mm_shuffle_epi8(pair, interleave)); // B0 B1 G0 G1 R0 R1 X0 X1
+            const __m128i w = _mm_set1_epi32(make_pair(coefficients[k], coefficients[k + 1]));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(p, w));
+        }
+        if (k < taps) {
+            int32_t pixel = 0;
+            std::memcpy(&pixel, input + 4 * k, 4);
+            const __m128i p = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(pixel));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(p, _mm_set1_epi32(make_pair(coefficients[k], 0))));
+        }
+        const int32_t packed = _mm_cvtsi128_si32(narrow(sum, sum));
+        std::memcpy(dst + 4 * x, &packed, 4);
+    }
+}
+
+} // namespace
+
+void scale_vertical_sse41(const uint8_t* const* rows, const int16_t* coefficients, uint32_t taps, uint8_t* dst,
+                          uint32_t count) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_setzero_si128();
+        __m128i hi = _mm_setzero_si128();
+        uint32_t k = 0;
+        for (; k + 2 <= taps; k += 2) {
+            const __m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k] + i)));
+            const __m128i b = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k + 1] + i)));
+            const __m128i w = _mm_set1_epi32(make_pair(coefficients[k], coefficients[k + 1]));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+        }
+        if (k < taps) {
+            const __m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k] + i)));
+            const __m128i w = _mm_set1_epi32(make_pair(coefficients[k], 0));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, zero), w));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, zero), w));
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), narrow(lo, hi));
+    }
+    scale_vertical_scalar(rows, coefficients, taps, dst, i, count);
+}
+
+void scale_horizontal_sse41(const uint8_t* src, uint8_t* dst, uint32_t channels, const filter_bank_t& bank,
+                            uint32_t width) noexcept {
+    switch (channels) {
+    case 1:
+        return scale_horizontal<1>(src, dst, bank, width);
+    case 2:
+        return scale_horizontal<2>(src, dst, bank, width);
+    case 4:
+        return scale_horizontal_rgb32(src, dst, bank, width);
+    default:
+        return scale_horizontal_scalar(src, dst, channels, bank, 0, width);
+    }
+}
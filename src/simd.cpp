@@ -0,0 +1,57 @@
+#include "simd.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+static simd_level_t detect_simd_level() noexcept {
+#if !defined(MEDIA_CORE_X86)
+    return simd_level_t::scalar; // the SIMD kernels are not built
+#elif defined(_MSC_VER)
+    int info[4]{};
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    const bool sse41 = info[2] & (1 << 19);
+    const bool osxsave = info[2] & (1 << 27);
+    const bool avx = info[2] & (1 << 28);
+    bool avx2 = false;
+    if (max_leaf >= 7 && osxsave && avx) {
+        const bool ymm_enabled = (_xgetbv(0) & 0b110) == 0b110; // the OS saves XMM/YMM registers
+        __cpuidex(info, 7, 0);
+        avx2 = ymm_enabled && (info[1] & (1 << 5));
+    }
+    if (avx2)
+        return simd_level_t::avx2;
+    return sse41 ? simd_level_t::sse41 : simd_level_t::scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return simd_level_t::avx2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return simd_level_t::sse41;
+    return simd_level_t::scalar;
+#endif
+}
+
+simd_level_t get_simd_level() noexcept {
+    static const simd_level_t level = detect_simd_level();
+    return level;
+}
+
+simd_level_t clamp_simd_level(simd_level_t level) noexcept {
+    const simd_level_t supported = get_simd_level();
+    return level < supported ? level : supported;
+}
+
+const char* to_string(simd_level_t level) noexcept {
+    switch (level) {
+    case simd_level_t::sse41:
+        return "sse41";
+    case simd_level_t::avx2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
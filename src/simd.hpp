@@ -0,0 +1,22 @@
+/**
+ * @file    simd.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Runtime CPU dispatch for the frame kernels
+ */
+#pragma once
+#include <cstdint>
+
+/// @brief Instruction sets of the kernels. The greater one includes the smaller ones
+enum class simd_level_t : uint32_t {
+    scalar = 0, ///< portable C++. the reference of the others
+    sse41,      ///< SSE 4.1 (with SSSE3)
+    avx2,
+};
+
+/// @brief the best level which is supported by both the build and the CPU. detected once
+simd_level_t get_simd_level() noexcept;
+
+/// @return the `level` if it's supported, or the best one below it
+simd_level_t clamp_simd_level(simd_level_t level) noexcept;
+
+const char* to_string(simd_level_t level) noexcept;
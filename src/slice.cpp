@@ -0,0 +1,48 @@
+#include "slice.hpp"
+#include "pixel_traits.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+using namespace std;
+
+uint32_t get_row_alignment(const frame_view_t& view) noexcept {
+    const uint32_t shift_y = get_pixel_traits(view.format).shift_y;
+    size_t alignment = size_t{1} << shift_y;
+    for (uint32_t i = 0; i < view.num_plane; ++i) {
+        // the boundary `b` is the row `b / factor` of the plane. its offset must be the multiple of the cache line
+        const size_t factor = i > 0 ? size_t{1} << shift_y : 1;
+        const size_t pitch = view.planes[i].pitch % cache_line_size;
+        const size_t rows = pitch == 0 ? 1 : cache_line_size / gcd(pitch, cache_line_size);
+        alignment = lcm(alignment, factor * rows);
+    }
+    return static_cast<uint32_t>(alignment);
+}
+
+vector<row_range_t> split_rows(uint32_t height, uint32_t alignment, size_t count) noexcept(false) {
+    vector<row_range_t> ranges{};
+    if (height == 0 || count == 0)
+        return ranges;
+    alignment = max(alignment, 1u);
+    const uint64_t units = (uint64_t{height} + alignment - 1) / alignment;
+    count = static_cast<size_t>(min<uint64_t>(count, units));
+    const uint64_t step = (units + count - 1) / count * alignment;
+    ranges.reserve(count);
+    for (uint64_t begin = 0; begin < height; begin += step)
+        ranges.emplace_back(
+            row_range_t{static_cast<uint32_t>(begin), static_cast<uint32_t>(min(begin + step, uint64_t{height}))});
+    return ranges;
+}
+
+bool parallel_rows(executor_t& executor, const frame_view_t& dst,
+                   const function<bool(row_range_t)>& fn) noexcept(false) {
+    const size_t count = max(executor.size(), (get_contiguous_size(dst) + stripe_bytes - 1) / stripe_bytes);
+    const vector<row_range_t> ranges = split_rows(dst.height, get_row_alignment(dst), count);
+    atomic_bool succeeded{true};
+    executor.parallel_for(ranges.size(), [&](size_t i) {
+        if (fn(ranges[i]) == false)
+            succeeded.store(false, memory_order_relaxed);
+    });
+    return succeeded;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file    slice.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Row partition of the frame kernels for `executor_t`
+ */
+#pragma once
+#include <executor.hpp>
+#include <frame_buffer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/// @brief Rows [begin, end) of the output frame. `end` is clamped to the height by the kernels
+struct row_range_t final {
+    uint32_t begin = 0;
+    uint32_t end = UINT32_MAX;
+};
+
+/// @brief all rows of the frame. the default of the kernels
+constexpr row_range_t all_rows{};
+
+/// @brief Rough budget of the output bytes for 1 stripe. The input rows of the stripe fit in L2 too
+constexpr size_t stripe_bytes = 256 * 1024;
+
+/**
+ * @brief The step of the stripe boundaries which keeps the stripes in the separate cache lines
+ * @details The rows of each plane must start at the cache line at the boundaries, and the 4:2:0 chroma row
+ *          must belong to only 1 stripe. 1 or 2 for `frame_buffer_t`. The larger one for the odd pitches
+ * @note    The planes are assumed to start at the cache line. `frame_buffer_t` does
+ */
+uint32_t get_row_alignment(const frame_view_t& view) noexcept;
+
+/**
+ * @brief Split the `height` rows into `count` stripes or less
+ * @param alignment the boundaries are the multiple of it. see `get_row_alignment`
+ * @return not empty ranges. the last one may be smaller than the others
+ */
+std::vector<row_range_t> split_rows(uint32_t height, uint32_t alignment, size_t count) noexcept(false);
+
+/**
+ * @brief Run `fn` for each stripe of the `dst` with the `executor` and wait for all of them
+ *
+ * @details The number of the stripes is `executor.size()` or more, so 1 stripe writes about `stripe_bytes`.
+ *          The kernels must write only the rows in the given range.
+ * @code
+ * parallel_rows(executor, dst.view(), [&](row_range_t rows) {
+ *     return convert_yuv_to_rgb32(src.view(), dst.view(), color, get_simd_level(), rows);
+ * });
+ * @endcode
+ * @return false if any of the `fn` returned false
+ * @throw the first exception from the `fn`
+ */
+bool parallel_rows(executor_t& executor, const frame_view_t& dst,
+                   const std::function<bool(row_range_t rows)>& fn) noexcept(false);
@@ -0,0 +1,126 @@
+/**
+ * @file    spsc_ring.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Wait-free single-producer/single-consumer ring
+ */
+#pragma once
+#include <frame_pool.hpp> // cache_line_size
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @brief Fixed size ring of frame handles(e.g. `com_ptr<IMFSample>`) between 2 threads
+ *
+ * @details The producer and the consumer own their index in separate cache lines.
+ *          Each side caches the other's index and reloads it only when the ring looks full/empty,
+ *          so the shared cache line is touched once per batch in the steady state.
+ *          All operations are wait-free. They never block or take a lock.
+ * @note    Only 1 thread may push and only 1 thread may pop at the same time
+ */
+template <typename T>
+class spsc_ring_t final {
+    static_assert(std::is_nothrow_move_assignable_v<T>);
+    static_assert(std::is_nothrow_default_constructible_v<T>);
+
+    struct alignas(cache_line_size) producer_t final {
+        std::atomic<size_t> tail{0};
+        size_t cached_head = 0;
+    };
+    struct alignas(cache_line_size) consumer_t final {
+        std::atomic<size_t> head{0};
+        size_t cached_tail = 0;
+    };
+
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+    producer_t producer{};
+    consumer_t consumer{};
+
+  public:
+    /**
+     * @param capacity rounded up to the power of 2
+     * @throw std::invalid_argument if `capacity` is 0
+     */
+    explicit spsc_ring_t(size_t capacity) noexcept(false)
+        : mask{round_up(capacity) - 1}, slots{std::make_unique<T[]>(mask + 1)} {
+    }
+    spsc_ring_t(const spsc_ring_t&) = delete;
+    spsc_ring_t(spsc_ring_t&&) = delete;
+    spsc_ring_t& operator=(const spsc_ring_t&) = delete;
+    spsc_ring_t& operator=(spsc_ring_t&&) = delete;
+
+    size_t capacity() const noexcept {
+        return mask + 1;
+    }
+    /// @note the value can be changed by the other thread right after the return
+    size_t size_approx() const noexcept {
+        const size_t tail = producer.tail.load(std::memory_order_acquire);
+        const size_t head = consumer.head.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    /// @return false if the ring is full. the `item` is not moved in the case
+    bool try_push(T&& item) noexcept {
+        return try_push(&item, 1) == 1;
+    }
+
+    /**
+     * @brief move the `items` into the ring until it becomes full
+     * @return number of moved items from the front of `items`
+     */
+    size_t try_push(T* items, size_t count) noexcept {
+        const size_t tail = producer.tail.load(std::memory_order_relaxed);
+        size_t available = capacity() - (tail - producer.cached_head);
+        if (available < count) {
+            producer.cached_head = consumer.head.load(std::memory_order_acquire);
+            available = capacity() - (tail - producer.cached_head);
+        }
+        if (count > available)
+            count = available;
+        for (size_t i = 0; i < count; ++i)
+            slots[(tail + i) & mask] = std::move(items[i]);
+        producer.tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /// @return false if the ring is empty
+    bool try_pop(T& item) noexcept {
+        return try_pop(&item, 1) == 1;
+    }
+
+    /**
+     * @brief move at most `count` items out of the ring
+     * @return number of the items written to `items`
+     */
+    size_t try_pop(T* items, size_t count) noexcept {
+        const size_t head = consumer.head.load(std::memory_order_relaxed);
+        size_t available = consumer.cached_tail - head;
+        if (available < count) {
+            consumer.cached_tail = producer.tail.load(std::memory_order_acquire);
+            available = consumer.cached_tail - head;
+        }
+        if (count > available)
+            count = available;
+        for (size_t i = 0; i < count; ++i) {
+            T& slot = slots[(head + i) & mask];
+            items[i] = std::move(slot);
+            slot = T{}; // release the handle in the slot now. not when it is overwritten
+        }
+        consumer.head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+  private:
+    static size_t round_up(size_t capacity) noexcept(false) {
+        if (capacity == 0)
+            throw std::invalid_argument{"spsc_ring_t: capacity must be greater than 0"};
+        size_t value = 1;
+        while (value < capacity)
+            value <<= 1;
+        return value;
+    }
+};
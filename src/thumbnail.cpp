@@ -0,0 +1,185 @@
+#include "thumbnail.hpp"
+#include "kernels.hpp"
+#include "pixel_traits.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+bool is_thumbnail_source(pixel_format_t format) noexcept {
+    return format == pixel_format_t::nv12 || format == pixel_format_t::yuy2 || format == pixel_format_t::uyvy;
+}
+
+bool is_thumbnail_factor(uint32_t factor) noexcept {
+    return factor && factor <= max_thumbnail_factor && (factor & (factor - 1)) == 0;
+}
+
+void accumulate_row_scalar(const uint8_t* src, uint16_t* sum, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i)
+        sum[i] = static_cast<uint16_t>(sum[i] + src[i]);
+}
+
+void halve_row_scalar(const uint16_t* src, uint16_t* dst, uint32_t channels, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t i = begin; i < end; ++i)
+        for (uint32_t c = 0; c < channels; ++c)
+            dst[i * channels + c] =
+                static_cast<uint16_t>(src[2 * i * channels + c] + src[(2 * i + 1) * channels + c]);
+}
+
+void round_row_scalar(const uint16_t* src, uint8_t* dst, uint32_t shift, uint32_t begin, uint32_t end) noexcept {
+    const uint32_t half = (1u << shift) >> 1;
+    for (uint32_t i = begin; i < end; ++i)
+        dst[i] = static_cast<uint8_t>((src[i] + half) >> shift);
+}
+
+namespace {
+
+/// @brief row kernels of 1 `simd_level_t`. the scalar ones are adapted to the same signature
+struct thumbnail_kernels_t final {
+    void (*accumulate)(const uint8_t*, uint16_t*, uint32_t);
+    void (*halve)(const uint16_t*, uint16_t*, uint32_t, uint32_t);
+    void (*round)(const uint16_t*, uint8_t*, uint32_t, uint32_t);
+};
+
+const thumbnail_kernels_t scalar_kernels{
+    [](const uint8_t* src, uint16_t* sum, uint32_t n) noexcept { accumulate_row_scalar(src, sum, 0, n); },
+    [](const uint16_t* src, uint16_t* dst, uint32_t channels, uint32_t n) noexcept {
+        halve_row_scalar(src, dst, channels, 0, n);
+    },
+    [](const uint16_t* src, uint8_t* dst, uint32_t shift, uint32_t n) noexcept {
+        round_row_scalar(src, dst, shift, 0, n);
+    },
+};
+
+#if defined(MEDIA_CORE_X86)
+const thumbnail_kernels_t sse41_kernels{&accumulate_row_sse41, &halve_row_sse41, &round_row_sse41};
+const thumbnail_kernels_t avx2_kernels{&accumulate_row_avx2, &halve_row_avx2, &round_row_avx2};
+#endif
+
+const thumbnail_kernels_t& get_thumbnail_kernels(simd_level_t level) noexcept {
+    switch (level) {
+#if defined(MEDIA_CORE_X86)
+    case simd_level_t::avx2:
+        return avx2_kernels;
+    case simd_level_t::sse41:
+        return sse41_kernels;
+#endif
+    default:
+        return scalar_kernels;
+    }
+}
+
+uint32_t get_log2(uint32_t value) noexcept {
+    uint32_t n = 0;
+    while (value >>= 1)
+        ++n;
+    return n;
+}
+
+/// @brief the memory of the thread for the sums and the averaged rows. reused, so the repeated calls don't allocate
+struct thumbnail_scratch_t final {
+    vector<uint16_t> packed{}; ///< the sums of YUY2/UYVY rows
+    vector<uint16_t> luma{};
+    vector<uint16_t> chroma{}; ///< interleaved U/V
+    vector<uint8_t> y{};
+    vector<uint8_t> uv{};
+};
+
+/// @brief the chroma pairs after the available ones repeat the last pair. `count` is the number of the values
+void repeat_last(uint16_t* sums, uint32_t available, uint32_t count, uint32_t channels) noexcept {
+    for (uint32_t i = available; i < count; i += channels)
+        memcpy(sums + i, sums + available - channels, channels * sizeof(uint16_t));
+}
+
+/// @brief halve the `sums` `times` times and round them into `dst`. `count` is the number of the output pixels
+void decimate(uint16_t* sums, uint8_t* dst, uint32_t count, uint32_t channels, uint32_t times, uint32_t shift,
+              const thumbnail_kernels_t& k) noexcept {
+    for (uint32_t i = 0; i < times; ++i)
+        k.halve(sums, sums, channels, count << (times - i - 1));
+    k.round(sums, dst, shift, count * channels);
+}
+
+/// @return false if the planes can't hold the `width` x `height` of the `view`
+bool has_planes(const frame_view_t& view) noexcept {
+    const pixel_traits_t traits = get_pixel_traits(view.format);
+    if (view.num_plane == 0 || view.num_plane != traits.num_plane)
+        return false;
+    for (uint32_t i = 0; i < view.num_plane; ++i) {
+        const plane_t& plane = view.planes[i];
+        if (plane.data == nullptr || plane.rows < get_plane_rows(traits, view.height, i) ||
+            plane.row_bytes < get_row_bytes(traits, view.width, i))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool make_thumbnail(const frame_view_t& src, const frame_view_t& dst, uint32_t factor, yuv_color_t color,
+                    simd_level_t level, row_range_t rows) noexcept {
+    if (is_thumbnail_source(src.format) == false || dst.format != pixel_format_t::rgb32 ||
+        is_thumbnail_factor(factor) == false)
+        return false;
+    if (dst.width == 0 || dst.height == 0 || dst.width != src.width / factor || dst.height != src.height / factor)
+        return false;
+    if (has_planes(src) == false || has_planes(dst) == false)
+        return false;
+    level = clamp_simd_level(level);
+    const thumbnail_kernels_t& k = get_thumbnail_kernels(level);
+    const yuv_coefficients_t coefficients = get_yuv_coefficients(color);
+
+    const uint32_t times = get_log2(factor);
+    const uint32_t luma_count = dst.width * factor;           // luma samples for a row
+    const uint32_t pair_count = (dst.width + 1) / 2 * factor; // U/V pairs for a row
+    const uint32_t pair_available = (src.width + 1) / 2;      // U/V pairs in the `src` row
+    const uint32_t pair_read = min(pair_count, pair_available);
+    const uint32_t chroma_rows = src.format == pixel_format_t::nv12 ? max(factor / 2, 1u) : factor;
+
+    static thread_local thumbnail_scratch_t scratch{};
+    try {
+        scratch.packed.resize(max<size_t>(scratch.packed.size(), pair_count * 4));
+        scratch.luma.resize(max<size_t>(scratch.luma.size(), luma_count));
+        scratch.chroma.resize(max<size_t>(scratch.chroma.size(), pair_count * 2));
+        scratch.y.resize(max<size_t>(scratch.y.size(), dst.width));
+        scratch.uv.resize(max<size_t>(scratch.uv.size(), (dst.width + 1) / 2 * 2));
+    } catch (const bad_alloc&) {
+        return false;
+    }
+    uint16_t* luma = scratch.luma.data();
+    uint16_t* chroma = scratch.chroma.data();
+
+    const uint32_t end = min(rows.end, dst.height);
+    for (uint32_t y = rows.begin; y < end; ++y) {
+        if (src.format == pixel_format_t::nv12) {
+            memset(luma, 0, luma_count * sizeof(uint16_t));
+            for (uint32_t r = 0; r < factor; ++r)
+                k.accumulate(src.planes[0].row(y * factor + r), luma, luma_count);
+            memset(chroma, 0, pair_read * 2 * sizeof(uint16_t));
+            for (uint32_t r = 0; r < chroma_rows; ++r)
+                k.accumulate(src.planes[1].row(y * factor / 2 + r), chroma, pair_read * 2);
+        } else {
+            // Y0 U Y1 V or U Y0 V Y1. the rows are summed together, then the sums are separated
+            uint16_t* packed = scratch.packed.data();
+            memset(packed, 0, pair_read * 4 * sizeof(uint16_t));
+            for (uint32_t r = 0; r < factor; ++r)
+                k.accumulate(src.planes[0].row(y * factor + r), packed, pair_read * 4);
+            const uint32_t y_offset = src.format == pixel_format_t::yuy2 ? 0 : 1;
+            const uint32_t u_offset = 1 - y_offset;
+            for (uint32_t x = 0; x < luma_count; ++x)
+                luma[x] = packed[2 * x + y_offset];
+            for (uint32_t p = 0; p < pair_read; ++p) {
+                chroma[2 * p + 0] = packed[4 * p + u_offset];
+                chroma[2 * p + 1] = packed[4 * p + u_offset + 2];
+            }
+        }
+        repeat_last(chroma, pair_read * 2, pair_count * 2, 2);
+        decimate(luma, scratch.y.data(), dst.width, 1, times, 2 * times, k);
+        decimate(chroma, scratch.uv.data(), (dst.width + 1) / 2, 2, times, times + get_log2(chroma_rows), k);
+        convert_row_nv12_rgb32(scratch.y.data(), scratch.uv.data(), dst.planes[0].row(y), dst.width, coefficients,
+                               level);
+    }
+    return true;
+}
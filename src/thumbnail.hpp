@@ -0,0 +1,35 @@
+/**
+ * @file    thumbnail.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Box filter decimation into RGB32 for the photo confirmation
+ * @see     https://docs.microsoft.com/en-us/windows-hardware/drivers/stream/photo-confirmation
+ */
+#pragma once
+#include <color_convert.hpp>
+#include <frame_buffer.hpp>
+#include <simd.hpp>
+#include <slice.hpp>
+
+/// @return true for `nv12`, `yuy2` and `uyvy`
+bool is_thumbnail_source(pixel_format_t format) noexcept;
+
+/// @brief The largest `factor` of `make_thumbnail`. The sum of 16 x 16 samples fits in 16 bit
+constexpr uint32_t max_thumbnail_factor = 16;
+
+/// @return true for the power of 2 in [1, `max_thumbnail_factor`]
+bool is_thumbnail_factor(uint32_t factor) noexcept;
+
+/**
+ * @brief Decimate the `src` by `factor` and convert it to RGB32 in 1 pass
+ *
+ * @details Each output pixel is the rounded average of `factor` x `factor` luma samples. The chroma samples of
+ *          the same rows are averaged for each 2 output pixels, like 4:2:2. The rows of the `src` are summed in
+ *          16 bit and the sums are halved `log2(factor)` times, so there is no division.
+ *          The sums stay in the scratch memory of the thread.
+ * @param dst `rgb32` with `src.width / factor` x `src.height / factor`. The remainder of the `src` is dropped
+ * @param level `simd_level_t::scalar` for the reference. clamped with `clamp_simd_level`
+ * @param rows  of the `dst` to write. see `parallel_rows`
+ * @return false if the formats, the sizes or the `factor` can't be used, or the allocation failed
+ */
+bool make_thumbnail(const frame_view_t& src, const frame_view_t& dst, uint32_t factor, yuv_color_t color = {},
+                    simd_level_t level = get_simd_level(), row_range_t rows = all_rows) noexcept;
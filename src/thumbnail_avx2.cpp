@@ -0,0 +1,66 @@
+/**
+ * @note compiled with AVX2. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+__m256i load(const void* ptr) noexcept {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+
+void store(void* ptr, __m256i value) noexcept {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), value);
+}
+
+/// @brief the horizontal add and the pack work in the 128 bit lanes. restore the order of the 64 bit blocks
+__m256i reorder(__m256i value) noexcept {
+    return _mm256_permute4x64_epi64(value, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+} // namespace
+
+void accumulate_row_avx2(const uint8_t* src, uint16_t* sum, uint32_t count) noexcept {
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i lo = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        const __m256i hi = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16)));
+        store(sum + i, _mm256_add_epi16(load(sum + i), lo));
+        store(sum + i + 16, _mm256_add_epi16(load(sum + i + 16), hi));
+    }
+    accumulate_row_scalar(src, sum, i, count);
+}
+
+void halve_row_avx2(const uint16_t* src, uint16_t* dst, uint32_t channels, uint32_t count) noexcept {
+    // U0 V0 U1 V1 → U0 U1 V0 V1, so the horizontal add makes U0+U1 V0+V1
+    const __m256i order = channels == 2 ? _mm256_setr_epi8(0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15, //
+                                                           0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15)
+                                        : _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, //
+                                                           0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const uint32_t step = 16 / channels;
+    uint32_t i = 0;
+    if (channels == 1 || channels == 2) {
+        for (; i + step <= count; i += step) {
+            const uint16_t* in = src + 2 * i * channels;
+            const __m256i lo = _mm256_shuffle_epi8(load(in), order);
+            const __m256i hi = _mm256_shuffle_epi8(load(in + 16), order);
+            // the 16 bit sums don't saturate. the caller limits them
+            store(dst + i * channels, reorder(_mm256_hadd_epi16(lo, hi)));
+        }
+    }
+    halve_row_scalar(src, dst, channels, i, count);
+}
+
+void round_row_avx2(const uint16_t* src, uint8_t* dst, uint32_t shift, uint32_t count) noexcept {
+    const __m256i half = _mm256_set1_epi16(static_cast<int16_t>((1u << shift) >> 1));
+    const __m128i bits = _mm_cvtsi32_si128(static_cast<int>(shift));
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i lo = _mm256_srl_epi16(_mm256_add_epi16(load(src + i), half), bits);
+        const __m256i hi = _mm256_srl_epi16(_mm256_add_epi16(load(src + i + 16), half), bits);
+        store(dst + i, reorder(_mm256_packus_epi16(lo, hi)));
+    }
+    round_row_scalar(src, dst, shift, i, count);
+}
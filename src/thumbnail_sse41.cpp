@@ -0,0 +1,59 @@
+/**
+ * @note compiled with SSE 4.1. The functions are called only if `get_simd_level` allows
+ */
+#include "kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+__m128i load(const void* ptr) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+
+void store(void* ptr, __m128i value) noexcept {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value);
+}
+
+} // namespace
+
+void accumulate_row_sse41(const uint8_t* src, uint16_t* sum, uint32_t count) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i value = load(src + i);
+        store(sum + i, _mm_add_epi16(load(sum + i), _mm_unpacklo_epi8(value, zero)));
+        store(sum + i + 8, _mm_add_epi16(load(sum + i + 8), _mm_unpackhi_epi8(value, zero)));
+    }
+    accumulate_row_scalar(src, sum, i, count);
+}
+
+void halve_row_sse41(const uint16_t* src, uint16_t* dst, uint32_t channels, uint32_t count) noexcept {
+    // U0 V0 U1 V1 → U0 U1 V0 V1, so the horizontal add makes U0+U1 V0+V1
+    const __m128i order = channels == 2 ? _mm_setr_epi8(0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15)
+                                        : _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const uint32_t step = 8 / channels;
+    uint32_t i = 0;
+    if (channels == 1 || channels == 2) {
+        for (; i + step <= count; i += step) {
+            const uint16_t* in = src + 2 * i * channels;
+            const __m128i lo = _mm_shuffle_epi8(load(in), order);
+            const __m128i hi = _mm_shuffle_epi8(load(in + 8), order);
+            // the 16 bit sums don't saturate. the caller limits them
+            store(dst + i * channels, _mm_hadd_epi16(lo, hi));
+        }
+    }
+    halve_row_scalar(src, dst, channels, i, count);
+}
+
+void round_row_sse41(const uint16_t* src, uint8_t* dst, uint32_t shift, uint32_t count) noexcept {
+    const __m128i half = _mm_set1_epi16(static_cast<int16_t>((1u << shift) >> 1));
+    const __m128i bits = _mm_cvtsi32_si128(static_cast<int>(shift));
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i lo = _mm_srl_epi16(_mm_add_epi16(load(src + i), half), bits);
+        const __m128i hi = _mm_srl_epi16(_mm_add_epi16(load(src + i + 8), half), bits);
+        store(dst + i, _mm_packus_epi16(lo, hi));
+    }
+    round_row_scalar(src, dst, shift, i, count);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file    async_reader_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <async_reader.hpp>
+#include <bounded_queue.hpp>
+#include "coroutine_helpers.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono_literals;
+
+/// @brief simulates `IMFSourceReader` in the asynchronous mode. The callback is invoked in its own thread
+class simulated_source_t final {
+    bounded_queue_t<int> requests{64};
+    thread worker{};
+    atomic_size_t max_in_flight{0};
+
+  public:
+    /// @param count number of the frames. then the end of the stream
+    simulated_source_t(async_reader_t<int>& reader, int count, chrono::microseconds interval) {
+        worker = thread{[this, &reader, count, interval]() {
+            int frame = 0;
+            bool ticked = false;
+            for (int ticket = 0; requests.pop(ticket);) {
+                this_thread::sleep_for(interval);
+                if (frame == count) {
+                    reader.close(); // MF_SOURCE_READERF_ENDOFSTREAM
+                    break;
+                }
+                max_in_flight = max(max_in_flight.load(), reader.get_in_flight());
+                if (frame % 7 == 3 && ticked == false) {
+                    ticked = true;
+                    reader.skip(); // MF_SOURCE_READERF_STREAMTICK without sample
+                    continue;
+                }
+                ticked = false;
+                reader.complete(frame++);
+            }
+        }};
+    }
+    ~simulated_source_t() {
+        requests.close();
+        worker.join();
+    }
+    /// @brief `ReadSample` in the asynchronous mode
+    bool request() {
+        return requests.push(0);
+    }
+    size_t get_max_in_flight() const noexcept {
+        return max_in_flight;
+    }
+};
+
+static detached_t consume(async_reader_t<int>& reader, vector<int>& frames, promise<void>& done) {
+    while (auto frame = co_await reader.next()) {
+        frames.push_back(*frame);
+        this_thread::sleep_for(100us); // consumer's work
+    }
+    done.set_value();
+}
+
+TEST_CASE("async_channel_t", "[coroutine]") {
+    async_channel_t<int> channel{};
+    vector<int> items{};
+    bool finished = false;
+    auto receive = [](async_channel_t<int>& channel, vector<int>& items, bool& finished) -> detached_t {
+        while (auto item = co_await channel.pop())
+            items.push_back(*item);
+        finished = true;
+    };
+    REQUIRE(channel.push(1)); // ready before the await
+    receive(channel, items, finished);
+    REQUIRE(items.size() == 1);
+    REQUIRE(channel.push(2)); // resumes the consumer in this thread
+    REQUIRE(items.size() == 2);
+    REQUIRE_FALSE(finished);
+    channel.close();
+    REQUIRE(finished);
+    REQUIRE_FALSE(channel.push(3));
+}
+
+TEST_CASE("async_reader_t", "[coroutine]") {
+    async_reader_t<int> reader{3};
+    REQUIRE(reader.get_depth() == 3);
+
+    simulated_source_t source{reader, 50, 200us};
+    vector<int> frames{};
+    promise<void> done{};
+    auto finished = done.get_future();
+    reader.start([&source]() { return source.request(); });
+    consume(reader, frames, done);
+
+    REQUIRE(finished.wait_for(10s) == future_status::ready);
+    REQUIRE(frames.size() == 50);
+    for (int i = 0; i < 50; ++i)
+        REQUIRE(frames[i] == i);
+    // other requests were pending while the source was working on 1
+    REQUIRE(source.get_max_in_flight() > 1);
+    REQUIRE(source.get_max_in_flight() <= 3);
+}
+
+TEST_CASE("async_reader_t request failure", "[coroutine]") {
+    async_reader_t<int> reader{2};
+    vector<int> frames{};
+    promise<void> done{};
+    auto finished = done.get_future();
+    reader.start([]() { return false; }); // closed immediately
+    consume(reader, frames, done);
+    REQUIRE(finished.wait_for(0s) == future_status::ready);
+    REQUIRE(frames.empty());
+    REQUIRE(reader.get_in_flight() == 0);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file    buffer_span_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <buffer_span.hpp>
+
+#include <numeric>
+#include <vector>
+
+using namespace std;
+
+/// @brief FNV-1a. stands for the consumers which visit all bytes once
+static uint32_t update_hash(uint32_t hash, const uint8_t* data, size_t size) noexcept {
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+
+TEST_CASE("span_list_t", "[memory]") {
+    vector<uint8_t> memory(100);
+    iota(memory.begin(), memory.end(), uint8_t{0});
+    span_list_t spans{};
+    spans.push_back(memory.data(), 10);
+    spans.push_back(memory.data() + 10, 0); // ignored
+    spans.push_back(memory.data() + 10, 40);
+    spans.push_back(memory.data() + 50, 50);
+    REQUIRE(spans.count() == 3);
+    REQUIRE(spans.total_size() == 100);
+
+    SECTION("iterate") {
+        size_t total = 0;
+        for (const byte_span_t& span : spans)
+            total += span.size;
+        REQUIRE(total == spans.total_size());
+        REQUIRE(spans[1].data == memory.data() + 10);
+    }
+    SECTION("locate") {
+        size_t local = 0;
+        REQUIRE(spans.locate(0, local) == 0);
+        REQUIRE(spans.locate(10, local) == 1);
+        REQUIRE(local == 0);
+        REQUIRE(spans.locate(99, local) == 2);
+        REQUIRE(local == 49);
+        REQUIRE(spans.locate(100, local) == spans.count());
+        REQUIRE(spans.at(42) == 42);
+    }
+    SECTION("read across the pieces") {
+        uint8_t buf[20]{};
+        REQUIRE(spans.read(5, buf, 20) == 20);
+        REQUIRE(equal(buf, buf + 20, memory.begin() + 5));
+        REQUIRE(spans.read(90, buf, 20) == 10);
+        REQUIRE(spans.read(100, buf, 20) == 0);
+    }
+    SECTION("hash without flattening") {
+        uint32_t expected = update_hash(2166136261u, memory.data(), memory.size());
+        uint32_t hash = 2166136261u;
+        for (const byte_span_t& span : spans)
+            hash = update_hash(hash, span.data, span.size);
+        REQUIRE(hash == expected);
+    }
+    SECTION("clear") {
+        spans.clear();
+        REQUIRE(spans.count() == 0);
+        REQUIRE(spans.total_size() == 0);
+    }
+}
+
+TEST_CASE("span_list_t benchmark", "[memory][!benchmark]") {
+    // 1080p NV12 in 3 pieces(Y, UV top/bottom) and H.264 access unit like 64 small pieces
+    const size_t bufsz = 1920 * 1080 * 3 / 2;
+    vector<uint8_t> memory(bufsz, 0x7F);
+    for (size_t num_piece : {3u, 64u}) {
+        span_list_t spans{};
+        const size_t unit = bufsz / num_piece;
+        for (size_t offset = 0; offset < bufsz; offset += unit)
+            spans.push_back(memory.data() + offset, min(unit, bufsz - offset));
+
+        // same work with `ConvertToContiguousBuffer`: allocate, gather, then visit
+        BENCHMARK("flatten and hash(" + to_string(num_piece) + " pieces)") {
+            vector<uint8_t> contiguous(spans.total_size());
+            spans.read(0, contiguous.data(), contiguous.size());
+            return update_hash(2166136261u, contiguous.data(), contiguous.size());
+        };
+        BENCHMARK("hash spans(" + to_string(num_piece) + " pieces)") {
+            uint32_t hash = 2166136261u;
+            for (const byte_span_t& span : spans)
+                hash = update_hash(hash, span.data, span.size);
+            return hash;
+        };
+        BENCHMARK("flatten and copy(" + to_string(num_piece) + " pieces)") {
+            vector<uint8_t> contiguous(spans.total_size());
+            spans.read(0, contiguous.data(), contiguous.size());
+            vector<uint8_t> output(contiguous);
+            return output.size();
+        };
+        BENCHMARK("copy spans(" + to_string(num_piece) + " pieces)") {
+            vector<uint8_t> output(spans.total_size());
+            spans.read(0, output.data(), output.size());
+            return output.size();
+        };
+    }
+}
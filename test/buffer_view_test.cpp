@@ -0,0 +1,89 @@
+/**
+ * @file    buffer_view_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <buffer_view.hpp>
+
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("buffer_view_t", "[memory]") {
+    vector<uint8_t> source(1920 * 1080 * 3 / 2);
+    iota(source.begin(), source.end(), uint8_t{0});
+    buffer_view_t view = make_buffer_view(source.data(), source.size());
+    REQUIRE(view.size() == source.size());
+    REQUIRE(view.data() != source.data());
+    REQUIRE_FALSE(view.is_shared());
+
+    SECTION("copy shares the block") {
+        buffer_view_t preview = view;
+        buffer_view_t recording = view;
+        REQUIRE(preview.data() == view.data());
+        REQUIRE(recording.data() == view.data());
+        REQUIRE(view.get_block().use_count() == 3);
+        REQUIRE(view.is_shared());
+    }
+    SECTION("slice shares the block") {
+        const auto y = view.slice(0, 1920 * 1080);
+        const auto uv = view.slice(1920 * 1080, 1920 * 1080 / 2);
+        REQUIRE(y.data() == view.data());
+        REQUIRE(uv.data() == view.data() + 1920 * 1080);
+        REQUIRE(uv.size() == 1920 * 1080 / 2);
+        // slice of the slice
+        const auto row = uv.slice(1920, 1920);
+        REQUIRE(row.data() == view.data() + 1920 * 1081);
+        REQUIRE(row.get_block() == view.get_block());
+    }
+    SECTION("slice out of range") {
+        REQUIRE_THROWS_AS(view.slice(source.size(), 1), out_of_range);
+        REQUIRE_THROWS_AS(view.slice(1, source.size()), out_of_range);
+        REQUIRE_THROWS_AS(buffer_view_t(view.get_block(), 0, view.get_block()->size + 1), out_of_range);
+        REQUIRE(view.slice(source.size(), 0).empty());
+    }
+    SECTION("mutate without sharing") {
+        const uint8_t* address = view.data();
+        uint8_t* ptr = view.mutable_data();
+        REQUIRE(ptr == address); // no copy
+        ptr[0] = 0xFF;
+        REQUIRE(view.data()[0] == 0xFF);
+    }
+    SECTION("copy on write") {
+        buffer_view_t reader = view;
+        const uint8_t* address = reader.data();
+        uint8_t* ptr = view.mutable_data();
+        REQUIRE(ptr != address); // copied because of the reader
+        REQUIRE(equal(source.begin(), source.end(), ptr));
+        ptr[0] = 0xFF;
+        REQUIRE(reader.data() == address);
+        REQUIRE(reader.data()[0] == 0);
+        REQUIRE_FALSE(reader.is_shared());
+        REQUIRE_FALSE(view.is_shared());
+        // now the writer owns its block. the next write doesn't copy
+        REQUIRE(view.mutable_data() == ptr);
+    }
+    SECTION("copy on write of a slice") {
+        buffer_view_t uv = view.slice(1920 * 1080, 1920 * 1080 / 2);
+        uint8_t* ptr = uv.mutable_data();
+        REQUIRE(ptr != view.data() + 1920 * 1080);
+        REQUIRE(uv.size() == 1920 * 1080 / 2);
+        REQUIRE(equal(source.begin() + 1920 * 1080, source.end(), ptr));
+    }
+}
+
+TEST_CASE("buffer_view_t with frame_pool_t", "[memory]") {
+    frame_pool_t pool{};
+    const vector<uint8_t> source(4096, 7);
+    {
+        buffer_view_t view = make_buffer_view(source.data(), source.size(), &pool);
+        buffer_view_t reader = view;
+        view.mutable_data(&pool);
+        REQUIRE(pool.stats().miss == 2);
+        REQUIRE(pool.stats().outstanding == 2);
+    }
+    REQUIRE(pool.stats().outstanding == 0);
+    REQUIRE(pool.stats().recycled == 2);
+}
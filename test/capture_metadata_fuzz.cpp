@@ -0,0 +1,37 @@
+/**
+ * @file    capture_metadata_fuzz.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   libFuzzer harness of `metadata_view_t`. Configure with `-DBUILD_FUZZING=ON` and Clang
+ * @see     https://llvm.org/docs/LibFuzzer.html
+ */
+#include <capture_metadata.hpp>
+
+#include <cstdlib>
+
+/// @brief Every byte that the decoders read must be in the buffer. AddressSanitizer reports the others
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    metadata_view_t view{data, size};
+    size_t consumed = 0;
+    for (const metadata_item_t& item : view) {
+        consumed += sizeof(metadata_item_header_t) + item.size;
+        preview_aggregation_t preview{};
+        image_aggregation_t image{};
+        histogram_t histogram{};
+        metadata_faces_t faces{};
+        if (decode_metadata(item, preview))
+            continue;
+        if (decode_metadata(item, image))
+            continue;
+        if (decode_metadata(item, histogram))
+            continue;
+        if (decode_metadata(item, faces)) {
+            uint32_t confidence = 0;
+            for (uint32_t i = 0; i < faces.size(); ++i)
+                confidence |= faces[i].confidence;
+            (void)confidence;
+        }
+    }
+    if (consumed > size || view.is_well_formed() != (consumed == size && size > 0))
+        std::abort();
+    return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file    capture_metadata_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <capture_metadata.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace std;
+
+static void append_header(vector<uint8_t>& buffer, uint32_t id, uint32_t size) {
+    const metadata_item_header_t header{id, size};
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&header);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(header));
+}
+
+template <typename T>
+static void append_item(vector<uint8_t>& buffer, metadata_id_t id, const T& payload) {
+    append_header(buffer, static_cast<uint32_t>(id), sizeof(metadata_item_header_t) + sizeof(T));
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&payload);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+static size_t count_items(const metadata_view_t& view) {
+    size_t count = 0;
+    for (auto it = view.begin(); it != view.end(); ++it)
+        ++count;
+    return count;
+}
+
+TEST_CASE("metadata_view_t items", "[metadata]") {
+    preview_aggregation_t preview{};
+    preview.iso_speed = {1, 400};
+    preview.exposure_time = {1, 0, 166666};
+    preview.white_balance_gain_r = {1, 0, 3, 2};
+    image_aggregation_t image{};
+    image.orientation = {1, 6, 0};
+    histogram_t histogram{};
+    histogram.channel_mask = histogram_channel_y | histogram_channel_cr | histogram_channel_cb;
+    histogram.p0[16] = 100;
+
+    vector<uint8_t> buffer{};
+    append_item(buffer, metadata_id_t::preview_aggregation, preview);
+    append_item(buffer, metadata_id_t::image_aggregation, image);
+    append_item(buffer, metadata_id_t::histogram, histogram);
+    append_header(buffer, 0x7FFF0000, 12); // unknown item is skipped by the consumers
+    buffer.insert(buffer.end(), 4, 0);
+
+    metadata_view_t view{buffer.data(), buffer.size()};
+    REQUIRE(view.is_well_formed());
+    REQUIRE(count_items(view) == 4);
+
+    auto it = view.begin();
+    REQUIRE(it->id == metadata_id_t::preview_aggregation);
+    REQUIRE(it->size == sizeof(preview_aggregation_t));
+    preview_aggregation_t decoded_preview{};
+    REQUIRE(decode_metadata(*it, decoded_preview));
+    REQUIRE(decoded_preview.iso_speed.value == 400);
+    REQUIRE(decoded_preview.exposure_time.value == 166666);
+    REQUIRE(to_float(decoded_preview.white_balance_gain_r) == 1.5f);
+    image_aggregation_t decoded_image{};
+    REQUIRE_FALSE(decode_metadata(*it, decoded_image)); // the other id
+
+    ++it;
+    REQUIRE(decode_metadata(*it, decoded_image));
+    REQUIRE(decoded_image.orientation.set);
+    REQUIRE(decoded_image.orientation.value == 6);
+
+    ++it;
+    histogram_t decoded_histogram{};
+    REQUIRE(decode_metadata(*it, decoded_histogram));
+    REQUIRE(decoded_histogram.channel_mask == histogram.channel_mask);
+    REQUIRE(decoded_histogram.p0[16] == 100);
+
+    ++it;
+    REQUIRE(static_cast<uint32_t>(it->id) == 0x7FFF0000);
+    REQUIRE(it->size == 4);
+    ++it;
+    REQUIRE(it == view.end());
+}
+
+TEST_CASE("metadata_view_t faces", "[metadata]") {
+    metadata_face_header_t header{};
+    header.count = 2;
+    header.timestamp = 1234;
+    metadata_face_t faces[2]{};
+    faces[0] = {10, 20, 110, 120, 90, 0, 0, 0, 1, 80};
+    faces[1] = {200, 20, 260, 90, 40, 5, 7, 0, 0, 0};
+
+    vector<uint8_t> buffer{};
+    append_header(buffer, static_cast<uint32_t>(metadata_id_t::face_detection),
+                  sizeof(metadata_item_header_t) + sizeof(header) + sizeof(faces));
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&header);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(header));
+    bytes = reinterpret_cast<const uint8_t*>(faces);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(faces));
+
+    SECTION("decode") {
+        metadata_view_t view{buffer.data(), buffer.size()};
+        REQUIRE(view.is_well_formed());
+        metadata_faces_t decoded{};
+        REQUIRE(decode_metadata(*view.begin(), decoded));
+        REQUIRE(decoded.header.timestamp == 1234);
+        REQUIRE(decoded.size() == 2);
+        REQUIRE(decoded[0].right == 110);
+        REQUIRE(decoded[0].expression == 1);
+        REQUIRE(decoded[1].blink_score_right == 7);
+    }
+    SECTION("count larger than the item") {
+        header.count = 0xFFFFFFFF; // the multiplication must not overflow
+        memcpy(buffer.data() + sizeof(metadata_item_header_t), &header, sizeof(header));
+        metadata_view_t view{buffer.data(), buffer.size()};
+        metadata_faces_t decoded{};
+        REQUIRE_FALSE(decode_metadata(*view.begin(), decoded));
+        REQUIRE(decoded.size() == 0);
+    }
+}
+
+TEST_CASE("metadata_view_t malformed", "[metadata]") {
+    vector<uint8_t> buffer{};
+    append_item(buffer, metadata_id_t::preview_aggregation, preview_aggregation_t{});
+
+    SECTION("empty") {
+        metadata_view_t view{};
+        REQUIRE_FALSE(view.is_well_formed());
+        REQUIRE(view.begin() == view.end());
+        REQUIRE(count_items(metadata_view_t{buffer.data(), 4}) == 0);
+    }
+    SECTION("trailing bytes") {
+        buffer.insert(buffer.end(), 7, 0);
+        metadata_view_t view{buffer.data(), buffer.size()};
+        REQUIRE(count_items(view) == 1);
+        REQUIRE_FALSE(view.is_well_formed());
+    }
+    SECTION("zero size item") {
+        append_header(buffer, static_cast<uint32_t>(metadata_id_t::histogram), 0);
+        metadata_view_t view{buffer.data(), buffer.size()};
+        REQUIRE(count_items(view) == 1);
+        REQUIRE_FALSE(view.is_well_formed());
+    }
+    SECTION("item crosses the end") {
+        append_header(buffer, static_cast<uint32_t>(metadata_id_t::histogram), sizeof(histogram_t));
+        metadata_view_t view{buffer.data(), buffer.size()};
+        REQUIRE(count_items(view) == 1);
+        REQUIRE_FALSE(view.is_well_formed());
+    }
+    SECTION("item smaller than the payload") {
+        vector<uint8_t> small{};
+        append_header(small, static_cast<uint32_t>(metadata_id_t::image_aggregation), 16);
+        small.insert(small.end(), 8, 0);
+        metadata_view_t view{small.data(), small.size()};
+        REQUIRE(view.is_well_formed());
+        image_aggregation_t image{};
+        REQUIRE_FALSE(decode_metadata(*view.begin(), image));
+    }
+}
+
+/// @see test/capture_metadata_fuzz.cpp for the coverage guided one
+TEST_CASE("metadata_view_t random bytes", "[metadata]") {
+    mt19937 gen{17};
+    uniform_int_distribution<int> byte{0, 255};
+    uniform_int_distribution<uint32_t> id{0, 3};
+    for (uint32_t round = 0; round < 2000; ++round) {
+        // plausible headers with the random sizes, so the walk goes deeper than 1 item
+        vector<uint8_t> buffer{};
+        for (uint32_t i = 0; i < 4; ++i) {
+            const uint32_t size = uniform_int_distribution<uint32_t>{0, 4000}(gen);
+            append_header(buffer, 0x80000000 + id(gen), size);
+            for (uint32_t k = 8; k < size && buffer.size() < 16000; ++k)
+                buffer.push_back(static_cast<uint8_t>(byte(gen)));
+        }
+        buffer.resize(buffer.size() - byte(gen) % 8);
+        metadata_view_t view{buffer.data(), buffer.size()};
+        size_t consumed = 0;
+        for (const metadata_item_t& item : view) {
+            REQUIRE(item.data >= buffer.data());
+            REQUIRE(item.data + item.size <= buffer.data() + buffer.size());
+            consumed += sizeof(metadata_item_header_t) + item.size;
+            metadata_faces_t faces{};
+            if (decode_metadata(item, faces) && faces.size() > 0)
+                REQUIRE(faces.faces + faces.size() * sizeof(metadata_face_t) <= item.data + item.size);
+        }
+        REQUIRE(consumed <= buffer.size());
+        REQUIRE(view.is_well_formed() == (consumed == buffer.size() && consumed > 0));
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * @file    color_convert_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <color_convert.hpp>
+#include "frame_helpers.hpp"
+
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+static const uint8_t* get_pixel(const frame_buffer_t& frame, uint32_t x, uint32_t y) noexcept {
+    return frame.plane(0).row(y) + 4 * x;
+}
+
+TEST_CASE("get_simd_level", "[color]") {
+    const simd_level_t level = get_simd_level();
+    CAPTURE(to_string(level));
+    REQUIRE(clamp_simd_level(simd_level_t::scalar) == simd_level_t::scalar);
+    REQUIRE(clamp_simd_level(simd_level_t::avx2) == level);
+}
+
+TEST_CASE("convert_yuv_to_rgb32 scalar", "[color]") {
+    frame_buffer_t src{pixel_format_t::nv12, 4, 2};
+    frame_buffer_t dst{pixel_format_t::rgb32, 4, 2};
+    uint8_t* y = src.plane(0).row(0);
+    uint8_t* uv = src.plane(1).row(0);
+
+    SECTION("limited range black and white") {
+        y[0] = 16, y[1] = 235;
+        uv[0] = uv[1] = 128;
+        REQUIRE(convert_yuv_to_rgb32(src.view(), dst.view(), {}, simd_level_t::scalar));
+        const uint8_t* black = get_pixel(dst, 0, 0);
+        const uint8_t* white = get_pixel(dst, 1, 0);
+        REQUIRE(black[0] == 0);
+        REQUIRE(black[2] == 0);
+        REQUIRE(white[1] == 255);
+        REQUIRE(white[3] == 255); // alpha
+    }
+    SECTION("full range gray") {
+        y[0] = y[1] = 128;
+        uv[0] = uv[1] = 128;
+        REQUIRE(convert_yuv_to_rgb32(src.view(), dst.view(), {yuv_matrix_t::bt709, yuv_range_t::full},
+                                     simd_level_t::scalar));
+        const uint8_t* gray = get_pixel(dst, 0, 0);
+        REQUIRE(gray[0] == 128);
+        REQUIRE(gray[1] == 128);
+        REQUIRE(gray[2] == 128);
+    }
+    SECTION("BT.709 red") {
+        // R'G'B'(255, 0, 0) in BT.709 limited range
+        y[0] = y[1] = 63;
+        uv[0] = 102, uv[1] = 240;
+        REQUIRE(convert_yuv_to_rgb32(src.view(), dst.view(), {yuv_matrix_t::bt709, yuv_range_t::limited},
+                                     simd_level_t::scalar));
+        const uint8_t* red = get_pixel(dst, 0, 0);
+        REQUIRE(red[0] <= 2);
+        REQUIRE(red[1] <= 2);
+        REQUIRE(red[2] >= 253);
+    }
+    SECTION("matrix changes the result") {
+        y[0] = 100;
+        uv[0] = 60, uv[1] = 200;
+        REQUIRE(convert_yuv_to_rgb32(src.view(), dst.view(), {yuv_matrix_t::bt601}, simd_level_t::scalar));
+        const uint32_t bt601 = *reinterpret_cast<const uint32_t*>(get_pixel(dst, 0, 0));
+        REQUIRE(convert_yuv_to_rgb32(src.view(), dst.view(), {yuv_matrix_t::bt2020}, simd_level_t::scalar));
+        const uint32_t bt2020 = *reinterpret_cast<const uint32_t*>(get_pixel(dst, 0, 0));
+        REQUIRE(bt601 != bt2020);
+    }
+    SECTION("invalid arguments") {
+        frame_buffer_t small{pixel_format_t::rgb32, 2, 2};
+        REQUIRE_FALSE(convert_yuv_to_rgb32(src.view(), small.view()));
+        REQUIRE_FALSE(convert_yuv_to_rgb32(dst.view(), dst.view()));
+        REQUIRE_FALSE(convert_yuv_to_rgb32(src.view(), src.view()));
+    }
+}
+
+TEST_CASE("convert_yuv_to_rgb32 SIMD matches scalar", "[color]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420);
+    // not multiple of the vector width, odd sizes and the padded pitch
+    const uint32_t width = GENERATE(2u, 17u, 33u, 640u, 1366u);
+    const uint32_t height = GENERATE(1u, 7u, 48u);
+    const yuv_color_t color = GENERATE(yuv_color_t{yuv_matrix_t::bt601, yuv_range_t::limited},
+                                       yuv_color_t{yuv_matrix_t::bt709, yuv_range_t::full},
+                                       yuv_color_t{yuv_matrix_t::bt2020, yuv_range_t::limited});
+    CAPTURE(static_cast<uint32_t>(format), width, height);
+    CAPTURE(static_cast<uint32_t>(color.matrix), static_cast<uint32_t>(color.range));
+
+    frame_buffer_t src{format, width, height};
+    fill_random(src, width * height);
+    frame_buffer_t expected{pixel_format_t::rgb32, width, height};
+    REQUIRE(convert_yuv_to_rgb32(src.view(), expected.view(), color, simd_level_t::scalar));
+
+    for (simd_level_t level : {simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue; // not supported by this CPU
+        CAPTURE(to_string(level));
+        frame_buffer_t actual{pixel_format_t::rgb32, width, height};
+        REQUIRE(convert_yuv_to_rgb32(src.view(), actual.view(), color, level));
+        REQUIRE(is_same_pixels(expected, actual));
+    }
+}
+
+TEST_CASE("convert_yuv_to_rgb32 benchmark", "[color][!benchmark]") {
+    constexpr uint32_t width = 1920, height = 1080;
+    frame_buffer_t nv12{pixel_format_t::nv12, width, height};
+    frame_buffer_t i420{pixel_format_t::i420, width, height};
+    fill_random(nv12, 1);
+    fill_random(i420, 2);
+    frame_buffer_t rgb32{pixel_format_t::rgb32, width, height};
+    const yuv_color_t color{yuv_matrix_t::bt709, yuv_range_t::limited};
+
+    for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        const string suffix = string{"("} + to_string(level) + ") 1080p";
+        BENCHMARK("NV12→RGB32" + suffix) {
+            return convert_yuv_to_rgb32(nv12.view(), rgb32.view(), color, level);
+        };
+        BENCHMARK("I420→RGB32" + suffix) {
+            return convert_yuv_to_rgb32(i420.view(), rgb32.view(), color, level);
+        };
+        // megapixels per second for the capture boxes' budget
+        constexpr int count = 30;
+        const auto start = chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i)
+            convert_yuv_to_rgb32(nv12.view(), rgb32.view(), color, level);
+        const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        const double megapixels = static_cast<double>(width) * height * count / 1e6;
+        WARN("NV12→RGB32" << suffix << ": " << megapixels / elapsed.count() << " MP/s");
+    }
+}
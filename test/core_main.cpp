@@ -0,0 +1,11 @@
+/**
+ * @file core_main.cpp
+ * @author github.com/luncliff (luncliff@gmail.com)
+ * @brief Test runner for `media_core`. Benchmarks are tagged with `[!benchmark]`
+ *
+ * @code
+ * media_core_test_suite "[!benchmark]"
+ * @endcode
+ */
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
@@ -0,0 +1,29 @@
+/**
+ * @file    coroutine_helpers.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Shared helpers of the coroutine tests
+ */
+#pragma once
+#include <coroutine.hpp>
+
+#include <exception>
+
+/// @brief eagerly started coroutine. the test waits with `std::future`
+struct detached_t final {
+    struct promise_type final {
+        detached_t get_return_object() noexcept {
+            return {};
+        }
+        suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() noexcept {
+        }
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+};
@@ -0,0 +1,194 @@
+/**
+ * @file    deinterlace_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <deinterlace.hpp>
+#include "frame_helpers.hpp"
+
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+/// @brief each row has its own value, so the interpolation can be checked
+static void fill_rows(const frame_buffer_t& frame) {
+    for (uint32_t i = 0; i < frame.view().num_plane; ++i) {
+        const plane_t& plane = frame.plane(i);
+        for (uint32_t y = 0; y < plane.rows; ++y)
+            memset(plane.row(y), static_cast<int>(y * 10), plane.row_bytes);
+    }
+}
+
+TEST_CASE("interlace_mode_t", "[deinterlace]") {
+    REQUIRE(get_deinterlace(interlace_mode_t::unknown) == deinterlace_t::none);
+    REQUIRE(get_deinterlace(interlace_mode_t::progressive) == deinterlace_t::none);
+    REQUIRE(get_deinterlace(interlace_mode_t::single_upper) == deinterlace_t::none);
+    REQUIRE(get_deinterlace(interlace_mode_t::upper_first) == deinterlace_t::blend);
+    REQUIRE(get_deinterlace(interlace_mode_t::lower_first) == deinterlace_t::blend);
+    REQUIRE(get_deinterlace(interlace_mode_t::mixed) == deinterlace_t::blend);
+    REQUIRE(get_first_field(interlace_mode_t::upper_first) == 0);
+    REQUIRE(get_first_field(interlace_mode_t::lower_first) == 1);
+    REQUIRE(is_deinterlaceable(pixel_format_t::i420));
+    REQUIRE_FALSE(is_deinterlaceable(pixel_format_t::rgb32));
+}
+
+TEST_CASE("deinterlace", "[deinterlace]") {
+    const simd_level_t level = simd_level_t::scalar;
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420);
+    CAPTURE(static_cast<uint32_t>(format));
+    frame_buffer_t src{format, 8, 8};
+    fill_rows(src);
+    frame_buffer_t dst{format, 8, 8};
+
+    SECTION("weave keeps both fields") {
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, dst.view(), deinterlace_t::weave, 0, level));
+        REQUIRE(is_same_pixels(src.view(), dst.view()));
+    }
+    SECTION("bob interpolates the other field") {
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, dst.view(), deinterlace_t::bob, 0, level));
+        REQUIRE(dst.plane(0).row(0)[0] == 0);
+        REQUIRE(dst.plane(0).row(1)[0] == 10); // (0 + 20 + 1) / 2
+        REQUIRE(dst.plane(0).row(2)[0] == 20);
+        REQUIRE(dst.plane(0).row(7)[0] == 60); // the edge is repeated
+        REQUIRE(dst.plane(1).row(1)[0] == 10); // chroma has its own field
+        REQUIRE(dst.plane(1).row(3)[0] == 20);
+    }
+    SECTION("bob of the lower field") {
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, dst.view(), deinterlace_t::bob, 1, level));
+        REQUIRE(dst.plane(0).row(0)[0] == 10);
+        REQUIRE(dst.plane(0).row(1)[0] == 10);
+        REQUIRE(dst.plane(0).row(2)[0] == 20);
+    }
+    SECTION("blend weaves the static frame") {
+        frame_buffer_t previous{format, 8, 8};
+        fill_rows(previous);
+        REQUIRE(deinterlace(src.view(), previous.view(), dst.view(), deinterlace_t::blend, 0, level));
+        REQUIRE(is_same_pixels(src.view(), dst.view()));
+    }
+    SECTION("blend bobs the moving frame") {
+        frame_buffer_t previous{format, 8, 8};
+        fill_random(previous, 7);
+        for (uint32_t i = 0; i < previous.view().num_plane; ++i)
+            for (uint32_t y = 1; y < previous.plane(i).rows; y += 2)
+                memset(previous.plane(i).row(y), 255, previous.plane(i).row_bytes);
+        frame_buffer_t expected{format, 8, 8};
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, expected.view(), deinterlace_t::bob, 0, level));
+        REQUIRE(deinterlace(src.view(), previous.view(), dst.view(), deinterlace_t::blend, 0, level));
+        REQUIRE(is_same_pixels(expected.view(), dst.view()));
+    }
+    SECTION("in place") {
+        frame_buffer_t expected{format, 8, 8};
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, expected.view(), deinterlace_t::bob, 0, level));
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, src.view(), deinterlace_t::bob, 0, level));
+        REQUIRE(is_same_pixels(expected.view(), src.view()));
+    }
+    SECTION("mismatch") {
+        frame_buffer_t small{format, 4, 4};
+        frame_buffer_t rgb32{pixel_format_t::rgb32, 8, 8};
+        REQUIRE_FALSE(deinterlace(src.view(), frame_view_t{}, small.view(), deinterlace_t::bob, 0, level));
+        REQUIRE_FALSE(deinterlace(rgb32.view(), frame_view_t{}, rgb32.view(), deinterlace_t::bob, 0, level));
+        REQUIRE_FALSE(deinterlace(src.view(), frame_view_t{}, dst.view(), deinterlace_t::bob, 2, level));
+    }
+}
+
+TEST_CASE("deinterlacer_t", "[deinterlace]") {
+    const simd_level_t level = simd_level_t::scalar;
+    frame_buffer_t src{pixel_format_t::nv12, 16, 8};
+    fill_random(src, 1);
+    frame_buffer_t dst{pixel_format_t::nv12, 16, 8};
+    frame_buffer_t expected{pixel_format_t::nv12, 16, 8};
+
+    SECTION("progressive is copied") {
+        deinterlacer_t deinterlacer{interlace_mode_t::progressive};
+        REQUIRE(deinterlacer.get_method() == deinterlace_t::none);
+        REQUIRE(deinterlacer.process(src.view(), dst.view(), level));
+        REQUIRE(is_same_pixels(src.view(), dst.view()));
+    }
+    SECTION("the first frame is bob, the same frame again is weave") {
+        deinterlacer_t deinterlacer{interlace_mode_t::lower_first};
+        REQUIRE(deinterlacer.get_method() == deinterlace_t::blend);
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, expected.view(), deinterlace_t::bob, 1, level));
+        REQUIRE(deinterlacer.process(src.view(), dst.view(), level));
+        REQUIRE(is_same_pixels(expected.view(), dst.view()));
+        REQUIRE(deinterlacer.process(src.view(), dst.view(), level));
+        REQUIRE(is_same_pixels(src.view(), dst.view()));
+    }
+    SECTION("set_interlace_mode drops the previous frame") {
+        deinterlacer_t deinterlacer{interlace_mode_t::upper_first};
+        REQUIRE(deinterlacer.process(src.view(), dst.view(), level));
+        deinterlacer.set_interlace_mode(interlace_mode_t::upper_first);
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, expected.view(), deinterlace_t::bob, 0, level));
+        REQUIRE(deinterlacer.process(src.view(), dst.view(), level));
+        REQUIRE(is_same_pixels(expected.view(), dst.view()));
+    }
+    SECTION("mixed uses the fields of each sample") {
+        deinterlacer_t deinterlacer{interlace_mode_t::mixed};
+        REQUIRE(deinterlacer.get_method() == deinterlace_t::blend);
+        REQUIRE(deinterlace(src.view(), frame_view_t{}, expected.view(), deinterlace_t::bob, 1, level));
+        REQUIRE(deinterlacer.process(src.view(), dst.view(), sample_fields_t{true, true}, level));
+        REQUIRE(is_same_pixels(expected.view(), dst.view()));
+
+        frame_buffer_t progressive{pixel_format_t::nv12, 16, 8};
+        fill_random(progressive, 2);
+        REQUIRE(deinterlacer.process(progressive.view(), dst.view(), sample_fields_t{false, false}, level));
+        REQUIRE(is_same_pixels(progressive.view(), dst.view()));
+        // the progressive sample is the previous frame. the same frame is weave
+        REQUIRE(deinterlacer.process(progressive.view(), dst.view(), sample_fields_t{true, false}, level));
+        REQUIRE(is_same_pixels(progressive.view(), dst.view()));
+    }
+    SECTION("the fields are ignored if the mode is not mixed") {
+        deinterlacer_t deinterlacer{interlace_mode_t::progressive};
+        REQUIRE(deinterlacer.process(src.view(), dst.view(), sample_fields_t{true, true}, level));
+        REQUIRE(is_same_pixels(src.view(), dst.view()));
+    }
+    SECTION("blend can't be in place") {
+        deinterlacer_t deinterlacer{interlace_mode_t::upper_first};
+        REQUIRE_FALSE(deinterlacer.process(src.view(), src.view(), level));
+    }
+}
+
+TEST_CASE("deinterlace SIMD matches scalar", "[deinterlace]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420);
+    const uint32_t width = GENERATE(2u, 33u, 95u, 640u);
+    const uint32_t height = GENERATE(2u, 9u);
+    CAPTURE(static_cast<uint32_t>(format), width, height);
+    frame_buffer_t src{format, width, height};
+    fill_random(src, width * height);
+    frame_buffer_t previous{format, width, height};
+    fill_random(previous, width + height);
+
+    for (deinterlace_t method : {deinterlace_t::bob, deinterlace_t::blend}) {
+        CAPTURE(static_cast<uint32_t>(method));
+        frame_buffer_t expected{format, width, height};
+        REQUIRE(deinterlace(src.view(), previous.view(), expected.view(), method, 1, simd_level_t::scalar));
+        for (simd_level_t level : {simd_level_t::sse41, simd_level_t::avx2}) {
+            if (clamp_simd_level(level) != level)
+                continue;
+            CAPTURE(to_string(level));
+            frame_buffer_t actual{format, width, height, 1024};
+            REQUIRE(deinterlace(src.view(), previous.view(), actual.view(), method, 1, level));
+            REQUIRE(is_same_pixels(expected.view(), actual.view()));
+        }
+    }
+}
+
+TEST_CASE("deinterlace benchmark", "[deinterlace][!benchmark]") {
+    constexpr uint32_t width = 1920, height = 1080;
+    frame_buffer_t src{pixel_format_t::nv12, width, height};
+    fill_random(src, 3);
+    frame_buffer_t previous{pixel_format_t::nv12, width, height};
+    fill_random(previous, 4);
+    frame_buffer_t dst{pixel_format_t::nv12, width, height}; // reused
+    for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        const string suffix = "(" + string{to_string(level)} + ") 1080i NV12";
+        BENCHMARK("bob" + suffix) {
+            return deinterlace(src.view(), previous.view(), dst.view(), deinterlace_t::bob, 0, level);
+        };
+        BENCHMARK("blend" + suffix) {
+            return deinterlace(src.view(), previous.view(), dst.view(), deinterlace_t::blend, 0, level);
+        };
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * @file    executor_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <executor.hpp>
+#include <frame_buffer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono_literals;
+
+TEST_CASE("executor_t", "[thread]") {
+    executor_t executor{4};
+    REQUIRE(executor.size() == 4);
+    REQUIRE(executor.current_worker() == executor_t::any_worker);
+
+    SECTION("submit") {
+        atomic_size_t count{0};
+        for (auto i = 0; i < 1000; ++i)
+            executor.submit([&count]() { ++count; });
+        while (count < 1000)
+            this_thread::yield();
+        REQUIRE(executor.stats().submitted == 1000);
+    }
+    SECTION("affinity hint") {
+        atomic_size_t worker{executor_t::any_worker};
+        atomic_bool done{false};
+        executor.submit(
+            [&]() {
+                worker = executor.current_worker();
+                done = true;
+            },
+            2);
+        while (done == false)
+            this_thread::yield();
+        // it's a hint. another worker may steal it
+        REQUIRE(worker < executor.size());
+    }
+    SECTION("parallel_for") {
+        vector<int> values(1000, 0);
+        executor.parallel_for(values.size(), [&values](size_t i) { values[i] = static_cast<int>(i); });
+        for (size_t i = 0; i < values.size(); ++i)
+            REQUIRE(values[i] == static_cast<int>(i));
+    }
+    SECTION("nested parallel_for") {
+        atomic_size_t count{0};
+        executor.parallel_for(8, [&](size_t) { //
+            executor.parallel_for(8, [&count](size_t) { ++count; });
+        });
+        REQUIRE(count == 64);
+    }
+    SECTION("parallel_for exception") {
+        atomic_size_t count{0};
+        REQUIRE_THROWS_AS(executor.parallel_for(16,
+                                                [&count](size_t i) {
+                                                    ++count;
+                                                    if (i == 7)
+                                                        throw runtime_error{"job failed"};
+                                                }),
+                          runtime_error);
+        REQUIRE(count == 16); // the other jobs are not cancelled
+    }
+    SECTION("steal") {
+        // all jobs are hinted to the blocked worker, which waits until the others finish them.
+        // the blocking job itself can be stolen, so it reports where it runs
+        atomic_size_t blocked{executor_t::any_worker};
+        atomic_size_t count{0};
+        atomic_bool exited{false};
+        executor.submit(
+            [&]() {
+                blocked = executor.current_worker();
+                const auto until = chrono::steady_clock::now() + 1s;
+                while (count < 32 && chrono::steady_clock::now() < until)
+                    this_thread::yield();
+                exited = true; // the last access to the locals of the section
+            },
+            0);
+        while (blocked == executor_t::any_worker)
+            this_thread::yield();
+        for (auto i = 0; i < 32; ++i)
+            executor.submit([&count]() { ++count; }, blocked);
+        while (count < 32)
+            this_thread::yield();
+        // the executor outlives the section. the blocking job must not poll the locals after the return
+        while (exited == false)
+            this_thread::yield();
+        REQUIRE(executor.stats().stolen >= 32);
+    }
+}
+
+TEST_CASE("executor_t destructor waits the jobs", "[thread]") {
+    atomic_size_t count{0};
+    {
+        executor_t executor{2};
+        for (auto i = 0; i < 100; ++i)
+            executor.submit([&count]() { ++count; });
+    }
+    REQUIRE(count == 100);
+}
+
+/// @brief RGB32 → luma for the rows [begin, end). stands for the frame conversion kernels
+static void convert_rows(const frame_buffer_t& src, frame_buffer_t& dst, uint32_t begin, uint32_t end) noexcept {
+    for (uint32_t y = begin; y < end; ++y) {
+        const uint8_t* bgrx = src.plane(0).row(y);
+        uint8_t* luma = dst.plane(0).row(y);
+        for (uint32_t x = 0; x < src.width(); ++x, bgrx += 4)
+            luma[x] = static_cast<uint8_t>((29 * bgrx[0] + 150 * bgrx[1] + 77 * bgrx[2]) >> 8);
+    }
+}
+
+TEST_CASE("executor_t benchmark", "[thread][!benchmark]") {
+    const frame_buffer_t src{pixel_format_t::rgb32, 1920, 1080};
+    frame_buffer_t dst{pixel_format_t::nv12, 1920, 1080};
+    const uint32_t num_slice = 32;
+    BENCHMARK("serial RGB32→Y(1080p)") {
+        convert_rows(src, dst, 0, 1080);
+        return dst.data();
+    };
+    const size_t num_cpu = max(1u, thread::hardware_concurrency());
+    for (size_t count = 1; count <= num_cpu; count *= 2) {
+        executor_t executor{count, true};
+        BENCHMARK("executor_t(" + to_string(count) + ") RGB32→Y(1080p)") {
+            executor.parallel_for(num_slice, [&](size_t i) {
+                const uint32_t begin = static_cast<uint32_t>(1080 * i / num_slice);
+                const uint32_t end = static_cast<uint32_t>(1080 * (i + 1) / num_slice);
+                convert_rows(src, dst, begin, end);
+            });
+            return dst.data();
+        };
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * @file    frame_buffer_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <frame_buffer.hpp>
+
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+static bool is_aligned(const void* ptr, size_t alignment) noexcept {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+static void require_aligned_rows(const frame_buffer_t& frame) {
+    const auto& view = frame.view();
+    for (auto i = 0u; i < view.num_plane; ++i) {
+        const plane_t& plane = view.planes[i];
+        CAPTURE(i);
+        REQUIRE(plane.pitch >= plane.row_bytes);
+        REQUIRE(plane.pitch % frame_buffer_t::alignment == 0);
+        REQUIRE(is_aligned(plane.data, frame_buffer_t::alignment));
+        // the padding of the last row must be in the buffer
+        REQUIRE(plane.row(plane.rows - 1) + plane.pitch <= frame.data() + frame.size());
+    }
+}
+
+TEST_CASE("frame_buffer_t", "[memory]") {
+    SECTION("nv12") {
+        frame_buffer_t frame{pixel_format_t::nv12, 1920, 1080};
+        REQUIRE(frame.view().num_plane == 2);
+        REQUIRE(frame.pitch() == 1920);
+        REQUIRE(frame.is_contiguous());
+        REQUIRE(frame.plane(1).data == frame.data() + 1920 * 1080);
+        REQUIRE(frame.plane(1).rows == 540);
+        REQUIRE(frame.size() == 1920 * 1080 * 3 / 2);
+        require_aligned_rows(frame);
+    }
+    SECTION("nv12 with padding") {
+        frame_buffer_t frame{pixel_format_t::nv12, 1366, 767};
+        REQUIRE(frame.pitch() == 1408);
+        REQUIRE_FALSE(frame.is_contiguous());
+        REQUIRE(frame.plane(1).row_bytes == 1366);
+        REQUIRE(frame.plane(1).rows == 384);
+        require_aligned_rows(frame);
+    }
+    SECTION("i420") {
+        frame_buffer_t frame{pixel_format_t::i420, 1280, 720};
+        REQUIRE(frame.view().num_plane == 3);
+        REQUIRE(frame.pitch() == 1280);
+        REQUIRE(frame.plane(1).pitch == 640);
+        REQUIRE(frame.plane(2).data == frame.plane(1).data + 640 * 360);
+        require_aligned_rows(frame);
+    }
+    SECTION("i420 chroma alignment") {
+        frame_buffer_t frame{pixel_format_t::i420, 640, 480};
+        REQUIRE(frame.pitch() == 640);
+        require_aligned_rows(frame);
+        frame_buffer_t odd{pixel_format_t::i420, 700, 480};
+        REQUIRE(odd.pitch() == 768);
+        require_aligned_rows(odd);
+    }
+    SECTION("rgb32") {
+        frame_buffer_t frame{pixel_format_t::rgb32, 1000, 10};
+        REQUIRE(frame.view().num_plane == 1);
+        REQUIRE(frame.pitch() == 4032);
+        require_aligned_rows(frame);
+    }
+    SECTION("rgb565") {
+        frame_buffer_t frame{pixel_format_t::rgb565, 1000, 10};
+        REQUIRE(frame.pitch() == 2048);
+        require_aligned_rows(frame);
+    }
+    SECTION("configurable pitch") {
+        frame_buffer_t frame{pixel_format_t::nv12, 1920, 1080, 2048};
+        REQUIRE(frame.pitch() == 2048);
+        REQUIRE(frame.plane(1).pitch == 2048);
+        frame_buffer_t rounded{pixel_format_t::rgb32, 64, 64, 300};
+        REQUIRE(rounded.pitch() == 320);
+    }
+    SECTION("invalid argument") {
+        REQUIRE_THROWS_AS(frame_buffer_t(pixel_format_t::unknown, 64, 64), invalid_argument);
+        REQUIRE_THROWS_AS(frame_buffer_t(pixel_format_t::nv12, 0, 64), invalid_argument);
+    }
+    SECTION("move") {
+        frame_buffer_t frame{pixel_format_t::nv12, 64, 64};
+        uint8_t* data = frame.data();
+        frame_buffer_t other = move(frame);
+        REQUIRE(other.data() == data);
+    }
+}
+
+TEST_CASE("frame_buffer_t with frame_pool_t", "[memory]") {
+    frame_pool_t pool{};
+    uint8_t* data = nullptr;
+    {
+        frame_buffer_t frame{pool, pixel_format_t::nv12, 1920, 1080};
+        data = frame.data();
+        require_aligned_rows(frame);
+    }
+    frame_buffer_t frame{pool, pixel_format_t::nv12, 1920, 1080};
+    REQUIRE(frame.data() == data);
+    REQUIRE(pool.stats().hit == 1);
+}
+
+TEST_CASE("make_frame_view", "[memory]") {
+    vector<uint8_t> memory(get_frame_size(pixel_format_t::i420, 4, 8));
+    const auto view = make_frame_view(pixel_format_t::i420, 4, 4, memory.data(), 8);
+    REQUIRE(view.num_plane == 3);
+    REQUIRE(view.planes[1].data == memory.data() + 32);
+    REQUIRE(view.planes[2].data == memory.data() + 40);
+    REQUIRE(view.planes[2].pitch == 4);
+
+    // pitch must be greater than the row
+    REQUIRE(make_frame_view(pixel_format_t::rgb32, 4, 4, memory.data(), 8).num_plane == 0);
+}
+
+TEST_CASE("copy_to_contiguous/copy_from_contiguous", "[memory]") {
+    frame_buffer_t frame{pixel_format_t::nv12, 70, 6}; // pitch 128
+    const auto& view = frame.view();
+    const auto length = get_contiguous_size(view);
+    REQUIRE(length == 70 * 6 + 70 * 3);
+
+    vector<uint8_t> input(length);
+    iota(input.begin(), input.end(), uint8_t{0});
+    REQUIRE(copy_from_contiguous(view, input.data(), input.size()));
+    REQUIRE(frame.plane(0).row(1)[0] == 70);
+    REQUIRE(frame.plane(1).row(0)[0] == static_cast<uint8_t>(70 * 6));
+
+    vector<uint8_t> output(length);
+    REQUIRE_FALSE(copy_to_contiguous(view, output.data(), length - 1));
+    REQUIRE(copy_to_contiguous(view, output.data(), length));
+    REQUIRE(output == input);
+}
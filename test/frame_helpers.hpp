@@ -0,0 +1,52 @@
+/**
+ * @file    frame_helpers.hpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ * @brief   Shared helpers of the frame kernel tests
+ */
+#pragma once
+#include <frame_buffer.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+/**
+ * @brief Fill the pixels with the noise of the `seed`. The row padding is not touched
+ * @note  16 bit formats get 16 bit samples. P010 keeps the low 6 bits 0
+ */
+inline void fill_random(const frame_buffer_t& frame, uint32_t seed) {
+    std::mt19937 gen{seed};
+    const pixel_format_t format = frame.format();
+    const bool wide =
+        format == pixel_format_t::p010 || format == pixel_format_t::p016 || format == pixel_format_t::rgba16;
+    std::uniform_int_distribution<int> dist{0, wide ? 0xFFFF : 0xFF};
+    const uint16_t mask = format == pixel_format_t::p010 ? 0xFFC0 : 0xFFFF;
+    for (uint32_t i = 0; i < frame.view().num_plane; ++i) {
+        const plane_t& plane = frame.plane(i);
+        for (uint32_t y = 0; y < plane.rows; ++y) {
+            if (wide) {
+                auto* row = reinterpret_cast<uint16_t*>(plane.row(y));
+                for (uint32_t x = 0; x < plane.row_bytes / 2; ++x)
+                    row[x] = static_cast<uint16_t>(dist(gen) & mask);
+                continue;
+            }
+            for (uint32_t x = 0; x < plane.row_bytes; ++x)
+                plane.row(y)[x] = static_cast<uint8_t>(dist(gen));
+        }
+    }
+}
+
+/// @note compares the pixels only. the row padding is ignored
+inline bool is_same_pixels(const frame_view_t& lhs, const frame_view_t& rhs) noexcept {
+    if (lhs.num_plane != rhs.num_plane)
+        return false;
+    for (uint32_t i = 0; i < lhs.num_plane; ++i)
+        for (uint32_t y = 0; y < lhs.planes[i].rows; ++y)
+            if (std::memcmp(lhs.planes[i].row(y), rhs.planes[i].row(y), lhs.planes[i].row_bytes) != 0)
+                return false;
+    return true;
+}
+
+inline bool is_same_pixels(const frame_buffer_t& lhs, const frame_buffer_t& rhs) noexcept {
+    return is_same_pixels(lhs.view(), rhs.view());
+}
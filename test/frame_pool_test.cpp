@@ -0,0 +1,156 @@
+/**
+ * @file    frame_pool_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <frame_pool.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("aligned_allocate", "[memory]") {
+    for (size_t alignment : {16u, 32u, 64u, 4096u}) {
+        void* ptr = aligned_allocate(1920 * 1080, alignment);
+        REQUIRE(ptr);
+        REQUIRE(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+        aligned_deallocate(ptr);
+    }
+    REQUIRE(aligned_allocate(128, 0) == nullptr);
+    REQUIRE(aligned_allocate(128, 48) == nullptr);
+}
+
+TEST_CASE("frame_pool_t", "[memory]") {
+    frame_pool_t pool{};
+    const size_t bufsz = 1920 * 1080 * 3 / 2; // NV12
+
+    SECTION("recycle") {
+        void* address = nullptr;
+        {
+            auto block = pool.acquire(bufsz);
+            REQUIRE(block);
+            REQUIRE(block->size >= bufsz);
+            REQUIRE(reinterpret_cast<uintptr_t>(block->data) % 64 == 0);
+            address = block->data;
+        }
+        auto block = pool.acquire(bufsz);
+        REQUIRE(block->data == address);
+
+        const auto stats = pool.stats();
+        REQUIRE(stats.miss == 1);
+        REQUIRE(stats.hit == 1);
+        REQUIRE(stats.recycled == 1);
+        REQUIRE(stats.outstanding == 1);
+        REQUIRE(stats.cached == 0);
+    }
+    SECTION("keyed with size and alignment") {
+        pool.acquire(bufsz, 64);
+        pool.acquire(bufsz, 32); // different alignment
+        pool.acquire(bufsz / 2); // different size
+        auto stats = pool.stats();
+        REQUIRE(stats.miss == 3);
+        REQUIRE(stats.cached == 3);
+
+        pool.acquire(bufsz / 2);
+        stats = pool.stats();
+        REQUIRE(stats.hit == 1);
+    }
+    SECTION("high water") {
+        vector<shared_ptr<frame_block_t>> blocks{};
+        for (auto i = 0; i < 5; ++i)
+            blocks.emplace_back(pool.acquire(bufsz));
+        blocks.clear();
+        for (auto i = 0; i < 3; ++i)
+            blocks.emplace_back(pool.acquire(bufsz));
+        const auto stats = pool.stats();
+        REQUIRE(stats.high_water == 5);
+        REQUIRE(stats.outstanding == 3);
+        REQUIRE(stats.cached == 2);
+        REQUIRE(stats.hit == 3);
+    }
+    SECTION("trim") {
+        pool.acquire(bufsz);
+        REQUIRE(pool.stats().cached == 1);
+        pool.trim();
+        REQUIRE(pool.stats().cached == 0);
+        REQUIRE(pool.stats().cached_bytes == 0);
+    }
+    SECTION("invalid alignment") {
+        REQUIRE(pool.acquire(bufsz, 0) == nullptr);
+        REQUIRE(pool.acquire(bufsz, 24) == nullptr);
+        REQUIRE(pool.stats().outstanding == 0);
+    }
+}
+
+TEST_CASE("frame_pool_t bounded", "[memory]") {
+    const size_t bufsz = 4096;
+    frame_pool_t pool{bufsz * 2};
+    {
+        vector<shared_ptr<frame_block_t>> blocks{};
+        for (auto i = 0; i < 4; ++i)
+            blocks.emplace_back(pool.acquire(bufsz));
+    }
+    const auto stats = pool.stats();
+    REQUIRE(stats.cached == 2);
+    REQUIRE(stats.cached_bytes == bufsz * 2);
+    REQUIRE(stats.recycled == 2);
+    REQUIRE(stats.discarded == 2);
+}
+
+TEST_CASE("frame_pool_t outlived by blocks", "[memory]") {
+    shared_ptr<frame_block_t> block{};
+    {
+        frame_pool_t pool{};
+        block = pool.acquire(1024);
+    }
+    REQUIRE(block);
+    memset(block->data, 0xFF, block->size);
+    block = nullptr; // the shared state is released here
+}
+
+TEST_CASE("frame_pool_t multi-thread", "[memory][thread]") {
+    frame_pool_t pool{};
+    const auto num_worker = 4u;
+    const auto num_repeat = 1000u;
+    atomic_uint failed = 0; // Catch2 assertions are not thread-safe
+    vector<thread> workers{};
+    for (auto w = 0u; w < num_worker; ++w)
+        workers.emplace_back([&pool, &failed, w]() {
+            for (auto i = 0u; i < num_repeat; ++i) {
+                auto block = pool.acquire(4096 * (1 + i % 3));
+                if (block == nullptr) {
+                    failed += 1;
+                    continue;
+                }
+                memset(block->data, static_cast<int>(w), block->size);
+            }
+        });
+    for (auto& worker : workers)
+        worker.join();
+    REQUIRE(failed == 0);
+
+    const auto stats = pool.stats();
+    REQUIRE(stats.hit + stats.miss == num_worker * num_repeat);
+    REQUIRE(stats.outstanding == 0);
+    REQUIRE(stats.high_water <= num_worker);
+    REQUIRE(stats.cached == stats.miss - stats.discarded);
+}
+
+TEST_CASE("frame_pool_t benchmark", "[memory][!benchmark]") {
+    const size_t bufsz = 1920 * 1080 * 3 / 2; // NV12 1080p
+    frame_pool_t pool{};
+    BENCHMARK("aligned_allocate(1080p NV12)") {
+        void* ptr = aligned_allocate(bufsz, 64);
+        static_cast<char*>(ptr)[0] = 1; // touch
+        aligned_deallocate(ptr);
+        return ptr;
+    };
+    BENCHMARK("frame_pool_t::acquire(1080p NV12)") {
+        auto block = pool.acquire(bufsz);
+        static_cast<char*>(block->data)[0] = 1;
+        return block;
+    };
+}
@@ -0,0 +1,253 @@
+/**
+ * @file    graph_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <graph.hpp>
+#include <scale_graph.hpp>
+#include "frame_helpers.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/// @brief stands for the frame. records the nodes which touched it
+struct traced_frame_t final {
+    pixel_format_t format = pixel_format_t::unknown;
+    string trace{};
+};
+
+static auto make_converter(pixel_format_t output) {
+    return [output]() -> graph_builder_t<traced_frame_t>::process_t {
+        return [output](traced_frame_t&& frame, const auto& emit) {
+            frame.format = output;
+            frame.trace += "c";
+            emit(move(frame));
+        };
+    };
+}
+
+static auto make_converter_for_fusion() {
+    return [](pixel_format_t) -> graph_builder_t<traced_frame_t>::process_t {
+        return [](traced_frame_t&& frame, const auto& emit) { emit(move(frame)); };
+    };
+}
+
+TEST_CASE("graph_builder_t", "[pipeline]") {
+    graph_builder_t<traced_frame_t> graph{};
+    pixel_format_t source_format = pixel_format_t::unknown;
+    auto source = [&source_format](pixel_format_t format) -> graph_builder_t<traced_frame_t>::source_t {
+        source_format = format;
+        return [format, count = 0](traced_frame_t& frame) mutable {
+            frame = traced_frame_t{format, "s"};
+            return count++ < 10;
+        };
+    };
+    vector<traced_frame_t> outputs{};
+    auto sink = [&outputs](pixel_format_t) -> graph_builder_t<traced_frame_t>::sink_t {
+        return [&outputs](traced_frame_t&& frame) { outputs.emplace_back(move(frame)); };
+    };
+    graph.add_converter("nv12→rgb32", pixel_format_t::nv12, pixel_format_t::rgb32,
+                        make_converter(pixel_format_t::rgb32));
+    graph.add_converter("nv12→i420", pixel_format_t::nv12, pixel_format_t::i420, make_converter(pixel_format_t::i420));
+    graph.add_converter("i420→rgb32", pixel_format_t::i420, pixel_format_t::rgb32,
+                        make_converter(pixel_format_t::rgb32));
+    graph.add_converter("rgb32→rgb565", pixel_format_t::rgb32, pixel_format_t::rgb565,
+                        make_converter(pixel_format_t::rgb565));
+
+    SECTION("no conversion if the sink accepts the source") {
+        graph.set_source("camera", {pixel_format_t::nv12, pixel_format_t::rgb32}, source);
+        graph.set_sink("display", {pixel_format_t::rgb32}, sink);
+        const graph_plan_t plan = graph.resolve();
+        REQUIRE(plan.conversions == 0);
+        REQUIRE(plan.steps.size() == 2);
+        REQUIRE(plan.steps[0].output == pixel_format_t::rgb32);
+        REQUIRE(plan.steps[1].input == pixel_format_t::rgb32);
+    }
+    SECTION("fewest conversions") {
+        graph.set_source("decoder", {pixel_format_t::nv12}, source);
+        graph.set_sink("display", {pixel_format_t::rgb565}, sink);
+        const graph_plan_t plan = graph.resolve();
+        // nv12→rgb32→rgb565 instead of nv12→i420→rgb32→rgb565
+        REQUIRE(plan.conversions == 2);
+        REQUIRE(plan.steps.size() == 4);
+        REQUIRE(plan.steps[1].name == "nv12→rgb32");
+        REQUIRE(plan.steps[2].name == "rgb32→rgb565");
+    }
+    SECTION("fewer copies for the same conversions") {
+        graph.add_converter("nv12→rgb32(in-place)", pixel_format_t::nv12, pixel_format_t::rgb32,
+                            make_converter(pixel_format_t::rgb32), 0);
+        graph.set_source("decoder", {pixel_format_t::nv12}, source);
+        graph.set_sink("display", {pixel_format_t::rgb32}, sink);
+        const graph_plan_t plan = graph.resolve();
+        REQUIRE(plan.conversions == 1);
+        REQUIRE(plan.copies == 0);
+        REQUIRE(plan.steps[1].name == "nv12→rgb32(in-place)");
+    }
+    SECTION("stages keep the order and the format") {
+        auto stage = [](const char* mark) {
+            return [mark](pixel_format_t) -> graph_builder_t<traced_frame_t>::process_t {
+                return [mark](traced_frame_t&& frame, const auto& emit) {
+                    frame.trace += mark;
+                    emit(move(frame));
+                };
+            };
+        };
+        // the scaler supports I420 only. the crop works with RGB32 only
+        graph.add_stage("scaler", {pixel_format_t::i420}, stage("x"));
+        graph.add_stage("crop", {pixel_format_t::rgb32}, stage("y"));
+        graph.set_source("decoder", {pixel_format_t::nv12}, source);
+        graph.set_sink("display", {pixel_format_t::rgb32}, sink);
+
+        pipeline_t<traced_frame_t> pipeline{2};
+        const graph_plan_t plan = graph.build(pipeline);
+        REQUIRE(source_format == pixel_format_t::nv12);
+        REQUIRE(plan.conversions == 2);
+        REQUIRE(plan.steps.size() == 6); // decoder → nv12→i420 → scaler → i420→rgb32 → crop → display
+        REQUIRE(plan.steps[2].name == "scaler");
+        REQUIRE(plan.steps[4].name == "crop");
+
+        pipeline.start();
+        pipeline.wait();
+        REQUIRE(outputs.size() == 10);
+        for (const traced_frame_t& frame : outputs) {
+            REQUIRE(frame.format == pixel_format_t::rgb32);
+            REQUIRE(frame.trace == "scxcy");
+        }
+    }
+    SECTION("fusion of the adjacent steps") {
+        auto stage = [](const char* mark) {
+            return [mark](pixel_format_t) -> graph_builder_t<traced_frame_t>::process_t {
+                return [mark](traced_frame_t&& frame, const auto& emit) {
+                    frame.trace += mark;
+                    emit(move(frame));
+                };
+            };
+        };
+        graph.add_stage("crop", {pixel_format_t::nv12}, stage("x"));
+        graph.add_stage("resize", {pixel_format_t::nv12}, stage("y"));
+        pixel_format_t fused_input = pixel_format_t::unknown;
+        graph.add_fusion("crop+resize+nv12→rgb32", {"crop", "resize", "nv12→rgb32"},
+                         [&fused_input](pixel_format_t format) -> graph_builder_t<traced_frame_t>::process_t {
+                             fused_input = format;
+                             return [](traced_frame_t&& frame, const auto& emit) {
+                                 frame.format = pixel_format_t::rgb32;
+                                 frame.trace += "f";
+                                 emit(move(frame));
+                             };
+                         });
+        graph.add_fusion("resize+rgb32→rgb565", {"resize", "rgb32→rgb565"}, stage("z"));
+        graph.set_source("decoder", {pixel_format_t::nv12}, source);
+        graph.set_sink("display", {pixel_format_t::rgb32}, sink);
+
+        pipeline_t<traced_frame_t> pipeline{2};
+        const graph_plan_t plan = graph.build(pipeline);
+        REQUIRE(plan.fusions == 1);
+        REQUIRE(plan.conversions == 1); // of the negotiated path
+        REQUIRE(plan.steps.size() == 3); // decoder → crop+resize+nv12→rgb32 → display
+        REQUIRE(plan.steps[1].name == "crop+resize+nv12→rgb32");
+        REQUIRE(plan.steps[1].input == pixel_format_t::nv12);
+        REQUIRE(plan.steps[1].output == pixel_format_t::rgb32);
+        REQUIRE(fused_input == pixel_format_t::nv12);
+
+        pipeline.start();
+        pipeline.wait();
+        REQUIRE(outputs.size() == 10);
+        for (const traced_frame_t& frame : outputs)
+            REQUIRE(frame.trace == "sf");
+    }
+    SECTION("fusion requires the adjacent steps") {
+        graph.add_fusion("nv12→rgb32+rgb32→rgb565", {"nv12→rgb32", "rgb32→rgb565"}, make_converter_for_fusion());
+        graph.set_source("decoder", {pixel_format_t::nv12}, source);
+        graph.set_sink("display", {pixel_format_t::rgb32}, sink);
+        const graph_plan_t plan = graph.resolve();
+        REQUIRE(plan.fusions == 0);
+        REQUIRE(plan.steps[1].name == "nv12→rgb32");
+        REQUIRE_THROWS_AS(graph.add_fusion("single", {"nv12→rgb32"}, make_converter_for_fusion()), invalid_argument);
+    }
+    SECTION("source preference") {
+        graph.set_source("camera", {pixel_format_t::i420, pixel_format_t::nv12}, source);
+        graph.set_sink("display", {pixel_format_t::rgb32}, sink);
+        const graph_plan_t plan = graph.resolve();
+        REQUIRE(plan.conversions == 1);
+        REQUIRE(plan.steps[0].output == pixel_format_t::i420);
+    }
+    SECTION("no path") {
+        graph.set_source("camera", {pixel_format_t::rgb565}, source);
+        graph.set_sink("display", {pixel_format_t::nv12}, sink);
+        REQUIRE_THROWS_AS(graph.resolve(), runtime_error);
+    }
+    SECTION("source and sink are required") {
+        graph.set_sink("display", {pixel_format_t::nv12}, sink);
+        REQUIRE_THROWS_AS(graph.resolve(), logic_error);
+    }
+}
+
+TEST_CASE("add_scale_nodes", "[pipeline]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420);
+    CAPTURE(static_cast<uint32_t>(format));
+    frame_pool_t pool{};
+    scale_graph_options_t options{};
+    options.crop = {8, 4, 40, 32};
+    options.width = 24;
+    options.height = 18;
+    options.filter = scale_filter_t::bicubic;
+    options.color = {yuv_matrix_t::bt709, yuv_range_t::limited};
+
+    graph_builder_t<frame_buffer_t> graph{};
+    graph.set_source("decoder", {format}, [&pool](pixel_format_t format) -> graph_builder_t<frame_buffer_t>::source_t {
+        return [&pool, format, count = 0u](frame_buffer_t& frame) mutable {
+            frame = frame_buffer_t{pool, format, 64, 48};
+            fill_random(frame, count);
+            return count++ < 4;
+        };
+    });
+    add_scale_nodes(graph, options, pool);
+    vector<frame_buffer_t> outputs{};
+    auto sink = [&outputs](pixel_format_t) -> graph_builder_t<frame_buffer_t>::sink_t {
+        return [&outputs](frame_buffer_t&& frame) { outputs.emplace_back(move(frame)); };
+    };
+
+    SECTION("fused") {
+        graph.set_sink("display", {pixel_format_t::rgb32}, sink);
+        pipeline_t<frame_buffer_t> pipeline{2};
+        const graph_plan_t plan = graph.build(pipeline);
+        REQUIRE(plan.fusions == 1);
+        REQUIRE(plan.steps.size() == 3);
+        REQUIRE(plan.steps[1].name.find("crop+resize+") == 0);
+        pipeline.start();
+        pipeline.wait();
+        REQUIRE(outputs.size() == 4);
+        // same with the chain of the copy, `scale` and `convert_yuv_to_rgb32`
+        for (uint32_t i = 0; i < outputs.size(); ++i) {
+            frame_buffer_t src{format, 64, 48};
+            fill_random(src, i);
+            frame_buffer_t cropped{format, 40, 32};
+            scaler_t crop{scale_filter_t::nearest};
+            crop.set_source_rectangle(options.crop);
+            REQUIRE(crop.scale(src.view(), cropped.view()));
+            frame_buffer_t scaled{format, 24, 18};
+            REQUIRE(scaler_t{scale_filter_t::bicubic}.scale(cropped.view(), scaled.view()));
+            frame_buffer_t expected{pixel_format_t::rgb32, 24, 18};
+            REQUIRE(convert_yuv_to_rgb32(scaled.view(), expected.view(), options.color));
+            REQUIRE(is_same_pixels(expected, outputs[i]));
+        }
+    }
+    SECTION("no fusion without the conversion") {
+        graph.set_sink("encoder", {format}, sink);
+        pipeline_t<frame_buffer_t> pipeline{2};
+        const graph_plan_t plan = graph.build(pipeline);
+        REQUIRE(plan.fusions == 0);
+        REQUIRE(plan.steps.size() == 4); // decoder → crop → resize → encoder
+        pipeline.start();
+        pipeline.wait();
+        REQUIRE(outputs.size() == 4);
+        for (const frame_buffer_t& frame : outputs) {
+            REQUIRE(frame.format() == format);
+            REQUIRE(frame.width() == 24);
+            REQUIRE(frame.height() == 18);
+        }
+    }
+}
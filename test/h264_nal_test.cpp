@@ -0,0 +1,76 @@
+/**
+ * @file    h264_nal_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <h264_nal.hpp>
+
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("next_nal_unit", "[h264]") {
+    const vector<uint8_t> stream{
+        0, 0, 0, 1, 0x67, 0x42, 0x00, // SPS with 4 byte start code
+        0, 0, 1, 0x68, 0xce,          // PPS with 3 byte start code
+        0, 0, 0, 1, 0x65, 0x88, 0x80, // IDR
+    };
+    size_t offset = 0, length = 0;
+    const uint8_t* nal = next_nal_unit(stream.data(), stream.size(), offset, length);
+    REQUIRE(nal == stream.data() + 4);
+    REQUIRE(length == 2); // the last 0x00 is trailing_zero_8bits
+    nal = next_nal_unit(stream.data(), stream.size(), offset, length);
+    REQUIRE(nal[0] == 0x68);
+    REQUIRE(length == 2);
+    nal = next_nal_unit(stream.data(), stream.size(), offset, length);
+    REQUIRE(nal[0] == 0x65);
+    REQUIRE(length == 3);
+    REQUIRE(next_nal_unit(stream.data(), stream.size(), offset, length) == nullptr);
+}
+
+TEST_CASE("is_non_reference_h264", "[h264]") {
+    SECTION("IDR") {
+        const uint8_t au[] = {0, 0, 0, 1, 0x65, 0x88, 0x80};
+        REQUIRE_FALSE(is_non_reference_h264(au, sizeof(au)));
+    }
+    SECTION("reference P slice") {
+        const uint8_t au[] = {0, 0, 0, 1, 0x09, 0x30, 0, 0, 0, 1, 0x41, 0x9a, 0x02};
+        REQUIRE_FALSE(is_non_reference_h264(au, sizeof(au)));
+    }
+    SECTION("non-reference B slice") {
+        // AUD, then 2 slices with nal_ref_idc 0
+        const uint8_t au[] = {0, 0, 0, 1, 0x09, 0x50, 0, 0, 1, 0x01, 0x9e, 0x04, 0, 0, 1, 0x01, 0x9e, 0x08};
+        REQUIRE(is_non_reference_h264(au, sizeof(au)));
+    }
+    SECTION("mixed slices") {
+        const uint8_t au[] = {0, 0, 1, 0x01, 0x9e, 0x04, 0, 0, 1, 0x21, 0x9e, 0x08};
+        REQUIRE_FALSE(is_non_reference_h264(au, sizeof(au)));
+    }
+    SECTION("no slice") {
+        const uint8_t au[] = {0, 0, 0, 1, 0x67, 0x42, 0, 0, 1, 0x68, 0xce};
+        REQUIRE_FALSE(is_non_reference_h264(au, sizeof(au)));
+        REQUIRE_FALSE(is_non_reference_h264(nullptr, 0));
+    }
+}
+
+TEST_CASE("is_non_reference_h264 with span_list_t", "[h264]") {
+    const vector<vector<uint8_t>> units{
+        {0, 0, 0, 1, 0x65, 0x88, 0x80},
+        {0, 0, 0, 1, 0x09, 0x30, 0, 0, 0, 1, 0x41, 0x9a, 0x02},
+        {0, 0, 0, 1, 0x09, 0x50, 0, 0, 1, 0x01, 0x9e, 0x04, 0, 0, 1, 0x01, 0x9e, 0x08},
+        {0, 0, 1, 0x01, 0x9e, 0x04, 0, 0, 1, 0x21, 0x9e, 0x08},
+        {0, 0, 0, 1, 0x67, 0x42, 0, 0, 1, 0x68, 0xce},
+    };
+    for (const vector<uint8_t>& au : units) {
+        const bool expected = is_non_reference_h264(au.data(), au.size());
+        // the start code and the header are split at every position
+        for (size_t cut = 0; cut <= au.size(); ++cut) {
+            CAPTURE(cut);
+            span_list_t list{};
+            list.push_back(au.data(), cut);
+            list.push_back(au.data() + cut, au.size() - cut);
+            REQUIRE(is_non_reference_h264(list) == expected);
+        }
+    }
+    REQUIRE_FALSE(is_non_reference_h264(span_list_t{}));
+}
@@ -0,0 +1,143 @@
+/**
+ * @file    histogram_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <histogram.hpp>
+#include <pixel_traits.hpp>
+#include "frame_helpers.hpp"
+
+#include <cstring>
+#include <numeric>
+#include <string>
+
+using namespace std;
+
+static uint64_t sum_of(const uint32_t (&bins)[256]) noexcept {
+    return accumulate(begin(bins), end(bins), uint64_t{0});
+}
+
+static bool is_same_histogram(const histogram_t& lhs, const histogram_t& rhs) noexcept {
+    return memcmp(&lhs, &rhs, sizeof(histogram_t)) == 0;
+}
+
+TEST_CASE("histogram source", "[histogram]") {
+    REQUIRE(is_histogram_source(pixel_format_t::nv12));
+    REQUIRE(is_histogram_source(pixel_format_t::rgb32));
+    REQUIRE_FALSE(is_histogram_source(pixel_format_t::yuy2));
+
+    histogram_t histogram{};
+    frame_buffer_t yuy2{pixel_format_t::yuy2, 16, 16};
+    frame_buffer_t nv12{pixel_format_t::nv12, 16, 16};
+    REQUIRE_FALSE(compute_histogram(yuy2.view(), histogram));
+    REQUIRE_FALSE(compute_histogram(nv12.view(), histogram, 0));
+}
+
+TEST_CASE("compute_histogram", "[histogram]") {
+    const simd_level_t level = simd_level_t::scalar;
+
+    SECTION("NV12 header and counts") {
+        frame_buffer_t nv12{pixel_format_t::nv12, 33, 17};
+        fill_random(nv12, 3);
+        histogram_t histogram{};
+        REQUIRE(compute_histogram(nv12.view(), histogram, 1, level));
+        REQUIRE(histogram.width == 33);
+        REQUIRE(histogram.height == 17);
+        REQUIRE(histogram.channel_mask == (histogram_channel_y | histogram_channel_cr | histogram_channel_cb));
+        REQUIRE(histogram.fourcc == get_pixel_traits(pixel_format_t::nv12).fourcc);
+        REQUIRE(sum_of(histogram.p0) == 33 * 17);
+        REQUIRE(sum_of(histogram.p1) == 17 * 9);
+        REQUIRE(sum_of(histogram.p2) == 17 * 9);
+    }
+    SECTION("RGB32 solid color") {
+        frame_buffer_t rgb32{pixel_format_t::rgb32, 20, 10};
+        for (uint32_t y = 0; y < 10; ++y)
+            for (uint32_t x = 0; x < 20; ++x) {
+                uint8_t* pixel = rgb32.plane(0).row(y) + 4 * x; // B G R X
+                pixel[0] = 30, pixel[1] = 20, pixel[2] = 10, pixel[3] = 255;
+            }
+        histogram_t histogram{};
+        REQUIRE(compute_histogram(rgb32.view(), histogram, 1, level));
+        REQUIRE(histogram.channel_mask == (histogram_channel_r | histogram_channel_g | histogram_channel_b));
+        REQUIRE(histogram.p0[10] == 200);
+        REQUIRE(histogram.p1[20] == 200);
+        REQUIRE(histogram.p2[30] == 200);
+        REQUIRE(sum_of(histogram.p0) == 200);
+    }
+    SECTION("subsampling") {
+        const uint32_t step = GENERATE(2u, 3u, 4u);
+        CAPTURE(step);
+        frame_buffer_t nv12{pixel_format_t::nv12, 64, 30};
+        fill_random(nv12, step);
+        histogram_t histogram{};
+        REQUIRE(compute_histogram(nv12.view(), histogram, step, level));
+        REQUIRE(sum_of(histogram.p0) == ((64 + step - 1) / step) * ((30 + step - 1) / step));
+        REQUIRE(sum_of(histogram.p1) == ((32 + step - 1) / step) * ((15 + step - 1) / step));
+    }
+    SECTION("merged ranges are same with the full frame") {
+        const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::rgb32);
+        const uint32_t step = GENERATE(1u, 2u);
+        CAPTURE(static_cast<uint32_t>(format), step);
+        frame_buffer_t src{format, 48, 37};
+        fill_random(src, 5);
+        histogram_t expected{};
+        REQUIRE(compute_histogram(src.view(), expected, step, level));
+        histogram_t merged{};
+        for (row_range_t rows : split_rows(37, 2 * step, 5)) {
+            histogram_t partial{};
+            REQUIRE(compute_histogram(src.view(), partial, step, level, rows));
+            merge_histogram(merged, partial);
+        }
+        REQUIRE(is_same_histogram(expected, merged));
+    }
+    SECTION("executor") {
+        frame_buffer_t nv12{pixel_format_t::nv12, 320, 181};
+        fill_random(nv12, 7);
+        histogram_t expected{};
+        REQUIRE(compute_histogram(nv12.view(), expected, 2, level));
+        executor_t executor{4};
+        histogram_t actual{};
+        REQUIRE(compute_histogram(executor, nv12.view(), actual, 2, level));
+        REQUIRE(is_same_histogram(expected, actual));
+    }
+}
+
+TEST_CASE("histogram SIMD matches scalar", "[histogram]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::rgb32);
+    const uint32_t step = GENERATE(1u, 2u, 3u);
+    const uint32_t width = GENERATE(2u, 33u, 95u, 640u);
+    CAPTURE(static_cast<uint32_t>(format), step, width);
+    frame_buffer_t src{format, width, 6};
+    fill_random(src, width);
+    histogram_t expected{};
+    REQUIRE(compute_histogram(src.view(), expected, step, simd_level_t::scalar));
+    for (simd_level_t level : {simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        CAPTURE(to_string(level));
+        histogram_t actual{};
+        REQUIRE(compute_histogram(src.view(), actual, step, level));
+        REQUIRE(is_same_histogram(expected, actual));
+    }
+}
+
+TEST_CASE("histogram benchmark", "[histogram][!benchmark]") {
+    constexpr uint32_t width = 3840, height = 2160;
+    for (pixel_format_t format : {pixel_format_t::nv12, pixel_format_t::rgb32}) {
+        frame_buffer_t src{format, width, height};
+        fill_random(src, 13);
+        for (uint32_t step : {1u, 4u}) {
+            for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+                if (clamp_simd_level(level) != level)
+                    continue;
+                const string suffix = "(" + string{to_string(level)} + ") 4K " +
+                                      (format == pixel_format_t::nv12 ? "NV12" : "RGB32") + " 1/" + to_string(step);
+                BENCHMARK("histogram" + suffix) {
+                    histogram_t histogram{};
+                    compute_histogram(src.view(), histogram, step, level);
+                    return histogram.p0[128];
+                };
+            }
+        }
+    }
+}
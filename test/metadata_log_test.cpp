@@ -0,0 +1,153 @@
+/**
+ * @file    metadata_log_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <metadata_log.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static string get_log_path(const char* name) {
+    return (fs::temp_directory_path() / name).string();
+}
+
+static metadata_record_t make_record(int64_t timestamp) {
+    metadata_record_t record{};
+    record.timestamp = timestamp;
+    record.exposure_time = timestamp % 1000 + 100;
+    record.fields = record_field_exposure_time | record_field_iso_speed;
+    record.iso_speed = static_cast<uint32_t>(timestamp % 3200);
+    record.lens_position = static_cast<uint32_t>(timestamp % 7);
+    record.white_balance_gains[0] = 1.5f;
+    record.face_count = static_cast<uint32_t>(timestamp % 3);
+    record.faces[1] = metadata_rect_t{1, 2, 3, static_cast<int32_t>(timestamp % 100)};
+    return record;
+}
+
+static bool is_same_record(const metadata_record_t& lhs, const metadata_record_t& rhs) noexcept {
+    return memcmp(&lhs, &rhs, sizeof(metadata_record_t)) == 0;
+}
+
+TEST_CASE("update_metadata_record", "[metadata]") {
+    metadata_record_t record{};
+    SECTION("preview aggregation") {
+        preview_aggregation_t preview{};
+        preview.iso_speed = {1, 800};
+        preview.exposure_time = {1, 0, 333333};
+        preview.white_balance_gain_b = {1, 0, 5, 4};
+        update_metadata_record(record, metadata_item_t{metadata_id_t::preview_aggregation,
+                                                       reinterpret_cast<const uint8_t*>(&preview), sizeof(preview)});
+        REQUIRE(record.fields == (record_field_iso_speed | record_field_exposure_time |
+                                  record_field_white_balance_gains));
+        REQUIRE(record.iso_speed == 800);
+        REQUIRE(record.exposure_time == 333333);
+        REQUIRE(record.white_balance_gains[2] == 1.25f);
+        REQUIRE(record.white_balance_gains[0] == 0.0f);
+    }
+    SECTION("faces more than the record") {
+        struct {
+            metadata_face_header_t header;
+            metadata_face_t faces[6];
+        } payload{};
+        payload.header.count = 6;
+        for (int32_t i = 0; i < 6; ++i)
+            payload.faces[i] = metadata_face_t{i, i, i + 10, i + 10, 50, 0, 0, 0, 0, 0};
+        update_metadata_record(record, metadata_item_t{metadata_id_t::face_detection,
+                                                       reinterpret_cast<const uint8_t*>(&payload), sizeof(payload)});
+        REQUIRE(record.fields == record_field_faces);
+        REQUIRE(record.face_count == 6);
+        REQUIRE(record.faces[3].left == 3);
+        REQUIRE(record.faces[3].bottom == 13);
+    }
+    SECTION("unknown item") {
+        const uint8_t payload[16]{};
+        update_metadata_record(record, metadata_item_t{static_cast<metadata_id_t>(7), payload, sizeof(payload)});
+        REQUIRE(record.fields == 0);
+    }
+}
+
+TEST_CASE("metadata log write/read", "[metadata]") {
+    const string path = get_log_path("metadata_log_test.bin");
+    const uint32_t count = GENERATE(0u, 1u, 1000u, 5000u);
+    CAPTURE(count);
+    {
+        metadata_log_writer_t writer{path, 1024, 4};
+        for (uint32_t i = 0; i < count; ++i)
+            while (writer.append(make_record(i * 333)) == false)
+                this_thread::yield(); // the test requires all records. the capture thread doesn't retry
+        writer.flush();
+        REQUIRE(writer.get_stats().appended == count);
+    }
+    metadata_log_reader_t reader{path};
+    REQUIRE(reader.record_count() == count);
+    REQUIRE(reader.block_count() == (count + 1023) / 1024);
+    for (uint32_t i = 0; i < count; i += 97)
+        REQUIRE(is_same_record(reader[i], make_record(i * 333)));
+    if (count) {
+        REQUIRE(is_same_record(reader[count - 1], make_record((count - 1) * 333)));
+        REQUIRE(reader.block(0).first_timestamp == 0);
+    }
+    REQUIRE(reader.lower_bound(-1) == 0);
+    REQUIRE(reader.lower_bound(int64_t{count} * 333) == count);
+    if (count > 10) {
+        REQUIRE(reader.lower_bound(10 * 333) == 10);
+        REQUIRE(reader.lower_bound(10 * 333 + 1) == 11);
+    }
+}
+
+TEST_CASE("metadata log truncated", "[metadata]") {
+    const string path = get_log_path("metadata_log_truncated.bin");
+    {
+        metadata_log_writer_t writer{path, 100, 2};
+        for (uint32_t i = 0; i < 300; ++i)
+            while (writer.append(make_record(i)) == false)
+                this_thread::yield();
+    }
+    fs::resize_file(path, fs::file_size(path) - 10); // the last block is broken
+    metadata_log_reader_t reader{path};
+    REQUIRE(reader.block_count() == 2);
+    REQUIRE(reader.record_count() == 200);
+
+    fs::resize_file(path, 8);
+    REQUIRE_THROWS_AS(metadata_log_reader_t{path}, runtime_error);
+    REQUIRE_THROWS_AS(metadata_log_reader_t{get_log_path("metadata_log_missing.bin")}, system_error);
+    REQUIRE_THROWS_AS(metadata_log_writer_t(path, 0), invalid_argument);
+}
+
+TEST_CASE("metadata log benchmark", "[metadata][!benchmark]") {
+    const string path = get_log_path("metadata_log_benchmark.bin");
+    constexpr uint32_t count = 2'000'000; // 18 hours in 30 fps
+    BENCHMARK("metadata log append 2M") {
+        metadata_log_writer_t writer{path};
+        uint64_t dropped = 0;
+        for (uint32_t i = 0; i < count; ++i)
+            dropped += writer.append(make_record(i)) == false;
+        return dropped;
+    };
+    {
+        metadata_log_writer_t writer{path};
+        for (uint32_t i = 0; i < count; ++i)
+            while (writer.append(make_record(i)) == false)
+                this_thread::yield();
+    }
+    metadata_log_reader_t reader{path};
+    BENCHMARK("metadata log scan ISO of 2M") {
+        uint64_t sum = 0;
+        for (size_t b = 0; b < reader.block_count(); ++b) {
+            const metadata_block_view_t& block = reader.block(b);
+            for (uint32_t i = 0; i < block.count; ++i)
+                sum += block.iso_speed[i];
+        }
+        return sum;
+    };
+    BENCHMARK("metadata log open 2M") {
+        metadata_log_reader_t log{path};
+        return log.record_count();
+    };
+}
@@ -0,0 +1,154 @@
+/**
+ * @file    orientation_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <orientation.hpp>
+#include "frame_helpers.hpp"
+
+#include <string>
+
+using namespace std;
+
+/// @brief the pixels of RGB32 in the row major order
+static string get_pixels(const frame_buffer_t& frame) {
+    string text{};
+    for (uint32_t y = 0; y < frame.height(); ++y)
+        for (uint32_t x = 0; x < frame.width(); ++x)
+            text.push_back(static_cast<char>(reinterpret_cast<const uint32_t*>(frame.plane(0).row(y))[x]));
+    return text;
+}
+
+/// @brief the frame after `orient`. the size is transposed if needed
+static frame_buffer_t make_oriented(const frame_buffer_t& src, orientation_t orientation) {
+    const bool transposed = is_transposed(orientation);
+    return frame_buffer_t{src.format(), transposed ? src.height() : src.width(),
+                          transposed ? src.width() : src.height()};
+}
+
+TEST_CASE("orientation_t", "[orientation]") {
+    REQUIRE(get_orientation(0) == orientation_t::identity);
+    REQUIRE(get_orientation(6) == orientation_t::rotate_90);
+    REQUIRE(get_orientation(9) == orientation_t::identity);
+    REQUIRE(is_transposed(orientation_t::rotate_270));
+    REQUIRE_FALSE(is_transposed(orientation_t::rotate_180));
+    REQUIRE(is_mirrored(orientation_t::transpose));
+    REQUIRE_FALSE(is_mirrored(orientation_t::rotate_90));
+    REQUIRE(get_rotation(orientation_t::rotate_90) == 90);
+    REQUIRE(get_rotation(orientation_t::transpose) == 270);
+    REQUIRE(is_orientable(pixel_format_t::nv12));
+    REQUIRE(is_orientable(pixel_format_t::rgb32));
+    REQUIRE_FALSE(is_orientable(pixel_format_t::yuy2));
+}
+
+TEST_CASE("orient RGB32", "[orientation]") {
+    // a b c
+    // d e f
+    frame_buffer_t src{pixel_format_t::rgb32, 3, 2};
+    for (uint32_t y = 0; y < 2; ++y)
+        for (uint32_t x = 0; x < 3; ++x)
+            reinterpret_cast<uint32_t*>(src.plane(0).row(y))[x] = 'a' + y * 3 + x;
+    const auto [orientation, expected] = GENERATE(table<orientation_t, string>({
+        {orientation_t::identity, "abcdef"},
+        {orientation_t::mirror, "cbafed"},
+        {orientation_t::rotate_180, "fedcba"},
+        {orientation_t::flip, "defabc"},
+        {orientation_t::transpose, "adbecf"},
+        {orientation_t::rotate_90, "daebfc"},
+        {orientation_t::transverse, "fcebda"},
+        {orientation_t::rotate_270, "cfbead"},
+    }));
+    CAPTURE(static_cast<uint32_t>(orientation));
+    frame_buffer_t dst = make_oriented(src, orientation);
+    REQUIRE(orient(src.view(), dst.view(), orientation));
+    REQUIRE(get_pixels(dst) == expected);
+}
+
+TEST_CASE("orient NV12/I420", "[orientation]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420, pixel_format_t::p010);
+    const uint32_t width = GENERATE(2u, 33u, 95u, 640u);
+    const uint32_t height = GENERATE(2u, 9u, 100u);
+    CAPTURE(static_cast<uint32_t>(format), width, height);
+    frame_buffer_t src{format, width, height};
+    fill_random(src, width * height);
+
+    SECTION("4 times of rotate_90") {
+        frame_buffer_t rotated = make_oriented(src, orientation_t::rotate_90);
+        frame_buffer_t back{format, width, height};
+        REQUIRE(orient(src.view(), rotated.view(), orientation_t::rotate_90));
+        REQUIRE(orient(rotated.view(), back.view(), orientation_t::rotate_90));
+        frame_buffer_t half{format, width, height};
+        REQUIRE(orient(src.view(), half.view(), orientation_t::rotate_180));
+        REQUIRE(is_same_pixels(half.view(), back.view()));
+        REQUIRE(orient(back.view(), rotated.view(), orientation_t::rotate_90));
+        REQUIRE(orient(rotated.view(), half.view(), orientation_t::rotate_90));
+        REQUIRE(is_same_pixels(src.view(), half.view()));
+    }
+    SECTION("the reverse orientation") {
+        for (auto [forward, reverse] : {pair{orientation_t::mirror, orientation_t::mirror},
+                                        pair{orientation_t::flip, orientation_t::flip},
+                                        pair{orientation_t::transpose, orientation_t::transpose},
+                                        pair{orientation_t::transverse, orientation_t::transverse},
+                                        pair{orientation_t::rotate_270, orientation_t::rotate_90}}) {
+            CAPTURE(static_cast<uint32_t>(forward));
+            frame_buffer_t oriented = make_oriented(src, forward);
+            frame_buffer_t back{format, width, height};
+            REQUIRE(orient(src.view(), oriented.view(), forward));
+            REQUIRE(orient(oriented.view(), back.view(), reverse));
+            REQUIRE(is_same_pixels(src.view(), back.view()));
+        }
+    }
+    SECTION("rows") {
+        const orientation_t orientation = GENERATE(orientation_t::rotate_90, orientation_t::rotate_180);
+        frame_buffer_t expected = make_oriented(src, orientation);
+        frame_buffer_t actual = make_oriented(src, orientation);
+        REQUIRE(orient(src.view(), expected.view(), orientation));
+        for (row_range_t rows : split_rows(actual.height(), 2, 3))
+            REQUIRE(orient(src.view(), actual.view(), orientation, rows));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+}
+
+TEST_CASE("orient mismatch", "[orientation]") {
+    frame_buffer_t src{pixel_format_t::nv12, 6, 4};
+    frame_buffer_t same{pixel_format_t::nv12, 6, 4};
+    frame_buffer_t i420{pixel_format_t::i420, 4, 6};
+    frame_buffer_t yuy2{pixel_format_t::yuy2, 6, 4};
+    REQUIRE_FALSE(orient(src.view(), same.view(), orientation_t::rotate_90));
+    REQUIRE_FALSE(orient(src.view(), i420.view(), orientation_t::rotate_90));
+    REQUIRE_FALSE(orient(yuy2.view(), yuy2.view(), orientation_t::identity));
+}
+
+/// @brief 1 pixel from each row of the `src` for the `dst` row. for the comparison with the tiles
+static void rotate_90_naive(const frame_view_t& src, const frame_view_t& dst) noexcept {
+    for (uint32_t y = 0; y < dst.height; ++y) {
+        auto* out = reinterpret_cast<uint32_t*>(dst.planes[0].row(y));
+        for (uint32_t x = 0; x < dst.width; ++x)
+            out[x] = reinterpret_cast<const uint32_t*>(src.planes[0].row(src.height - 1 - x))[y];
+    }
+}
+
+TEST_CASE("orient benchmark", "[orientation][!benchmark]") {
+    constexpr uint32_t width = 3840, height = 2160;
+    for (pixel_format_t format : {pixel_format_t::nv12, pixel_format_t::rgb32}) {
+        frame_buffer_t src{format, width, height};
+        fill_random(src, 5);
+        frame_buffer_t rotated{format, height, width};
+        frame_buffer_t flipped{format, width, height};
+        const string suffix = format == pixel_format_t::nv12 ? "(NV12) 4K" : "(RGB32) 4K";
+        if (format == pixel_format_t::rgb32) {
+            BENCHMARK("rotate_90 naive" + suffix) {
+                return rotate_90_naive(src.view(), rotated.view());
+            };
+        }
+        BENCHMARK("rotate_90" + suffix) {
+            return orient(src.view(), rotated.view(), orientation_t::rotate_90);
+        };
+        BENCHMARK("rotate_180" + suffix) {
+            return orient(src.view(), flipped.view(), orientation_t::rotate_180);
+        };
+        BENCHMARK("flip" + suffix) {
+            return orient(src.view(), flipped.view(), orientation_t::flip);
+        };
+    }
+}
@@ -0,0 +1,193 @@
+/**
+ * @file    p010_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <p010.hpp>
+#include "frame_helpers.hpp"
+
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+/// @brief Y and U/V of all pixels in 10 bit
+static void fill_p010(const frame_buffer_t& frame, uint16_t y, uint16_t u, uint16_t v) {
+    for (uint32_t row = 0; row < frame.height(); ++row) {
+        auto* luma = reinterpret_cast<uint16_t*>(frame.plane(0).row(row));
+        for (uint32_t x = 0; x < frame.width(); ++x)
+            luma[x] = static_cast<uint16_t>(y << 6);
+    }
+    for (uint32_t row = 0; row < frame.plane(1).rows; ++row) {
+        auto* uv = reinterpret_cast<uint16_t*>(frame.plane(1).row(row));
+        for (uint32_t x = 0; x < frame.plane(1).row_bytes / 4; ++x) {
+            uv[2 * x + 0] = static_cast<uint16_t>(u << 6);
+            uv[2 * x + 1] = static_cast<uint16_t>(v << 6);
+        }
+    }
+}
+
+TEST_CASE("P010 layout", "[format]") {
+    frame_buffer_t p010{pixel_format_t::p010, 6, 3};
+    REQUIRE(p010.view().num_plane == 2);
+    REQUIRE(p010.plane(0).row_bytes == 12);
+    REQUIRE(p010.plane(1).row_bytes == 12); // 3 U/V pairs
+    REQUIRE(p010.plane(1).rows == 2);
+    REQUIRE(p010.plane(1).pitch == p010.pitch());
+    REQUIRE(is_high_bit_depth(pixel_format_t::p016));
+    REQUIRE_FALSE(is_high_bit_depth(pixel_format_t::nv12));
+}
+
+TEST_CASE("convert_p010_to_nv12", "[color]") {
+    const simd_level_t level = simd_level_t::scalar;
+    SECTION("limited range is kept") {
+        frame_buffer_t p010{pixel_format_t::p010, 4, 2};
+        fill_p010(p010, 940, 64, 960);
+        frame_buffer_t nv12{pixel_format_t::nv12, 4, 2};
+        REQUIRE(convert_p010_to_nv12(p010.view(), nv12.view(), dither_t::none, level));
+        REQUIRE(nv12.plane(0).row(1)[3] == 235);
+        REQUIRE(nv12.plane(1).row(0)[0] == 16);
+        REQUIRE(nv12.plane(1).row(0)[1] == 240);
+    }
+    SECTION("rounding saturates") {
+        frame_buffer_t p016{pixel_format_t::p016, 2, 2};
+        auto* y = reinterpret_cast<uint16_t*>(p016.plane(0).row(0));
+        y[0] = 0xFFFF, y[1] = 0x127F;
+        frame_buffer_t nv12{pixel_format_t::nv12, 2, 2};
+        REQUIRE(convert_p010_to_nv12(p016.view(), nv12.view(), dither_t::none, level));
+        REQUIRE(nv12.plane(0).row(0)[0] == 255);
+        REQUIRE(nv12.plane(0).row(0)[1] == 0x12);
+    }
+    SECTION("dithering keeps the fraction") {
+        // 100.25 in 8 bit. the rounding loses the 0.25 of the flat area
+        frame_buffer_t p010{pixel_format_t::p010, 8, 8};
+        fill_p010(p010, 401, 512, 512);
+        frame_buffer_t nv12{pixel_format_t::nv12, 8, 8};
+        REQUIRE(convert_p010_to_nv12(p010.view(), nv12.view(), dither_t::ordered, level));
+        uint32_t sum = 0;
+        for (uint32_t y = 0; y < 4; ++y)
+            for (uint32_t x = 0; x < 4; ++x)
+                sum += nv12.plane(0).row(y)[x];
+        REQUIRE(sum == 1604); // 100.25 * 16
+        REQUIRE(convert_p010_to_nv12(p010.view(), nv12.view(), dither_t::none, level));
+        REQUIRE(nv12.plane(0).row(0)[0] == 100);
+    }
+    SECTION("invalid arguments") {
+        frame_buffer_t p010{pixel_format_t::p010, 4, 2};
+        frame_buffer_t nv12{pixel_format_t::nv12, 4, 4};
+        frame_buffer_t i420{pixel_format_t::i420, 4, 2};
+        REQUIRE_FALSE(convert_p010_to_nv12(p010.view(), nv12.view()));
+        REQUIRE_FALSE(convert_p010_to_nv12(p010.view(), i420.view()));
+        REQUIRE_FALSE(convert_p010_to_nv12(i420.view(), i420.view()));
+    }
+}
+
+TEST_CASE("convert_p010_to_rgba16", "[color]") {
+    const simd_level_t level = simd_level_t::scalar;
+    frame_buffer_t p010{pixel_format_t::p010, 4, 2};
+    frame_buffer_t rgba16{pixel_format_t::rgba16, 4, 2};
+    SECTION("white") {
+        fill_p010(p010, 940, 512, 512);
+        REQUIRE(convert_p010_to_rgba16(p010.view(), rgba16.view(), {}, level));
+        const auto* pixel = reinterpret_cast<const uint16_t*>(rgba16.plane(0).row(1)) + 4 * 3;
+        for (uint32_t i = 0; i < 4; ++i)
+            REQUIRE(pixel[i] == 0xFFFF);
+    }
+    SECTION("black") {
+        fill_p010(p010, 64, 512, 512);
+        REQUIRE(convert_p010_to_rgba16(p010.view(), rgba16.view(), {}, level));
+        const auto* pixel = reinterpret_cast<const uint16_t*>(rgba16.plane(0).row(0));
+        REQUIRE(pixel[0] == 0);
+        REQUIRE(pixel[1] == 0);
+        REQUIRE(pixel[2] == 0);
+        REQUIRE(pixel[3] == 0xFFFF);
+    }
+    SECTION("invalid arguments") {
+        frame_buffer_t rgb32{pixel_format_t::rgb32, 4, 2};
+        REQUIRE_FALSE(convert_p010_to_rgba16(p010.view(), rgb32.view()));
+        REQUIRE_FALSE(convert_p010_to_rgb32(p010.view(), rgba16.view()));
+    }
+}
+
+TEST_CASE("convert_p010_to_rgb32 matches RGBA16", "[color]") {
+    const yuv_color_t color{yuv_matrix_t::bt2020, yuv_range_t::limited};
+    frame_buffer_t p010{pixel_format_t::p010, 64, 8};
+    fill_random(p010, 7);
+    frame_buffer_t rgb32{pixel_format_t::rgb32, 64, 8};
+    frame_buffer_t rgba16{pixel_format_t::rgba16, 64, 8};
+    REQUIRE(convert_p010_to_rgb32(p010.view(), rgb32.view(), color, simd_level_t::scalar));
+    REQUIRE(convert_p010_to_rgba16(p010.view(), rgba16.view(), color, simd_level_t::scalar));
+    // RGB32 uses the rounded 8 bit Y/U/V. the error is amplified by the matrix
+    for (uint32_t y = 0; y < 8; ++y) {
+        const uint8_t* bgra = rgb32.plane(0).row(y);
+        const auto* rgba = reinterpret_cast<const uint16_t*>(rgba16.plane(0).row(y));
+        for (uint32_t x = 0; x < 64; ++x) {
+            CAPTURE(x, y);
+            REQUIRE(abs(bgra[4 * x + 2] - (rgba[4 * x + 0] >> 8)) <= 2);
+            REQUIRE(abs(bgra[4 * x + 1] - (rgba[4 * x + 1] >> 8)) <= 2);
+            REQUIRE(abs(bgra[4 * x + 0] - (rgba[4 * x + 2] >> 8)) <= 2);
+        }
+    }
+}
+
+TEST_CASE("P010 SIMD matches scalar", "[color]") {
+    const pixel_format_t input = GENERATE(pixel_format_t::p010, pixel_format_t::p016);
+    const uint32_t width = GENERATE(2u, 33u, 95u, 640u);
+    const uint32_t height = GENERATE(1u, 9u);
+    CAPTURE(static_cast<uint32_t>(input), width, height);
+    frame_buffer_t src{input, width, height};
+    fill_random(src, width * height);
+    const yuv_color_t color{yuv_matrix_t::bt709, yuv_range_t::full};
+
+    frame_buffer_t nv12{pixel_format_t::nv12, width, height};
+    frame_buffer_t dithered{pixel_format_t::nv12, width, height};
+    frame_buffer_t rgb32{pixel_format_t::rgb32, width, height};
+    frame_buffer_t rgba16{pixel_format_t::rgba16, width, height};
+    REQUIRE(convert_p010_to_nv12(src.view(), nv12.view(), dither_t::none, simd_level_t::scalar));
+    REQUIRE(convert_p010_to_nv12(src.view(), dithered.view(), dither_t::ordered, simd_level_t::scalar));
+    REQUIRE(convert_p010_to_rgb32(src.view(), rgb32.view(), color, simd_level_t::scalar));
+    REQUIRE(convert_p010_to_rgba16(src.view(), rgba16.view(), color, simd_level_t::scalar));
+    for (simd_level_t level : {simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        CAPTURE(to_string(level));
+        frame_buffer_t actual{pixel_format_t::nv12, width, height, 1024};
+        REQUIRE(convert_p010_to_nv12(src.view(), actual.view(), dither_t::none, level));
+        REQUIRE(is_same_pixels(nv12.view(), actual.view()));
+        REQUIRE(convert_p010_to_nv12(src.view(), actual.view(), dither_t::ordered, level));
+        REQUIRE(is_same_pixels(dithered.view(), actual.view()));
+        frame_buffer_t bgra{pixel_format_t::rgb32, width, height};
+        REQUIRE(convert_p010_to_rgb32(src.view(), bgra.view(), color, level));
+        REQUIRE(is_same_pixels(rgb32.view(), bgra.view()));
+        frame_buffer_t rgba{pixel_format_t::rgba16, width, height};
+        REQUIRE(convert_p010_to_rgba16(src.view(), rgba.view(), color, level));
+        REQUIRE(is_same_pixels(rgba16.view(), rgba.view()));
+    }
+}
+
+TEST_CASE("P010 conversion benchmark", "[color][!benchmark]") {
+    constexpr uint32_t width = 1920, height = 1080;
+    frame_buffer_t src{pixel_format_t::p010, width, height};
+    fill_random(src, 3);
+    frame_buffer_t nv12{pixel_format_t::nv12, width, height}; // reused
+    frame_buffer_t rgb32{pixel_format_t::rgb32, width, height};
+    frame_buffer_t rgba16{pixel_format_t::rgba16, width, height};
+    const yuv_color_t color{yuv_matrix_t::bt2020, yuv_range_t::limited};
+    for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        const string suffix = "(" + string{to_string(level)} + ") 1080p";
+        BENCHMARK("P010→NV12" + suffix) {
+            return convert_p010_to_nv12(src.view(), nv12.view(), dither_t::none, level);
+        };
+        BENCHMARK("P010→NV12 dithered" + suffix) {
+            return convert_p010_to_nv12(src.view(), nv12.view(), dither_t::ordered, level);
+        };
+        BENCHMARK("P010→RGB32" + suffix) {
+            return convert_p010_to_rgb32(src.view(), rgb32.view(), color, level);
+        };
+        BENCHMARK("P010→RGBA16" + suffix) {
+            return convert_p010_to_rgba16(src.view(), rgba16.view(), color, level);
+        };
+    }
+}
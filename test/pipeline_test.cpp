@@ -0,0 +1,288 @@
+/**
+ * @file    pipeline_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <pipeline.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono_literals;
+
+/// @brief software stage which occupies the CPU like a codec
+static uint64_t spin(chrono::microseconds duration) noexcept {
+    const auto until = chrono::steady_clock::now() + duration;
+    uint64_t count = 0;
+    while (chrono::steady_clock::now() < until)
+        ++count;
+    return count;
+}
+
+TEST_CASE("bounded_queue_t", "[pipeline]") {
+    bounded_queue_t<int> queue{2};
+    REQUIRE(queue.push(1));
+    REQUIRE(queue.push(2));
+    REQUIRE(queue.size() == 2);
+
+    SECTION("push blocks while full") {
+        thread producer{[&queue]() { queue.push(3); }};
+        this_thread::sleep_for(10ms);
+        REQUIRE(queue.size() == 2);
+        int item = 0;
+        REQUIRE(queue.pop(item));
+        REQUIRE(item == 1);
+        producer.join();
+        REQUIRE(queue.size() == 2);
+    }
+    SECTION("close") {
+        queue.close();
+        REQUIRE_FALSE(queue.push(3));
+        int item = 0;
+        REQUIRE(queue.pop(item));
+        REQUIRE(queue.pop(item));
+        REQUIRE(item == 2);
+        REQUIRE_FALSE(queue.pop(item));
+    }
+    SECTION("cancel") {
+        queue.cancel();
+        int item = 0;
+        REQUIRE_FALSE(queue.pop(item));
+    }
+    SECTION("close wakes up the consumer") {
+        bounded_queue_t<int> empty{1};
+        thread consumer{[&empty]() {
+            int item = 0;
+            empty.pop(item);
+        }};
+        empty.close();
+        consumer.join();
+    }
+}
+
+TEST_CASE("bounded_queue_t overflow policy", "[pipeline]") {
+    bounded_queue_t<int> queue{3};
+    vector<int> dropped{};
+    queue.set_drop_hook([&dropped](const int& item, overflow_policy_t) { dropped.push_back(item); });
+    auto drain = [&queue]() {
+        vector<int> items{};
+        queue.close();
+        for (int item = 0; queue.pop(item);)
+            items.push_back(item);
+        return items;
+    };
+
+    SECTION("drop_oldest") {
+        queue.set_policy(overflow_policy_t::drop_oldest);
+        for (int i = 0; i < 5; ++i)
+            REQUIRE(queue.push(move(i)));
+        REQUIRE(dropped == vector<int>{0, 1});
+        REQUIRE(drain() == vector<int>{2, 3, 4});
+        const auto stats = queue.stats();
+        REQUIRE(stats.pushed == 5);
+        REQUIRE(stats.popped == 3);
+        REQUIRE(stats.dropped == 2);
+        REQUIRE(stats.blocked == 0);
+        REQUIRE(stats.high_water == 3);
+    }
+    SECTION("drop_newest") {
+        queue.set_policy(overflow_policy_t::drop_newest);
+        for (int i = 0; i < 5; ++i)
+            REQUIRE(queue.push(move(i)));
+        REQUIRE(dropped == vector<int>{3, 4});
+        REQUIRE(drain() == vector<int>{0, 1, 2});
+        const auto stats = queue.stats();
+        REQUIRE(stats.pushed == 3);
+        REQUIRE(stats.dropped == 2);
+    }
+    SECTION("drop_non_reference") {
+        queue.set_policy(overflow_policy_t::drop_non_reference);
+        size_t checked = 0;
+        queue.set_droppable([&checked](const int& item) {
+            ++checked;
+            return item % 2 == 1; // odd numbers are droppable
+        });
+        for (int i = 0; i < 6; ++i)
+            REQUIRE(queue.push(move(i)));
+        // {0,1,2} → 3 replaces 1 → {0,2,3} → 4 replaces 3 → {0,2,4} → 5 is dropped
+        REQUIRE(dropped == vector<int>{1, 3, 5});
+        REQUIRE(drain() == vector<int>{0, 2, 4});
+        REQUIRE(queue.stats().dropped == 3);
+        REQUIRE(checked == 6); // once for each push, not for each overflow
+    }
+    SECTION("drop_non_reference blocks if nothing is droppable") {
+        queue.set_policy(overflow_policy_t::drop_non_reference);
+        queue.set_droppable([](const int&) { return false; });
+        for (int i = 0; i < 3; ++i)
+            REQUIRE(queue.push(move(i)));
+        thread producer{[&queue]() { queue.push(3); }};
+        while (queue.stats().blocked == 0)
+            this_thread::yield();
+        int item = -1;
+        REQUIRE(queue.pop(item));
+        producer.join();
+        REQUIRE(item == 0);
+        REQUIRE(dropped.empty());
+        REQUIRE(drain() == vector<int>{1, 2, 3});
+    }
+    SECTION("closed queue doesn't drop") {
+        queue.set_policy(overflow_policy_t::drop_oldest);
+        queue.close();
+        REQUIRE_FALSE(queue.push(1));
+        REQUIRE(dropped.empty());
+        REQUIRE(queue.stats().pushed == 0);
+    }
+}
+
+TEST_CASE("pipeline_t overflow policy", "[pipeline]") {
+    // the source is faster than the sink. like a camera with a slow writer
+    pipeline_t<int> pipeline{2};
+    int next = 0;
+    pipeline.set_source([&next](int& item) {
+        item = next++;
+        return item < 100;
+    });
+    pipeline.add_stage([](int&& item, const auto& emit) { emit(move(item)); });
+    atomic_size_t dropped{0};
+    pipeline.set_policy(0, overflow_policy_t::drop_oldest);
+    pipeline.set_drop_hook([&dropped](const int&, overflow_policy_t) { ++dropped; });
+    vector<int> outputs{};
+    pipeline.set_sink([&outputs](int&& item) {
+        outputs.push_back(item);
+        this_thread::sleep_for(100us);
+    });
+    pipeline.start();
+    pipeline.wait();
+
+    const auto source = pipeline.stats(0);
+    const auto sink = pipeline.stats(pipeline.num_stage());
+    REQUIRE(source.dropped == dropped);
+    REQUIRE(sink.dropped == 0);
+    REQUIRE(outputs.size() + dropped == 100);
+    REQUIRE(is_sorted(outputs.begin(), outputs.end()));
+    REQUIRE(outputs.back() == 99); // the latest frame is never lost
+}
+
+TEST_CASE("pipeline_t", "[pipeline]") {
+    pipeline_t<int> pipeline{2};
+    int next = 0;
+    pipeline.set_source([&next](int& item) {
+        item = next++;
+        return item < 100;
+    });
+
+    SECTION("order") {
+        pipeline.add_stage([](int&& item, const auto& emit) { emit(item * 2); });
+        pipeline.add_stage([](int&& item, const auto& emit) { emit(item + 1); });
+        vector<int> outputs{};
+        pipeline.set_sink([&outputs](int&& item) { outputs.push_back(item); });
+        pipeline.start();
+        pipeline.wait();
+        REQUIRE(outputs.size() == 100);
+        for (int i = 0; i < 100; ++i)
+            REQUIRE(outputs[i] == i * 2 + 1);
+    }
+    SECTION("1 input, many outputs and drain") {
+        // like a decoder. holds 1 item and releases it later
+        int held = -1;
+        pipeline.add_stage(
+            [&held](int&& item, const auto& emit) {
+                if (held >= 0)
+                    emit(move(held));
+                held = item;
+                if (item % 10 == 0)
+                    emit(-1); // an extra output
+            },
+            [&held](const auto& emit) { emit(move(held)); });
+        vector<int> outputs{};
+        pipeline.set_sink([&outputs](int&& item) { outputs.push_back(item); });
+        pipeline.start();
+        pipeline.wait();
+        REQUIRE(outputs.size() == 110);
+        REQUIRE(outputs.back() == 99);
+    }
+    SECTION("pop without sink") {
+        pipeline.start();
+        int count = 0;
+        for (int item = 0; pipeline.pop(item);)
+            REQUIRE(item == count++);
+        pipeline.wait();
+        REQUIRE(count == 100);
+    }
+    SECTION("exception stops the pipeline") {
+        pipeline.add_stage([](int&& item, const auto& emit) {
+            if (item == 50)
+                throw runtime_error{"stage failed"};
+            emit(move(item));
+        });
+        size_t count = 0;
+        pipeline.set_sink([&count](int&&) { ++count; });
+        pipeline.start();
+        REQUIRE_THROWS_AS(pipeline.wait(), runtime_error);
+        REQUIRE(pipeline.is_stopped());
+        REQUIRE(count <= 50);
+    }
+    SECTION("stop while running") {
+        pipeline.set_source([](int& item) {
+            item = 0;
+            return true; // infinite
+        });
+        pipeline.start();
+        int item = 0;
+        REQUIRE(pipeline.pop(item));
+        pipeline.stop();
+        pipeline.wait();
+    }
+    SECTION("start requires source") {
+        pipeline_t<int> empty{};
+        REQUIRE_THROWS_AS(empty.start(), logic_error);
+    }
+}
+
+TEST_CASE("pipeline_t benchmark", "[pipeline][!benchmark]") {
+    // read 100us, transform 300us, write 100us for each frame
+    constexpr int count = 60;
+    BENCHMARK("serial read→transform→write") {
+        uint64_t total = 0;
+        for (int i = 0; i < count; ++i) {
+            total += spin(100us);
+            total += spin(300us);
+            total += spin(100us);
+        }
+        return total;
+    };
+    BENCHMARK("pipeline_t read→transform→write") {
+        pipeline_t<uint64_t> pipeline{4};
+        int index = 0;
+        pipeline.set_source([&index](uint64_t& item) {
+            item = spin(100us);
+            return index++ < count;
+        });
+        pipeline.add_stage([](uint64_t&& item, const auto& emit) { emit(item + spin(300us)); });
+        uint64_t total = 0;
+        pipeline.set_sink([&total](uint64_t&& item) { total += item + spin(100us); });
+        pipeline.start();
+        pipeline.wait();
+        return total;
+    };
+    BENCHMARK("pipeline_t read→transform(2 stages)→write") {
+        pipeline_t<uint64_t> pipeline{4};
+        int index = 0;
+        pipeline.set_source([&index](uint64_t& item) {
+            item = spin(100us);
+            return index++ < count;
+        });
+        pipeline.add_stage([](uint64_t&& item, const auto& emit) { emit(item + spin(150us)); });
+        pipeline.add_stage([](uint64_t&& item, const auto& emit) { emit(item + spin(150us)); });
+        uint64_t total = 0;
+        pipeline.set_sink([&total](uint64_t&& item) { total += item + spin(100us); });
+        pipeline.start();
+        pipeline.wait();
+        return total;
+    };
+}
@@ -0,0 +1,67 @@
+/**
+ * @file    pixel_traits_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <frame_buffer.hpp>
+#include <pixel_traits.hpp>
+
+using namespace std;
+
+// same with MFCalculateImageSize
+static_assert(get_image_size(pixel_format_t::nv12, 1920, 1080) == 3110400);
+static_assert(get_image_size(pixel_format_t::i420, 1920, 1080) == 3110400);
+static_assert(get_image_size(pixel_format_t::rgb32, 1920, 1080) == 8294400);
+static_assert(get_image_size(pixel_format_t::rgb565, 640, 480) == 614400);
+static_assert(get_image_size(pixel_format_t::yuy2, 1280, 720) == 1843200);
+static_assert(get_image_size(pixel_format_t::p010, 1920, 1080) == 6220800);
+static_assert(get_image_size(pixel_format_t::unknown, 1280, 720) == 0);
+
+static_assert(make_fourcc('N', 'V', '1', '2') == 0x3231564E);
+static_assert(pixel_traits_v<pixel_format_t::nv12>.num_plane == 2);
+static_assert(pixel_traits_v<pixel_format_t::yuy2>.shift_x == 1 && pixel_traits_v<pixel_format_t::yuy2>.shift_y == 0);
+static_assert(get_pixel_format(make_fourcc('I', 'Y', 'U', 'V')) == pixel_format_t::i420);
+static_assert(get_pixel_format(22) == pixel_format_t::rgb32);
+
+TEST_CASE("pixel_traits_t fourcc round trip", "[format]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420, pixel_format_t::rgb32,
+                                           pixel_format_t::rgb565, pixel_format_t::nv21, pixel_format_t::yuy2,
+                                           pixel_format_t::uyvy, pixel_format_t::p010, pixel_format_t::p016,
+                                           pixel_format_t::rgba16);
+    const pixel_traits_t traits = get_pixel_traits(format);
+    REQUIRE(traits.num_plane > 0);
+    REQUIRE(get_pixel_format(traits.fourcc) == format);
+    REQUIRE(get_pixel_format(make_fourcc('H', '2', '6', '4')) == pixel_format_t::unknown);
+}
+
+TEST_CASE("pixel_traits_t samples per pixel", "[format]") {
+    REQUIRE(get_samples_per_pixel(get_pixel_traits(pixel_format_t::rgb32), 0) == 4);
+    REQUIRE(get_samples_per_pixel(get_pixel_traits(pixel_format_t::rgb565), 0) == 1);
+    REQUIRE(get_samples_per_pixel(get_pixel_traits(pixel_format_t::yuy2), 0) == 2);
+    REQUIRE(get_samples_per_pixel(get_pixel_traits(pixel_format_t::nv12), 1) == 2);
+    REQUIRE(get_samples_per_pixel(get_pixel_traits(pixel_format_t::i420), 2) == 1);
+    REQUIRE(get_samples_per_pixel(get_pixel_traits(pixel_format_t::i420), 3) == 0);
+    REQUIRE(get_samples_per_pixel(get_pixel_traits(pixel_format_t::p010), 0) == 1);
+    REQUIRE(get_samples_per_pixel(get_pixel_traits(pixel_format_t::rgba16), 0) == 4);
+}
+
+TEST_CASE("pixel_traits_t matches frame_buffer_t", "[format]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420, pixel_format_t::rgb32,
+                                           pixel_format_t::rgb565, pixel_format_t::nv21, pixel_format_t::yuy2,
+                                           pixel_format_t::uyvy, pixel_format_t::p010, pixel_format_t::p016,
+                                           pixel_format_t::rgba16);
+    const uint32_t width = GENERATE(1u, 6u, 37u, 640u);
+    const uint32_t height = GENERATE(1u, 3u, 480u);
+    CAPTURE(static_cast<uint32_t>(format), width, height);
+    const pixel_traits_t traits = get_pixel_traits(format);
+    frame_buffer_t frame{format, width, height};
+    const frame_view_t view = frame.view();
+    REQUIRE(view.num_plane == traits.num_plane);
+    for (uint32_t i = 0; i < view.num_plane; ++i) {
+        REQUIRE(view.planes[i].row_bytes == get_row_bytes(traits, width, i));
+        REQUIRE(view.planes[i].rows == get_plane_rows(traits, height, i));
+        REQUIRE(view.planes[i].pitch == get_plane_pitch(traits, frame.pitch(), i));
+        REQUIRE(view.planes[i].pitch % frame_buffer_t::alignment == 0);
+    }
+    REQUIRE(get_contiguous_size(view) == get_image_size(format, width, height));
+}
@@ -0,0 +1,150 @@
+/**
+ * @file    repack_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <repack.hpp>
+#include "frame_helpers.hpp"
+
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+static const char* get_name(pixel_format_t format) noexcept {
+    switch (format) {
+    case pixel_format_t::i420:
+        return "I420";
+    case pixel_format_t::nv12:
+        return "NV12";
+    case pixel_format_t::nv21:
+        return "NV21";
+    case pixel_format_t::yuy2:
+        return "YUY2";
+    case pixel_format_t::uyvy:
+        return "UYVY";
+    default:
+        return "?";
+    }
+}
+
+TEST_CASE("repack_yuv layout", "[color]") {
+    // 4x2 I420 with Y 0..7, U 100/101, V 200/201
+    frame_buffer_t i420{pixel_format_t::i420, 4, 2};
+    for (uint8_t i = 0; i < 4; ++i) {
+        i420.plane(0).row(0)[i] = i;
+        i420.plane(0).row(1)[i] = i + 4;
+    }
+    i420.plane(1).row(0)[0] = 100, i420.plane(1).row(0)[1] = 101;
+    i420.plane(2).row(0)[0] = 200, i420.plane(2).row(0)[1] = 201;
+    const simd_level_t level = simd_level_t::scalar;
+
+    SECTION("NV12") {
+        frame_buffer_t nv12{pixel_format_t::nv12, 4, 2};
+        REQUIRE(repack_yuv(i420.view(), nv12.view(), level));
+        const uint8_t* uv = nv12.plane(1).row(0);
+        REQUIRE(uv[0] == 100);
+        REQUIRE(uv[1] == 200);
+        REQUIRE(uv[2] == 101);
+        REQUIRE(uv[3] == 201);
+        REQUIRE(nv12.plane(0).row(1)[3] == 7);
+    }
+    SECTION("NV21") {
+        frame_buffer_t nv21{pixel_format_t::nv21, 4, 2};
+        REQUIRE(repack_yuv(i420.view(), nv21.view(), level));
+        const uint8_t* vu = nv21.plane(1).row(0);
+        REQUIRE(vu[0] == 200);
+        REQUIRE(vu[1] == 100);
+    }
+    SECTION("YUY2") {
+        frame_buffer_t yuy2{pixel_format_t::yuy2, 4, 2};
+        REQUIRE(repack_yuv(i420.view(), yuy2.view(), level));
+        const uint8_t expected[] = {4, 100, 5, 200, 6, 101, 7, 201}; // the chroma row is repeated
+        REQUIRE(memcmp(yuy2.plane(0).row(1), expected, sizeof(expected)) == 0);
+    }
+    SECTION("UYVY") {
+        frame_buffer_t uyvy{pixel_format_t::uyvy, 4, 2};
+        REQUIRE(repack_yuv(i420.view(), uyvy.view(), level));
+        const uint8_t expected[] = {100, 0, 200, 1, 101, 2, 201, 3};
+        REQUIRE(memcmp(uyvy.plane(0).row(0), expected, sizeof(expected)) == 0);
+    }
+    SECTION("4:2:2 → 4:2:0 averages the chroma rows") {
+        frame_buffer_t yuy2{pixel_format_t::yuy2, 2, 2};
+        const uint8_t row0[] = {10, 100, 11, 200};
+        const uint8_t row1[] = {12, 103, 13, 210};
+        memcpy(yuy2.plane(0).row(0), row0, 4);
+        memcpy(yuy2.plane(0).row(1), row1, 4);
+        frame_buffer_t nv12{pixel_format_t::nv12, 2, 2};
+        REQUIRE(repack_yuv(yuy2.view(), nv12.view(), level));
+        REQUIRE(nv12.plane(0).row(1)[1] == 13);
+        REQUIRE(nv12.plane(1).row(0)[0] == 102); // (100 + 103 + 1) / 2
+        REQUIRE(nv12.plane(1).row(0)[1] == 205);
+    }
+    SECTION("invalid arguments") {
+        frame_buffer_t rgb32{pixel_format_t::rgb32, 4, 2};
+        frame_buffer_t nv12{pixel_format_t::nv12, 8, 2};
+        REQUIRE_FALSE(is_repackable(pixel_format_t::rgb32));
+        REQUIRE_FALSE(repack_yuv(i420.view(), rgb32.view()));
+        REQUIRE_FALSE(repack_yuv(i420.view(), nv12.view()));
+    }
+}
+
+TEST_CASE("repack_yuv round trip", "[color]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::i420, pixel_format_t::nv12, pixel_format_t::nv21,
+                                           pixel_format_t::yuy2, pixel_format_t::uyvy);
+    const uint32_t width = GENERATE(6u, 37u, 128u);
+    const uint32_t height = GENERATE(3u, 16u);
+    CAPTURE(get_name(format), width, height);
+    // 4:2:0 → 4:2:2 → 4:2:0 is lossless because the repeated chroma rows are averaged
+    frame_buffer_t src{pixel_format_t::i420, width, height};
+    fill_random(src, width + height);
+    frame_buffer_t middle{format, width, height, 512}; // wider pitch than the others
+    frame_buffer_t dst{pixel_format_t::i420, width, height};
+    REQUIRE(repack_yuv(src.view(), middle.view()));
+    REQUIRE(repack_yuv(middle.view(), dst.view()));
+    REQUIRE(is_same_pixels(src.view(), dst.view()));
+}
+
+TEST_CASE("repack_yuv SIMD matches scalar", "[color]") {
+    const pixel_format_t input = GENERATE(pixel_format_t::i420, pixel_format_t::nv12, pixel_format_t::nv21,
+                                          pixel_format_t::yuy2, pixel_format_t::uyvy);
+    const pixel_format_t output = GENERATE(pixel_format_t::i420, pixel_format_t::nv12, pixel_format_t::nv21,
+                                           pixel_format_t::yuy2, pixel_format_t::uyvy);
+    const uint32_t width = GENERATE(2u, 33u, 95u, 640u);
+    const uint32_t height = GENERATE(1u, 9u);
+    CAPTURE(get_name(input), get_name(output), width, height);
+
+    frame_buffer_t src{input, width, height};
+    fill_random(src, width * height);
+    frame_buffer_t expected{output, width, height};
+    REQUIRE(repack_yuv(src.view(), expected.view(), simd_level_t::scalar));
+    for (simd_level_t level : {simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        CAPTURE(to_string(level));
+        frame_buffer_t actual{output, width, height, 1024};
+        REQUIRE(repack_yuv(src.view(), actual.view(), level));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+}
+
+TEST_CASE("repack_yuv benchmark", "[color][!benchmark]") {
+    constexpr uint32_t width = 1920, height = 1080;
+    const pair<pixel_format_t, pixel_format_t> cases[] = {
+        {pixel_format_t::nv12, pixel_format_t::i420}, {pixel_format_t::i420, pixel_format_t::nv12},
+        {pixel_format_t::yuy2, pixel_format_t::nv12}, {pixel_format_t::nv12, pixel_format_t::yuy2},
+        {pixel_format_t::nv12, pixel_format_t::nv21},
+    };
+    for (auto [input, output] : cases) {
+        frame_buffer_t src{input, width, height};
+        fill_random(src, 3);
+        frame_buffer_t dst{output, width, height}; // reused
+        for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+            if (clamp_simd_level(level) != level)
+                continue;
+            BENCHMARK(string{get_name(input)} + "→" + get_name(output) + "(" + to_string(level) + ") 1080p") {
+                return repack_yuv(src.view(), dst.view(), level);
+            };
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ * @file    rgb565_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <rgb565.hpp>
+#include "frame_helpers.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+static uint16_t get_rgb565(const frame_buffer_t& frame, uint32_t x, uint32_t y) noexcept {
+    return reinterpret_cast<const uint16_t*>(frame.plane(0).row(y))[x];
+}
+
+/// @brief horizontal ramp. 0 → 255 over the width for all channels
+static void fill_gradient(const frame_buffer_t& frame) noexcept {
+    for (uint32_t y = 0; y < frame.height(); ++y)
+        for (uint32_t x = 0; x < frame.width(); ++x) {
+            uint8_t* bgra = frame.plane(0).row(y) + 4 * x;
+            bgra[0] = bgra[1] = bgra[2] = static_cast<uint8_t>(x * 256 / frame.width());
+            bgra[3] = 255;
+        }
+}
+
+/**
+ * @brief The eye averages the neighbor pixels. Compare the 4x4 block averages of the channel
+ * @return mean absolute error of the block averages
+ */
+static double get_block_error(const frame_buffer_t& lhs, const frame_buffer_t& rhs, uint32_t channel) noexcept {
+    double total = 0;
+    uint32_t count = 0;
+    for (uint32_t by = 0; by + 4 <= lhs.height(); by += 4)
+        for (uint32_t bx = 0; bx + 4 <= lhs.width(); bx += 4, ++count) {
+            int sum = 0;
+            for (uint32_t y = by; y < by + 4; ++y)
+                for (uint32_t x = bx; x < bx + 4; ++x)
+                    sum += lhs.plane(0).row(y)[4 * x + channel] - rhs.plane(0).row(y)[4 * x + channel];
+            total += abs(sum / 16.0);
+        }
+    return total / count;
+}
+
+TEST_CASE("convert_rgb32_to_rgb565", "[color]") {
+    frame_buffer_t rgb32{pixel_format_t::rgb32, 4, 4};
+    frame_buffer_t rgb565{pixel_format_t::rgb565, 4, 4};
+    const simd_level_t level = simd_level_t::scalar;
+
+    SECTION("bit layout") {
+        const uint8_t bgra[] = {0xFF, 0x00, 0x00, 0, 0x00, 0xFF, 0x00, 0, 0x00, 0x00, 0xFF, 0, 0x08, 0x04, 0x08, 0};
+        memcpy(rgb32.plane(0).row(0), bgra, sizeof(bgra));
+        REQUIRE(convert_rgb32_to_rgb565(rgb32.view(), rgb565.view(), dither_t::none, level));
+        REQUIRE(get_rgb565(rgb565, 0, 0) == 0x001F); // blue
+        REQUIRE(get_rgb565(rgb565, 1, 0) == 0x07E0); // green
+        REQUIRE(get_rgb565(rgb565, 2, 0) == 0xF800); // red
+        REQUIRE(get_rgb565(rgb565, 3, 0) == 0x0821); // the least significant bits
+    }
+    SECTION("dither doesn't overflow the white") {
+        memset(rgb32.data(), 0xFF, rgb32.size());
+        REQUIRE(convert_rgb32_to_rgb565(rgb32.view(), rgb565.view(), dither_t::ordered, level));
+        for (uint32_t y = 0; y < 4; ++y)
+            for (uint32_t x = 0; x < 4; ++x)
+                REQUIRE(get_rgb565(rgb565, x, y) == 0xFFFF);
+    }
+    SECTION("dither keeps the representable values") {
+        // the results of the expansion. (q << 3) | (q >> 2) for the 5 bit, (q << 2) | (q >> 4) for the 6 bit
+        for (uint32_t y = 0; y < 4; ++y)
+            for (uint32_t x = 0; x < 4; ++x) {
+                uint8_t* bgra = rgb32.plane(0).row(y) + 4 * x;
+                bgra[0] = (3 << 3) | (3 >> 2), bgra[1] = (5 << 2) | (5 >> 4), bgra[2] = (30 << 3) | (30 >> 2);
+            }
+        REQUIRE(convert_rgb32_to_rgb565(rgb32.view(), rgb565.view(), dither_t::ordered, level));
+        for (uint32_t y = 0; y < 4; ++y)
+            for (uint32_t x = 0; x < 4; ++x)
+                REQUIRE(get_rgb565(rgb565, x, y) == ((30 << 11) | (5 << 5) | 3));
+    }
+    SECTION("invalid arguments") {
+        frame_buffer_t small{pixel_format_t::rgb565, 2, 4};
+        REQUIRE_FALSE(convert_rgb32_to_rgb565(rgb32.view(), small.view()));
+        REQUIRE_FALSE(convert_rgb32_to_rgb565(rgb565.view(), rgb32.view()));
+        REQUIRE_FALSE(convert_rgb565_to_rgb32(rgb32.view(), rgb565.view()));
+    }
+}
+
+TEST_CASE("convert_rgb565_to_rgb32", "[color]") {
+    // all 65536 values in 256x256. RGB565 → RGB32 → RGB565 must be lossless
+    frame_buffer_t src{pixel_format_t::rgb565, 256, 256};
+    for (uint32_t y = 0; y < 256; ++y)
+        for (uint32_t x = 0; x < 256; ++x)
+            reinterpret_cast<uint16_t*>(src.plane(0).row(y))[x] = static_cast<uint16_t>(y * 256 + x);
+    frame_buffer_t rgb32{pixel_format_t::rgb32, 256, 256};
+    REQUIRE(convert_rgb565_to_rgb32(src.view(), rgb32.view(), simd_level_t::scalar));
+    const uint8_t* white = rgb32.plane(0).row(255) + 4 * 255;
+    REQUIRE(white[0] == 255);
+    REQUIRE(white[1] == 255);
+    REQUIRE(white[2] == 255);
+    REQUIRE(white[3] == 255);
+
+    const dither_t dither = GENERATE(dither_t::none, dither_t::ordered);
+    frame_buffer_t dst{pixel_format_t::rgb565, 256, 256};
+    REQUIRE(convert_rgb32_to_rgb565(rgb32.view(), dst.view(), dither, simd_level_t::scalar));
+    REQUIRE(is_same_pixels(src, dst));
+}
+
+TEST_CASE("convert_rgb32_to_rgb565 banding", "[color]") {
+    // the banding of the truncation is the error of the local average, not the error of each pixel
+    frame_buffer_t src{pixel_format_t::rgb32, 1024, 64};
+    fill_gradient(src);
+    frame_buffer_t rgb565{pixel_format_t::rgb565, 1024, 64};
+    frame_buffer_t dst{pixel_format_t::rgb32, 1024, 64};
+
+    REQUIRE(convert_rgb32_to_rgb565(src.view(), rgb565.view(), dither_t::none));
+    REQUIRE(convert_rgb565_to_rgb32(rgb565.view(), dst.view()));
+    const double truncated[] = {get_block_error(src, dst, 0), get_block_error(src, dst, 1)};
+
+    REQUIRE(convert_rgb32_to_rgb565(src.view(), rgb565.view(), dither_t::ordered));
+    REQUIRE(convert_rgb565_to_rgb32(rgb565.view(), dst.view()));
+    const double dithered[] = {get_block_error(src, dst, 0), get_block_error(src, dst, 1)};
+
+    CAPTURE(truncated[0], truncated[1], dithered[0], dithered[1]);
+    REQUIRE(dithered[0] < truncated[0] / 2); // 5 bit
+    REQUIRE(dithered[1] < truncated[1] / 2); // 6 bit
+    REQUIRE(dithered[0] < 1.0);
+    REQUIRE(dithered[1] < 1.0);
+}
+
+TEST_CASE("convert_rgb32_to_rgb565 SIMD matches scalar", "[color]") {
+    const uint32_t width = GENERATE(1u, 7u, 17u, 33u, 640u, 1366u);
+    const uint32_t height = GENERATE(1u, 5u);
+    const dither_t dither = GENERATE(dither_t::none, dither_t::ordered);
+    CAPTURE(width, height, static_cast<uint32_t>(dither));
+
+    frame_buffer_t rgb32{pixel_format_t::rgb32, width, height};
+    fill_random(rgb32, width * height);
+    frame_buffer_t rgb565{pixel_format_t::rgb565, width, height};
+    fill_random(rgb565, width + height);
+    frame_buffer_t expected565{pixel_format_t::rgb565, width, height};
+    frame_buffer_t expected32{pixel_format_t::rgb32, width, height};
+    REQUIRE(convert_rgb32_to_rgb565(rgb32.view(), expected565.view(), dither, simd_level_t::scalar));
+    REQUIRE(convert_rgb565_to_rgb32(rgb565.view(), expected32.view(), simd_level_t::scalar));
+
+    for (simd_level_t level : {simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        CAPTURE(to_string(level));
+        frame_buffer_t actual565{pixel_format_t::rgb565, width, height, 4096};
+        frame_buffer_t actual32{pixel_format_t::rgb32, width, height};
+        REQUIRE(convert_rgb32_to_rgb565(rgb32.view(), actual565.view(), dither, level));
+        REQUIRE(convert_rgb565_to_rgb32(rgb565.view(), actual32.view(), level));
+        REQUIRE(is_same_pixels(expected565, actual565));
+        REQUIRE(is_same_pixels(expected32, actual32));
+    }
+}
+
+TEST_CASE("convert_rgb32_to_rgb565 benchmark", "[color][!benchmark]") {
+    constexpr uint32_t width = 1920, height = 1080;
+    frame_buffer_t rgb32{pixel_format_t::rgb32, width, height};
+    fill_random(rgb32, 1);
+    frame_buffer_t rgb565{pixel_format_t::rgb565, width, height};
+    for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        const string suffix = string{"("} + to_string(level) + ") 1080p";
+        BENCHMARK("RGB32→RGB565" + suffix) {
+            return convert_rgb32_to_rgb565(rgb32.view(), rgb565.view(), dither_t::none, level);
+        };
+        BENCHMARK("RGB32→RGB565(dither)" + suffix) {
+            return convert_rgb32_to_rgb565(rgb32.view(), rgb565.view(), dither_t::ordered, level);
+        };
+        BENCHMARK("RGB565→RGB32" + suffix) {
+            return convert_rgb565_to_rgb32(rgb565.view(), rgb32.view(), level);
+        };
+    }
+}
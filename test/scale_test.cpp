@@ -0,0 +1,295 @@
+/**
+ * @file    scale_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <scale.hpp>
+#include "frame_helpers.hpp"
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+static const char* get_name(scale_filter_t filter) noexcept {
+    switch (filter) {
+    case scale_filter_t::nearest:
+        return "nearest";
+    case scale_filter_t::bilinear:
+        return "bilinear";
+    case scale_filter_t::bicubic:
+        return "bicubic";
+    case scale_filter_t::area:
+        return "area";
+    default:
+        return "?";
+    }
+}
+
+TEST_CASE("make_filter_bank", "[scale]") {
+    const scale_filter_t filter = GENERATE(scale_filter_t::nearest, scale_filter_t::bilinear, scale_filter_t::bicubic,
+                                           scale_filter_t::area);
+    const uint32_t input = GENERATE(1u, 3u, 64u, 1920u);
+    const uint32_t output = GENERATE(1u, 2u, 100u, 1280u);
+    CAPTURE(get_name(filter), input, output);
+
+    const filter_bank_t bank = make_filter_bank(filter, input, output);
+    REQUIRE(bank.taps > 0);
+    REQUIRE(bank.taps <= input);
+    REQUIRE(bank.offsets.size() == output);
+    REQUIRE(bank.coefficients.size() == bank.taps * output);
+    for (uint32_t i = 0; i < output; ++i) {
+        REQUIRE(bank.offsets[i] + bank.taps <= input);
+        int32_t sum = 0;
+        for (uint32_t k = 0; k < bank.taps; ++k)
+            sum += bank.coefficients[i * bank.taps + k];
+        REQUIRE(sum == (1 << filter_bits));
+    }
+    REQUIRE_THROWS_AS(make_filter_bank(filter, 0, output), invalid_argument);
+}
+
+TEST_CASE("scaler_t", "[scale]") {
+    SECTION("same size is the copy") {
+        const scale_filter_t filter = GENERATE(scale_filter_t::nearest, scale_filter_t::bilinear,
+                                               scale_filter_t::bicubic, scale_filter_t::area);
+        const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420, pixel_format_t::rgb32);
+        CAPTURE(get_name(filter), static_cast<uint32_t>(format));
+        frame_buffer_t src{format, 38, 22};
+        fill_random(src, 1);
+        frame_buffer_t dst{format, 38, 22};
+        scaler_t scaler{filter};
+        REQUIRE(scaler.scale(src.view(), dst.view(), simd_level_t::scalar));
+        REQUIRE(is_same_pixels(src.view(), dst.view()));
+    }
+    SECTION("flat area stays flat") {
+        const scale_filter_t filter = GENERATE(scale_filter_t::bilinear, scale_filter_t::bicubic,
+                                               scale_filter_t::area);
+        CAPTURE(get_name(filter));
+        frame_buffer_t src{pixel_format_t::rgb32, 97, 31};
+        memset(src.data(), 200, src.size());
+        frame_buffer_t dst{pixel_format_t::rgb32, 40, 70};
+        scaler_t scaler{filter};
+        REQUIRE(scaler.scale(src.view(), dst.view()));
+        for (uint32_t y = 0; y < dst.height(); ++y)
+            for (uint32_t x = 0; x < dst.plane(0).row_bytes; ++x)
+                REQUIRE(dst.plane(0).row(y)[x] == 200);
+    }
+    SECTION("nearest 2x repeats the pixels") {
+        frame_buffer_t src{pixel_format_t::i420, 4, 4};
+        for (uint32_t y = 0; y < 4; ++y)
+            for (uint32_t x = 0; x < 4; ++x)
+                src.plane(0).row(y)[x] = static_cast<uint8_t>(y * 4 + x);
+        frame_buffer_t dst{pixel_format_t::i420, 8, 8};
+        scaler_t scaler{scale_filter_t::nearest};
+        REQUIRE(scaler.scale(src.view(), dst.view()));
+        REQUIRE(dst.plane(0).row(0)[0] == 0);
+        REQUIRE(dst.plane(0).row(1)[1] == 0);
+        REQUIRE(dst.plane(0).row(2)[3] == 5);
+        REQUIRE(dst.plane(0).row(7)[7] == 15);
+    }
+    SECTION("area 1/2 averages 2x2") {
+        frame_buffer_t src{pixel_format_t::rgb32, 4, 2};
+        const uint8_t row0[] = {10, 20, 30, 255, 30, 40, 50, 255, 0, 0, 0, 255, 100, 100, 100, 255};
+        const uint8_t row1[] = {10, 20, 30, 255, 30, 40, 50, 255, 0, 0, 0, 255, 100, 100, 100, 255};
+        memcpy(src.plane(0).row(0), row0, sizeof(row0));
+        memcpy(src.plane(0).row(1), row1, sizeof(row1));
+        frame_buffer_t dst{pixel_format_t::rgb32, 2, 1};
+        scaler_t scaler{scale_filter_t::area};
+        REQUIRE(scaler.scale(src.view(), dst.view()));
+        const uint8_t expected[] = {20, 30, 40, 255, 50, 50, 50, 255};
+        REQUIRE(memcmp(dst.plane(0).row(0), expected, sizeof(expected)) == 0);
+    }
+    SECTION("rectangles") {
+        // the source rectangle is the flat area in the noise. the destination rectangle is the center
+        frame_buffer_t src{pixel_format_t::nv12, 64, 48};
+        fill_random(src, 2);
+        for (uint32_t y = 8; y < 24; ++y)
+            memset(src.plane(0).row(y) + 16, 50, 32);
+        for (uint32_t y = 4; y < 12; ++y)
+            memset(src.plane(1).row(y) + 16, 128, 32);
+        frame_buffer_t dst{pixel_format_t::nv12, 40, 40};
+        memset(dst.data(), 7, dst.size());
+
+        scaler_t scaler{scale_filter_t::bicubic};
+        scaler.set_source_rectangle({16, 8, 32, 16});
+        scaler.set_destination_rectangle({4, 10, 30, 20});
+        REQUIRE(scaler.scale(src.view(), dst.view()));
+        for (uint32_t y = 0; y < 40; ++y)
+            for (uint32_t x = 0; x < 40; ++x) {
+                const bool inside = x >= 4 && x < 34 && y >= 10 && y < 30;
+                REQUIRE(dst.plane(0).row(y)[x] == (inside ? 50 : 7)); // the noise must not bleed in
+            }
+        for (uint32_t y = 0; y < 20; ++y)
+            for (uint32_t x = 0; x < 40; ++x) {
+                const bool inside = x >= 4 && x < 34 && y >= 5 && y < 15;
+                REQUIRE(dst.plane(1).row(y)[x] == (inside ? 128 : 7));
+            }
+    }
+    SECTION("odd source rectangle") {
+        // the chroma row({0, 3} of NV12) is wider than the half of the luma row
+        const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420);
+        const scale_rect_t rect = GENERATE(scale_rect_t{1, 0, 5, 8}, scale_rect_t{0, 1, 7, 5}, scale_rect_t{3, 3, 1, 1});
+        CAPTURE(static_cast<uint32_t>(format), rect.x, rect.y, rect.width, rect.height);
+        frame_buffer_t src{format, 8, 8};
+        fill_random(src, 5);
+        scaler_t scaler{scale_filter_t::bicubic};
+        scaler.set_source_rectangle(rect);
+        frame_buffer_t expected{format, 6, 6};
+        bool scaled = false;
+        // the new thread starts with the empty scratch line of `scale`
+        thread{[&]() { scaled = scaler.scale(src.view(), expected.view(), simd_level_t::scalar); }}.join();
+        REQUIRE(scaled);
+        frame_buffer_t actual{format, 6, 6};
+        REQUIRE(scaler.scale(src.view(), actual.view()));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+    SECTION("invalid arguments") {
+        frame_buffer_t nv12{pixel_format_t::nv12, 16, 16};
+        frame_buffer_t rgb32{pixel_format_t::rgb32, 16, 16};
+        frame_buffer_t yuy2{pixel_format_t::yuy2, 16, 16};
+        scaler_t scaler{};
+        REQUIRE_FALSE(scaler.scale(nv12.view(), rgb32.view()));
+        REQUIRE_FALSE(scaler.scale(yuy2.view(), yuy2.view()));
+        scaler.set_source_rectangle({8, 8, 16, 4});
+        REQUIRE_FALSE(scaler.scale(nv12.view(), nv12.view()));
+    }
+}
+
+TEST_CASE("scaler_t reuses the filter banks", "[scale]") {
+    scaler_t scaler{scale_filter_t::bicubic};
+    const auto bank = scaler.get_filter_bank(1920, 1280);
+    REQUIRE(scaler.get_filter_bank(1920, 1280) == bank);
+    REQUIRE(scaler.get_filter_bank(1080, 720) != bank);
+    scaler.set_filter(scale_filter_t::bilinear);
+    REQUIRE(scaler.get_filter_bank(1920, 1280) != bank);
+}
+
+TEST_CASE("scaler_t SIMD matches scalar", "[scale]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420, pixel_format_t::rgb32);
+    const scale_filter_t filter = GENERATE(scale_filter_t::nearest, scale_filter_t::bilinear, scale_filter_t::bicubic,
+                                           scale_filter_t::area);
+    const auto [width, height] = GENERATE(pair{33u, 17u}, pair{320u, 240u}, pair{1u, 1u});
+    CAPTURE(static_cast<uint32_t>(format), get_name(filter), width, height);
+
+    frame_buffer_t src{format, 100, 60};
+    fill_random(src, width);
+    scaler_t scaler{filter};
+    scaler.set_source_rectangle({2, 4, 94, 52});
+    frame_buffer_t expected{format, width, height};
+    REQUIRE(scaler.scale(src.view(), expected.view(), simd_level_t::scalar));
+    for (simd_level_t level : {simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        CAPTURE(to_string(level));
+        frame_buffer_t actual{format, width, height};
+        REQUIRE(scaler.scale(src.view(), actual.view(), level));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+}
+
+TEST_CASE("scaler_t benchmark", "[scale][!benchmark]") {
+    const pair<pixel_format_t, const char*> formats[] = {{pixel_format_t::nv12, "NV12"},
+                                                         {pixel_format_t::rgb32, "RGB32"}};
+    for (auto [format, name] : formats) {
+        frame_buffer_t src{format, 1920, 1080};
+        fill_random(src, 3);
+        frame_buffer_t dst{format, 1280, 720};
+        for (scale_filter_t filter : {scale_filter_t::nearest, scale_filter_t::bilinear, scale_filter_t::bicubic,
+                                      scale_filter_t::area}) {
+            scaler_t scaler{filter};
+            for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+                if (clamp_simd_level(level) != level)
+                    continue;
+                BENCHMARK(string{name} + " " + get_name(filter) + "(" + to_string(level) + ") 1080p→720p") {
+                    return scaler.scale(src.view(), dst.view(), level);
+                };
+            }
+        }
+    }
+}
+
+TEST_CASE("scaler_t scale_to_rgb32", "[scale]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::i420);
+    const scale_filter_t filter = GENERATE(scale_filter_t::bilinear, scale_filter_t::bicubic, scale_filter_t::area);
+    const auto [width, height] = GENERATE(pair{33u, 17u}, pair{160u, 90u}, pair{255u, 131u});
+    CAPTURE(static_cast<uint32_t>(format), get_name(filter), width, height);
+    const yuv_color_t color{yuv_matrix_t::bt709, yuv_range_t::limited};
+
+    frame_buffer_t src{format, 200, 120};
+    fill_random(src, width * height);
+    scaler_t scaler{filter};
+    scaler.set_source_rectangle({10, 6, 150, 100});
+    // 3 pass chain
+    frame_buffer_t scaled{format, width, height};
+    frame_buffer_t expected{pixel_format_t::rgb32, width, height};
+    REQUIRE(scaler.scale(src.view(), scaled.view(), simd_level_t::scalar));
+    REQUIRE(convert_yuv_to_rgb32(scaled.view(), expected.view(), color, simd_level_t::scalar));
+
+    for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        CAPTURE(to_string(level));
+        frame_buffer_t actual{pixel_format_t::rgb32, width, height};
+        REQUIRE(scaler.scale_to_rgb32(src.view(), actual.view(), color, level));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+    SECTION("destination rectangle") {
+        // the chroma grid starts at the rectangle. same with the intermediate frame for the odd x/y too
+        const auto [x, y0] = GENERATE(pair{8u, 4u}, pair{7u, 3u});
+        frame_buffer_t actual{pixel_format_t::rgb32, width + 8, height + 4};
+        memset(actual.data(), 7, actual.size());
+        scaler.set_destination_rectangle({x, y0, width, height});
+        REQUIRE(scaler.scale_to_rgb32(src.view(), actual.view(), color));
+        REQUIRE(actual.plane(0).row(y0 - 1)[0] == 7);
+        for (uint32_t y = 0; y < height; ++y)
+            REQUIRE(memcmp(actual.plane(0).row(y + y0) + x * 4, expected.plane(0).row(y), width * 4) == 0);
+    }
+    SECTION("invalid arguments") {
+        REQUIRE_FALSE(scaler.scale_to_rgb32(src.view(), scaled.view()));
+        REQUIRE_FALSE(scaler.scale_to_rgb32(expected.view(), expected.view()));
+    }
+}
+
+/// @brief copy of the rectangle. the crop stage of the chain
+static void crop(const frame_view_t& src, const scale_rect_t& rect, const frame_view_t& dst) noexcept {
+    for (uint32_t y = 0; y < rect.height; ++y)
+        memcpy(dst.planes[0].row(y), src.planes[0].row(rect.y + y) + rect.x, rect.width);
+    for (uint32_t y = 0; y < rect.height / 2; ++y)
+        memcpy(dst.planes[1].row(y), src.planes[1].row(rect.y / 2 + y) + rect.x, rect.width);
+}
+
+TEST_CASE("scaler_t scale_to_rgb32 benchmark", "[scale][!benchmark]") {
+    // 1080p NV12 → crop 4:3 → 720p RGB32
+    const scale_rect_t rect{240, 0, 1440, 1080};
+    constexpr uint32_t width = 960, height = 720;
+    frame_buffer_t src{pixel_format_t::nv12, 1920, 1080};
+    fill_random(src, 4);
+    frame_buffer_t cropped{pixel_format_t::nv12, rect.width, rect.height};
+    frame_buffer_t scaled{pixel_format_t::nv12, width, height};
+    frame_buffer_t rgb32{pixel_format_t::rgb32, width, height};
+    const yuv_color_t color{yuv_matrix_t::bt709, yuv_range_t::limited};
+
+    // the bytes which are read and written in the main memory. the scratch rows are not counted
+    const double crop_bytes = static_cast<double>(get_contiguous_size(cropped.view()));
+    const double scaled_bytes = static_cast<double>(get_contiguous_size(scaled.view()));
+    const double rgb32_bytes = static_cast<double>(get_contiguous_size(rgb32.view()));
+    const double chain_traffic = 2 * crop_bytes + crop_bytes + scaled_bytes + scaled_bytes + rgb32_bytes;
+    const double fused_traffic = crop_bytes + rgb32_bytes;
+    WARN("3 pass: " << chain_traffic / 1e6 << " MB/frame, fused: " << fused_traffic / 1e6 << " MB/frame");
+
+    for (scale_filter_t filter : {scale_filter_t::bilinear, scale_filter_t::bicubic}) {
+        scaler_t resizer{filter};
+        scaler_t fused{filter};
+        fused.set_source_rectangle(rect);
+        const string suffix = string{" "} + get_name(filter) + "(" + to_string(get_simd_level()) + ")";
+        BENCHMARK("crop → resize → NV12→RGB32" + suffix) {
+            crop(src.view(), rect, cropped.view());
+            resizer.scale(cropped.view(), scaled.view());
+            return convert_yuv_to_rgb32(scaled.view(), rgb32.view(), color);
+        };
+        BENCHMARK("fused" + suffix) {
+            return fused.scale_to_rgb32(src.view(), rgb32.view(), color);
+        };
+    }
+}
@@ -0,0 +1,166 @@
+/**
+ * @file    slice_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <color_convert.hpp>
+#include <repack.hpp>
+#include <rgb565.hpp>
+#include <scale.hpp>
+#include <slice.hpp>
+#include "frame_helpers.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("get_row_alignment", "[slice]") {
+    SECTION("frame_buffer_t") {
+        REQUIRE(get_row_alignment(frame_buffer_t{pixel_format_t::rgb32, 33, 7}.view()) == 1);
+        REQUIRE(get_row_alignment(frame_buffer_t{pixel_format_t::yuy2, 33, 7}.view()) == 1);
+        REQUIRE(get_row_alignment(frame_buffer_t{pixel_format_t::nv12, 33, 7}.view()) == 2);
+        REQUIRE(get_row_alignment(frame_buffer_t{pixel_format_t::i420, 33, 7}.view()) == 2);
+    }
+    SECTION("odd pitch") {
+        vector<uint8_t> memory(100 * 64);
+        // 100 * 16 is the first multiple of 64
+        REQUIRE(get_row_alignment(make_frame_view(pixel_format_t::rgb32, 25, 64, memory.data(), 100)) == 16);
+        // the chroma pitch is 48. 2 luma rows for 1 chroma row
+        REQUIRE(get_row_alignment(make_frame_view(pixel_format_t::i420, 90, 32, memory.data(), 96)) == 8);
+    }
+}
+
+TEST_CASE("split_rows", "[slice]") {
+    const uint32_t height = GENERATE(1u, 7u, 720u, 1080u, 2160u);
+    const uint32_t alignment = GENERATE(1u, 2u, 16u);
+    const size_t count = GENERATE(size_t{1}, size_t{3}, size_t{8}, size_t{4096});
+    CAPTURE(height, alignment, count);
+
+    const vector<row_range_t> ranges = split_rows(height, alignment, count);
+    REQUIRE(ranges.size() > 0);
+    REQUIRE(ranges.size() <= count);
+    uint32_t next = 0;
+    for (const row_range_t& range : ranges) {
+        REQUIRE(range.begin == next);
+        REQUIRE(range.begin % alignment == 0);
+        REQUIRE(range.end > range.begin);
+        next = range.end;
+    }
+    REQUIRE(next == height);
+    REQUIRE(split_rows(0, alignment, count).empty());
+}
+
+TEST_CASE("parallel_rows writes the separate cache lines", "[slice]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::rgb32, pixel_format_t::nv12, pixel_format_t::i420);
+    frame_buffer_t frame{format, 1000, 300};
+    const frame_view_t& view = frame.view();
+    executor_t executor{4};
+    vector<row_range_t> ranges(300);
+    size_t count = 0;
+    REQUIRE(parallel_rows(executor, view, [&ranges, &count](row_range_t rows) {
+        ranges[rows.begin] = rows; // the begins are unique
+        return true;
+    }));
+    for (const row_range_t& range : ranges) {
+        if (range.end == UINT32_MAX)
+            continue;
+        ++count;
+        for (uint32_t i = 0; i < view.num_plane; ++i) {
+            const uint32_t row = format != pixel_format_t::rgb32 && i > 0 ? range.begin / 2 : range.begin;
+            REQUIRE(reinterpret_cast<uintptr_t>(view.planes[i].row(row)) % cache_line_size == 0);
+        }
+    }
+    REQUIRE(count >= executor.size());
+}
+
+TEST_CASE("parallel_rows matches the serial kernels", "[slice]") {
+    executor_t executor{3};
+    const uint32_t width = 333, height = 97;
+    const yuv_color_t color{yuv_matrix_t::bt709, yuv_range_t::limited};
+    frame_buffer_t nv12{pixel_format_t::nv12, width, height};
+    fill_random(nv12, 1);
+
+    SECTION("convert_yuv_to_rgb32") {
+        frame_buffer_t expected{pixel_format_t::rgb32, width, height};
+        frame_buffer_t actual{pixel_format_t::rgb32, width, height};
+        REQUIRE(convert_yuv_to_rgb32(nv12.view(), expected.view(), color));
+        REQUIRE(parallel_rows(executor, actual.view(), [&](row_range_t rows) {
+            return convert_yuv_to_rgb32(nv12.view(), actual.view(), color, get_simd_level(), rows);
+        }));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+    SECTION("repack_yuv") {
+        const pixel_format_t format = GENERATE(pixel_format_t::i420, pixel_format_t::yuy2);
+        frame_buffer_t expected{format, width, height};
+        frame_buffer_t actual{format, width, height};
+        REQUIRE(repack_yuv(nv12.view(), expected.view()));
+        REQUIRE(parallel_rows(executor, actual.view(), [&](row_range_t rows) {
+            return repack_yuv(nv12.view(), actual.view(), get_simd_level(), rows);
+        }));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+    SECTION("convert_rgb32_to_rgb565") {
+        frame_buffer_t rgb32{pixel_format_t::rgb32, width, height};
+        fill_random(rgb32, 2);
+        frame_buffer_t expected{pixel_format_t::rgb565, width, height};
+        frame_buffer_t actual{pixel_format_t::rgb565, width, height};
+        REQUIRE(convert_rgb32_to_rgb565(rgb32.view(), expected.view()));
+        REQUIRE(parallel_rows(executor, actual.view(), [&](row_range_t rows) {
+            return convert_rgb32_to_rgb565(rgb32.view(), actual.view(), dither_t::ordered, get_simd_level(), rows);
+        }));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+    SECTION("scaler_t") {
+        scaler_t scaler{scale_filter_t::bicubic};
+        scaler.set_source_rectangle({4, 2, 300, 90});
+        scaler.set_destination_rectangle({3, 5, 150, 40});
+        frame_buffer_t expected{pixel_format_t::nv12, 160, 50};
+        frame_buffer_t actual{pixel_format_t::nv12, 160, 50};
+        memset(expected.data(), 0, expected.size());
+        memset(actual.data(), 0, actual.size());
+        REQUIRE(scaler.scale(nv12.view(), expected.view()));
+        REQUIRE(parallel_rows(executor, actual.view(), [&](row_range_t rows) {
+            return scaler.scale(nv12.view(), actual.view(), get_simd_level(), rows);
+        }));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+
+        frame_buffer_t expected32{pixel_format_t::rgb32, 160, 50};
+        frame_buffer_t actual32{pixel_format_t::rgb32, 160, 50};
+        memset(expected32.data(), 0, expected32.size());
+        memset(actual32.data(), 0, actual32.size());
+        REQUIRE(scaler.scale_to_rgb32(nv12.view(), expected32.view(), color));
+        REQUIRE(parallel_rows(executor, actual32.view(), [&](row_range_t rows) {
+            return scaler.scale_to_rgb32(nv12.view(), actual32.view(), color, get_simd_level(), rows);
+        }));
+        REQUIRE(is_same_pixels(expected32.view(), actual32.view()));
+    }
+}
+
+TEST_CASE("parallel_rows benchmark", "[slice][!benchmark]") {
+    const yuv_color_t color{yuv_matrix_t::bt709, yuv_range_t::limited};
+    const pair<uint32_t, uint32_t> sizes[] = {{1920, 1080}, {3840, 2160}};
+    for (auto [width, height] : sizes) {
+        frame_buffer_t nv12{pixel_format_t::nv12, width, height};
+        fill_random(nv12, 3);
+        frame_buffer_t rgb32{pixel_format_t::rgb32, width, height};
+        frame_buffer_t half{pixel_format_t::nv12, width / 2, height / 2};
+        scaler_t scaler{scale_filter_t::bilinear};
+        const string suffix = " " + to_string(height) + "p";
+        for (size_t count : {1, 2, 4, 8}) {
+            executor_t executor{count};
+            const string threads = " " + to_string(count) + " thread(s)";
+            BENCHMARK("NV12→RGB32" + suffix + threads) {
+                return parallel_rows(executor, rgb32.view(), [&](row_range_t rows) {
+                    return convert_yuv_to_rgb32(nv12.view(), rgb32.view(), color, get_simd_level(), rows);
+                });
+            };
+            BENCHMARK("scale 1/2" + suffix + threads) {
+                return parallel_rows(executor, half.view(), [&](row_range_t rows) {
+                    return scaler.scale(nv12.view(), half.view(), get_simd_level(), rows);
+                });
+            };
+        }
+    }
+}
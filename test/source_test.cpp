@@ -6,6 +6,10 @@
 #define CATCH_CONFIG_WINDOWS_CRTDBG
 #include <catch2/catch.hpp>
 #include <spdlog/spdlog.h>
+#include "coroutine_helpers.hpp"
+
+#include <atomic>
+#include <future>
 
 using namespace std;
 namespace fs = std::filesystem;
@@ -96,6 +100,41 @@ TEST_CASE("MFCreateSourceReader", "[!mayfail]") {
     }
 }
 
+/// @note runs on the callback thread of the reader. The failures are asserted after `done`
+static detached_t count_samples(std::shared_ptr<sample_reader_t> reader, size_t& count, std::atomic<size_t>& nulls,
+                                std::promise<void>& done) {
+    while (auto sample = co_await reader->next()) {
+        if (*sample == nullptr)
+            ++nulls;
+        ++count;
+    }
+    done.set_value();
+}
+
+TEST_CASE("sample_reader_t") {
+    auto on_return = media_startup();
+
+    com_ptr<IMFMediaSourceEx> source{};
+    MF_OBJECT_TYPE media_object_type = MF_OBJECT_INVALID;
+    REQUIRE(resolve(get_asset_dir() / "fm5p7flyCSY.mp4", source.put(), media_object_type) == S_OK);
+
+    auto reader = std::make_shared<sample_reader_t>(3);
+    com_ptr<IMFSourceReaderCallback> callback{};
+    REQUIRE(create_reader_callback(reader, callback.put()) == S_OK);
+    com_ptr<IMFSourceReader> source_reader{};
+    REQUIRE(create_source_reader(source, callback, source_reader.put()) == S_OK);
+
+    size_t count = 0;
+    std::atomic<size_t> nulls = 0;
+    std::promise<void> done{};
+    auto finished = done.get_future();
+    REQUIRE(start_reading(*reader, source_reader.get()) == S_OK);
+    count_samples(reader, count, nulls, done);
+    REQUIRE(finished.wait_for(std::chrono::seconds{30}) == std::future_status::ready);
+    REQUIRE(count > 0);
+    REQUIRE(nulls == 0);
+}
+
 TEST_CASE("IMFSourceReaderEx(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING)") {
     auto on_return = media_startup();
 
@@ -145,3 +184,83 @@ TEST_CASE("IMFSourceReaderEx(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING)"
         REQUIRE(FAILED(hr));
     }
 }
+
+TEST_CASE("get_subtype") {
+    for (auto format : {pixel_format_t::nv12, pixel_format_t::i420, pixel_format_t::rgb32, pixel_format_t::rgb565,
+                        pixel_format_t::nv21, pixel_format_t::yuy2, pixel_format_t::uyvy, pixel_format_t::p010,
+                        pixel_format_t::p016})
+        REQUIRE(get_pixel_format(get_subtype(format)) == format);
+    REQUIRE(get_subtype(pixel_format_t::rgb32) == MFVideoFormat_RGB32);
+    REQUIRE(get_subtype(pixel_format_t::p010) == MFVideoFormat_P010);
+    // D3DFMT_A16B16G16R16 has no subtype. `MFVideoFormat_A16B16G16R16F` is the float one
+    REQUIRE(get_subtype(pixel_format_t::rgba16) == GUID_NULL);
+    REQUIRE(get_pixel_format(MFVideoFormat_A16B16G16R16F) == pixel_format_t::unknown);
+    REQUIRE(get_subtype(pixel_format_t::unknown) == GUID_NULL);
+}
+
+TEST_CASE("graph_builder_t(IMFSourceReader)") {
+    auto on_return = media_startup();
+
+    com_ptr<IMFMediaSourceEx> source{};
+    MF_OBJECT_TYPE media_object_type = MF_OBJECT_INVALID;
+    REQUIRE(resolve(get_asset_dir() / "fm5p7flyCSY.mp4", source.put(), media_object_type) == S_OK);
+
+    com_ptr<IMFSourceReader> source_reader{};
+    {
+        com_ptr<IMFAttributes> attrs{};
+        REQUIRE(MFCreateAttributes(attrs.put(), 1) == S_OK);
+        REQUIRE(attrs->SetUINT32(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING, TRUE) == S_OK);
+        REQUIRE(MFCreateSourceReaderFromMediaSource(source.get(), attrs.get(), source_reader.put()) == S_OK);
+    }
+    const auto reader_stream = static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM);
+
+    using graph_t = graph_builder_t<com_ptr<IMFSample>>;
+    graph_t graph{};
+    // the reader can decode to NV12 or RGB32. the negotiation happens once, here
+    graph.set_source("reader", {pixel_format_t::nv12, pixel_format_t::rgb32},
+                     [source_reader, reader_stream](pixel_format_t format) -> graph_t::source_t {
+                         com_ptr<IMFMediaType> output_type{};
+                         winrt::check_hresult(source_reader->GetCurrentMediaType(reader_stream, output_type.put()));
+                         winrt::check_hresult(output_type->SetGUID(MF_MT_SUBTYPE, get_subtype(format)));
+                         winrt::check_hresult(source_reader->SetCurrentMediaType(reader_stream, NULL, output_type.get()));
+                         return [source_reader, reader_stream](com_ptr<IMFSample>& sample) {
+                             DWORD stream_index = 0, flags = 0;
+                             LONGLONG timestamp = 0;
+                             do {
+                                 sample = nullptr;
+                                 winrt::check_hresult(source_reader->ReadSample(reader_stream, 0, &stream_index, &flags,
+                                                                                &timestamp, sample.put()));
+                                 if (flags & MF_SOURCE_READERF_ENDOFSTREAM)
+                                     return false;
+                             } while (sample == nullptr);
+                             return true;
+                         };
+                     });
+    size_t converted = 0;
+    graph.add_converter("NV12→RGB32", pixel_format_t::nv12, pixel_format_t::rgb32, [&converted]() -> graph_t::process_t {
+        ++converted;
+        return [](com_ptr<IMFSample>&& sample, const auto& emit) { emit(std::move(sample)); };
+    });
+    size_t count = 0;
+    pixel_format_t sink_format = pixel_format_t::unknown;
+    graph.set_sink("counter", {pixel_format_t::rgb32}, [&count, &sink_format](pixel_format_t format) -> graph_t::sink_t {
+        sink_format = format;
+        return [&count](com_ptr<IMFSample>&&) { ++count; };
+    });
+
+    pipeline_t<com_ptr<IMFSample>> pipeline{3};
+    const graph_plan_t plan = graph.build(pipeline);
+    REQUIRE(plan.conversions == 0); // the reader produces RGB32 directly
+    REQUIRE(converted == 0);
+    REQUIRE(sink_format == pixel_format_t::rgb32);
+
+    com_ptr<IMFMediaType> current{};
+    REQUIRE(source_reader->GetCurrentMediaType(reader_stream, current.put()) == S_OK);
+    GUID subtype{};
+    REQUIRE(current->GetGUID(MF_MT_SUBTYPE, &subtype) == S_OK);
+    REQUIRE(get_pixel_format(subtype) == pixel_format_t::rgb32);
+
+    pipeline.start();
+    pipeline.wait();
+    REQUIRE(count > 0);
+}
@@ -0,0 +1,182 @@
+/**
+ * @file    spsc_ring_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <bounded_queue.hpp>
+#include <spsc_ring.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("spsc_ring_t", "[thread]") {
+    spsc_ring_t<int> ring{6};
+    REQUIRE(ring.capacity() == 8);
+    REQUIRE(ring.size_approx() == 0);
+
+    SECTION("push/pop") {
+        int item = 0;
+        REQUIRE_FALSE(ring.try_pop(item));
+        for (int i = 0; i < 8; ++i)
+            REQUIRE(ring.try_push(move(i)));
+        REQUIRE_FALSE(ring.try_push(8)); // full
+        REQUIRE(ring.size_approx() == 8);
+        for (int i = 0; i < 8; ++i) {
+            REQUIRE(ring.try_pop(item));
+            REQUIRE(item == i);
+        }
+        REQUIRE_FALSE(ring.try_pop(item));
+    }
+    SECTION("wrap around") {
+        int item = 0;
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(ring.try_push(move(i)));
+            REQUIRE(ring.try_pop(item));
+            REQUIRE(item == i);
+        }
+    }
+    SECTION("batch") {
+        int items[12]{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+        REQUIRE(ring.try_push(items, 5) == 5);
+        REQUIRE(ring.try_push(items + 5, 7) == 3); // partial
+        int outputs[12]{};
+        REQUIRE(ring.try_pop(outputs, 3) == 3);
+        REQUIRE(outputs[2] == 2);
+        REQUIRE(ring.try_pop(outputs, 12) == 5);
+        REQUIRE(outputs[4] == 7);
+    }
+    SECTION("invalid capacity") {
+        REQUIRE_THROWS_AS(spsc_ring_t<int>{0}, invalid_argument);
+    }
+}
+
+TEST_CASE("spsc_ring_t releases the handle", "[thread]") {
+    spsc_ring_t<shared_ptr<int>> ring{4};
+    auto handle = make_shared<int>(1);
+    REQUIRE(ring.try_push(shared_ptr<int>{handle}));
+    REQUIRE(handle.use_count() == 2);
+    {
+        shared_ptr<int> item{};
+        REQUIRE(ring.try_pop(item));
+    }
+    REQUIRE(handle.use_count() == 1);
+
+    spsc_ring_t<unique_ptr<int>> unique_ring{4}; // move-only
+    REQUIRE(unique_ring.try_push(make_unique<int>(2)));
+}
+
+TEST_CASE("spsc_ring_t stress", "[thread]") {
+    constexpr uint64_t count = 1'000'000;
+    spsc_ring_t<uint64_t> ring{256};
+    atomic_uint32_t failures{0};
+
+    thread producer{[&ring]() {
+        uint64_t items[16]{};
+        for (uint64_t next = 0; next < count;) {
+            // mix the single and batch push
+            if (next % 3 == 0) {
+                uint64_t item = next;
+                if (ring.try_push(move(item)))
+                    ++next;
+                else
+                    this_thread::yield();
+                continue;
+            }
+            const size_t n = static_cast<size_t>(min<uint64_t>(16, count - next));
+            for (size_t i = 0; i < n; ++i)
+                items[i] = next + i;
+            const size_t pushed = ring.try_push(items, n);
+            if (pushed == 0)
+                this_thread::yield();
+            next += pushed;
+        }
+    }};
+    uint64_t expected = 0;
+    uint64_t items[32]{};
+    while (expected < count) {
+        const size_t n = ring.try_pop(items, 32);
+        if (n == 0)
+            this_thread::yield();
+        for (size_t i = 0; i < n; ++i, ++expected)
+            if (items[i] != expected)
+                ++failures;
+    }
+    producer.join();
+    REQUIRE(failures == 0);
+    REQUIRE(ring.size_approx() == 0);
+}
+
+TEST_CASE("spsc_ring_t benchmark", "[thread][!benchmark]") {
+    constexpr uint64_t count = 200'000;
+    BENCHMARK("throughput bounded_queue_t") {
+        bounded_queue_t<uint64_t> queue{256};
+        thread producer{[&queue]() {
+            for (uint64_t i = 0; i < count; ++i)
+                queue.push(uint64_t{i});
+            queue.close();
+        }};
+        uint64_t sum = 0;
+        for (uint64_t item = 0; queue.pop(item);)
+            sum += item;
+        producer.join();
+        return sum;
+    };
+    for (size_t batch : {1u, 32u}) {
+        BENCHMARK("throughput spsc_ring_t(batch " + to_string(batch) + ")") {
+            spsc_ring_t<uint64_t> ring{256};
+            thread producer{[&ring, batch]() {
+                vector<uint64_t> items(batch);
+                for (uint64_t next = 0; next < count;) {
+                    const size_t n = static_cast<size_t>(min<uint64_t>(batch, count - next));
+                    for (size_t i = 0; i < n; ++i)
+                        items[i] = next + i;
+                    const size_t pushed = ring.try_push(items.data(), n);
+                    if (pushed == 0)
+                        this_thread::yield();
+                    next += pushed;
+                }
+            }};
+            vector<uint64_t> items(batch);
+            uint64_t sum = 0;
+            for (uint64_t received = 0; received < count;) {
+                const size_t n = ring.try_pop(items.data(), batch);
+                if (n == 0)
+                    this_thread::yield();
+                for (size_t i = 0; i < n; ++i)
+                    sum += items[i];
+                received += n;
+            }
+            producer.join();
+            return sum;
+        };
+    }
+    // round trip latency: ping → pong
+    BENCHMARK("latency spsc_ring_t(1000 round trips)") {
+        spsc_ring_t<uint64_t> ping{16}, pong{16};
+        thread echo{[&ping, &pong]() {
+            for (uint64_t i = 0; i < 1000; ++i) {
+                uint64_t item = 0;
+                while (ping.try_pop(item) == false)
+                    this_thread::yield();
+                while (pong.try_push(move(item)) == false)
+                    this_thread::yield();
+            }
+        }};
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < 1000; ++i) {
+            uint64_t item = i;
+            while (ping.try_push(move(item)) == false)
+                this_thread::yield();
+            while (pong.try_pop(item) == false)
+                this_thread::yield();
+            sum += item;
+        }
+        echo.join();
+        return sum;
+    };
+}
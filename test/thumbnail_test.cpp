@@ -0,0 +1,165 @@
+/**
+ * @file    thumbnail_test.cpp
+ * @author  github.com/luncliff (luncliff@gmail.com)
+ */
+#include <catch2/catch.hpp>
+#include <repack.hpp>
+#include <thumbnail.hpp>
+#include "frame_helpers.hpp"
+
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+/// @brief average of the box with the division. the chroma box of the row `y` is same with `make_thumbnail`
+static frame_buffer_t make_thumbnail_reference(const frame_buffer_t& nv12, uint32_t factor, yuv_color_t color) {
+    const uint32_t width = nv12.width() / factor, height = nv12.height() / factor;
+    frame_buffer_t dst{pixel_format_t::rgb32, width, height};
+    const uint32_t chroma_rows = max(factor / 2, 1u);
+    const uint32_t pairs = nv12.plane(1).row_bytes / 2;
+    for (uint32_t y = 0; y < height; ++y) {
+        frame_buffer_t row{pixel_format_t::nv12, width, 1};
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t sum = 0;
+            for (uint32_t r = 0; r < factor; ++r)
+                for (uint32_t c = 0; c < factor; ++c)
+                    sum += nv12.plane(0).row(y * factor + r)[x * factor + c];
+            row.plane(0).row(0)[x] = static_cast<uint8_t>((sum + factor * factor / 2) / (factor * factor));
+        }
+        for (uint32_t p = 0; p < (width + 1) / 2; ++p) {
+            for (uint32_t i = 0; i < 2; ++i) {
+                uint32_t sum = 0;
+                for (uint32_t r = 0; r < chroma_rows; ++r)
+                    for (uint32_t c = 0; c < factor; ++c)
+                        sum += nv12.plane(1).row(y * factor / 2 + r)[2 * min(p * factor + c, pairs - 1) + i];
+                const uint32_t count = chroma_rows * factor;
+                row.plane(1).row(0)[2 * p + i] = static_cast<uint8_t>((sum + count / 2) / count);
+            }
+        }
+        frame_buffer_t rgb32{pixel_format_t::rgb32, width, 1};
+        REQUIRE(convert_yuv_to_rgb32(row.view(), rgb32.view(), color, simd_level_t::scalar));
+        memcpy(dst.plane(0).row(y), rgb32.plane(0).row(0), dst.plane(0).row_bytes);
+    }
+    return dst;
+}
+
+TEST_CASE("thumbnail factor", "[thumbnail]") {
+    REQUIRE(is_thumbnail_factor(1));
+    REQUIRE(is_thumbnail_factor(4));
+    REQUIRE(is_thumbnail_factor(16));
+    REQUIRE_FALSE(is_thumbnail_factor(0));
+    REQUIRE_FALSE(is_thumbnail_factor(3));
+    REQUIRE_FALSE(is_thumbnail_factor(32));
+    REQUIRE(is_thumbnail_source(pixel_format_t::yuy2));
+    REQUIRE_FALSE(is_thumbnail_source(pixel_format_t::i420));
+
+    frame_buffer_t src{pixel_format_t::nv12, 64, 48};
+    frame_buffer_t dst{pixel_format_t::rgb32, 16, 12};
+    frame_buffer_t small{pixel_format_t::rgb32, 8, 6};
+    REQUIRE(make_thumbnail(src.view(), dst.view(), 4));
+    REQUIRE_FALSE(make_thumbnail(src.view(), dst.view(), 3));
+    REQUIRE_FALSE(make_thumbnail(src.view(), small.view(), 4));
+    REQUIRE_FALSE(make_thumbnail(src.view(), src.view(), 1));
+    // the planes must match the width/height of the view
+    frame_view_t empty = src.view();
+    empty.num_plane = 0;
+    REQUIRE_FALSE(make_thumbnail(empty, dst.view(), 4));
+    frame_view_t narrow = src.view();
+    narrow.width = 128;
+    narrow.height = 96;
+    REQUIRE_FALSE(make_thumbnail(narrow, dst.view(), 8));
+    frame_view_t short_rows = dst.view();
+    short_rows.planes[0].rows = 11;
+    REQUIRE_FALSE(make_thumbnail(src.view(), short_rows, 4));
+}
+
+TEST_CASE("make_thumbnail", "[thumbnail]") {
+    const simd_level_t level = simd_level_t::scalar;
+    const yuv_color_t color{yuv_matrix_t::bt709, yuv_range_t::limited};
+
+    SECTION("solid color") {
+        frame_buffer_t nv12{pixel_format_t::nv12, 32, 32};
+        memset(nv12.plane(0).data, 235, nv12.plane(0).pitch * nv12.plane(0).rows);
+        memset(nv12.plane(1).data, 128, nv12.plane(1).pitch * nv12.plane(1).rows);
+        frame_buffer_t dst{pixel_format_t::rgb32, 4, 4};
+        REQUIRE(make_thumbnail(nv12.view(), dst.view(), 8, color, level));
+        for (uint32_t y = 0; y < 4; ++y)
+            for (uint32_t x = 0; x < 4 * 4; ++x)
+                REQUIRE(dst.plane(0).row(y)[x] == 255);
+    }
+    SECTION("average of the box") {
+        const uint32_t factor = GENERATE(1u, 2u, 4u, 8u, 16u);
+        const uint32_t width = GENERATE(48u, 81u), height = GENERATE(32u, 37u);
+        CAPTURE(factor, width, height);
+        frame_buffer_t nv12{pixel_format_t::nv12, width, height};
+        fill_random(nv12, width * height);
+        frame_buffer_t expected = make_thumbnail_reference(nv12, factor, color);
+        frame_buffer_t actual{pixel_format_t::rgb32, width / factor, height / factor};
+        REQUIRE(make_thumbnail(nv12.view(), actual.view(), factor, color, level));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+    SECTION("YUY2/UYVY with the repeated chroma rows") {
+        const uint32_t factor = GENERATE(1u, 2u, 4u);
+        const pixel_format_t format = GENERATE(pixel_format_t::yuy2, pixel_format_t::uyvy);
+        CAPTURE(factor, static_cast<uint32_t>(format));
+        frame_buffer_t nv12{pixel_format_t::nv12, 64, 32};
+        fill_random(nv12, factor);
+        frame_buffer_t packed{format, 64, 32};
+        REQUIRE(repack_yuv(nv12.view(), packed.view(), level));
+        frame_buffer_t expected{pixel_format_t::rgb32, 64 / factor, 32 / factor};
+        frame_buffer_t actual{pixel_format_t::rgb32, 64 / factor, 32 / factor};
+        REQUIRE(make_thumbnail(nv12.view(), expected.view(), factor, color, level));
+        REQUIRE(make_thumbnail(packed.view(), actual.view(), factor, color, level));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+    SECTION("rows") {
+        frame_buffer_t nv12{pixel_format_t::nv12, 256, 128};
+        fill_random(nv12, 9);
+        frame_buffer_t expected{pixel_format_t::rgb32, 64, 32};
+        frame_buffer_t actual{pixel_format_t::rgb32, 64, 32};
+        REQUIRE(make_thumbnail(nv12.view(), expected.view(), 4, color, level));
+        for (row_range_t rows : split_rows(32, 1, 5))
+            REQUIRE(make_thumbnail(nv12.view(), actual.view(), 4, color, level, rows));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+}
+
+TEST_CASE("thumbnail SIMD matches scalar", "[thumbnail]") {
+    const pixel_format_t format = GENERATE(pixel_format_t::nv12, pixel_format_t::yuy2, pixel_format_t::uyvy);
+    const uint32_t factor = GENERATE(1u, 2u, 4u, 8u, 16u);
+    const uint32_t width = GENERATE(2u, 33u, 95u, 640u);
+    CAPTURE(static_cast<uint32_t>(format), factor, width);
+    frame_buffer_t src{format, width * factor + factor / 2, 3 * factor}; // with the remainder
+    fill_random(src, width * factor);
+    frame_buffer_t expected{pixel_format_t::rgb32, width, 3};
+    REQUIRE(make_thumbnail(src.view(), expected.view(), factor, {}, simd_level_t::scalar));
+    for (simd_level_t level : {simd_level_t::sse41, simd_level_t::avx2}) {
+        if (clamp_simd_level(level) != level)
+            continue;
+        CAPTURE(to_string(level));
+        frame_buffer_t actual{pixel_format_t::rgb32, width, 3};
+        REQUIRE(make_thumbnail(src.view(), actual.view(), factor, {}, level));
+        REQUIRE(is_same_pixels(expected.view(), actual.view()));
+    }
+}
+
+TEST_CASE("thumbnail benchmark", "[thumbnail][!benchmark]") {
+    constexpr uint32_t width = 3840, height = 2160;
+    for (pixel_format_t format : {pixel_format_t::nv12, pixel_format_t::yuy2}) {
+        frame_buffer_t src{format, width, height};
+        fill_random(src, 11);
+        for (uint32_t factor : {4u, 8u}) {
+            frame_buffer_t dst{pixel_format_t::rgb32, width / factor, height / factor};
+            for (simd_level_t level : {simd_level_t::scalar, simd_level_t::sse41, simd_level_t::avx2}) {
+                if (clamp_simd_level(level) != level)
+                    continue;
+                const string suffix = "(" + string{to_string(level)} + ") 4K " +
+                                      (format == pixel_format_t::nv12 ? "NV12" : "YUY2") + " 1/" + to_string(factor);
+                BENCHMARK("thumbnail" + suffix) {
+                    return make_thumbnail(src.view(), dst.view(), factor, {}, level);
+                };
+            }
+        }
+    }
+}
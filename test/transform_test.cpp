@@ -6,6 +6,7 @@
 #define CATCH_CONFIG_WINDOWS_CRTDBG
 #include <catch2/catch.hpp>
 #include <spdlog/spdlog.h>
+#include "frame_helpers.hpp"
 
 #include <filesystem>
 
@@ -25,26 +26,10 @@ void make_test_source(com_ptr<IMFMediaSourceEx>& source, com_ptr<IMFSourceReader
                       const GUID& output_subtype, const fs::path& fpath);
 
 HRESULT check_sample(com_ptr<IMFSample> sample) {
-    com_ptr<IMFMediaBuffer> buffer{};
-    {
-        DWORD num_buffer = 0;
-        if (auto hr = sample->GetBufferCount(&num_buffer))
-            return hr;
-        if (num_buffer > 1) {
-            if (auto hr = sample->ConvertToContiguousBuffer(buffer.put()))
-                return hr;
-        } else {
-            sample->GetBufferByIndex(0, buffer.put());
-        }
-    }
-    DWORD bufsz{};
-    if (auto hr = buffer->GetCurrentLength(&bufsz))
-        return hr;
-    BYTE* ptr = NULL;
-    DWORD capacity = 0, length = 0;
-    if (auto hr = buffer->Lock(&ptr, &capacity, &length))
+    // visit the buffers without `ConvertToContiguousBuffer`
+    sample_spans_t spans{};
+    if (auto hr = spans.lock(sample.get()))
         return hr;
-    auto on_return = gsl::finally([buffer]() { buffer->Unlock(); });
     // consume the IMFSample
     return S_OK;
 }
@@ -99,6 +84,427 @@ HRESULT consume(com_ptr<IMFSourceReader> source_reader, com_ptr<IMFTransform> tr
     }
 }
 
+TEST_CASE("create_single_buffer_sample(frame_pool_t)") {
+    auto on_return = media_startup();
+
+    frame_pool_t pool{};
+    const DWORD bufsz = 1920 * 1080 * 3 / 2; // NV12
+    for (auto i = 0; i < 3; ++i) {
+        com_ptr<IMFSample> sample{};
+        REQUIRE(create_single_buffer_sample(pool, sample.put(), bufsz) == S_OK);
+        com_ptr<IMFMediaBuffer> buffer{};
+        REQUIRE(sample->GetBufferByIndex(0, buffer.put()) == S_OK);
+        DWORD capacity = 0;
+        REQUIRE(buffer->GetMaxLength(&capacity) == S_OK);
+        REQUIRE(capacity == bufsz);
+        REQUIRE(buffer->SetCurrentLength(bufsz) == S_OK);
+        REQUIRE(check_sample(sample) == S_OK);
+        // the recycled sample must not carry the previous owner's state
+        UINT32 count = 0;
+        REQUIRE(sample->GetCount(&count) == S_OK);
+        REQUIRE(count == 0);
+        REQUIRE(sample->SetUINT32(MFSampleExtension_Discontinuity, TRUE) == S_OK);
+        REQUIRE(sample->SetSampleTime(333'333 * (i + 1)) == S_OK);
+        buffer = nullptr;
+        sample = nullptr;
+        // the sample is recycled in the work queue. wait for its buffer
+        for (auto retry = 0; retry < 100 && pool.stats().outstanding > 0; ++retry)
+            SleepEx(10, true);
+    }
+    const auto stats = pool.stats();
+    print(stats);
+    REQUIRE(stats.miss == 1);
+    REQUIRE(stats.hit == 2);
+    REQUIRE(stats.outstanding == 0);
+}
+
+TEST_CASE("create_media_buffer(frame_buffer_t)") {
+    auto on_return = media_startup();
+
+    frame_buffer_t frame{pixel_format_t::nv12, 1366, 768};
+    const auto pitch = frame.pitch();
+    BYTE* const data = frame.data();
+    data[pitch] = 0;
+
+    com_ptr<IMFMediaBuffer> buffer{};
+    REQUIRE(create_media_buffer(std::move(frame), buffer.put()) == S_OK);
+    com_ptr<IMF2DBuffer> buffer2d{};
+    REQUIRE(buffer->QueryInterface(buffer2d.put()) == S_OK);
+
+    BYTE* scanline0 = nullptr;
+    LONG stride = 0;
+    REQUIRE(buffer2d->Lock2D(&scanline0, &stride) == S_OK);
+    REQUIRE(scanline0 == data);
+    REQUIRE(stride == static_cast<LONG>(pitch));
+    REQUIRE(buffer2d->Unlock2D() == S_OK);
+
+    BOOL contiguous = TRUE;
+    REQUIRE(buffer2d->IsContiguousFormat(&contiguous) == S_OK);
+    REQUIRE_FALSE(contiguous);
+    DWORD length = 0;
+    REQUIRE(buffer2d->GetContiguousLength(&length) == S_OK);
+    REQUIRE(length == 1366 * 768 * 3 / 2);
+
+    BYTE* ptr = nullptr;
+    REQUIRE(buffer->Lock(&ptr, nullptr, nullptr) == S_OK);
+    REQUIRE(ptr != data); // contiguous copy for the padded rows
+    BYTE* nested = nullptr;
+    REQUIRE(buffer->Lock(&nested, nullptr, nullptr) == S_OK);
+    REQUIRE(nested == ptr);
+    REQUIRE(buffer2d->Lock2D(&scanline0, &stride) == MF_E_UNEXPECTED);
+    ptr[1366] = 0x7F; // the first byte of the 2nd row
+    REQUIRE(buffer->Unlock() == S_OK);
+    REQUIRE(data[pitch] != 0x7F); // written back with the last `Unlock`
+    REQUIRE(buffer->Unlock() == S_OK);
+    REQUIRE(data[pitch] == 0x7F);
+    REQUIRE(buffer->Unlock() == MF_E_INVALIDREQUEST);
+}
+
+TEST_CASE("create_thumbnail_sample") {
+    auto on_return = media_startup();
+
+    com_ptr<IMFMediaType> type{};
+    REQUIRE(make_video_type(type.put(), MFVideoFormat_NV12) == S_OK);
+    REQUIRE(MFSetAttributeSize(type.get(), MF_MT_FRAME_SIZE, 66, 48) == S_OK);
+    frame_buffer_t frame{pixel_format_t::nv12, 66, 48}; // padded rows. locked with `IMF2DBuffer` in place
+    fill_random(frame, 4);
+    frame_buffer_t expected{pixel_format_t::rgb32, 16, 12};
+    REQUIRE(make_thumbnail(frame.view(), expected.view(), 4));
+
+    com_ptr<IMFMediaBuffer> buffer{};
+    REQUIRE(create_media_buffer(std::move(frame), buffer.put()) == S_OK);
+    com_ptr<IMFSample> sample{};
+    REQUIRE(MFCreateSample(sample.put()) == S_OK);
+    REQUIRE(sample->AddBuffer(buffer.get()) == S_OK);
+
+    com_ptr<IMFSample> thumbnail{};
+    REQUIRE(create_thumbnail_sample(sample.get(), type.get(), 4, thumbnail.put()) == S_OK);
+    com_ptr<IMFMediaBuffer> output{};
+    REQUIRE(thumbnail->GetBufferByIndex(0, output.put()) == S_OK);
+    com_ptr<IMF2DBuffer> output2d = output.as<IMF2DBuffer>();
+    BYTE* data = nullptr;
+    LONG pitch = 0;
+    REQUIRE(output2d->Lock2D(&data, &pitch) == S_OK);
+    const frame_view_t view = make_frame_view(pixel_format_t::rgb32, 16, 12, data, static_cast<size_t>(pitch));
+    const bool same = is_same_pixels(expected.view(), view);
+    REQUIRE(output2d->Unlock2D() == S_OK);
+    REQUIRE(same);
+    REQUIRE(create_thumbnail_sample(sample.get(), type.get(), 3, thumbnail.put()) == E_INVALIDARG);
+}
+
+TEST_CASE("create_oriented_sample") {
+    auto on_return = media_startup();
+
+    com_ptr<IMFMediaType> type{};
+    REQUIRE(make_video_type(type.put(), MFVideoFormat_NV12) == S_OK);
+    REQUIRE(MFSetAttributeSize(type.get(), MF_MT_FRAME_SIZE, 6, 4) == S_OK);
+    frame_buffer_t frame{pixel_format_t::nv12, 6, 4};
+    fill_random(frame, 6);
+    frame_buffer_t expected{pixel_format_t::nv12, 4, 6};
+    REQUIRE(orient(frame.view(), expected.view(), orientation_t::rotate_90));
+
+    com_ptr<IMFMediaBuffer> buffer{};
+    REQUIRE(create_media_buffer(std::move(frame), buffer.put()) == S_OK);
+    com_ptr<IMFSample> sample{};
+    REQUIRE(MFCreateSample(sample.put()) == S_OK);
+    REQUIRE(sample->AddBuffer(buffer.get()) == S_OK);
+    REQUIRE(sample->SetSampleTime(333) == S_OK);
+
+    SECTION("identity returns the sample") {
+        com_ptr<IMFSample> oriented{};
+        REQUIRE(create_oriented_sample(sample.get(), type.get(), oriented.put()) == S_OK);
+        REQUIRE(oriented == sample);
+    }
+    SECTION("rotate_90") {
+        com_ptr<IMFAttributes> metadata{};
+        REQUIRE(MFCreateAttributes(metadata.put(), 1) == S_OK);
+        REQUIRE(metadata->SetUINT32(MF_CAPTURE_METADATA_ORIENTATION, 6) == S_OK);
+        REQUIRE(sample->SetUnknown(MFSampleExtension_CaptureMetadata, metadata.get()) == S_OK);
+
+        com_ptr<IMFSample> oriented{};
+        REQUIRE(create_oriented_sample(sample.get(), type.get(), oriented.put()) == S_OK);
+        REQUIRE(oriented != sample);
+        REQUIRE(get_orientation(oriented.get()) == orientation_t::identity);
+        REQUIRE(get_orientation(sample.get()) == orientation_t::rotate_90);
+        LONGLONG time = 0;
+        REQUIRE(oriented->GetSampleTime(&time) == S_OK);
+        REQUIRE(time == 333);
+
+        com_ptr<IMFMediaBuffer> output{};
+        REQUIRE(oriented->GetBufferByIndex(0, output.put()) == S_OK);
+        com_ptr<IMF2DBuffer> output2d = output.as<IMF2DBuffer>();
+        BYTE* data = nullptr;
+        LONG pitch = 0;
+        REQUIRE(output2d->Lock2D(&data, &pitch) == S_OK);
+        const frame_view_t view = make_frame_view(pixel_format_t::nv12, 4, 6, data, static_cast<size_t>(pitch));
+        const bool same = is_same_pixels(expected.view(), view);
+        REQUIRE(output2d->Unlock2D() == S_OK);
+        REQUIRE(same);
+    }
+}
+
+TEST_CASE("create_deinterlaced_sample") {
+    auto on_return = media_startup();
+
+    com_ptr<IMFMediaType> type{};
+    REQUIRE(make_video_type(type.put(), MFVideoFormat_NV12) == S_OK);
+    REQUIRE(MFSetAttributeSize(type.get(), MF_MT_FRAME_SIZE, 64, 48) == S_OK);
+    frame_buffer_t frame{pixel_format_t::nv12, 64, 48};
+    fill_random(frame, 19);
+
+    com_ptr<IMFMediaBuffer> buffer{};
+    REQUIRE(create_media_buffer(std::move(frame), buffer.put()) == S_OK);
+    com_ptr<IMFSample> sample{};
+    REQUIRE(MFCreateSample(sample.put()) == S_OK);
+    REQUIRE(sample->AddBuffer(buffer.get()) == S_OK);
+    REQUIRE(sample->SetSampleTime(333) == S_OK);
+
+    SECTION("progressive returns the sample") {
+        REQUIRE(type->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive) == S_OK);
+        deinterlacer_t deinterlacer{get_interlace_mode(type.get())};
+        com_ptr<IMFSample> deinterlaced{};
+        REQUIRE(create_deinterlaced_sample(sample.get(), type.get(), deinterlacer, deinterlaced.put()) == S_OK);
+        REQUIRE(deinterlaced == sample);
+    }
+    SECTION("upper_first") {
+        REQUIRE(type->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_FieldInterleavedUpperFirst) == S_OK);
+        REQUIRE(get_sample_fields(sample.get(), get_interlace_mode(type.get())).interlaced);
+        deinterlacer_t deinterlacer{get_interlace_mode(type.get())};
+        com_ptr<IMFSample> deinterlaced{};
+        REQUIRE(create_deinterlaced_sample(sample.get(), type.get(), deinterlacer, deinterlaced.put()) == S_OK);
+        REQUIRE(deinterlaced != sample);
+        REQUIRE(get_sample_fields(deinterlaced.get(), get_interlace_mode(type.get())).interlaced == false);
+        LONGLONG time = 0;
+        REQUIRE(deinterlaced->GetSampleTime(&time) == S_OK);
+        REQUIRE(time == 333);
+
+        // the first frame has no previous frame, so `blend` works like `bob`
+        BYTE* data = nullptr;
+        LONG pitch = 0;
+        com_ptr<IMF2DBuffer> input2d = buffer.as<IMF2DBuffer>();
+        REQUIRE(input2d->Lock2D(&data, &pitch) == S_OK);
+        frame_buffer_t expected{pixel_format_t::nv12, 64, 48};
+        const bool processed =
+            deinterlace(make_frame_view(pixel_format_t::nv12, 64, 48, data, static_cast<size_t>(pitch)), {},
+                        expected.view(), deinterlace_t::blend, 0);
+        REQUIRE(input2d->Unlock2D() == S_OK);
+        REQUIRE(processed);
+
+        com_ptr<IMFMediaBuffer> output{};
+        REQUIRE(deinterlaced->GetBufferByIndex(0, output.put()) == S_OK);
+        com_ptr<IMF2DBuffer> output2d = output.as<IMF2DBuffer>();
+        REQUIRE(output2d->Lock2D(&data, &pitch) == S_OK);
+        const frame_view_t view = make_frame_view(pixel_format_t::nv12, 64, 48, data, static_cast<size_t>(pitch));
+        const bool same = is_same_pixels(expected.view(), view);
+        REQUIRE(output2d->Unlock2D() == S_OK);
+        REQUIRE(same);
+    }
+    SECTION("mixed without the sample attributes") {
+        REQUIRE(type->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_MixedInterlaceOrProgressive) == S_OK);
+        REQUIRE(get_sample_fields(sample.get(), get_interlace_mode(type.get())).interlaced == false);
+    }
+}
+
+TEST_CASE("set_capture_histogram") {
+    auto on_return = media_startup();
+
+    auto histogram = std::make_unique<histogram_t>();
+    histogram->width = 64;
+    histogram->height = 48;
+    histogram->channel_mask = histogram_channel_r | histogram_channel_g | histogram_channel_b;
+    histogram->fourcc = MFVideoFormat_RGB32.Data1;
+    for (uint32_t i = 0; i < 256; ++i) {
+        histogram->p0[i] = i;
+        histogram->p1[i] = 1000 + i;
+        histogram->p2[i] = 2000 + i;
+    }
+    com_ptr<IMFAttributes> metadata{};
+    REQUIRE(MFCreateAttributes(metadata.put(), 1) == S_OK);
+    REQUIRE(set_capture_histogram(metadata.get(), *histogram) == S_OK);
+
+    using blob_t = histogram_blob_t<4>;
+    static_assert(sizeof(blob_t) == sizeof(HistogramBlobHeader) + sizeof(HistogramHeader) +
+                                        4 * (sizeof(HistogramDataHeader) + 256 * sizeof(ULONG)));
+    UINT32 size = 0;
+    REQUIRE(metadata->GetBlobSize(MF_CAPTURE_METADATA_HISTOGRAM, &size) == S_OK);
+    REQUIRE(size == sizeof(blob_t));
+    auto blob = std::make_unique<blob_t>();
+    REQUIRE(metadata->GetBlob(MF_CAPTURE_METADATA_HISTOGRAM, reinterpret_cast<UINT8*>(blob.get()), size, &size) ==
+            S_OK);
+    REQUIRE(blob->blob.Size == sizeof(blob_t));
+    REQUIRE(blob->blob.Histograms == 1);
+    REQUIRE(blob->header.Size == sizeof(HistogramHeader) + sizeof(blob->channels));
+    REQUIRE(blob->header.Bins == 256);
+    REQUIRE(blob->header.FourCC == MFVideoFormat_RGB32.Data1);
+    REQUIRE(blob->header.Grid.Width == 64);
+    REQUIRE(blob->header.Grid.Height == 48);
+    REQUIRE(blob->header.Grid.Region.right == 63);
+    REQUIRE(blob->header.Grid.Region.bottom == 47);
+    // Y(faked with G), R, G, B
+    const uint32_t masks[4]{histogram_channel_y, histogram_channel_r, histogram_channel_g, histogram_channel_b};
+    const uint32_t* bins[4]{histogram->p1, histogram->p0, histogram->p1, histogram->p2};
+    for (uint32_t i = 0; i < 4; ++i) {
+        const auto& channel = blob->channels[i];
+        REQUIRE(channel.header.Size == sizeof(channel));
+        REQUIRE(channel.header.ChannelMask == masks[i]);
+        REQUIRE(channel.header.Linear == 1);
+        REQUIRE(memcmp(channel.color, bins[i], sizeof(channel.color)) == 0);
+    }
+
+    histogram->channel_mask = 0;
+    REQUIRE(set_capture_histogram(metadata.get(), *histogram) == S_FALSE);
+}
+
+TEST_CASE("compute_capture_histogram") {
+    auto on_return = media_startup();
+
+    com_ptr<IMFMediaType> type{};
+    REQUIRE(make_video_type(type.put(), MFVideoFormat_NV12) == S_OK);
+    REQUIRE(MFSetAttributeSize(type.get(), MF_MT_FRAME_SIZE, 66, 48) == S_OK);
+    frame_buffer_t frame{pixel_format_t::nv12, 66, 48};
+    fill_random(frame, 22);
+    auto expected = std::make_unique<histogram_t>();
+    REQUIRE(compute_histogram(frame.view(), *expected));
+
+    com_ptr<IMFMediaBuffer> buffer{};
+    REQUIRE(create_media_buffer(std::move(frame), buffer.put()) == S_OK);
+    com_ptr<IMFSample> sample{};
+    REQUIRE(MFCreateSample(sample.put()) == S_OK);
+    REQUIRE(sample->AddBuffer(buffer.get()) == S_OK);
+
+    REQUIRE(compute_capture_histogram(sample.get(), type.get()) == S_OK);
+    com_ptr<IMFAttributes> metadata{};
+    REQUIRE(sample->GetUnknown(MFSampleExtension_CaptureMetadata, IID_PPV_ARGS(metadata.put())) == S_OK);
+    auto blob = std::make_unique<histogram_blob_t<3>>();
+    UINT32 size = 0;
+    REQUIRE(metadata->GetBlob(MF_CAPTURE_METADATA_HISTOGRAM, reinterpret_cast<UINT8*>(blob.get()), sizeof(*blob),
+                              &size) == S_OK);
+    REQUIRE(size == sizeof(*blob));
+    REQUIRE(blob->channels[0].header.ChannelMask == histogram_channel_y);
+    REQUIRE(memcmp(blob->channels[0].color, expected->p0, sizeof(expected->p0)) == 0);
+    // the histogram of the source is kept
+    REQUIRE(compute_capture_histogram(sample.get(), type.get()) == S_FALSE);
+}
+
+TEST_CASE("create_shared_sample") {
+    auto on_return = media_startup();
+
+    const std::vector<uint8_t> memory(1920 * 1080 * 3 / 2, 0x80);
+    com_ptr<IMFMediaBuffer> buffer{};
+    REQUIRE(create_media_buffer(make_buffer_view(memory.data(), memory.size()), buffer.put()) == S_OK);
+    com_ptr<IMFSample> preview{};
+    REQUIRE(MFCreateSample(preview.put()) == S_OK);
+    REQUIRE(preview->AddBuffer(buffer.get()) == S_OK);
+    REQUIRE(preview->SetSampleTime(1234) == S_OK);
+
+    com_ptr<IMFSample> recording{};
+    REQUIRE(create_shared_sample(preview.get(), recording.put()) == S_OK);
+    LONGLONG time = 0;
+    REQUIRE(recording->GetSampleTime(&time) == S_OK);
+    REQUIRE(time == 1234);
+
+    com_ptr<IMFMediaBuffer> shared{};
+    REQUIRE(recording->GetBufferByIndex(0, shared.put()) == S_OK);
+    buffer_view_t lhs{}, rhs{};
+    REQUIRE(get_buffer_view(buffer.get(), lhs) == S_OK);
+    REQUIRE(get_buffer_view(shared.get(), rhs) == S_OK);
+    REQUIRE(lhs.data() == rhs.data()); // no copy
+
+    // the read doesn't copy
+    BYTE* ptr = nullptr;
+    REQUIRE(shared->Lock(&ptr, nullptr, nullptr) == S_OK);
+    REQUIRE(ptr == lhs.data());
+    REQUIRE(shared->Unlock() == S_OK);
+
+    // the mutation of the recording doesn't affect the preview
+    REQUIRE(lock_for_write(shared.get(), &ptr, nullptr) == S_OK);
+    REQUIRE(ptr != lhs.data());
+    ptr[0] = 0;
+    REQUIRE(shared->Unlock() == S_OK);
+    REQUIRE(lhs.data()[0] == 0x80);
+}
+
+/// @brief `IMFSample` with `count` buffers which have the same size
+static HRESULT make_multi_buffer_sample(IMFSample** sample, DWORD count, DWORD bufsz) {
+    if (auto hr = MFCreateSample(sample))
+        return hr;
+    for (DWORD i = 0; i < count; ++i) {
+        com_ptr<IMFMediaBuffer> buffer{};
+        if (auto hr = MFCreateMemoryBuffer(bufsz, buffer.put()))
+            return hr;
+        if (auto hr = buffer->SetCurrentLength(bufsz))
+            return hr;
+        if (auto hr = (*sample)->AddBuffer(buffer.get()))
+            return hr;
+    }
+    return S_OK;
+}
+
+TEST_CASE("sample_spans_t") {
+    auto on_return = media_startup();
+    com_ptr<IMFSample> sample{};
+    REQUIRE(make_multi_buffer_sample(sample.put(), 3, 1024) == S_OK);
+
+    sample_spans_t spans{};
+    REQUIRE(spans.lock(sample.get()) == S_OK);
+    REQUIRE(spans.get().count() == 3);
+    REQUIRE(spans.get().total_size() == 3 * 1024);
+
+    // the span is the memory of the buffer. not a copy
+    com_ptr<IMFMediaBuffer> buffer{};
+    REQUIRE(sample->GetBufferByIndex(1, buffer.put()) == S_OK);
+    BYTE* ptr = nullptr;
+    REQUIRE(buffer->Lock(&ptr, nullptr, nullptr) == S_OK);
+    REQUIRE(ptr == spans.get()[1].data);
+    REQUIRE(buffer->Unlock() == S_OK);
+
+    spans.unlock();
+    REQUIRE(spans.get().count() == 0);
+}
+
+TEST_CASE("sample_spans_t benchmark", "[!benchmark]") {
+    auto on_return = media_startup();
+    const DWORD bufsz = 1920 * 1080 * 3 / 2;
+    for (DWORD count : {3ul, 64ul}) {
+        com_ptr<IMFSample> source{};
+        REQUIRE(make_multi_buffer_sample(source.put(), count, bufsz / count) == S_OK);
+        // `ConvertToContiguousBuffer` replaces the buffers of the sample. each run uses a new sample
+        auto make_sample = [source, count]() {
+            com_ptr<IMFSample> sample{};
+            MFCreateSample(sample.put());
+            for (DWORD i = 0; i < count; ++i) {
+                com_ptr<IMFMediaBuffer> buffer{};
+                source->GetBufferByIndex(i, buffer.put());
+                sample->AddBuffer(buffer.get());
+            }
+            return sample;
+        };
+        BENCHMARK("ConvertToContiguousBuffer(" + std::to_string(count) + " buffers)") {
+            com_ptr<IMFSample> sample = make_sample();
+            com_ptr<IMFMediaBuffer> buffer{};
+            sample->ConvertToContiguousBuffer(buffer.put());
+            BYTE* ptr = nullptr;
+            DWORD length = 0;
+            buffer->Lock(&ptr, nullptr, &length);
+            uint32_t sum = 0;
+            for (DWORD i = 0; i < length; i += 64)
+                sum += ptr[i];
+            buffer->Unlock();
+            return sum;
+        };
+        BENCHMARK("sample_spans_t(" + std::to_string(count) + " buffers)") {
+            com_ptr<IMFSample> sample = make_sample();
+            sample_spans_t spans{};
+            spans.lock(sample.get());
+            uint32_t sum = 0;
+            for (const byte_span_t& span : spans.get())
+                for (size_t i = 0; i < span.size; i += 64)
+                    sum += span.data[i];
+            return sum;
+        };
+    }
+}
+
 // see https://docs.microsoft.com/en-us/windows/win32/medfound/h-264-video-decoder
 // see https://docs.microsoft.com/en-us/windows/win32/medfound/basic-mft-processing-model
 TEST_CASE("MFTransform - H.264 Decoder", "[codec]") {
@@ -195,6 +601,20 @@ TEST_CASE("MFTransform - H.264 Decoder", "[codec]") {
         REQUIRE(count);
     }
 
+    SECTION("Pipelined") {
+        INFO("testing read/transform on the worker threads with process_pipelined");
+        size_t count = 0;
+        HRESULT ec = S_OK;
+        for (com_ptr<IMFSample> output_sample : process_pipelined(transform, istream, ostream, source_reader, ec)) {
+            if (auto hr = check_sample(output_sample))
+                FAIL(to_readable(hr));
+            ++count;
+        }
+        if (FAILED(ec))
+            FAIL(to_readable(ec));
+        REQUIRE(count);
+    }
+
     SECTION("Synchronous(Detailed)") {
         bool input_available = true;
         while (input_available) {